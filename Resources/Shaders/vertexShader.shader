@@ -15,6 +15,10 @@ layout(location = 0) in vec4 position; // Vertices' positions.
 layout(location = 1) in vec2 texCoord;
 layout(location = 2) in vec3 normal;
 
+// Per instance attributes used for instanced entity rendering (see the 'entityInstance' struct).
+layout(location = 3) in vec3 instancePos;
+layout(location = 4) in vec3 instanceRot; // Rotation angles in radians around the X, Y and Z axes.
+
 // This are output varying variables. These are variables that are shared between shader programs.
 out vec2 v_TexCoord;
 out vec3 v_fragPos;
@@ -22,6 +26,7 @@ out vec3 v_normal;
 
 uniform vec3 u_sunLightPos;
 uniform int u_renderMode;
+uniform int u_instanced; // 1 if the vertices belong to a model drawn with instanced rendering.
 uniform mat4 u_MVP; // u_MVP stands for u_Model_view_projection_matrix although only the view and projection matrix are currently used.
 uniform mat4 u_MVPGUI;
 
@@ -34,13 +39,31 @@ void main() {
 		/*
 		3D rendering.
 		*/
+		vec4 worldPosition = position;
+		vec3 worldNormal = normal;
+
+		if (u_instanced == 1) {
+
+			// Rotation around the X axis followed by the one around the Y axis and the one around the Z axis,
+			// the same one applied in the CPU to the vertices of the entity batches.
+			vec3 s = sin(instanceRot),
+				 c = cos(instanceRot);
+			mat3 rotation = mat3(c.z * c.y, s.z * c.y, -s.y,
+								 c.z * s.y * s.x - s.z * c.x, s.z * s.y * s.x + c.z * c.x, c.y * s.x,
+								 c.z * s.y * c.x + s.z * s.x, s.z * s.y * c.x - c.z * s.x, c.y * c.x);
+
+			worldPosition = vec4(rotation * position.xyz + instancePos, 1.0);
+			worldNormal = rotation * normal;
+
+		}
+
 		// Export variables to fragment shader.
 		v_TexCoord = texCoord;
-		v_fragPos = position.xyz;
+		v_fragPos = worldPosition.xyz;
 
-		v_normal = mat3(transpose(inverse(mat3(1)))) * normal;
+		v_normal = mat3(transpose(inverse(mat3(1)))) * worldNormal;
 	
-		gl_Position = u_MVP * position;
+		gl_Position = u_MVP * worldPosition;
 
 	}
 	else {
@@ -1,6 +1,8 @@
 #include "AIGameEx1.h"
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdlib>
 #include <filesystem>
 #include <typeinfo>
 #include "../logger.h"
@@ -26,253 +28,342 @@ namespace AIExample {
 		if (miningAIGame* game = dynamic_cast<miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())) {
 
 			GeneticNeuralNetwork& individual = game->getGenetic().individual(individualID);
-			VoxelEng::vec3 posBox1,
-						   posBox2;
-			VoxelEng::block blockObtained = 0;
-			bool hasObtainedBlock = false;
-			VoxelEng::blockViewDir blockViewDir = VoxelEng::blockViewDir::NONE;
-			unsigned int depth = game->visionDepth(),
-				         radius = game->visionRadius(),
-				         action = 0;
-			std::vector<VoxelEng::block> seenBlocks;
-			unsigned int remainingActions = game->nInitialActions(),
-				         nActionsNoCostPerformed = 0;
+			std::vector<int> networkInput(game->vision(individualID).nBlocks() + 2);
 
 
-			while (remainingActions) {
-			
-				// Get input for the neural network.
-				// That is, get the blocks in front of where the
-				// agent is looking, the agent's position in the y-axis
-				// and the direction it is currently looking at.
+			miningAIGameBegin(individualID);
 
-				posBox1 = game->getEntityPos(individualID);
-				posBox2 = posBox1;
+			while (miningAIGameObserve(individualID, networkInput.data()))
+				miningAIGameAct(individualID, individual.forwardPropagationMax<int>(networkInput)); // Pass obtained input to the neural network to get the action to perform.
 
-				blockViewDir = game->getBlockViewDir(individualID);
-				const VoxelEng::vec3& pos = game->getEntityPos(individualID);
+			//VoxelEng::logger::debugLog(std::to_string(individualID) + " score " + std::to_string(game->getScore(individualID)));
+			return game->getScore(individualID);
 
-				// Get information related to the direction the agent is looking at.
-				switch (blockViewDir) {
-				
-					case VoxelEng::blockViewDir::PLUSY:
+		}
+		else
+			VoxelEng::logger::errorLog("Loaded AI game is not a mining AI game");
+	}
 
-						posBox1.y += 1;
-						posBox1.x += radius;
-						posBox1.z += radius;
+	void miningAIGameBegin(unsigned int individualID) {
 
-						posBox2.y += depth;
-						posBox2.x -= radius - 1;
-						posBox2.z -= radius - 1;
+		if (miningAIGame* game = dynamic_cast<miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())) {
 
-						break;
+			game->remainingActions(individualID) = game->nInitialActions();
+			game->nActionsNoCostPerformed(individualID) = 0;
+			game->nActionsPerformed(individualID) = 0;
 
-					case VoxelEng::blockViewDir::NEGY:
+			// The vision buffer is filled once per match. After that, only the
+			// blocks that become visible when the agent moves are queried.
+			game->vision(individualID).reset(game->getEntityPos(individualID));
 
-						posBox1.y -= 1;
-						posBox1.x -= radius;
-						posBox1.z -= radius;
+		}
+		else
+			VoxelEng::logger::errorLog("Loaded AI game is not a mining AI game");
 
-						posBox2.y -= depth;
-						posBox2.x += radius - 1;
-						posBox2.z += radius - 1;
+	}
 
-						break;
+	bool miningAIGameObserve(unsigned int individualID, int* input) {
 
-					case VoxelEng::blockViewDir::PLUSX:
+		if (miningAIGame* game = dynamic_cast<miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())) {
 
-						posBox1.x += 1;
-						posBox1.y += radius;
-						posBox1.z += radius;
+			if (!game->remainingActions(individualID))
+				return false;
 
-						posBox2.x += depth;
-						posBox2.y -= radius - 1;
-						posBox2.z -= radius - 1;
+			// Get input for the neural network.
+			// That is, get the blocks in front of where the
+			// agent is looking, the agent's position in the y-axis
+			// and the direction it is currently looking at.
 
-						break;
+			agentVision& vision = game->vision(individualID);
+			unsigned int nSeenBlocks = vision.nBlocks();
+			VoxelEng::blockViewDir blockViewDir = game->getBlockViewDir(individualID);
 
-					case VoxelEng::blockViewDir::NEGX:
+			vision.observe(blockViewDir, input);
+			input[nSeenBlocks] = game->getEntityPos(individualID).y;
+			input[nSeenBlocks + 1] = static_cast<unsigned int>(blockViewDir);
 
-						posBox1.x -= 1;
-						posBox1.y -= radius;
-						posBox1.z -= radius;
+			return true;
 
-						posBox2.x -= depth;
-						posBox2.y += radius - 1;
-						posBox2.z += radius - 1;
+		}
+		else
+			VoxelEng::logger::errorLog("Loaded AI game is not a mining AI game");
 
-						break;
+	}
 
-					case VoxelEng::blockViewDir::PLUSZ:
+	void miningAIGameAct(unsigned int individualID, unsigned int action) {
 
-						posBox1.z += 1;
-						posBox1.x += radius;
-						posBox1.y += radius;
+		if (miningAIGame* game = dynamic_cast<miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())) {
 
-						posBox2.z += depth;
-						posBox2.x -= radius - 1;
-						posBox2.y -= radius - 1;
+			agentVision& vision = game->vision(individualID);
+			unsigned int& remainingActions = game->remainingActions(individualID),
+						& nActionsNoCostPerformed = game->nActionsNoCostPerformed(individualID);
+			VoxelEng::blockViewDir blockViewDir = game->getBlockViewDir(individualID);
+			VoxelEng::vec3 pos = game->getEntityPos(individualID),
+						   movement,
+						   frontPos;
+			VoxelEng::block blockObtained = 0;
 
-						break;
 
-					case VoxelEng::blockViewDir::NEGZ:
+			game->nActionsPerformed(individualID)++;
 
-						posBox1.z -= 1;
-						posBox1.x -= radius;
-						posBox1.y -= radius;
+			switch (action) {
+				
+				case 0: // Move forward to the direction the agent is looking at.
+					movement = VoxelEng::uDirectionToVec3(blockViewDir);
+					game->moveEntity(individualID, movement);
+					vision.move(movement);
+					remainingActions--;
+					break;
 
-						posBox2.z -= depth;
-						posBox2.x += radius - 1;
-						posBox2.y += radius - 1;
+				case 1: // Rotate agent 90 degrees in the X axis.
+					game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::PLUSX);
+					nActionsNoCostPerformed++;
+					break;
 
-						break;
+				case 2:  // Rotate agent -90 degrees in the X axis.
+					game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::NEGX);
+					nActionsNoCostPerformed++;
+					break;
+
+				case 3:  // Rotate agent 90 degrees in the Y axis.
+					game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::PLUSY);
+					nActionsNoCostPerformed++;
+					break;
+
+				case 4:  // Rotate agent -90 degrees in the Y axis.
+					game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::NEGY);
+					nActionsNoCostPerformed++;
+					break;
+
+				case 5: // Get block in front of the agent and get the points
+						// corresponding to the block's type.
+	
+					frontPos = pos + VoxelEng::uDirectionToVec3(blockViewDir);
+
+					if (game->isInWorld(frontPos)) {
+
+						game->selectAIworld(individualID);
+						blockObtained = game->setBlock(individualID, frontPos.x, frontPos.y, frontPos.z, 0, game->recordAgentModifiedBlocks());
+						vision.setBlock(frontPos.x, frontPos.y, frontPos.z, 0);
+
+						game->addScore(individualID, game->blockScore(blockObtained));
+
+					}
+
+					remainingActions--;
+
+					break;
 				
-				}
-				seenBlocks = game->getBlocksBox(posBox1, posBox2);
-				std::vector<int> networkInput(seenBlocks.cbegin(), seenBlocks.cend());
-				networkInput.push_back(pos.y);
-				networkInput.push_back(static_cast<unsigned int>(blockViewDir));
+			}
+
+			// End of "turn".
+			if (nActionsNoCostPerformed >= game->nNoCostActionsToPen()) {
 				
-				// Pass obtained input to the neural network to get
-				// the action to perform.
-				action = individual.forwardPropagationMax<int>(networkInput);
+				remainingActions--;
 
-				switch (action) {
+				nActionsNoCostPerformed = 0;
 				
-					case 0: // Move forward to the direction the agent is looking at.
-						game->moveEntity(individualID, VoxelEng::uDirectionToVec3(blockViewDir));
-						remainingActions--;
-						break;
+			}
 
-					case 1: // Rotate agent 90 degrees in the X axis.
-						game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::PLUSX);
-						nActionsNoCostPerformed++;
-						break;
+		}
+		else
+			VoxelEng::logger::errorLog("Loaded AI game is not a mining AI game");
 
-					case 2:  // Rotate agent -90 degrees in the X axis.
-						game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::NEGX);
-						nActionsNoCostPerformed++;
-						break;
+	}
 
-					case 3:  // Rotate agent 90 degrees in the Y axis.
-						game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::PLUSY);
-						nActionsNoCostPerformed++;
-						break;
+	float miningAIGameScore(unsigned int individualID) {
 
-					case 4:  // Rotate agent -90 degrees in the Y axis.
-						game->rotateAgentViewDir(individualID, VoxelEng::blockViewDir::NEGY);
-						nActionsNoCostPerformed++;
-						break;
+		if (miningAIGame* game = dynamic_cast<miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame()))
+			return game->getScore(individualID);
+		else
+			VoxelEng::logger::errorLog("Loaded AI game is not a mining AI game");
 
-					case 5: // Get block in front of the agent and get the points
-							// corresponding to the block's type.
-	
-						switch (blockViewDir) {
-					
-						case VoxelEng::blockViewDir::PLUSX:
+	}
 
-							if (game->isInWorld(pos.x + 1, pos.y, pos.z)) {
-						
-								game->selectAIworld(individualID);
-								blockObtained = game->setBlock(individualID, pos.x + 1, pos.y, pos.z, 0, game->recordAgentModifiedBlocks());
-								hasObtainedBlock = true;
-						
-							}
-						
-							break;
 
-						case VoxelEng::blockViewDir::NEGX:
+	// 'agentVision' class.
 
-							if (game->isInWorld(pos.x - 1, pos.y, pos.z)) {
+	agentVision::agentVision(unsigned int depth, unsigned int radius)
+		: depth_(depth), radius_(radius), extent_(std::max(depth, radius)), side_(2 * extent_ + 1),
+		posX_(0), posY_(0), posZ_(0), initialised_(false), blocks_(side_* side_* side_, 0)
+	{}
 
-								game->selectAIworld(individualID);
-								blockObtained = game->setBlock(individualID, pos.x - 1, pos.y, pos.z, 0, game->recordAgentModifiedBlocks());
-								hasObtainedBlock = true;
+	void agentVision::observe(VoxelEng::blockViewDir viewDir, int* input) const {
 
-							}
+		int x1, y1, z1,
+			x2, y2, z2;
+		unsigned int n = 0;
 
-							break;
 
-						case VoxelEng::blockViewDir::PLUSY:
+		if (!initialised_)
+			VoxelEng::logger::errorLog("Agent vision buffer was not initialised");
 
-							if (game->isInWorld(pos.x, pos.y + 1, pos.z)) {
+		viewBox_(viewDir, x1, y1, z1, x2, y2, z2);
 
-								game->selectAIworld(individualID);
-								blockObtained = game->setBlock(individualID, pos.x, pos.y + 1, pos.z, 0, game->recordAgentModifiedBlocks());
-								hasObtainedBlock = true;
+		// Same traversal order as chunkManager::getBlocksBox().
+		int iInc = (x1 <= x2) ? 1 : -1,
+			jInc = (y1 <= y2) ? 1 : -1,
+			kInc = (z1 <= z2) ? 1 : -1;
+		x2 += iInc;
+		y2 += jInc;
+		z2 += kInc;
 
-							}
-						
-							break;
+		for (int i = x1; i != x2; i += iInc)
+			for (int j = y1; j != y2; j += jInc)
+				for (int k = z1; k != z2; k += kInc)
+					input[n++] = blocks_[index_(i, j, k)];
 
-						case VoxelEng::blockViewDir::NEGY:
+	}
 
-							if (game->isInWorld(pos.x, pos.y - 1, pos.z)) {
+	void agentVision::reset(const VoxelEng::vec3& pos) {
 
-								game->selectAIworld(individualID);
-								blockObtained = game->setBlock(individualID, pos.x, pos.y - 1, pos.z, 0, game->recordAgentModifiedBlocks());
-								hasObtainedBlock = true;
+		posX_ = pos.x;
+		posY_ = pos.y;
+		posZ_ = pos.z;
 
-							}
-						
-							break;
+		fetch_(posX_ - extent_, posY_ - extent_, posZ_ - extent_, posX_ + extent_, posY_ + extent_, posZ_ + extent_);
 
-						case VoxelEng::blockViewDir::PLUSZ:
+		initialised_ = true;
 
-							if (game->isInWorld(pos.x, pos.y, pos.z + 1)) {
+	}
 
-								game->selectAIworld(individualID);
-								blockObtained = game->setBlock(individualID, pos.x, pos.y, pos.z + 1, 0, game->recordAgentModifiedBlocks());
-								hasObtainedBlock = true;
+	void agentVision::move(const VoxelEng::vec3& movement) {
 
-							}
-						
-							break;
+		int x = movement.x,
+			y = movement.y,
+			z = movement.z;
 
-						case VoxelEng::blockViewDir::NEGZ:
+		if (!x && !y && !z)
+			return;
 
-							if (game->isInWorld(pos.x, pos.y, pos.z - 1)) {
+		if (!initialised_ || std::abs(x) + std::abs(y) + std::abs(z) != 1)
+			reset(VoxelEng::vec3(posX_ + x, posY_ + y, posZ_ + z));
+		else {
 
-								game->selectAIworld(individualID);
-								blockObtained = game->setBlock(individualID, pos.x, pos.y, pos.z - 1, 0, game->recordAgentModifiedBlocks());
-								hasObtainedBlock = true;
+			posX_ += x;
+			posY_ += y;
+			posZ_ += z;
 
-							}
-						
-							break;
-					
-						}
+			// The cells of the face left behind are the same ones that the new face uses,
+			// so overwriting them is enough to shift the buffer.
+			if (x)
+				fetch_(posX_ + x * extent_, posY_ - extent_, posZ_ - extent_, posX_ + x * extent_, posY_ + extent_, posZ_ + extent_);
+			else if (y)
+				fetch_(posX_ - extent_, posY_ + y * extent_, posZ_ - extent_, posX_ + extent_, posY_ + y * extent_, posZ_ + extent_);
+			else
+				fetch_(posX_ - extent_, posY_ - extent_, posZ_ + z * extent_, posX_ + extent_, posY_ + extent_, posZ_ + z * extent_);
 
-						if (hasObtainedBlock) {
-					
-							game->addScore(individualID, game->blockScore(blockObtained));
-							hasObtainedBlock = false;
-					
-						}
+		}
 
-						remainingActions--;
+	}
 
-						break;
-				
-				}
+	void agentVision::setBlock(int x, int y, int z, VoxelEng::block blockID) {
 
-				// End of "turn".
-				if (nActionsNoCostPerformed >= 10) {
-				
-					remainingActions--;
+		if (std::abs(x - posX_) <= extent_ && std::abs(y - posY_) <= extent_ && std::abs(z - posZ_) <= extent_)
+			blocks_[index_(x, y, z)] = blockID;
 
-					nActionsNoCostPerformed = 0;
-				
-				}
-			
-			}
+	}
 
-			//VoxelEng::logger::debugLog(std::to_string(individualID) + " score " + std::to_string(game->getScore(individualID)));
-			return game->getScore(individualID);
+	void agentVision::viewBox_(VoxelEng::blockViewDir viewDir, int& x1, int& y1, int& z1, int& x2, int& y2, int& z2) const {
+
+		int depth = depth_,
+			radius = radius_;
+
+		x1 = x2 = posX_;
+		y1 = y2 = posY_;
+		z1 = z2 = posZ_;
+
+		switch (viewDir) {
+
+			case VoxelEng::blockViewDir::PLUSY:
+
+				y1 += 1;
+				x1 += radius;
+				z1 += radius;
+
+				y2 += depth;
+				x2 -= radius - 1;
+				z2 -= radius - 1;
+
+				break;
+
+			case VoxelEng::blockViewDir::NEGY:
+
+				y1 -= 1;
+				x1 -= radius;
+				z1 -= radius;
+
+				y2 -= depth;
+				x2 += radius - 1;
+				z2 += radius - 1;
+
+				break;
+
+			case VoxelEng::blockViewDir::PLUSX:
+
+				x1 += 1;
+				y1 += radius;
+				z1 += radius;
+
+				x2 += depth;
+				y2 -= radius - 1;
+				z2 -= radius - 1;
+
+				break;
+
+			case VoxelEng::blockViewDir::NEGX:
+
+				x1 -= 1;
+				y1 -= radius;
+				z1 -= radius;
+
+				x2 -= depth;
+				y2 += radius - 1;
+				z2 += radius - 1;
+
+				break;
+
+			case VoxelEng::blockViewDir::PLUSZ:
+
+				z1 += 1;
+				x1 += radius;
+				y1 += radius;
+
+				z2 += depth;
+				x2 -= radius - 1;
+				y2 -= radius - 1;
+
+				break;
+
+			case VoxelEng::blockViewDir::NEGZ:
+
+				z1 -= 1;
+				x1 -= radius;
+				y1 -= radius;
+
+				z2 -= depth;
+				x2 += radius - 1;
+				y2 += radius - 1;
+
+				break;
+
+			default:
+
+				VoxelEng::logger::errorLog("Invalid view direction for the agent's vision box");
+
+				break;
 
 		}
-		else
-			VoxelEng::logger::errorLog("Loaded AI game is not a mining AI game");
+
+	}
+
+	void agentVision::fetch_(int x1, int y1, int z1, int x2, int y2, int z2) {
+
+		for (int i = x1; i <= x2; i++)
+			for (int j = y1; j <= y2; j++)
+				for (int k = z1; k <= z2; k++)
+					blocks_[index_(i, j, k)] = (VoxelEng::chunkManager::isInWorld(i, j, k)) ? VoxelEng::chunkManager::getBlock(i, j, k) : 0;
+
 	}
 
 
@@ -288,7 +379,7 @@ namespace AIExample {
 		chunkColHeight_.clear();
 
 		if (!VoxelEng::game::selectedSaveSlot() && VoxelEng::chunkManager::openedTerrainFileName().empty())
-			setSeed();
+			newSeed_();
 
 		playerSpawnPos_.x = 0;
 		playerSpawnPos_.y = chunkHeightMap_({ 0, 0 })[0][0] + 10;
@@ -541,11 +632,7 @@ namespace AIExample {
 	void miningWorldGen::cascadeOreGen_(const VoxelEng::vec3 chunkPos, unsigned int& nBlocksCounter, unsigned int nBlocks,
 		unsigned int inChunkX, unsigned int inChunkY, unsigned int inChunkZ, VoxelEng::block oreID) {
 
-		VoxelEng::chunk* cascadeChunk = nullptr;
-		if (VoxelEng::chunkManager::getChunkLoadLevel(chunkPos) == VoxelEng::chunkLoadLevel::NOTLOADED)
-			cascadeChunk = VoxelEng::chunkManager::createChunk(true, chunkPos);
-		else
-			cascadeChunk = VoxelEng::chunkManager::selectChunkByChunkPos(chunkPos);
+		VoxelEng::chunk* cascadeChunk = levelChunk_(chunkPos);
 		unsigned int spreadDirection = 0;
 		for (nBlocksCounter; nBlocksCounter < nBlocks; nBlocksCounter++) {
 
@@ -654,6 +741,38 @@ namespace AIExample {
 
 	}
 
+	void miningAIGame::benchmarkInference(unsigned int nActions) {
+
+		std::vector<unsigned int> sizeLayer;
+		std::vector<float> weights;
+		std::uniform_real_distribution<float> weightDist(-5.0f, 5.0f);
+
+
+		generalSetUp_();
+
+		// Same topology and initial weight range as the trained agents.
+		sizeLayer = { nInputs_, 50, 50, 50, 50, 50, 6 };
+		weights.resize(GeneticNeuralNetwork::nWeights(sizeLayer));
+		for (std::size_t i = 0; i < weights.size(); i++)
+			weights[i] = weightDist(randGen_);
+
+		// The inputs are mostly the IDs of the blocks seen by the agent.
+		GeneticNeuralNetwork(weights.data(), sizeLayer).benchmarkForwardPropagation(nActions, 0, 10);
+
+	}
+
+	void miningAIGame::benchmarkAgentsData(unsigned int nAgents, unsigned int nRepetitions) {
+
+		generalSetUp_();
+
+		// Same topology and initial weight range as the trained agents.
+		genetic_.setNetworkTaxonomy({ nInputs_, 50, 50, 50, 50, 50, 6 });
+		genetic_.genInitPop(nAgents, -5.0f, 5.0f, false);
+
+		genetic_.benchmarkIndividualsData((std::filesystem::temp_directory_path() / "VoxelEngAIDataBenchmark").string(), nRepetitions);
+
+	}
+
 	float miningAIGame::blockScore(VoxelEng::block ID) const {
 
 		if (blockScore_.contains(ID))
@@ -680,7 +799,10 @@ namespace AIExample {
 
 		genetic_.setGame();
 		genetic_.setFitnessFunction(miningAIGameFitness);
+		genetic_.setLockstepFunctions(miningAIGameBegin, miningAIGameObserve, miningAIGameAct, miningAIGameScore);
 		genetic_.setNThreads();
+		genetic_.setEvaluationMode(evaluationMode::INDIVIDUAL);
+		genetic_.setTimingsReport(false);
 
 		if (!VoxelEng::worldGen::isGenRegistered("miningWorldGen"))
 			VoxelEng::worldGen::registerGen<AIExample::miningWorldGen>("miningWorldGen");
@@ -953,6 +1075,30 @@ namespace AIExample {
 
 	}
 
+	void miningAIGame::setUpHeadlessTraining_(unsigned int seed, unsigned int nThreads, unsigned int nProcesses, const std::string& executable) {
+
+		randGen_.seed(seed);
+		VoxelEng::worldGen::setSeed(seed);
+
+		genetic_.setNThreads(nThreads);
+		if (nProcesses) {
+
+			genetic_.setWorkerProcesses(nProcesses, executable);
+			genetic_.setEvaluationMode(evaluationMode::MULTIPROCESS);
+
+		}
+		else
+			genetic_.setEvaluationMode(evaluationMode::LOCKSTEP);
+		genetic_.setTimingsReport(true);
+
+	}
+
+	void miningAIGame::serveFitnessRequests_(VoxelEng::processChannel& channel) {
+
+		genetic_.serveFitnessRequests(popSize_, channel);
+
+	}
+
 	void miningAIGame::train_() {
 
 		// Begin training.
@@ -1037,6 +1183,15 @@ namespace AIExample {
 		
 			const VoxelEng::vec3& spawnPos = dynamic_cast<miningWorldGen&>(VoxelEng::worldGen::selectedGen()).spawnPos();
 
+			if (visions_.size() != nAgents) {
+
+				visions_ = std::vector<agentVision>(nAgents, agentVision(visionDepth_, visionRadius_));
+				remainingActions_ = std::vector<unsigned int>(nAgents, 0);
+				nActionsNoCostPerformed_ = std::vector<unsigned int>(nAgents, 0);
+				nActionsPerformed_ = std::vector<unsigned int>(nAgents, 0);
+
+			}
+
 			if (AIagentEntityID_.empty())
 				for (unsigned int i = 0; i < nAgents; i++) {
 
@@ -1047,9 +1202,11 @@ namespace AIExample {
 			else // Reuse already created entity objects to spawn the agents if they exist.
 				for (unsigned int i = 0; i < nAgents; i++) {
 				
+					// Every match must start from the same state as when the agent was created,
+					// since the fitness cache assumes that the same genome always gets the same fitness.
 					scores_[i] = 0;
 					setEntityPos(AIagentEntityID_[i], spawnPos);
-					rotateAgentViewDir(i, VoxelEng::blockViewDir::PLUSX);
+					setAgentViewDir(i, VoxelEng::blockViewDir::PLUSX);
 				
 				}
 				
@@ -1073,6 +1230,10 @@ namespace AIExample {
 		AIagentLookDirection_.clear();
 		freeAIagentID_.clear();
 		scores_.clear();
+		visions_.clear();
+		remainingActions_.clear();
+		nActionsNoCostPerformed_.clear();
+		nActionsPerformed_.clear();
 		VoxelEng::chunk::cleanUp();
 		VoxelEng::chunkManager::clean();
 		VoxelEng::entityManager::clean();
@@ -17,6 +17,8 @@
 #include "../definitions.h"
 #include "../worldGen.h"
 #include "../chunk.h"
+#include "../counterRNG.h"
+#include "../utilities.h"
 #include "genetic.h"
 #include "NN.h"
 
@@ -28,8 +30,36 @@ namespace AIExample {
 	//Function prototypes.//
 	////////////////////////
 
+	/**
+	* @brief Plays a whole match with the specified agent and returns its score.
+	*/
 	float miningAIGameFitness(unsigned int individualID);
 
+	/**
+	* @brief Prepares the specified agent to begin a match.
+	* Used for lockstep evaluation of the population.
+	*/
+	void miningAIGameBegin(unsigned int individualID);
+
+	/**
+	* @brief Writes in 'input' the neural network input of the specified agent.
+	* Returns false without writing anything if the agent has no actions left.
+	* Used for lockstep evaluation of the population.
+	*/
+	bool miningAIGameObserve(unsigned int individualID, int* input);
+
+	/**
+	* @brief Performs the specified action with the specified agent.
+	* Used for lockstep evaluation of the population.
+	*/
+	void miningAIGameAct(unsigned int individualID, unsigned int action);
+
+	/**
+	* @brief Returns the current score of the specified agent.
+	* Used for lockstep evaluation of the population.
+	*/
+	float miningAIGameScore(unsigned int individualID);
+
 
 	/////////////
 	//Typedefs.//
@@ -150,6 +180,155 @@ namespace AIExample {
 	}
 
 
+	// 'agentVision' class.
+
+	/**
+	* @brief Incremental observation buffer for one mining AI agent.
+	* It caches the cube of blocks surrounding the agent that contains the
+	* vision boxes of all six view directions, addressed by world coordinates
+	* modulo the cube's side. Moving one block only fetches the newly exposed
+	* face of the cube and rotating the agent's view only re-indexes the
+	* cached blocks, so no world access is needed.
+	* WARNING. The agent's own world modifications must be notified with
+	* agentVision::setBlock() to keep the buffer up to date.
+	*/
+	class agentVision {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Default constructor.
+		*/
+		agentVision();
+
+		/**
+		* @brief Class constructor.
+		*/
+		agentVision(unsigned int depth, unsigned int radius);
+
+
+		// Observers.
+
+		/**
+		* @brief Number of blocks inside the vision box of an agent.
+		*/
+		unsigned int nBlocks() const;
+
+		/**
+		* @brief Returns true if the buffer has been filled with a call to agentVision::reset().
+		*/
+		bool initialised() const;
+
+		/**
+		* @brief Writes the blocks seen while looking in the specified direction
+		* into the first agentVision::nBlocks() elements of 'input'.
+		* The blocks are written in the same order as aiGame::getBlocksBox() would
+		* return them for said vision box.
+		*/
+		void observe(VoxelEng::blockViewDir viewDir, int* input) const;
+
+		/**
+		* @brief Same as agentVision::observe(VoxelEng::blockViewDir viewDir, int* input) but
+		* checking that 'input' is big enough.
+		*/
+		void observe(VoxelEng::blockViewDir viewDir, std::vector<int>& input) const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Fill the whole buffer with the blocks surrounding 'pos'.
+		*/
+		void reset(const VoxelEng::vec3& pos);
+
+		/**
+		* @brief Update the buffer after the agent has been moved by 'movement'.
+		* Unit movements along one axis only fetch the newly exposed face of
+		* blocks. Any other movement refills the whole buffer.
+		*/
+		void move(const VoxelEng::vec3& movement);
+
+		/**
+		* @brief Notify a modification of a block made by the agent.
+		* Blocks outside the buffer are ignored.
+		*/
+		void setBlock(int x, int y, int z, VoxelEng::block blockID);
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		unsigned int depth_,
+					 radius_;
+		int extent_, // Distance from the agent's position to the faces of the cached cube.
+			side_, // Side of the cached cube.
+			posX_,
+			posY_,
+			posZ_;
+		bool initialised_;
+		std::vector<VoxelEng::block> blocks_;
+
+
+		/*
+		Methods.
+		*/
+
+		// Observers.
+
+		unsigned int index_(int x, int y, int z) const;
+
+		/*
+		Gets the two opposite corners of the vision box when looking in 'viewDir'.
+		*/
+		void viewBox_(VoxelEng::blockViewDir viewDir, int& x1, int& y1, int& z1, int& x2, int& y2, int& z2) const;
+
+
+		// Modifiers.
+
+		/*
+		Fetches from the world all the blocks between the two (inclusive) corners
+		of the box and stores them into the buffer.
+		*/
+		void fetch_(int x1, int y1, int z1, int x2, int y2, int z2);
+
+	};
+
+	inline agentVision::agentVision()
+		: agentVision(0, 0)
+	{}
+
+	inline unsigned int agentVision::nBlocks() const {
+
+		return depth_ * 2 * radius_ * 2 * radius_;
+
+	}
+
+	inline bool agentVision::initialised() const {
+
+		return initialised_;
+
+	}
+
+	inline void agentVision::observe(VoxelEng::blockViewDir viewDir, std::vector<int>& input) const {
+
+		if (input.size() < nBlocks())
+			VoxelEng::logger::errorOutOfRange("Input vector is smaller than the agent's vision box");
+
+		observe(viewDir, input.data());
+
+	}
+
+	inline unsigned int agentVision::index_(int x, int y, int z) const {
+
+		return (VoxelEng::floorMod(x, side_) * side_ + VoxelEng::floorMod(y, side_)) * side_ + VoxelEng::floorMod(z, side_);
+
+	}
+
+
 	// 'miningAIGame' class.
 
 	/**
@@ -185,6 +364,28 @@ namespace AIExample {
 		*/
 		unsigned int visionRadius() const;
 
+		/**
+		* @brief Get the incremental vision buffer of an AI agent without bounds checking.
+		*/
+		agentVision& vision(unsigned int individualID);
+
+		/**
+		* @brief Get the number of actions that an AI agent has left in the current match without bounds checking.
+		*/
+		unsigned int& remainingActions(unsigned int individualID);
+
+		/**
+		* @brief Get the number of actions without cost that an AI agent has performed since its last penalization
+		* without bounds checking.
+		*/
+		unsigned int& nActionsNoCostPerformed(unsigned int individualID);
+
+		/**
+		* @brief Get the total number of actions (with or without cost) that an AI agent has performed
+		* in the current match without bounds checking.
+		*/
+		unsigned int& nActionsPerformed(unsigned int individualID);
+
 		/**
 		* @brief Get the score associated with a specified block ID.
 		*/
@@ -215,6 +416,12 @@ namespace AIExample {
 		*/
 		af::randomEngine& AIrandEng();
 
+		/**
+		* @brief The counter-based random generator used by the AI game with things that do not involve terrain generation.
+		* It shares its seed with the one returned by miningAIGame::AIrandEng() and can be used by several threads at the same time.
+		*/
+		const VoxelEng::counterRNG& AIcounterRNG() const;
+
 		/**
 		* @brief Set seed used to generate random weight data when creating new neural networks and
 		* similar uses.
@@ -262,6 +469,21 @@ namespace AIExample {
 		*/
 		void saveAgentsData(const std::string& path);
 
+		/**
+		* @brief Report the inference speed of a network with the agents' topology and random weights
+		* using 'nActions' random inputs. See GeneticNeuralNetwork::benchmarkForwardPropagation().
+		* WARNING. There cannot be an AI game in progress.
+		*/
+		void benchmarkInference(unsigned int nActions);
+
+		/**
+		* @brief Report how long it takes to save and load 'nAgents' agents with random weights with both
+		* ".aidata" formats, repeating each operation 'nRepetitions' times. See genetic::benchmarkIndividualsData().
+		* The temporary files are created in the system's temporary directory.
+		* WARNING. There cannot be an AI game in progress.
+		*/
+		void benchmarkAgentsData(unsigned int nAgents, unsigned int nRepetitions);
+
 		/**
 		* @brief Sets the agents' model to a registered one.
 		* By default the model used is the default one (model ID = 0).
@@ -304,6 +526,14 @@ namespace AIExample {
 
 		void setUpTraining_(unsigned int nAgents, unsigned nEpochs);
 
+		/*
+		The agents are evaluated in lockstep so that the time spent in the inference
+		can be reported separately from the time spent accessing the world, unless worker processes are requested.
+		*/
+		void setUpHeadlessTraining_(unsigned int seed, unsigned int nThreads, unsigned int nProcesses, const std::string& executable);
+
+		void serveFitnessRequests_(VoxelEng::processChannel& channel);
+
 		void train_();
 
 		bool trainLoadedAgents_(const std::string& path);
@@ -322,6 +552,7 @@ namespace AIExample {
 		std::mt19937 randGen_;
 		std::uniform_int_distribution<unsigned int> UIdist_;
 		af::randomEngine AFrandEng_; // Random engine used separately from the world generation for the AI training.
+		VoxelEng::counterRNG counterRNG_;
 		unsigned int popSize_,
 					 visionDepth_,
 					 visionRadius_,
@@ -332,6 +563,10 @@ namespace AIExample {
 				     agentsModelID_;
 		std::unordered_map<VoxelEng::block, float> blockScore_;
 		std::vector<float> scores_;
+		std::vector<agentVision> visions_;
+		std::vector<unsigned int> remainingActions_,
+								  nActionsNoCostPerformed_,
+								  nActionsPerformed_;
 		genetic genetic_;
 		std::string lastWorldPath_;
 
@@ -351,6 +586,12 @@ namespace AIExample {
 	
 	}
 
+	inline const VoxelEng::counterRNG& miningAIGame::AIcounterRNG() const {
+
+		return counterRNG_;
+
+	}
+
 	inline const genetic& miningAIGame::getGenetic() const {
 
 		return genetic_;
@@ -360,6 +601,7 @@ namespace AIExample {
 	inline void miningAIGame::setAISeed() {
 
 		AFrandEng_.setSeed(UIdist_(randGen_));
+		counterRNG_.setSeed(AFrandEng_.getSeed());
 		VoxelEng::logger::debugLog("AF seed: " + std::to_string(AFrandEng_.getSeed()));
 
 	}
@@ -367,6 +609,7 @@ namespace AIExample {
 	inline void miningAIGame::setAISeed(unsigned int seed) {
 
 		AFrandEng_.setSeed(seed);
+		counterRNG_.setSeed(seed);
 		VoxelEng::logger::debugLog("AF seed: " + std::to_string(AFrandEng_.getSeed()));
 
 	}
@@ -401,6 +644,30 @@ namespace AIExample {
 	
 	}
 
+	inline agentVision& miningAIGame::vision(unsigned int individualID) {
+
+		return visions_[individualID];
+
+	}
+
+	inline unsigned int& miningAIGame::remainingActions(unsigned int individualID) {
+
+		return remainingActions_[individualID];
+
+	}
+
+	inline unsigned int& miningAIGame::nActionsNoCostPerformed(unsigned int individualID) {
+
+		return nActionsNoCostPerformed_[individualID];
+
+	}
+
+	inline unsigned int& miningAIGame::nActionsPerformed(unsigned int individualID) {
+
+		return nActionsPerformed_[individualID];
+
+	}
+
 	inline bool miningAIGame::needsTraining() const {
 	
 		return true;
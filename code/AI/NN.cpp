@@ -1,6 +1,17 @@
 #include "NN.h"
-#include "AIGameEx1.h"
-#include "../AIAPI.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+#endif
+
+#include "../timer.h"
 
 
 namespace AIExample {
@@ -8,56 +19,157 @@ namespace AIExample {
 	// 'GeneticNeuralNetwork' class.
 
 
-	void GeneticNeuralNetwork::initNetwork(const std::vector<unsigned int>& sizeLayer, float rangeMin, float rangeMax) {
+	unsigned int GeneticNeuralNetwork::nWeights(const std::vector<unsigned int>& sizeLayer) {
 
-		nLayers_ = sizeLayer.size();
-		weights_ = std::vector<af::array>(nLayers_ - 1);
-		AIExample::miningAIGame* aiGame_ = dynamic_cast<AIExample::miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame());
+		unsigned int nWeights = 0;
 
 
-		if (!aiGame_)
-			VoxelEng::logger::errorLog("The selected AI game is not a 'miningAIGame'");
+		for (std::size_t i = 0; i + 1 < sizeLayer.size(); i++)
+			nWeights += (sizeLayer[i] + 1) * sizeLayer[i + 1];
 
-		// Initialize weights randomly.
-		for (unsigned int i = 0; i < nLayers_ - 1; i++)
-			weights_[i] = (rangeMax - rangeMin) * af::randu(af::dim4(sizeLayer[i] + 1, sizeLayer[i + 1]), af::dtype::f32, aiGame_->AIrandEng()) + rangeMin;
+		return nWeights;
 
 	}
 
-	GeneticNeuralNetwork::GeneticNeuralNetwork() 
-	: nLayers_(0) {}
+	unsigned int GeneticNeuralNetwork::layerOffset(unsigned int layer) const {
 
-	GeneticNeuralNetwork& GeneticNeuralNetwork::operator=(const GeneticNeuralNetwork& source) {
-	
-		nLayers_ = source.nLayers_;
+		unsigned int offset = 0;
 
-		weights_ = source.weights_;
 
-		return *this;
-	
+		for (unsigned int i = 0; i < layer; i++)
+			offset += ((*sizeLayer_)[i] + 1) * (*sizeLayer_)[i + 1];
+
+		return offset;
+
+	}
+
+	af::array GeneticNeuralNetwork::layerWeights(unsigned int layer) const {
+
+		if (layer + 1 >= nLayers_)
+			VoxelEng::logger::errorOutOfRange("Layer " + std::to_string(layer) + " has no outgoing weights");
+
+		return af::array((*sizeLayer_)[layer] + 1, (*sizeLayer_)[layer + 1], weights_ + layerOffset(layer));
+
+	}
+
+	void GeneticNeuralNetwork::copyWeights(const GeneticNeuralNetwork& source) {
+
+		if (source.weights_ != weights_)
+			std::copy(source.weights_, source.weights_ + source.nWeights(), weights_);
+
+	}
+
+	void GeneticNeuralNetwork::benchmarkForwardPropagation(unsigned int nActions, int inputMin, int inputMax) const {
+
+		if (!nLayers_)
+			VoxelEng::logger::errorLog("Cannot benchmark an empty neural network");
+
+		std::mt19937 generator(0);
+		std::uniform_int_distribution<int> inputDist(inputMin, inputMax);
+		std::vector<std::vector<int>> inputs(nActions, std::vector<int>((*sizeLayer_)[0]));
+		std::vector<unsigned int> actionsAF(nActions),
+								  actionsHost(nActions);
+		unsigned int nMismatches = 0;
+		VoxelEng::timer t;
+		VoxelEng::duration durationAF,
+						   durationHost;
+
+
+		for (unsigned int i = 0; i < nActions; i++)
+			for (std::size_t j = 0; j < inputs[i].size(); j++)
+				inputs[i][j] = inputDist(generator);
+
+		t.start();
+		for (unsigned int i = 0; i < nActions; i++)
+			actionsAF[i] = forwardPropagationMaxAF<int>(inputs[i]);
+		t.finish();
+		durationAF = t.getDurationMs();
+
+		t.start();
+		for (unsigned int i = 0; i < nActions; i++)
+			actionsHost[i] = forwardPropagationMax<int>(inputs[i]);
+		t.finish();
+		durationHost = t.getDurationMs();
+
+		for (unsigned int i = 0; i < nActions; i++)
+			if (actionsAF[i] != actionsHost[i])
+				nMismatches++;
+
+		VoxelEng::logger::say("ArrayFire inference: " + std::to_string(nActions * 1000.0 / std::max<VoxelEng::duration>(durationAF, 1)) + " actions/s");
+		VoxelEng::logger::say("Host inference: " + std::to_string(nActions * 1000.0 / std::max<VoxelEng::duration>(durationHost, 1)) + " actions/s");
+		VoxelEng::logger::say("Actions that differ between both paths: " + std::to_string(nMismatches) + "/" + std::to_string(nActions));
+
+	}
+
+	void GeneticNeuralNetwork::stackWeights(const std::vector<GeneticNeuralNetwork>& networks, const unsigned int* indices,
+											unsigned int nNetworks, std::vector<af::array>& stackedWeights) {
+
+		if (!nNetworks)
+			VoxelEng::logger::errorLog("Cannot stack the weights of zero neural networks");
+
+		const GeneticNeuralNetwork& first = networks[indices[0]];
+		unsigned int nWeights = first.nWeights(),
+					 offset = 0;
+		std::vector<float> gathered(static_cast<std::size_t>(nWeights) * nNetworks);
+		af::array allWeights;
+
+
+		// Gather the selected networks' weights so that they are uploaded with a single transfer.
+		for (unsigned int i = 0; i < nNetworks; i++)
+			std::copy(networks[indices[i]].weights_, networks[indices[i]].weights_ + nWeights, gathered.data() + static_cast<std::size_t>(i) * nWeights);
+		allWeights = af::array(nWeights, nNetworks, gathered.data());
+
+		stackedWeights.resize(first.nLayers_ - 1);
+		for (unsigned int layer = 0; layer < first.nLayers_ - 1; layer++) {
+
+			unsigned int nRows = (*first.sizeLayer_)[layer] + 1,
+						 nColumns = (*first.sizeLayer_)[layer + 1];
+
+			stackedWeights[layer] = af::moddims(allWeights(af::seq(offset, offset + nRows * nColumns - 1), af::span), nRows, nColumns, nNetworks);
+			offset += nRows * nColumns;
+
+		}
+
+	}
+
+	af::array GeneticNeuralNetwork::forwardPropagationMaxBatch(const std::vector<af::array>& stackedWeights, const af::array& input) {
+
+		af::array values = input,
+				  maxValues,
+				  indices;
+
+
+		// af::matmul() multiplies each slice in the third dimension independently.
+		for (std::size_t i = 0; i < stackedWeights.size(); i++)
+			values = af::sigmoid(af::matmul(af::join(1, af::constant(1, 1, 1, values.dims(2), values.type()), values).as(af::dtype::f32), stackedWeights[i]));
+
+		af::max(maxValues, indices, values, 1);
+
+		return indices.as(af::dtype::u32);
+
 	}
 
-	af::array GeneticNeuralNetwork::addBias(const af::array& A) {
+	af::array GeneticNeuralNetwork::addBias(const af::array& A) const {
 	
 		// Add +1 as bias.
 		return af::join(1, af::constant(1, 1, A.type()), A);
 	
 	}
 
-	af::array GeneticNeuralNetwork::forwardPropagation(const af::array& input) {
+	af::array GeneticNeuralNetwork::forwardPropagation(const af::array& input) const {
 
 		// Process input through each layer and return the values at the output layer.
 		af::array values;
 
 		values = input;
 		for (unsigned int i = 0; i < nLayers_ - 1; i++)
-			values = af::sigmoid(af::matmul(addBias(values), weights_[i]));
+			values = af::sigmoid(af::matmul(addBias(values), layerWeights(i)));
 
 		return values;
 
 	}
 
-	unsigned int GeneticNeuralNetwork::forwardPropagationMax(const af::array& input) {
+	unsigned int GeneticNeuralNetwork::forwardPropagationMax(const af::array& input) const {
 
 		// Process input through each layer and return the values at the output layer.
 		af::array values,
@@ -65,7 +177,7 @@ namespace AIExample {
 
 		values = input;
 		for (unsigned int i = 0; i < nLayers_ - 1; i++)
-			values = af::sigmoid(af::matmul(addBias(values), weights_[i]));
+			values = af::sigmoid(af::matmul(addBias(values), layerWeights(i)));
 
 		af::max(values, indices, values);
 
@@ -73,7 +185,7 @@ namespace AIExample {
 
 	}
 
-	unsigned int GeneticNeuralNetwork::forwardPropagationMin(const af::array& input) {
+	unsigned int GeneticNeuralNetwork::forwardPropagationMin(const af::array& input) const {
 
 		// Process input through each layer and return the values at the output layer.
 		af::array values,
@@ -81,7 +193,7 @@ namespace AIExample {
 
 		values = input;
 		for (unsigned int i = 0; i < nLayers_ - 1; i++)
-			values = af::sigmoid(af::matmul(addBias(values), weights_[i]));
+			values = af::sigmoid(af::matmul(addBias(values), layerWeights(i)));
 
 		af::min(values, indices, values);
 
@@ -89,4 +201,84 @@ namespace AIExample {
 
 	}
 
-}
\ No newline at end of file
+	std::vector<float>& GeneticNeuralNetwork::hostValues() const {
+
+		thread_local std::vector<float> values;
+		unsigned int maxLayerSize = 0;
+
+
+		for (unsigned int i = 0; i < nLayers_; i++)
+			maxLayerSize = std::max(maxLayerSize, (*sizeLayer_)[i]);
+
+		if (values.size() < maxLayerSize * 2)
+			values.resize(maxLayerSize * 2);
+
+		return values;
+
+	}
+
+	unsigned int GeneticNeuralNetwork::forwardPropagationMaxHost() const {
+
+		std::vector<float>& values = hostValues();
+		float* input = values.data(),
+			 * output = input + values.size() / 2;
+		const float* layer = weights_;
+		unsigned int nInputs = 0,
+					 nOutputs = 0,
+					 maxIndex = 0;
+
+
+		for (unsigned int i = 0; i < nLayers_ - 1; i++) {
+
+			nInputs = (*sizeLayer_)[i];
+			nOutputs = (*sizeLayer_)[i + 1];
+
+			denseSigmoidHost(layer, input, nInputs, nOutputs, output);
+
+			layer += (nInputs + 1) * nOutputs;
+			std::swap(input, output);
+
+		}
+
+		// The first maximum is returned like af::max() does.
+		for (unsigned int j = 1; j < nOutputs; j++)
+			if (input[j] > input[maxIndex])
+				maxIndex = j;
+
+		return maxIndex;
+
+	}
+
+	void GeneticNeuralNetwork::denseSigmoidHost(const float* weights, const float* input,
+											   unsigned int nInputs, unsigned int nOutputs, float* output) {
+
+		for (unsigned int j = 0; j < nOutputs; j++) {
+
+			const float* column = weights + j * (nInputs + 1),
+					   * row = column + 1; // Skip the bias.
+			unsigned int k = 0;
+			float sum = 0.0f;
+
+#ifdef __AVX2__
+
+			__m256 acc = _mm256_setzero_ps();
+			for (; k + 8 <= nInputs; k += 8)
+				acc = _mm256_fmadd_ps(_mm256_loadu_ps(row + k), _mm256_loadu_ps(input + k), acc);
+
+			__m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+			half = _mm_hadd_ps(half, half);
+			half = _mm_hadd_ps(half, half);
+			sum = _mm_cvtss_f32(half);
+
+#endif
+
+			for (; k < nInputs; k++)
+				sum += row[k] * input[k];
+
+			output[j] = 1.0f / (1.0f + std::exp(-(sum + column[0])));
+
+		}
+
+	}
+
+}
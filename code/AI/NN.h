@@ -10,6 +10,7 @@
 */
 #ifndef _AI_NN_
 #define _AI_NN_
+#include <cstddef>
 #include <vector>
 #include <concepts>
 #include <typeinfo>
@@ -27,21 +28,16 @@ namespace AIExample {
 	* mutation and replacement to modify the network's weights.
 	* Implementations of some of these operators can be found in Deep dive open/code/AI/genetic.h and
 	* Deep dive open/code/AI/genetic.cpp
+	* A GeneticNeuralNetwork object does not own its weights. It is a view into a contiguous
+	* block of host memory (usually one row of the population's weight arena) that holds all the weights of the network.
+	* For each connection between layers, said block stores one column per neuron of the next layer
+	* holding the neuron's bias followed by the weights of its inputs. That is, the same
+	* layout that a column-major (number of inputs + 1) x (number of outputs) ArrayFire matrix has.
 	*/
 	class GeneticNeuralNetwork {
 
 	public:
 
-		// Initialisers.
-
-		/**
-		* @brief Initialise the neural network with the topology described in layers (number
-		* of neurons per layer) and with the respective weights initialized with
-		* random values between rangeMin and rangeMax.
-		*/
-		void initNetwork(const std::vector<unsigned int>& sizeLayer, float rangeMin, float rangeMax);
-
-
 		// Constructors.
 
 		/**
@@ -49,14 +45,45 @@ namespace AIExample {
 		*/
 		GeneticNeuralNetwork();
 
+		/**
+		* @brief Create a neural network with the topology described in 'sizeLayer' (number of neurons per layer)
+		* whose weights are stored in 'weights'.
+		* WARNING. 'weights' must point to at least GeneticNeuralNetwork::nWeights(sizeLayer) floats and
+		* both 'weights' and 'sizeLayer' must outlive the created object.
+		*/
+		GeneticNeuralNetwork(float* weights, const std::vector<unsigned int>& sizeLayer);
+
 
 		// Observers.
 
+		/**
+		* @brief Returns the number of weights (biases included) that a network with the topology
+		* described in 'sizeLayer' has.
+		*/
+		static unsigned int nWeights(const std::vector<unsigned int>& sizeLayer);
+
+		/**
+		* @brief Returns the number of weights (biases included) of the network.
+		*/
+		unsigned int nWeights() const;
+
 		/**
 		* @brief Returns the network's weights.
 		* WARNING. Not thread-safe.
 		*/
-		const std::vector<af::array>* weights() const;
+		const float* weights() const;
+
+		/**
+		* @brief Returns the position in the network's weights where the weights of the connection
+		* between layer 'layer' and layer 'layer' + 1 begin.
+		*/
+		unsigned int layerOffset(unsigned int layer) const;
+
+		/**
+		* @brief Returns a (number of inputs + 1) x (number of outputs) ArrayFire matrix
+		* with a copy of the weights of the connection between layer 'layer' and layer 'layer' + 1.
+		*/
+		af::array layerWeights(unsigned int layer) const;
 
 		/**
 		* @brief Returns the number of neuron layers in the network.
@@ -68,19 +95,19 @@ namespace AIExample {
 		* @brief Returns the values corresponding to the output neurons of
 		* the network after propagating the 'input' values through it.
 		*/
-		af::array forwardPropagation(const af::array& input);
+		af::array forwardPropagation(const af::array& input) const;
 
 		/**
 		* @brief Returns the index corresponding to the output neuron that has
 		* the biggest value of the entire output layer after propagating the 'input' values through it.
 		*/
-		unsigned int forwardPropagationMax(const af::array& input);
+		unsigned int forwardPropagationMax(const af::array& input) const;
 
 		/**
 		* @brief Returns the index corresponding to the output neuron that has
 		* the smallest value of the entire output layer after propagating the 'input' values through it.
 		*/
-		unsigned int forwardPropagationMin(const af::array& input);
+		unsigned int forwardPropagationMin(const af::array& input) const;
 
 		/**
 		* @brief Returns in 'output' the values corresponding to the output neurons of
@@ -90,15 +117,24 @@ namespace AIExample {
 		*/
 		template <typename TInput, typename TOutput>
 		requires std::is_arithmetic<TInput>::value && std::is_arithmetic<TOutput>::value
-		void forwardPropagation(const std::vector<TInput>& input, TOutput* output, unsigned int& outputSize);
+		void forwardPropagation(const std::vector<TInput>& input, TOutput* output, unsigned int& outputSize) const;
 
 		/**
 		* @brief Returns the index corresponding to the output neuron that has
 		* the biggest value of the entire output layer after propagating the 'input' values through it.
+		* The propagation is performed entirely in the CPU.
+		*/
+		template <typename TInput>
+		requires std::is_arithmetic<TInput>::value
+		unsigned int forwardPropagationMax(const std::vector<TInput>& input) const;
+
+		/**
+		* @brief Same as GeneticNeuralNetwork::forwardPropagationMax(const std::vector<TInput>& input) but
+		* using ArrayFire to propagate the input values.
 		*/
 		template <typename TInput>
 		requires std::is_arithmetic<TInput>::value
-		unsigned int forwardPropagationMax(const std::vector<TInput>& input);
+		unsigned int forwardPropagationMaxAF(const std::vector<TInput>& input) const;
 
 		/**
 		* @brief Returns the index corresponding to the output neuron that has
@@ -106,85 +142,129 @@ namespace AIExample {
 		*/
 		template <typename TInput>
 		requires std::is_arithmetic<TInput>::value
-		unsigned int forwardPropagationMin(const std::vector<TInput>& input);
+		unsigned int forwardPropagationMin(const std::vector<TInput>& input) const;
 
+		/**
+		* @brief Stacks the weights of the networks networks[indices[0]], ..., networks[indices[nNetworks - 1]]
+		* into 'stackedWeights' so that they can be used with GeneticNeuralNetwork::forwardPropagationMaxBatch().
+		* Each element of 'stackedWeights' is a 3D array that holds the weights of one layer of all the
+		* specified networks, one network per slice in the third dimension.
+		* All the specified networks must share the same topology.
+		*/
+		static void stackWeights(const std::vector<GeneticNeuralNetwork>& networks, const unsigned int* indices,
+								 unsigned int nNetworks, std::vector<af::array>& stackedWeights);
 
-		// Modifiers.
+		/**
+		* @brief Propagates the inputs of several networks at once, performing one batched matrix multiplication per layer.
+		* 'input' must have dimensions (1, number of inputs, number of networks) and 'stackedWeights' must have been generated
+		* with GeneticNeuralNetwork::stackWeights().
+		* Returns an unsigned int array with the index of the output neuron with the biggest value of each network.
+		*/
+		static af::array forwardPropagationMaxBatch(const std::vector<af::array>& stackedWeights, const af::array& input);
 
 		/**
-		* @brief Returns the network's weights.
-		* Do not forget to call GeneticNeuralNetwork::updateNLayers() on the object you called this method
-		* on to update the internal counted number of the network's layers if you want to reflect any
-		* changes made to said number of layers.
-		* WARNING. Not thread-safe.
+		* @brief Measure the number of actions per second that can be obtained with both the ArrayFire and the
+		* host inference paths using 'nActions' random inputs in the range [inputMin, inputMax].
+		* The number of actions where both paths do not agree is also reported.
 		*/
-		std::vector<af::array>* weights();
+		void benchmarkForwardPropagation(unsigned int nActions, int inputMin, int inputMax) const;
+
+
+		// Modifiers.
 
 		/**
-		* @brief Update the network's number of layers once all modifications to the network's layers are finished.
-		* WARNING. Not thread-safe. 
+		* @brief Returns the network's weights.
+		* WARNING. Not thread-safe.
 		*/
-		void updateNLayers();
+		float* weights();
 
 		/**
-		* @brief Overwrites this neural network's topology and weights with the ones
-		* from source.
+		* @brief Overwrites this neural network's weights with the ones from 'source'.
+		* Both networks must share the same topology.
 		*/
-		GeneticNeuralNetwork& operator= (const GeneticNeuralNetwork& source);
+		void copyWeights(const GeneticNeuralNetwork& source);
 
 	private:
 
 		// Attributes.
-		
+
 		unsigned int nLayers_;
-		std::vector<af::array> weights_;
+		const std::vector<unsigned int>* sizeLayer_;
+		float* weights_;
 
 
 		// Methods.
 
-		af::array addBias(const af::array& A);
+		af::array addBias(const af::array& A) const;
+
+		/*
+		Returns the calling thread's buffer used to propagate values through the network in the CPU.
+		It is big enough to hold two times the size of the biggest layer.
+		*/
+		std::vector<float>& hostValues() const;
+
+		/*
+		Propagates the input already written at the beginning of hostValues()
+		through the network and returns the index of the output neuron with the biggest value.
+		*/
+		unsigned int forwardPropagationMaxHost() const;
 
-		// NOTE. Backward propagation won't be implemented here due to the fact that 
+		/*
+		Computes output = sigmoid(W * input + b) for a single layer where 'weights' holds,
+		for each output neuron, its bias followed by the weights of its 'nInputs' inputs.
+		*/
+		static void denseSigmoidHost(const float* weights, const float* input,
+									 unsigned int nInputs, unsigned int nOutputs, float* output);
+
+		// NOTE. Backward propagation won't be implemented here due to the fact that
 		// this neural networks will be trained with genetic algorithms. Because
 		// of this, the backpropagation from the output layer error through the
 		// network is not needed in this case.
 
 	};
 
-	inline const std::vector<af::array>* GeneticNeuralNetwork::weights() const {
-	
-		return &weights_;
-	
+	inline GeneticNeuralNetwork::GeneticNeuralNetwork()
+		: nLayers_(0), sizeLayer_(nullptr), weights_(nullptr)
+	{}
+
+	inline GeneticNeuralNetwork::GeneticNeuralNetwork(float* weights, const std::vector<unsigned int>& sizeLayer)
+		: nLayers_(sizeLayer.size()), sizeLayer_(&sizeLayer), weights_(weights)
+	{}
+
+	inline unsigned int GeneticNeuralNetwork::nWeights() const {
+
+		return sizeLayer_ ? nWeights(*sizeLayer_) : 0;
+
 	}
 
-	inline std::vector<af::array>* GeneticNeuralNetwork::weights() {
-	
-		return &weights_;
-	
+	inline const float* GeneticNeuralNetwork::weights() const {
+
+		return weights_;
+
+	}
+
+	inline float* GeneticNeuralNetwork::weights() {
+
+		return weights_;
+
 	}
 
 	inline unsigned int GeneticNeuralNetwork::nLayers() const {
-	
+
 		return nLayers_;
-	
-	}
 
-	inline void GeneticNeuralNetwork::updateNLayers() {
-	
-		nLayers_ = weights_.size() + 1;
-	
 	}
 
 	template <typename TInput, typename TOutput>
 	requires std::is_arithmetic<TInput>::value && std::is_arithmetic<TOutput>::value
-	void GeneticNeuralNetwork::forwardPropagation(const std::vector<TInput>& input, TOutput* output, unsigned int& outputSize) {
+	void GeneticNeuralNetwork::forwardPropagation(const std::vector<TInput>& input, TOutput* output, unsigned int& outputSize) const {
 
 		// Process input through each layer and return the values at the output layer.
 		af::array values;
 
 		values.write<TInput>(input.data(), input.size());
 		for (int i = 0; i < nLayers_ - 1; i++)
-			values = af::sigmoid(af::matmul(addBias(values), weights_[i]));
+			values = af::sigmoid(af::matmul(addBias(values), layerWeights(i)));
 
 		output = values.host<TOutput>();
 		outputSize = values.elements();
@@ -193,7 +273,26 @@ namespace AIExample {
 
 	template <typename TInput>
 	requires std::is_arithmetic<TInput>::value
-	unsigned int GeneticNeuralNetwork::forwardPropagationMax(const std::vector<TInput>& input) {
+	unsigned int GeneticNeuralNetwork::forwardPropagationMax(const std::vector<TInput>& input) const {
+
+		if (!nLayers_)
+			VoxelEng::logger::errorLog("Cannot propagate values through an empty neural network");
+
+		if (input.size() != (*sizeLayer_)[0])
+			VoxelEng::logger::errorLog("Input size does not match the network's input layer size");
+
+
+		float* values = hostValues().data();
+		for (std::size_t i = 0; i < input.size(); i++)
+			values[i] = static_cast<float>(input[i]);
+
+		return forwardPropagationMaxHost();
+
+	}
+
+	template <typename TInput>
+	requires std::is_arithmetic<TInput>::value
+	unsigned int GeneticNeuralNetwork::forwardPropagationMaxAF(const std::vector<TInput>& input) const {
 
 		af::dtype type;
 		if (typeid(TInput) == typeid(int))
@@ -213,7 +312,7 @@ namespace AIExample {
 		values.write<TInput>(input.data(), input.size() * sizeof(TInput));
 
 		for (unsigned int i = 0; i < nLayers_ - 1; i++)
-			values = af::sigmoid(af::matmul(addBias(values).as(af::dtype::f32), weights_[i]));
+			values = af::sigmoid(af::matmul(addBias(values).as(af::dtype::f32), layerWeights(i)));
 
 		af::max(values, indices, values);
 
@@ -223,7 +322,7 @@ namespace AIExample {
 
 	template <typename TInput>
 	requires std::is_arithmetic<TInput>::value
-	unsigned int GeneticNeuralNetwork::forwardPropagationMin(const std::vector<TInput>& input) {
+	unsigned int GeneticNeuralNetwork::forwardPropagationMin(const std::vector<TInput>& input) const {
 
 		// Process input through each layer and return the values at the output layer.
 		af::array values,
@@ -231,7 +330,7 @@ namespace AIExample {
 
 		values.write<TInput>(input.data(), input.size());
 		for (int i = 0; i < nLayers_ - 1; i++)
-			values = af::sigmoid(af::matmul(addBias(values), weights_[i]));
+			values = af::sigmoid(af::matmul(addBias(values), layerWeights(i)));
 
 		af::min(values, indices, values);
 
@@ -241,4 +340,4 @@ namespace AIExample {
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,11 +1,18 @@
 #include "genetic.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
 #include <ctime>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <thread>
 #include <initializer_list>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <stdexcept>
 #include "af/algorithm.h"
 #include "af/defines.h"
 #include "../logger.h"
@@ -13,6 +20,7 @@
 #include "../AIAPI.h"
 #include "../worldGen.h"
 #include "../chunk.h"
+#include "../mappedFile.h"
 #include "../utilities.h"
 #include "AIGameEx1.h"
 
@@ -26,18 +34,24 @@ namespace AIExample {
 
 	// 'geneticJob' class.
 
-	geneticJob::geneticJob(size_t rangeStart, size_t rangeEnd, float* fitness, unsigned int* indices,
+	geneticJob::geneticJob(std::atomic<std::size_t>* nextIndividual, std::size_t nIndividuals, std::size_t batchSize,
+						   float* fitness, unsigned int* indices, float* evaluationTimes,
 						   float (*evaluationFunction)(unsigned int individualID))
-		: rangeStart_(rangeStart), rangeEnd_(rangeEnd), fitness_(fitness), indices_(indices), evaluationFunction_(evaluationFunction) {}
+		: nextIndividual_(nextIndividual), nIndividuals_(nIndividuals), batchSize_(batchSize), fitness_(fitness),
+		evaluationTimes_(evaluationTimes), indices_(indices), evaluationFunction_(evaluationFunction), busyTime_(0.0f) {}
 
-	void geneticJob::setAttributes(size_t rangeStart, size_t rangeEnd, float* fitness, unsigned int* indices,
+	void geneticJob::setAttributes(std::atomic<std::size_t>* nextIndividual, std::size_t nIndividuals, std::size_t batchSize,
+								   float* fitness, unsigned int* indices, float* evaluationTimes,
 								   float (*evaluationFunction)(unsigned int individualID)) {
 
-		rangeStart_ = rangeStart;
-		rangeEnd_ = rangeEnd;
+		nextIndividual_ = nextIndividual;
+		nIndividuals_ = nIndividuals;
+		batchSize_ = batchSize;
 		fitness_ = fitness;
 		indices_ = indices;
+		evaluationTimes_ = evaluationTimes;
 		evaluationFunction_ = evaluationFunction;
+		busyTime_ = 0.0f;
 
 	}
 
@@ -45,12 +59,79 @@ namespace AIExample {
 
 		VoxelEng::logger::debugLog("Genetic job started");
 
-		for (std::size_t i = rangeStart_; i <= rangeEnd_; i++)
-			fitness_[indices_[i]] = evaluationFunction_(indices_[i]);
+		std::chrono::steady_clock::time_point start;
+		std::size_t batchStart = 0,
+					batchEnd = 0;
+
+
+		busyTime_ = 0.0f;
+		while ((batchStart = nextIndividual_->fetch_add(batchSize_)) < nIndividuals_) {
+
+			batchEnd = std::min(batchStart + batchSize_, nIndividuals_);
+			for (std::size_t i = batchStart; i < batchEnd; i++) {
+
+				start = std::chrono::steady_clock::now();
+
+				fitness_[indices_[i]] = evaluationFunction_(indices_[i]);
+
+				evaluationTimes_[i] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+				busyTime_ += evaluationTimes_[i];
+
+			}
+
+		}
 	
 	}
 
 
+	// 'lockstepJob' class.
+
+	lockstepJob::lockstepJob(std::size_t rangeStart, std::size_t rangeEnd, const unsigned int* indices, const unsigned int* actions,
+							 unsigned char* active, int* inputs, unsigned int nInputs, bool firstStep,
+							 void (*beginFunction)(unsigned int individualID),
+							 bool (*observeFunction)(unsigned int individualID, int* input),
+							 void (*actFunction)(unsigned int individualID, unsigned int action))
+		: rangeStart_(rangeStart), rangeEnd_(rangeEnd), indices_(indices), actions_(actions), active_(active), inputs_(inputs),
+		nInputs_(nInputs), firstStep_(firstStep), beginFunction_(beginFunction), observeFunction_(observeFunction), actFunction_(actFunction) {}
+
+	void lockstepJob::setAttributes(std::size_t rangeStart, std::size_t rangeEnd, const unsigned int* indices, const unsigned int* actions,
+									unsigned char* active, int* inputs, unsigned int nInputs, bool firstStep,
+									void (*beginFunction)(unsigned int individualID),
+									bool (*observeFunction)(unsigned int individualID, int* input),
+									void (*actFunction)(unsigned int individualID, unsigned int action)) {
+
+		rangeStart_ = rangeStart;
+		rangeEnd_ = rangeEnd;
+		indices_ = indices;
+		actions_ = actions;
+		active_ = active;
+		inputs_ = inputs;
+		nInputs_ = nInputs;
+		firstStep_ = firstStep;
+		beginFunction_ = beginFunction;
+		observeFunction_ = observeFunction;
+		actFunction_ = actFunction;
+
+	}
+
+	void lockstepJob::process() {
+
+		for (std::size_t i = rangeStart_; i <= rangeEnd_; i++) {
+
+			if (firstStep_)
+				beginFunction_(indices_[i]);
+			else if (active_[i])
+				actFunction_(indices_[i], actions_[i]);
+			else
+				continue;
+
+			active_[i] = observeFunction_(indices_[i], inputs_ + i * nInputs_);
+
+		}
+
+	}
+
+
 	// 'copyJob' class.
 
 	copyJob::copyJob(std::size_t rangeStart, std::size_t rangeEnd, const GeneticNeuralNetwork* parent,
@@ -73,7 +154,209 @@ namespace AIExample {
 		VoxelEng::logger::debugLog("Copy job started");
 
 		for (std::size_t i = rangeStart_; i <= rangeEnd_; i++)
-			individuals_->operator[](newbornInds_[i]) = *parent_;
+			individuals_->operator[](newbornInds_[i]).copyWeights(*parent_);
+
+	}
+
+
+	// 'mutationJob' class.
+
+	mutationJob::mutationJob(std::size_t rangeStart, std::size_t rangeEnd, std::vector<GeneticNeuralNetwork>* individuals, const unsigned int* newbornInds,
+							 const VoxelEng::counterRNG* rng, unsigned int generation, float rate, float variationMin, float variationMax)
+		: rangeStart_(rangeStart), rangeEnd_(rangeEnd), individuals_(individuals), newbornInds_(newbornInds), rng_(rng),
+		generation_(generation), rate_(rate), variationMin_(variationMin), variationMax_(variationMax) {}
+
+	void mutationJob::setAttributes(std::size_t rangeStart, std::size_t rangeEnd, std::vector<GeneticNeuralNetwork>* individuals, const unsigned int* newbornInds,
+									const VoxelEng::counterRNG* rng, unsigned int generation, float rate, float variationMin, float variationMax) {
+
+		rangeStart_ = rangeStart;
+		rangeEnd_ = rangeEnd;
+		individuals_ = individuals;
+		newbornInds_ = newbornInds;
+		rng_ = rng;
+		generation_ = generation;
+		rate_ = rate;
+		variationMin_ = variationMin;
+		variationMax_ = variationMax;
+
+	}
+
+	void mutationJob::process() {
+
+		std::array<std::uint32_t, 4> random;
+
+
+		for (std::size_t i = rangeStart_; i <= rangeEnd_; i++) {
+
+			GeneticNeuralNetwork& newborn = individuals_->operator[](newbornInds_[i]);
+			float* weights = newborn.weights();
+			unsigned int nWeights = newborn.nWeights();
+
+			// One number decides whether the gene mutates and another one its variation.
+			for (unsigned int w = 0; w < nWeights; w++) {
+
+				random = rng_->generate(generation_, static_cast<std::uint32_t>(i), w, static_cast<std::uint32_t>(randomStream::MUTATION));
+				if (VoxelEng::counterRNG::toFloat(random[0]) < rate_)
+					weights[w] += (variationMax_ - variationMin_) * VoxelEng::counterRNG::toFloat(random[1]) + variationMin_;
+
+			}
+
+		}
+
+	}
+
+
+	// 'checkpointWriter' class.
+
+	checkpointWriter::checkpointWriter(unsigned int maxInFlight)
+		: maxInFlight_(maxInFlight ? maxInFlight : 1), nInFlight_(0), stop_(false)
+	{}
+
+	unsigned int checkpointWriter::nInFlight() {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		return nInFlight_;
+
+	}
+
+	std::vector<float> checkpointWriter::stagingBuffer() {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		std::vector<float> buffer;
+
+
+		if (!freeBuffers_.empty()) {
+
+			buffer = std::move(freeBuffers_.back());
+			freeBuffers_.pop_back();
+			buffer.clear();
+
+		}
+
+		return buffer;
+
+	}
+
+	void checkpointWriter::submit(const std::string& path, const std::vector<unsigned int>& sizeLayer,
+								  std::vector<float>&& weights, unsigned int nIndividuals) {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+
+		// Bound the memory used by the checkpoints that have not been written yet.
+		writtenCV_.wait(lock, [this] { return nInFlight_ < maxInFlight_; });
+
+		if (!writerThread_.joinable())
+			writerThread_ = std::thread(&checkpointWriter::writerLoop, this);
+
+		pending_.push_back(checkpoint{ path, sizeLayer, std::move(weights), nIndividuals });
+		nInFlight_++;
+
+		pendingCV_.notify_one();
+
+	}
+
+	void checkpointWriter::flush() {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		writtenCV_.wait(lock, [this] { return nInFlight_ == 0; });
+
+	}
+
+	void checkpointWriter::write(const std::string& path, const std::vector<unsigned int>& sizeLayer,
+								 const float* weights, unsigned int nIndividuals) {
+
+		std::string tmpPath = path + ".tmp";
+		std::vector<std::uint32_t> layout(sizeLayer.begin(), sizeLayer.end());
+		std::size_t nWeights = static_cast<std::size_t>(GeneticNeuralNetwork::nWeights(sizeLayer)) * nIndividuals;
+		aidataHeader header = { { 'V', 'X', 'A', 'I' }, aidataHeader::currentVersion, static_cast<std::uint32_t>(layout.size()), nIndividuals, 0 };
+
+
+		// The checksum covers everything that is written after the header.
+		header.checksum = VoxelEng::hashBytes(layout.data(), layout.size() * sizeof(std::uint32_t));
+		header.checksum = VoxelEng::hashBytes(weights, nWeights * sizeof(float), header.checksum);
+
+		{
+
+			std::ofstream saveFile(tmpPath, std::ios::binary | std::ios::trunc);
+
+			saveFile.write(reinterpret_cast<const char*>(&header), sizeof(aidataHeader));
+			saveFile.write(reinterpret_cast<const char*>(layout.data()), layout.size() * sizeof(std::uint32_t));
+			saveFile.write(reinterpret_cast<const char*>(weights), nWeights * sizeof(float));
+			saveFile.flush();
+
+			// Not logger::errorLog() since this also runs in the writer thread, where it would clean up the engine.
+			if (!saveFile)
+				throw std::runtime_error("Could not write AI data to " + tmpPath);
+
+		}
+
+		// Replace the previous file (if any) only once the new one has been completely written.
+		std::filesystem::rename(tmpPath, path);
+
+	}
+
+	void checkpointWriter::writerLoop() {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		checkpoint current;
+
+
+		while (true) {
+
+			pendingCV_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+
+			if (pending_.empty()) // Only reached if stop_ is true.
+				break;
+
+			current = std::move(pending_.front());
+			pending_.pop_front();
+
+			lock.unlock();
+
+			try {
+
+				VoxelEng::timer t;
+				t.start();
+
+				write(current.path, current.sizeLayer, current.weights.data(), current.nIndividuals);
+
+				t.finish();
+				VoxelEng::logger::debugLog("Checkpoint " + current.path + " written in " + std::to_string(t.getDurationMs()) + " ms");
+
+			}
+			catch (const std::exception& e) {
+
+				VoxelEng::logger::warningLog("Could not write checkpoint " + current.path + ": " + e.what());
+
+			}
+
+			lock.lock();
+
+			freeBuffers_.push_back(std::move(current.weights));
+			nInFlight_--;
+
+			writtenCV_.notify_all();
+
+		}
+
+	}
+
+	checkpointWriter::~checkpointWriter() {
+
+		{
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			stop_ = true;
+
+		}
+
+		pendingCV_.notify_one();
+
+		if (writerThread_.joinable())
+			writerThread_.join();
 
 	}
 
@@ -81,38 +364,81 @@ namespace AIExample {
 	// 'genetic' class.
 
 	genetic::genetic()
-		: simInProgress_(false), saveIndsData_(false), crossoverSplitPoint_(0),
+		: simInProgress_(false), training_(false), saveIndsData_(false), reportTimings_(false), fitnessCacheEnabled_(false), evaluationFunction_(nullptr), evaluationMode_(evaluationMode::INDIVIDUAL),
+		lockstepBeginFunction_(nullptr), lockstepObserveFunction_(nullptr), lockstepActFunction_(nullptr),
+		lockstepScoreFunction_(nullptr), nIndividuals_(0), generation_(0), nWeights_(0), crossoverSplitPoint_(0),
 		nJobs_(0), mutationRate_(0.0f), mutationVariationMin_(0.0f),
 		mutationVariationMax_(0.0f), popInds_(nullptr), newbornInds_(nullptr), hostFitness_(nullptr), hostSelected_(nullptr), 
-		hostPopInds_(nullptr), hostNewbornInds_(nullptr), threadPool_(nullptr) {}
+		hostPopInds_(nullptr), hostNewbornInds_(nullptr), threadPool_(nullptr), nextIndividual_(0), epochTimings_{},
+		nPregeneratedWorlds_(VoxelEng::DEF_N_PREGENERATED_WORLDS), nPregenerationThreads_(1),
+		pregenerationMemoryCap_(VoxelEng::DEF_PREGENERATED_WORLDS_MEMORY_CAP), fitnessCacheSeed_(0), nWorkerProcesses_(0), workerTimeout_(0) {}
 
 	void genetic::trainAgents(unsigned int nEpochs, unsigned int nEpochsPerSave, unsigned int nEpochsForNewWorld) {
 	
 		if (aiGame_ = dynamic_cast<AIExample::miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())) {
 
 			simInProgress_ = true;
+			training_ = true;
 			unsigned int epochSaveCounter = 0, // Used to decide when to save individuals' data.
 						 epochNewWorldCounter = nEpochsForNewWorld;
 			std::string epochString;
-			VoxelEng::timer t;
+			std::chrono::steady_clock::time_point epochStart,
+												  phaseStart;
+			float evaluationTimeBeforeOperators = 0.0f,
+				  trainingTime = 0.0f;
+			std::size_t nTrainingActions = 0;
+
+			// The seeds of all the worlds used during the training are fixed in advance
+			// so that said worlds can be generated in the background while the epochs run.
+			unsigned int nWorlds = nEpochsForNewWorld ? (nEpochs + nEpochsForNewWorld - 1) / nEpochsForNewWorld : nEpochs,
+						 nGeneratedWorlds = 0;
+			std::vector<unsigned int> worldSeeds(nWorlds);
+			for (unsigned int i = 0; i < nWorlds; i++) {
+
+				VoxelEng::worldGen::setSeed();
+				worldSeeds[i] = VoxelEng::worldGen::getSeed();
+
+			}
+
+			if (nPregeneratedWorlds_ && nWorlds)
+				VoxelEng::AIAPI::aiGame::startWorldPregeneration(worldSeeds, nPregeneratedWorlds_, pregenerationMemoryCap_, nPregenerationThreads_);
+
+			if (evaluationMode_ == evaluationMode::MULTIPROCESS)
+				startWorkers();
+
 			for (unsigned int epoch = 0; epoch < nEpochs; epoch++) {
 
 				/*
 				Begin epoch.
 				*/
-				t.start();
-				VoxelEng::worldGen::setSeed();
+				epochStart = std::chrono::steady_clock::now();
+				epochTimings_ = epochTimings{ epoch };
+				generation_ = epoch;
+
 				VoxelEng::chunkManager::resetAIChunks();
 				if (epochNewWorldCounter >= nEpochsForNewWorld) {
 
+					VoxelEng::worldGen::setSeed(worldSeeds[nGeneratedWorlds++]);
 					aiGame_->generateAIWorld();
 					epochNewWorldCounter = 0;
+					resetFitnessCache();
+
+					if (!workers_.empty())
+						sendWorldToWorkers(worldSeeds[nGeneratedWorlds - 1]);
 
 				}
 				aiGame_->spawnAgents();
+				if (!workers_.empty())
+					resetWorkers();
+				epochTimings_.worldTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - epochStart).count();
 
 				calculateFitness(); // Calculate fitness of the actual population.
 
+				// The newborn are evaluated inside the replacement operator. Said evaluation
+				// is not accounted as time spent in the genetic operators.
+				phaseStart = std::chrono::steady_clock::now();
+				evaluationTimeBeforeOperators = epochTimings_.worldTime + epochTimings_.inferenceTime;
+
 				selectionOperator(0);
 
 				crossoverOperator(0);
@@ -121,19 +447,34 @@ namespace AIExample {
 
 				replacementOperator(1);
 
-				t.finish();
+				epochTimings_.operatorsTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - phaseStart).count() -
+											  (epochTimings_.worldTime + epochTimings_.inferenceTime - evaluationTimeBeforeOperators);
+				epochTimings_.totalTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - epochStart).count();
+				for (std::size_t i = 0; i < telemetry_.size(); i++)
+					if (!telemetry_[i].cached)
+						epochTimings_.nActions += telemetry_[i].nActions;
+
+				trainingTime += epochTimings_.totalTime;
+				nTrainingActions += epochTimings_.nActions;
+
 				epochString = std::to_string(epoch);
 				VoxelEng::logger::debugLog("EPOCH " + epochString + " finished");
-				VoxelEng::logger::debugLog("Time: " + std::to_string(t.getDurationMs()) + " ms");
+				VoxelEng::logger::debugLog("Time: " + std::to_string(epochTimings_.totalTime) + " ms");
+
+				if (reportTimings_)
+					reportEpochTimings();
 
 				/*
 				Epoch's end.
 				*/
 
+				if (!telemetryPath_.empty())
+					dumpTelemetry(telemetryPath_, epoch);
+
 				epochSaveCounter++;
 				if (epochSaveCounter == nEpochsPerSave && saveIndsData_) {
 
-					saveIndividualsData("AIData/" + aiGame_->name() + '/' + aiGame_->name() + "_EPOCH_" + epochString);
+					checkpointIndividualsData("AIData/" + aiGame_->name() + '/' + aiGame_->name() + "_EPOCH_" + epochString);
 
 					epochSaveCounter = 0;
 
@@ -147,6 +488,21 @@ namespace AIExample {
 			if (saveIndsData_ && nEpochsPerSave == 0)
 				saveIndividualsData("AIData/" + aiGame_->name() + '/' + aiGame_->name() + "_FINAL_EPOCH");
 
+			VoxelEng::AIAPI::aiGame::stopWorldPregeneration();
+			stopWorkers();
+			fitnessCache_.clear();
+			training_ = false;
+
+			// Make sure that all the checkpoints are on disk before the training ends.
+			checkpointWriter_.flush();
+
+			trainingTime = std::max(trainingTime, 1e-3f);
+			if (reportTimings_ && nEpochs)
+				VoxelEng::logger::say("[TIMINGS] summary=1 epochs=" + std::to_string(nEpochs) + " individuals=" + std::to_string(nIndividuals_) +
+									  " threads=" + std::to_string(nJobs_) + " actions=" + std::to_string(nTrainingActions) +
+									  " totalMs=" + std::to_string(trainingTime) + " epochsPerSecond=" + std::to_string(nEpochs * 1000.0f / trainingTime) +
+									  " actionsPerSecond=" + std::to_string(nTrainingActions * 1000.0f / trainingTime));
+
 			simInProgress_ = false;
 		
 		}
@@ -198,6 +554,7 @@ namespace AIExample {
 
 				aiGame_->generateAIWorld();
 				epochNewWorldCounter = 0;
+				resetFitnessCache();
 
 			}
 			aiGame_->spawnAgents();
@@ -246,6 +603,7 @@ namespace AIExample {
 			Epoch's beginning.
 			*/
 			aiGame_->generateAIWorld();
+			resetFitnessCache();
 			aiGame_->spawnAgents();
 
 			calculateFitness(); // Calculate fitness of the actual population.
@@ -276,6 +634,7 @@ namespace AIExample {
 		*/
 
 		aiGame_->generateAIWorld();
+		resetFitnessCache();
 		aiGame_->spawnAgents();
 
 		calculateFitness(); // Calculate fitness of the actual population.
@@ -297,50 +656,29 @@ namespace AIExample {
 		VoxelEng::timer t;
 		t.start();
 
-		std::string truePath = path + ".aidata",
-			        saveData;
-		std::ofstream saveFile(truePath);
-		float* weightsData = nullptr;
-
+		std::vector<float> population(static_cast<std::size_t>(nWeights_) * nIndividuals_);
 
-		// Store the individuals' network layout.
-		for (std::size_t i = 0; i < sizeLayer_.size(); i++)
-			saveData += std::to_string(sizeLayer_[i]) + '|';
-		saveData += '/';
 
-		// Store individuals' data.
-		hostPopInds_ = popInds_->host<unsigned int>();
 		VoxelEng::logger::say("Saving AI data...");
-		for (unsigned int i = 0; i < nIndividuals_; i++) { // For each individual (population or newborn).
-		
-			std::vector<af::array>* weights = individuals_[*(hostPopInds_ + i)].weights();
-
-			for (unsigned int layer = 0; layer < weights->size(); layer++) { // Save for every individual's connection between layers.
-			
-				weightsData = weights->operator[](layer).host<float>();
 
-				for (unsigned int w = 0; w < weights->operator[](layer).elements(); w++) { // Every connection's weight.
-				
-					saveData += std::to_string(*(weightsData + w));
-					saveData += '|';
-				
-				}
+		// Store the population's weights in the order given by popInds_.
+		hostPopInds_ = popInds_->host<unsigned int>();
+		for (unsigned int i = 0; i < nIndividuals_; i++)
+			std::copy(individuals_[hostPopInds_[i]].weights(), individuals_[hostPopInds_[i]].weights() + nWeights_,
+					  population.begin() + static_cast<std::size_t>(i) * nWeights_);
+		af::freeHost(hostPopInds_);
+		hostPopInds_ = nullptr;
 
-				saveData += '#';
+		try {
 
-				af::freeHost(weightsData);
-			
-			}
+			checkpointWriter::write(path + ".aidata", sizeLayer_, population.data(), nIndividuals_);
 
-			if (i != nIndividuals_ - 1)
-				saveData += '@';
-		
 		}
+		catch (const std::exception& e) {
 
-		saveFile << saveData;
+			VoxelEng::logger::errorLog(e.what());
 
-		af::freeHost(hostPopInds_);
-		hostPopInds_ = nullptr;
+		}
 
 		t.finish();
 
@@ -348,116 +686,70 @@ namespace AIExample {
 	
 	}
 
-	int genetic::loadIndividualsData(const std::string& path) {
-	
-		VoxelEng::timer t;
-		t.start();
-		std::string truePath = path + ".aidata";
-
-		if (std::filesystem::exists(truePath)) {
-
-			std::ifstream saveFile(truePath);
-			std::string word;
-			float number = 0.0f;
-			char character;
-			unsigned int nIndividualsToLoad = 0;
-
-
-			VoxelEng::logger::say("Type the number of individuals to load from the file or 0 to load them all.");
-			while (!VoxelEng::validatedCinInput<unsigned int>(nIndividualsToLoad))
-				VoxelEng::logger::say("Invalid number. Try again.");
-
+	void genetic::checkpointIndividualsData(const std::string& path) {
 
-			// Clean up data structures when necessary.
-			individuals_.clear();
-			sizeLayer_.clear();
+		std::vector<float> snapshot = checkpointWriter_.stagingBuffer();
 
-			// Create the data for the first read individual.
-			individuals_.emplace_back();
-			std::vector<af::array>* weights = individuals_[0].weights();
 
-			// Read the individuals' data.
-			std::vector<float> hostLayer;
-			bool readingLayout = true,
-			     continueReading = true;
-			unsigned int layer = 0,
-						 nConnections = 0;
-			GeneticNeuralNetwork* previousInd = nullptr;
-			while (saveFile.get(character) && continueReading) {
+		snapshot.resize(static_cast<std::size_t>(nWeights_) * nIndividuals_);
 
-				switch (character) {
+		hostPopInds_ = popInds_->host<unsigned int>();
+		for (unsigned int i = 0; i < nIndividuals_; i++)
+			std::copy(individuals_[hostPopInds_[i]].weights(), individuals_[hostPopInds_[i]].weights() + nWeights_,
+					  snapshot.begin() + static_cast<std::size_t>(i) * nWeights_);
+		af::freeHost(hostPopInds_);
+		hostPopInds_ = nullptr;
 
-					case '/': // Finished reading the individuals' network layout.
-						readingLayout = false;
-						nConnections = sizeLayer_.size();
-						break;
+		checkpointWriter_.submit(path + ".aidata", sizeLayer_, std::move(snapshot), nIndividuals_);
 
-					case '@': // New individual.
+	}
 
-						// Reshape the previous read individual to match the read network's layout.
-						previousInd = &individuals_.back();
-						for (unsigned int i = 0; i < nConnections - 1; i++)
-							previousInd->weights()->operator[](i) = af::moddims(previousInd->weights()->operator[](i), sizeLayer_[i] + 1, sizeLayer_[i + 1]);
-						previousInd->updateNLayers();
+	int genetic::loadIndividualsData(const std::string& path) {
 
-						if (nIndividualsToLoad && individuals_.size() >= nIndividualsToLoad)
-							continueReading = false;
-						else {
-						
-							// Create data for the new read individual.
-							individuals_.emplace_back();
-							weights = individuals_.back().weights();
-							layer = 0;
-						
-						}
-						break;
+		if (std::filesystem::exists(path + ".aidata")) {
 
-					case '#': // New individual's layer.
+			unsigned int nIndividualsToLoad = 0;
 
-						weights->emplace_back(hostLayer.size(), af::dtype::f32);
-						weights->operator[](layer).write(hostLayer.data(), hostLayer.size() * sizeof(float));
 
-						layer++;
+			VoxelEng::logger::say("Type the number of individuals to load from the file or 0 to load them all.");
+			while (!VoxelEng::validatedCinInput<unsigned int>(nIndividualsToLoad))
+				VoxelEng::logger::say("Invalid number. Try again.");
 
-						hostLayer.clear();
+			return loadIndividualsData(path, nIndividualsToLoad);
 
-						break;
+		}
+		else
+			return 0;
 
-					case '|': // New weight.
+	}
 
-						number = std::stof(word);
-						word = "";
+	int genetic::loadIndividualsData(const std::string& path, unsigned int nIndividualsToLoad) {
+	
+		VoxelEng::timer t;
+		t.start();
+		std::string truePath = path + ".aidata";
 
-						if (readingLayout)
-							sizeLayer_.push_back(number);
-						else
-							hostLayer.push_back(number);
+		if (std::filesystem::exists(truePath)) {
 
-						break;
+			VoxelEng::mappedFile file(truePath);
 
-					default: // Any part of a weight.
 
-						word += character;
+			// Clean up data structures when necessary.
+			individuals_.clear();
+			sizeLayer_.clear();
 
-						break;
+			// Files that do not start with the binary format's magic number are
+			// assumed to use the old text format.
+			if (file.size() >= sizeof(aidataHeader) && std::memcmp(file.data(), "VXAI", 4) == 0)
+				loadBinaryIndividualsData(file, truePath, nIndividualsToLoad);
+			else {
 
-				}
+				file.close();
+				importTextIndividualsData(truePath, nIndividualsToLoad);
 
 			}
 
-			// Reshape the last read individual to match the read network's layout if there is more than 1.
-			if (individuals_.size() > 1) {
-			
-				previousInd = &individuals_.back();
-				for (unsigned int i = 0; i < nConnections - 1; i++)
-					previousInd->weights()->operator[](i) = af::moddims(previousInd->weights()->operator[](i), sizeLayer_[i] + 1, sizeLayer_[i + 1]);
-				previousInd->updateNLayers();
-
-			}
-			
 			// Adjust the other data structures that need first the individuals' data to be loaded.
-			nIndividuals_ = individuals_.size();
-
 			fitness_ = af::constant(0.0f, nIndividuals_ * 2, af::dtype::f32);
 			selected_ = af::constant(0, nIndividuals_, af::dtype::u32);
 
@@ -471,13 +763,6 @@ namespace AIExample {
 			newbornInds_ = new af::array(nIndividuals_, af::dtype::u32);
 			*newbornInds_ = af::seq(nIndividuals_).operator af::array().as(af::dtype::u32) + nIndividuals_;
 
-			for (unsigned int i = nIndividuals_; i < nIndividuals_ * 2; i++) {
-			
-				individuals_.emplace_back();
-				individuals_[i].initNetwork(sizeLayer_, 0.0f, 0.0f);
-
-			}
-
 			t.finish();
 			VoxelEng::logger::debugLog("Finished loading AI data on " + std::to_string(t.getDurationMs()) + " ms");
 
@@ -489,31 +774,268 @@ namespace AIExample {
 
 	}
 
-	void genetic::genInitPop(unsigned int nIndividuals, float rangeMin, float rangeMax, bool training) {
-	
-		if (training && nIndividuals % 2 != 0)
-			VoxelEng::logger::errorLog("The number of individuals must be divisible by 2.");
+	void genetic::benchmarkIndividualsData(const std::string& path, unsigned int nRepetitions) {
+
+		if (!nIndividuals_ || !popInds_)
+			VoxelEng::logger::errorLog("There are no individuals to benchmark the AI data save/load with");
+
+		std::string binaryPath = path + "Binary",
+					textPath = path + "Text";
+		std::vector<float> original(static_cast<std::size_t>(nWeights_) * nIndividuals_);
+		VoxelEng::duration binarySave = 0,
+						   binaryLoad = 0,
+						   textSave = 0,
+						   textLoad = 0;
+		float maxTextError = 0.0f;
+		bool binaryExact = true;
+		unsigned int nIndividuals = nIndividuals_;
+		VoxelEng::timer t;
 
-		unsigned int totalNIndividuals = (aiGame_->recording()) ? nIndividuals : nIndividuals * 2;
-		nIndividuals_ = nIndividuals;
-		individuals_ = std::vector<GeneticNeuralNetwork>(totalNIndividuals);
-		fitness_ = af::constant(0.0f, totalNIndividuals, af::dtype::f32);
-		selected_ = af::constant(0, nIndividuals_, af::dtype::u32);
 
-		if (popInds_)
-			delete popInds_;
-		popInds_ = new af::array(nIndividuals_, af::dtype::u32); // Allocate space.
-		*popInds_ = af::seq(nIndividuals_).operator af::array().as(af::dtype::u32); // Assign values by creating an af::seq and then converting it to an af::array.
+		// Keep a copy of the current population in the order in which it is saved.
+		hostPopInds_ = popInds_->host<unsigned int>();
+		for (unsigned int i = 0; i < nIndividuals_; i++)
+			std::copy(individuals_[hostPopInds_[i]].weights(), individuals_[hostPopInds_[i]].weights() + nWeights_, original.begin() + static_cast<std::size_t>(i) * nWeights_);
+		af::freeHost(hostPopInds_);
+		hostPopInds_ = nullptr;
 
-		if (newbornInds_)
-			delete newbornInds_;
-		newbornInds_ = new af::array(nIndividuals_, af::dtype::u32);
-		*newbornInds_ = af::seq(nIndividuals_).operator af::array().as(af::dtype::u32) + nIndividuals_;
+		for (unsigned int i = 0; i < nRepetitions; i++) {
 
-		for (unsigned int i = 0; i < totalNIndividuals; i++)
-			individuals_[i].initNetwork(sizeLayer_, rangeMin, rangeMax);
-	
-	}
+			t.start();
+			saveIndividualsData(binaryPath);
+			t.finish();
+			binarySave += t.getDurationMs();
+
+			t.start();
+			loadIndividualsData(binaryPath, nIndividuals);
+			t.finish();
+			binaryLoad += t.getDurationMs();
+
+			binaryExact = binaryExact && std::equal(original.begin(), original.end(), weightsArena_.begin());
+
+			t.start();
+			saveIndividualsDataText(textPath);
+			t.finish();
+			textSave += t.getDurationMs();
+
+			t.start();
+			loadIndividualsData(textPath, nIndividuals);
+			t.finish();
+			textLoad += t.getDurationMs();
+
+			for (std::size_t w = 0; w < original.size(); w++)
+				maxTextError = std::max(maxTextError, std::abs(original[w] - weightsArena_[w]));
+
+		}
+
+		// Leave the population as it was before the benchmark.
+		std::copy(original.begin(), original.end(), weightsArena_.begin());
+
+		VoxelEng::logger::say("Binary .aidata: " + std::to_string(std::filesystem::file_size(binaryPath + ".aidata")) + " bytes, save " +
+							  std::to_string(binarySave / std::max(nRepetitions, 1u)) + " ms, load " + std::to_string(binaryLoad / std::max(nRepetitions, 1u)) +
+							  " ms, exact: " + (binaryExact ? "yes" : "no"));
+		VoxelEng::logger::say("Text .aidata: " + std::to_string(std::filesystem::file_size(textPath + ".aidata")) + " bytes, save " +
+							  std::to_string(textSave / std::max(nRepetitions, 1u)) + " ms, load " + std::to_string(textLoad / std::max(nRepetitions, 1u)) +
+							  " ms, max error: " + std::to_string(maxTextError));
+
+		std::filesystem::remove(binaryPath + ".aidata");
+		std::filesystem::remove(textPath + ".aidata");
+
+	}
+
+	void genetic::saveIndividualsDataText(const std::string& path) {
+
+		std::string saveData;
+		std::ofstream saveFile(path + ".aidata");
+
+
+		// Store the individuals' network layout.
+		for (std::size_t i = 0; i < sizeLayer_.size(); i++)
+			saveData += std::to_string(sizeLayer_[i]) + '|';
+		saveData += '/';
+
+		// Store individuals' data.
+		hostPopInds_ = popInds_->host<unsigned int>();
+		for (unsigned int i = 0; i < nIndividuals_; i++) { // For each individual (population or newborn).
+		
+			const float* weights = individuals_[*(hostPopInds_ + i)].weights();
+
+			for (unsigned int layer = 0; layer < sizeLayer_.size() - 1; layer++) { // Save for every individual's connection between layers.
+
+				for (unsigned int w = 0; w < (sizeLayer_[layer] + 1) * sizeLayer_[layer + 1]; w++) { // Every connection's weight.
+
+					saveData += std::to_string(*weights++);
+					saveData += '|';
+
+				}
+
+				saveData += '#';
+
+			}
+
+			if (i != nIndividuals_ - 1)
+				saveData += '@';
+		
+		}
+
+		saveFile << saveData;
+
+		af::freeHost(hostPopInds_);
+		hostPopInds_ = nullptr;
+
+	}
+
+	void genetic::loadBinaryIndividualsData(const VoxelEng::mappedFile& file, const std::string& path, unsigned int nIndividualsToLoad) {
+
+		aidataHeader header;
+		const unsigned char* layout = file.data() + sizeof(aidataHeader);
+		const float* weights = nullptr;
+		std::size_t expectedSize = 0;
+
+
+		std::memcpy(&header, file.data(), sizeof(aidataHeader));
+		if (header.version != aidataHeader::currentVersion)
+			VoxelEng::logger::errorLog("Unsupported AI data file version " + std::to_string(header.version) + " in " + path);
+
+		if (header.nLayers < 2 || file.size() < sizeof(aidataHeader) + header.nLayers * sizeof(std::uint32_t))
+			VoxelEng::logger::errorLog("The AI data file " + path + " is corrupted");
+
+		// Read the individuals' network layout.
+		sizeLayer_.resize(header.nLayers);
+		for (unsigned int i = 0; i < header.nLayers; i++)
+			std::memcpy(&sizeLayer_[i], layout + i * sizeof(std::uint32_t), sizeof(std::uint32_t));
+
+		expectedSize = sizeof(aidataHeader) + header.nLayers * sizeof(std::uint32_t) +
+					   static_cast<std::size_t>(GeneticNeuralNetwork::nWeights(sizeLayer_)) * header.nIndividuals * sizeof(float);
+		if (file.size() != expectedSize || VoxelEng::hashBytes(layout, file.size() - sizeof(aidataHeader)) != header.checksum)
+			VoxelEng::logger::errorLog("The AI data file " + path + " is corrupted");
+
+		// The weights are stored with the same layout as the weights arena so they
+		// are copied straight from the mapped file.
+		nIndividuals_ = (nIndividualsToLoad && nIndividualsToLoad < header.nIndividuals) ? nIndividualsToLoad : header.nIndividuals;
+		allocateIndividuals(nIndividuals_ * 2);
+		weights = reinterpret_cast<const float*>(layout + header.nLayers * sizeof(std::uint32_t));
+		std::copy(weights, weights + static_cast<std::size_t>(nWeights_) * nIndividuals_, weightsArena_.begin());
+		std::fill(weightsArena_.begin() + static_cast<std::size_t>(nWeights_) * nIndividuals_, weightsArena_.end(), 0.0f);
+
+	}
+
+	void genetic::importTextIndividualsData(const std::string& path, unsigned int nIndividualsToLoad) {
+
+		std::ifstream saveFile(path);
+		std::string word;
+		float number = 0.0f;
+		char character;
+
+
+		// Read the individuals' data.
+		// The weights are stored in the file in the same order as in the weights arena.
+		std::vector<float> loadedWeights;
+		bool readingLayout = true,
+		     continueReading = true;
+		unsigned int nLoadedIndividuals = 1;
+		while (saveFile.get(character) && continueReading) {
+
+			switch (character) {
+
+				case '/': // Finished reading the individuals' network layout.
+					readingLayout = false;
+					break;
+
+				case '@': // New individual.
+
+					if (nIndividualsToLoad && nLoadedIndividuals >= nIndividualsToLoad)
+						continueReading = false;
+					else
+						nLoadedIndividuals++;
+					break;
+
+				case '#': // New individual's layer.
+					break;
+
+				case '|': // New weight.
+
+					number = std::stof(word);
+					word = "";
+
+					if (readingLayout)
+						sizeLayer_.push_back(number);
+					else
+						loadedWeights.push_back(number);
+
+					break;
+
+				default: // Any part of a weight.
+
+					word += character;
+
+					break;
+
+			}
+
+		}
+
+		// Store the read weights in the arena. The newborn start with all their weights set to zero.
+		nIndividuals_ = nLoadedIndividuals;
+		allocateIndividuals(nIndividuals_ * 2);
+		if (loadedWeights.size() != static_cast<std::size_t>(nWeights_) * nIndividuals_)
+			VoxelEng::logger::errorLog("The AI data file " + path + " is corrupted");
+		std::copy(loadedWeights.begin(), loadedWeights.end(), weightsArena_.begin());
+		std::fill(weightsArena_.begin() + loadedWeights.size(), weightsArena_.end(), 0.0f);
+
+	}
+
+	void genetic::genInitPop(unsigned int nIndividuals, float rangeMin, float rangeMax, bool training) {
+	
+		if (training && nIndividuals % 2 != 0)
+			VoxelEng::logger::errorLog("The number of individuals must be divisible by 2.");
+
+		unsigned int totalNIndividuals = (aiGame_->recording()) ? nIndividuals : nIndividuals * 2;
+		nIndividuals_ = nIndividuals;
+		allocateIndividuals(totalNIndividuals);
+		fitness_ = af::constant(0.0f, totalNIndividuals, af::dtype::f32);
+		selected_ = af::constant(0, nIndividuals_, af::dtype::u32);
+
+		if (popInds_)
+			delete popInds_;
+		popInds_ = new af::array(nIndividuals_, af::dtype::u32); // Allocate space.
+		*popInds_ = af::seq(nIndividuals_).operator af::array().as(af::dtype::u32); // Assign values by creating an af::seq and then converting it to an af::array.
+
+		if (newbornInds_)
+			delete newbornInds_;
+		newbornInds_ = new af::array(nIndividuals_, af::dtype::u32);
+		*newbornInds_ = af::seq(nIndividuals_).operator af::array().as(af::dtype::u32) + nIndividuals_;
+
+		// Initialize all weights randomly, four weights per number drawn from the counter-based generator.
+		const VoxelEng::counterRNG& rng = aiGame_->AIcounterRNG();
+		std::array<std::uint32_t, 4> random;
+		for (unsigned int i = 0; i < totalNIndividuals; i++) {
+
+			float* weights = individuals_[i].weights();
+
+			for (unsigned int w = 0; w < nWeights_; w++) {
+
+				if (w % 4 == 0)
+					random = rng.generate(0, i, w / 4, static_cast<std::uint32_t>(randomStream::INITIALIZATION));
+				weights[w] = (rangeMax - rangeMin) * VoxelEng::counterRNG::toFloat(random[w % 4]) + rangeMin;
+
+			}
+
+		}
+	
+	}
+
+	void genetic::allocateIndividuals(unsigned int nIndividuals) {
+
+		nWeights_ = GeneticNeuralNetwork::nWeights(sizeLayer_);
+		weightsArena_.resize(static_cast<std::size_t>(nWeights_) * nIndividuals);
+
+		individuals_.clear();
+		individuals_.reserve(nIndividuals);
+		for (unsigned int i = 0; i < nIndividuals; i++)
+			individuals_.emplace_back(weightsArena_.data() + static_cast<std::size_t>(i) * nWeights_, sizeLayer_);
+
+	}
 
 	void genetic::setGame() {
 
@@ -542,6 +1064,193 @@ namespace AIExample {
 	
 	}
 
+	void genetic::setLockstepFunctions(void (*beginFunction)(unsigned int individualID),
+									   bool (*observeFunction)(unsigned int individualID, int* input),
+									   void (*actFunction)(unsigned int individualID, unsigned int action),
+									   float (*scoreFunction)(unsigned int individualID)) {
+
+		if (simInProgress_)
+			VoxelEng::logger::errorLog("Cannot change lockstep functions during a simulation.");
+		else {
+
+			lockstepBeginFunction_ = beginFunction;
+			lockstepObserveFunction_ = observeFunction;
+			lockstepActFunction_ = actFunction;
+			lockstepScoreFunction_ = scoreFunction;
+
+		}
+
+	}
+
+	void genetic::setEvaluationMode(evaluationMode mode) {
+
+		if (simInProgress_)
+			VoxelEng::logger::errorLog("Cannot change evaluation mode during a simulation.");
+		else
+			evaluationMode_ = mode;
+
+	}
+
+	void genetic::setWorkerProcesses(unsigned int nProcesses, const std::string& executable, unsigned int timeout) {
+
+		if (simInProgress_)
+			VoxelEng::logger::errorLog("Cannot change the worker processes during a simulation");
+		else {
+
+			nWorkerProcesses_ = nProcesses;
+			workerExecutable_ = executable;
+			workerTimeout_ = timeout;
+
+		}
+
+	}
+
+	void genetic::serveFitnessRequests(unsigned int nIndividuals, VoxelEng::processChannel& channel) {
+
+		if (!(aiGame_ = dynamic_cast<AIExample::miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())))
+			VoxelEng::logger::errorLog("The selected AI game is not a 'miningAIGame'");
+
+		if (!evaluationFunction_)
+			VoxelEng::logger::errorLog("No evaluation function is set");
+
+		fitnessWorkerRequest request = fitnessWorkerRequest::RESET;
+		std::uint32_t seed = 0,
+					  length = 0,
+					  nRequested = 0;
+		std::vector<std::uint32_t> requestedIDs;
+		std::string path;
+		std::chrono::steady_clock::time_point evaluationStart;
+		bool open = true;
+
+
+		nIndividuals_ = nIndividuals;
+		allocateIndividuals(nIndividuals_ * 2);
+		simInProgress_ = true;
+
+		while (open && channel.read(&request, sizeof(request))) {
+
+			switch (request) {
+
+				case fitnessWorkerRequest::WORLD:
+
+					open = channel.read(&seed, sizeof(seed)) && channel.read(&length, sizeof(length));
+					path.resize(length);
+					open = open && channel.read(path.data(), length);
+					if (open) {
+
+						VoxelEng::chunkManager::attachAIWorld(path);
+
+						// Leave the world generator in the same state as if it had generated the world.
+						VoxelEng::worldGen::setSeed(seed);
+						VoxelEng::worldGen::prepareGen();
+
+					}
+
+					break;
+
+				case fitnessWorkerRequest::RESET:
+
+					VoxelEng::chunkManager::resetAIChunks();
+					aiGame_->spawnAgents();
+
+					break;
+
+				case fitnessWorkerRequest::EVALUATE:
+
+					// The whole request is read before evaluating anything. Otherwise the parent process, which
+					// sends the slices of the workers one after another, would be blocked writing the rest of this
+					// worker's slice (each genome is about as large as a pipe's buffer) until this worker finished
+					// evaluating, so the workers would not evaluate their slices at the same time.
+					open = channel.read(&nRequested, sizeof(nRequested));
+					requestedIDs.resize(open ? nRequested : 0);
+					for (std::uint32_t i = 0; open && i < nRequested; i++)
+						open = channel.read(&requestedIDs[i], sizeof(std::uint32_t)) && requestedIDs[i] < individuals_.size() &&
+							   channel.read(individuals_[requestedIDs[i]].weights(), nWeights_ * sizeof(float));
+
+					workerResults_.resize(requestedIDs.size());
+					for (std::uint32_t i = 0; open && i < nRequested; i++) {
+
+						evaluationStart = std::chrono::steady_clock::now();
+						workerResults_[i].fitness = evaluationFunction_(requestedIDs[i]);
+						workerResults_[i].nActions = aiGame_->nActionsPerformed(requestedIDs[i]);
+						workerResults_[i].evaluationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - evaluationStart).count();
+
+					}
+
+					open = open && channel.write(workerResults_.data(), nRequested * sizeof(fitnessWorkerResult));
+
+					break;
+
+				default:
+
+					VoxelEng::logger::errorLog("Unknown fitness worker request " + std::to_string(static_cast<std::uint32_t>(request)));
+
+			}
+
+		}
+
+		simInProgress_ = false;
+
+	}
+
+	void genetic::dumpTelemetry(const std::string& path, unsigned int generation) const {
+
+		bool writeColumnNames = !std::filesystem::exists(path);
+		std::ofstream telemetryFile(path, std::ios::app);
+		std::string data;
+
+
+		if (writeColumnNames)
+			data += "generation,individual,newborn,cached,fitness,actions,evaluationTimeMs\n";
+
+		for (std::size_t i = 0; i < telemetry_.size(); i++) {
+
+			const episodeTelemetry& episode = telemetry_[i];
+
+			data += std::to_string(generation) + ',' + std::to_string(episode.individualID) + ',' + (episode.newborn ? '1' : '0') + ',' + (episode.cached ? '1' : '0') + ',' +
+					std::to_string(episode.fitness) + ',' + std::to_string(episode.nActions) + ',' + std::to_string(episode.evaluationTime) + '\n';
+
+		}
+
+		telemetryFile << data;
+
+		if (!telemetryFile)
+			VoxelEng::logger::warningLog("Could not write telemetry to " + path);
+
+	}
+
+	void genetic::reportEpochTimings() const {
+
+		const epochTimings& timings = epochTimings_;
+		float totalTime = std::max(timings.totalTime, 1e-3f);
+
+
+		VoxelEng::logger::say("[TIMINGS] epoch=" + std::to_string(timings.epoch) + " individuals=" + std::to_string(nIndividuals_) +
+							  " threads=" + std::to_string(nJobs_) + " actions=" + std::to_string(timings.nActions) +
+							  " totalMs=" + std::to_string(timings.totalTime) + " worldMs=" + std::to_string(timings.worldTime) +
+							  " inferenceMs=" + std::to_string(timings.inferenceTime) + " operatorsMs=" + std::to_string(timings.operatorsTime) +
+							  " epochsPerSecond=" + std::to_string(1000.0f / totalTime) +
+							  " actionsPerSecond=" + std::to_string(timings.nActions * 1000.0f / totalTime) +
+							  " worldShare=" + std::to_string(timings.worldTime / totalTime) +
+							  " inferenceShare=" + std::to_string(timings.inferenceTime / totalTime) +
+							  " operatorsShare=" + std::to_string(timings.operatorsTime / totalTime));
+
+	}
+
+	void genetic::setWorldPregeneration(unsigned int nWorldsAhead, std::size_t memoryCap, unsigned int nThreads) {
+
+		if (simInProgress_)
+			VoxelEng::logger::errorLog("Cannot change the world pregeneration parameters during a simulation");
+		else {
+
+			nPregeneratedWorlds_ = nWorldsAhead;
+			pregenerationMemoryCap_ = memoryCap;
+			nPregenerationThreads_ = nThreads;
+
+		}
+
+	}
+
 	void genetic::setCrossoverSplitPoint(unsigned int point) {
 
 		if (simInProgress_)
@@ -601,6 +1310,10 @@ namespace AIExample {
 		if (!evaluationFunction_)
 			VoxelEng::logger::errorLog("No evaluation function was assigned to this object");
 
+		if (evaluationMode_ == evaluationMode::LOCKSTEP &&
+			(!lockstepBeginFunction_ || !lockstepObserveFunction_ || !lockstepActFunction_ || !lockstepScoreFunction_))
+			VoxelEng::logger::errorLog("Lockstep evaluation was selected but not all the lockstep functions were assigned to this object");
+
 		if (!aiGame_)
 			VoxelEng::logger::errorLog("No game was assigned to the simulation");
 
@@ -635,38 +1348,118 @@ namespace AIExample {
 		// Send jobs to thread pool and wait until they are done.
 		hostFitness_ = fitness_.host<float>(); // Do not free this as it is used later by other genetic operators.
 
-		if (nIndividuals_ < nJobs_) {
-		
-			if (geneticJobs_.empty())
-				geneticJobs_.emplace_back(0, nIndividuals_ - 1, hostFitness_, hostIndices, evaluationFunction_); // Avoid unnecesary copy from push_back().
-			else
-				geneticJobs_[0].setAttributes(0, nIndividuals_ - 1, hostFitness_, hostIndices, evaluationFunction_); // Reuse 'geneticJob' objects to avoid dynamic memory overhead.
-			threadPool_->submitJob(&geneticJobs_[0]);
-		
+		// The matches are deterministic, so an individual whose genome was already evaluated
+		// in the current world gets the same fitness without playing its match again.
+		// The cache is only used during training. When testing or recording, every individual must play its match.
+		// The first cache hit of each evaluation plays its match anyway to check that assumption, since said individual
+		// is evaluated in a different generation and usually in a different agent slot than when it was cached.
+		bool useFitnessCache = fitnessCacheEnabled_ && training_,
+			 checkFitnessCache = useFitnessCache;
+		std::size_t checkedIndex = nIndividuals_;
+		float checkedFitness = 0.0f;
+		genomeKeys_.resize(nIndividuals_);
+		fitnessCacheHits_.assign(nIndividuals_, nullptr);
+		pendingIndices_.clear();
+		for (std::size_t i = 0; i < nIndividuals_; i++) {
+
+			if (useFitnessCache) {
+
+				genomeKeys_[i] = genomeKey(hostIndices[i]);
+
+				auto it = fitnessCache_.find(genomeKeys_[i]);
+				if (it != fitnessCache_.cend() && checkFitnessCache) {
+
+					checkFitnessCache = false;
+					checkedIndex = i;
+					checkedFitness = it->second.fitness;
+
+				}
+				else if (it != fitnessCache_.cend()) {
+
+					fitnessCacheHits_[i] = &it->second;
+					hostFitness_[hostIndices[i]] = it->second.fitness;
+					continue;
+
+				}
+
+			}
+
+			pendingIndices_.push_back(hostIndices[i]);
+
 		}
-		else {
-		
-			std::size_t rangeStart = 0,
-				rangeEnd = 0,
-				nConstructedJobs = geneticJobs_.size();
-			for (std::size_t i = 0; i < nJobs_; i++) {
 
-				rangeStart = nIndividuals_ / nJobs_ * i;
-				rangeEnd = (i == nJobs_ - 1) ? nIndividuals_ - 1 : rangeStart + nIndividuals_ / nJobs_ - 1;
+		std::size_t nPending = pendingIndices_.size();
+		VoxelEng::logger::debugLog("Fitness cache hits: " + std::to_string(nIndividuals_ - nPending) + " of " + std::to_string(nIndividuals_));
+
+		// 'evaluationTimes_' follows the order of 'pendingIndices_'.
+		evaluationTimes_.assign(nPending, 0.0f);
+
+		if (nPending && evaluationMode_ == evaluationMode::LOCKSTEP)
+			calculateFitnessLockstep(pendingIndices_.data(), nPending);
+		else if (nPending && !workers_.empty())
+			calculateFitnessWorkers(pendingIndices_.data(), nPending);
+		else if (nPending) {
+
+			std::chrono::steady_clock::time_point evaluationStart = std::chrono::steady_clock::now();
+
+			// Matches vary a lot in length, so instead of giving each job a fixed range of individuals,
+			// the jobs claim small batches of them until there are none left.
+			std::size_t nActiveJobs = std::min<std::size_t>(nJobs_, nPending),
+						batchSize = std::max<std::size_t>(1, nPending / (nActiveJobs * 8)),
+						nConstructedJobs = geneticJobs_.size();
+			nextIndividual_ = 0;
+			for (std::size_t i = 0; i < nActiveJobs; i++) {
 
 				if (i >= nConstructedJobs)
-					geneticJobs_.emplace_back(rangeStart, rangeEnd, hostFitness_, hostIndices, evaluationFunction_); // Avoid unnecesary copy from push_back().
+					geneticJobs_.emplace_back(&nextIndividual_, nPending, batchSize, hostFitness_, pendingIndices_.data(), evaluationTimes_.data(), evaluationFunction_); // Avoid unnecesary copy from push_back().
 				else
-					geneticJobs_[i].setAttributes(rangeStart, rangeEnd, hostFitness_, hostIndices, evaluationFunction_); // Reuse 'geneticJob' objects to avoid dynamic memory overhead.
-				threadPool_->submitJob(&geneticJobs_[i]);
+					geneticJobs_[i].setAttributes(&nextIndividual_, nPending, batchSize, hostFitness_, pendingIndices_.data(), evaluationTimes_.data(), evaluationFunction_); // Reuse 'geneticJob' objects to avoid dynamic memory overhead.
+				threadPool_->submitJob(&geneticJobs_[i], jobsGroup_);
 
 			}
-		
+
+			VoxelEng::logger::debugLog("Waiting for all jobs to end");
+			threadPool_->wait(jobsGroup_);
+			VoxelEng::logger::debugLog("All jobs ended");
+
+			for (std::size_t i = 0; i < nActiveJobs; i++)
+				VoxelEng::logger::debugLog("Genetic job " + std::to_string(i) + " busy for " + std::to_string(geneticJobs_[i].busyTime()) + " ms");
+
+			// The matches interleave world access and inference, so all of their time is accounted as world access.
+			epochTimings_.worldTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - evaluationStart).count();
+
+		}
+
+		bool fitnessCacheFailed = checkedIndex < nIndividuals_ && hostFitness_[hostIndices[checkedIndex]] != checkedFitness;
+		if (fitnessCacheFailed) {
+
+			VoxelEng::logger::warningLog("Individual " + std::to_string(hostIndices[checkedIndex]) + " got a fitness of " +
+										 std::to_string(hostFitness_[hostIndices[checkedIndex]]) + " instead of its cached fitness of " +
+										 std::to_string(checkedFitness) + ". The matches are not deterministic, so the fitness cache is disabled");
+			fitnessCacheEnabled_ = false;
+			useFitnessCache = false;
+
 		}
 
-		VoxelEng::logger::debugLog("Waiting for all jobs to end");
-		threadPool_->awaitNoJobs();
-		VoxelEng::logger::debugLog("All jobs ended");
+		// Store the telemetry of the evaluated matches. A new generation starts when the population is evaluated.
+		if (!useNewborn)
+			telemetry_.clear();
+		for (std::size_t i = 0, nEvaluated = 0; i < nIndividuals_; i++)
+			if (const cachedFitness* hit = fitnessCacheHits_[i])
+				telemetry_.push_back(episodeTelemetry{ hostIndices[i], hit->nActions, hit->fitness, 0.0f, useNewborn, true });
+			else {
+
+				telemetry_.push_back(episodeTelemetry{ hostIndices[i], aiGame_->nActionsPerformed(hostIndices[i]),
+													   hostFitness_[hostIndices[i]], evaluationTimes_[nEvaluated++], useNewborn, false });
+
+				if (useFitnessCache)
+					fitnessCache_[genomeKeys_[i]] = cachedFitness{ telemetry_.back().fitness, telemetry_.back().nActions };
+
+			}
+
+		// Only after the telemetry has been stored since it points to the cached values.
+		if (fitnessCacheFailed)
+			fitnessCache_.clear();
 
 
 		// DEBUG.
@@ -685,6 +1478,262 @@ namespace AIExample {
 
 	}
 
+	void genetic::calculateFitnessLockstep(const unsigned int* hostIndices, std::size_t nIndices) {
+
+		unsigned int nInputs = sizeLayer_[0],
+					 nActive = 0;
+		bool firstStep = true;
+		std::size_t nSteps = 0;
+		std::chrono::steady_clock::time_point phaseStart = std::chrono::steady_clock::now();
+
+
+		if (nJobs_ > lockstepJobs_.capacity())
+			lockstepJobs_.reserve(nJobs_);
+
+		lockstepInputs_.assign(nIndices * nInputs, 0);
+		lockstepActions_.assign(nIndices, 0);
+		lockstepActive_.assign(nIndices, 0);
+
+		// The weights do not change during the evaluation, so they are stacked only once.
+		GeneticNeuralNetwork::stackWeights(individuals_, hostIndices, nIndices, stackedWeights_);
+		epochTimings_.inferenceTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - phaseStart).count();
+
+		do {
+
+			phaseStart = std::chrono::steady_clock::now();
+
+			// Perform the last chosen actions and get the next inputs in parallel.
+			// Ranges refer to the position of the individuals in 'hostIndices'.
+			std::size_t nStepJobs = (nIndices < nJobs_) ? 1 : nJobs_,
+						rangeStart = 0,
+						rangeEnd = 0,
+						nConstructedJobs = lockstepJobs_.size();
+			for (std::size_t i = 0; i < nStepJobs; i++) {
+
+				rangeStart = nIndices / nStepJobs * i;
+				rangeEnd = (i == nStepJobs - 1) ? nIndices - 1 : rangeStart + nIndices / nStepJobs - 1;
+
+				if (i >= nConstructedJobs)
+					lockstepJobs_.emplace_back(rangeStart, rangeEnd, hostIndices, lockstepActions_.data(), lockstepActive_.data(),
+											   lockstepInputs_.data(), nInputs, firstStep, lockstepBeginFunction_, lockstepObserveFunction_, lockstepActFunction_);
+				else
+					lockstepJobs_[i].setAttributes(rangeStart, rangeEnd, hostIndices, lockstepActions_.data(), lockstepActive_.data(),
+												   lockstepInputs_.data(), nInputs, firstStep, lockstepBeginFunction_, lockstepObserveFunction_, lockstepActFunction_);
+				threadPool_->submitJob(&lockstepJobs_[i], jobsGroup_);
+
+			}
+
+			threadPool_->wait(jobsGroup_);
+			firstStep = false;
+
+			nActive = 0;
+			for (std::size_t i = 0; i < nIndices; i++)
+				if (lockstepActive_[i])
+					nActive++;
+
+			epochTimings_.worldTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - phaseStart).count();
+
+			// Choose the next action of the whole population at once.
+			// Individuals whose match has ended are propagated too but their actions are ignored.
+			if (nActive) {
+
+				phaseStart = std::chrono::steady_clock::now();
+
+				af::array inputs(1, nInputs, nIndices, af::dtype::s32);
+				inputs.write(lockstepInputs_.data(), lockstepInputs_.size() * sizeof(int));
+
+				unsigned int* actions = GeneticNeuralNetwork::forwardPropagationMaxBatch(stackedWeights_, inputs).host<unsigned int>();
+				std::copy(actions, actions + nIndices, lockstepActions_.begin());
+				af::freeHost(actions);
+
+				epochTimings_.inferenceTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - phaseStart).count();
+				nSteps++;
+
+			}
+
+		} while (nActive);
+
+		VoxelEng::logger::debugLog("Lockstep evaluation finished after " + std::to_string(nSteps) + " steps");
+
+		for (std::size_t i = 0; i < nIndices; i++)
+			hostFitness_[hostIndices[i]] = lockstepScoreFunction_(hostIndices[i]);
+
+	}
+
+	void genetic::calculateFitnessWorkers(const unsigned int* hostIndices, std::size_t nIndices) {
+
+		std::chrono::steady_clock::time_point evaluationStart = std::chrono::steady_clock::now(),
+											  matchStart;
+		std::size_t nWorkers = workers_.size();
+		std::vector<std::size_t> slices(nWorkers + 1, 0); // Worker 'w' evaluates the individuals in positions [slices[w], slices[w + 1]).
+		fitnessWorkerRequest request = fitnessWorkerRequest::EVALUATE;
+		std::uint32_t nSliceIndividuals = 0,
+					  individualID = 0;
+		bool sent = false;
+
+
+		workerResults_.resize(nIndices);
+		for (std::size_t w = 0; w < nWorkers; w++)
+			slices[w + 1] = nIndices * (w + 1) / nWorkers;
+
+		// Send all the slices before waiting for any result so that the workers evaluate them at the same time.
+		for (std::size_t w = 0; w < nWorkers; w++) {
+
+			if (!workers_[w].isRunning())
+				continue;
+
+			VoxelEng::processChannel& channel = workers_[w].channel();
+			nSliceIndividuals = slices[w + 1] - slices[w];
+
+			sent = channel.write(&request, sizeof(request)) && channel.write(&nSliceIndividuals, sizeof(nSliceIndividuals));
+			for (std::size_t i = slices[w]; sent && i < slices[w + 1]; i++) {
+
+				individualID = hostIndices[i];
+				sent = channel.write(&individualID, sizeof(individualID)) &&
+					   channel.write(individuals_[individualID].weights(), nWeights_ * sizeof(float));
+
+			}
+
+			if (!sent)
+				dropWorker(w);
+
+		}
+
+		for (std::size_t w = 0; w < nWorkers; w++) {
+
+			if (workers_[w].isRunning() &&
+				!workers_[w].channel().read(workerResults_.data() + slices[w], (slices[w + 1] - slices[w]) * sizeof(fitnessWorkerResult)))
+				dropWorker(w);
+
+			// The slices of the workers that failed are evaluated here.
+			if (!workers_[w].isRunning())
+				for (std::size_t i = slices[w]; i < slices[w + 1]; i++) {
+
+					matchStart = std::chrono::steady_clock::now();
+					workerResults_[i].fitness = evaluationFunction_(hostIndices[i]);
+					workerResults_[i].nActions = aiGame_->nActionsPerformed(hostIndices[i]);
+					workerResults_[i].evaluationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - matchStart).count();
+
+				}
+
+		}
+
+		for (std::size_t i = 0; i < nIndices; i++) {
+
+			hostFitness_[hostIndices[i]] = workerResults_[i].fitness;
+			aiGame_->nActionsPerformed(hostIndices[i]) = workerResults_[i].nActions;
+			evaluationTimes_[i] = workerResults_[i].evaluationTime;
+
+		}
+
+		// As in evaluationMode::INDIVIDUAL, all the time of the matches is accounted as world access.
+		epochTimings_.worldTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - evaluationStart).count();
+
+	}
+
+	void genetic::startWorkers() {
+
+		if (!nWorkerProcesses_ || workerExecutable_.empty())
+			VoxelEng::logger::errorLog("The worker processes must be set with genetic::setWorkerProcesses() to use evaluationMode::MULTIPROCESS");
+
+		for (unsigned int i = 0; i < nWorkerProcesses_; i++) {
+
+			workers_.emplace_back();
+			workers_.back().start(workerExecutable_, { "--fitness-worker", aiGame_->name(), std::to_string(nIndividuals_) });
+			workers_.back().channel().setReadTimeout(workerTimeout_ * 1000);
+
+		}
+
+		VoxelEng::logger::debugLog("Started " + std::to_string(nWorkerProcesses_) + " fitness worker processes");
+
+	}
+
+	void genetic::sendWorldToWorkers(unsigned int seed) {
+
+		std::string previousPath = workerWorldPath_;
+		fitnessWorkerRequest request = fitnessWorkerRequest::WORLD;
+		std::uint32_t length = 0;
+		std::error_code error;
+
+
+		workerWorldPath_ = (std::filesystem::temp_directory_path() /
+						   ("VoxelEngAIWorld_" + std::to_string(seed) + '_' + std::to_string(generation_) + ".vxwi")).string();
+		length = workerWorldPath_.size();
+
+		VoxelEng::chunkManager::exportAIWorld(workerWorldPath_);
+
+		for (std::size_t w = 0; w < workers_.size(); w++)
+			if (workers_[w].isRunning()) {
+
+				VoxelEng::processChannel& channel = workers_[w].channel();
+
+				if (!channel.write(&request, sizeof(request)) || !channel.write(&seed, sizeof(seed)) ||
+					!channel.write(&length, sizeof(length)) || !channel.write(workerWorldPath_.data(), length))
+					dropWorker(w);
+
+			}
+
+		// The workers keep the previous image mapped until they read the new one. Removing it only unlinks it where that is allowed.
+		if (!previousPath.empty())
+			std::filesystem::remove(previousPath, error);
+
+	}
+
+	void genetic::resetWorkers() {
+
+		fitnessWorkerRequest request = fitnessWorkerRequest::RESET;
+
+
+		for (std::size_t w = 0; w < workers_.size(); w++)
+			if (workers_[w].isRunning() && !workers_[w].channel().write(&request, sizeof(request)))
+				dropWorker(w);
+
+	}
+
+	void genetic::stopWorkers() {
+
+		std::error_code error;
+
+
+		for (std::size_t w = 0; w < workers_.size(); w++)
+			workers_[w].stop();
+		workers_.clear();
+
+		if (!workerWorldPath_.empty()) {
+
+			std::filesystem::remove(workerWorldPath_, error);
+			workerWorldPath_.clear();
+
+		}
+
+	}
+
+	void genetic::dropWorker(std::size_t worker) {
+
+		VoxelEng::logger::warningLog("Fitness worker process " + std::to_string(worker) + " stopped responding. "
+									 "Its individuals are evaluated by the training process from now on");
+		workers_[worker].stop();
+
+	}
+
+	void genetic::resetFitnessCache() {
+
+		// The cached fitness values are only valid for the world where they were obtained.
+		fitnessCacheSeed_ = VoxelEng::worldGen::getSeed();
+		fitnessCache_.clear();
+
+	}
+
+	std::uint64_t genetic::genomeKey(unsigned int individualID) const {
+
+		const GeneticNeuralNetwork& individual = individuals_[individualID];
+
+
+		return VoxelEng::hashBytes(individual.weights(), individual.nWeights() * sizeof(float),
+								   VoxelEng::hashBytes(&fitnessCacheSeed_, sizeof(fitnessCacheSeed_)));
+
+	}
+
 	GeneticNeuralNetwork& genetic::individual(unsigned int individualID) {
 
 		if (individualID < individuals_.size())
@@ -711,7 +1760,10 @@ namespace AIExample {
 			float* prob = af::accum(popFitness / fitnessSum.as(af::dtype::f32).scalar<float>()).host<float>();
 
 			// Select the parents using said random numbers.
-			af::array rand = af::randu(nIndividuals_, af::dtype::f32, aiGame_->AIrandEng());
+			std::vector<float> hostRand(nIndividuals_);
+			for (unsigned int i = 0; i < nIndividuals_; i++)
+				hostRand[i] = aiGame_->AIcounterRNG().uniform(generation_, i, 0, static_cast<std::uint32_t>(randomStream::SELECTION));
+			af::array rand(nIndividuals_, hostRand.data());
 			selected_(af::where(rand <= prob[0])) = 0;
 			for (std::size_t i = 1; i <= nIndividuals_; i++)
 				selected_(af::where(rand <= prob[i] && rand > prob[i - 1])) = i;
@@ -753,27 +1805,21 @@ namespace AIExample {
 				hostSelected_ = selected_.host<unsigned int>();
 				hostPopInds_ = popInds_->host<unsigned int>();
 				hostNewbornInds_ = newbornInds_->host<unsigned int>();
+				unsigned int splitOffset = individuals_[0].layerOffset(std::min<unsigned int>(crossoverSplitPoint_ + 1, sizeLayer_.size() - 1));
 
 				for (unsigned int i = 0; i < nIndividuals_; i += 2) {
 
-					std::vector<af::array>* newborn1Weights = individuals_[hostNewbornInds_[i]].weights(),
-						* newborn2Weights = individuals_[hostNewbornInds_[i + 1]].weights(),
-						* parent1Weights = individuals_[hostPopInds_[hostSelected_[i]]].weights(),
-						* parent2Weights = individuals_[hostPopInds_[hostSelected_[i + 1]]].weights();
-
-					for (int j = crossoverSplitPoint_; j >= 0; j--) {
-
-						newborn1Weights->operator[](j) = parent2Weights->operator[](j);
-						newborn2Weights->operator[](j) = parent1Weights->operator[](j);
-
-					}
-
-					for (int j = crossoverSplitPoint_ + 1; j < newborn1Weights->size(); j++) {
+					float* newborn1Weights = individuals_[hostNewbornInds_[i]].weights(),
+						 * newborn2Weights = individuals_[hostNewbornInds_[i + 1]].weights();
+					const float* parent1Weights = individuals_[hostPopInds_[hostSelected_[i]]].weights(),
+							   * parent2Weights = individuals_[hostPopInds_[hostSelected_[i + 1]]].weights();
 
-						newborn1Weights->operator[](j) = parent1Weights->operator[](j);
-						newborn2Weights->operator[](j) = parent2Weights->operator[](j);
+					// Layers [0, crossoverSplitPoint_] come from the other parent.
+					std::copy(parent2Weights, parent2Weights + splitOffset, newborn1Weights);
+					std::copy(parent1Weights, parent1Weights + splitOffset, newborn2Weights);
 
-					}
+					std::copy(parent1Weights + splitOffset, parent1Weights + nWeights_, newborn1Weights + splitOffset);
+					std::copy(parent2Weights + splitOffset, parent2Weights + nWeights_, newborn2Weights + splitOffset);
 
 				}
 
@@ -817,12 +1863,12 @@ namespace AIExample {
 					copyJobs_.emplace_back(rangeStart, rangeEnd, &parent, &individuals_, hostNewbornInds_); // Avoid unnecesary copy from push_back().
 				else
 					copyJobs_[i].setAttributes(rangeStart, rangeEnd, &parent, &individuals_, hostNewbornInds_); // Reuse 'geneticJob' objects to avoid dynamic memory overhead.
-				threadPool_->submitJob(&copyJobs_[i]);
+				threadPool_->submitJob(&copyJobs_[i], jobsGroup_);
 
 			}
 
 			VoxelEng::logger::debugLog("Waiting for all jobs to end");
-			threadPool_->awaitNoJobs();
+			threadPool_->wait(jobsGroup_);
 			VoxelEng::logger::debugLog("All jobs ended");
 
 			// Free copied memory from device (GPU) to host (CPU).
@@ -841,26 +1887,35 @@ namespace AIExample {
 
 			hostNewbornInds_ = newbornInds_->host<unsigned int>();
 
-			unsigned int sizeX = 0,
-						 sizeY = 0;
-			for (unsigned int i = 0; i < nIndividuals_; i++) {
-			
-				std::vector<af::array>* weights = individuals_[hostNewbornInds_[i]].weights();
-
-				for (int j = 0; j < weights->size(); j++) {
-				
-					// Calculate genes unaffected by mutation.
-					sizeX = weights->operator[](j).dims(0);
-					sizeY = weights->operator[](j).dims(1);
-					af::array variation = (mutationVariationMax_ - mutationVariationMin_) * af::randu(af::dim4(sizeX, sizeY), af::dtype::f32, aiGame_->AIrandEng()) + mutationVariationMin_;
-
-					// Apply mutation variation.
-					weights->operator[](j) += variation * (af::randu(af::dim4(sizeX, sizeY), af::dtype::f32, aiGame_->AIrandEng()) < mutationRate_);
-				
-				}
-			
+			// Manage the jobs to send to the thread pool.
+			if (nJobs_ > mutationJobs_.capacity())
+				mutationJobs_.reserve(nJobs_);
+
+			if (!threadPool_)
+				threadPool_ = new VoxelEng::threadPool(nJobs_);
+
+			// Mutate the newborn in parallel. The drawn numbers only depend on the generation, the newborn and the gene.
+			std::size_t nMutationJobs = (nIndividuals_ < nJobs_) ? 1 : nJobs_,
+						rangeStart = 0,
+						rangeEnd = 0,
+						nConstructedJobs = mutationJobs_.size();
+			for (std::size_t i = 0; i < nMutationJobs; i++) {
+
+				rangeStart = nIndividuals_ / nMutationJobs * i;
+				rangeEnd = (i == nMutationJobs - 1) ? nIndividuals_ - 1 : rangeStart + nIndividuals_ / nMutationJobs - 1;
+
+				if (i >= nConstructedJobs)
+					mutationJobs_.emplace_back(rangeStart, rangeEnd, &individuals_, hostNewbornInds_, &aiGame_->AIcounterRNG(), generation_,
+											   mutationRate_, mutationVariationMin_, mutationVariationMax_);
+				else
+					mutationJobs_[i].setAttributes(rangeStart, rangeEnd, &individuals_, hostNewbornInds_, &aiGame_->AIcounterRNG(), generation_,
+												   mutationRate_, mutationVariationMin_, mutationVariationMax_);
+				threadPool_->submitJob(&mutationJobs_[i], jobsGroup_);
+
 			}
 
+			threadPool_->wait(jobsGroup_);
+
 			// Free copied memory from device (GPU) to host (CPU).
 			af::freeHost(hostNewbornInds_);
 			hostNewbornInds_ = nullptr;
@@ -10,12 +10,24 @@
 */
 #ifndef _AIEXAMPLE_GENETIC_
 #define _AIEXAMPLE_GENETIC_
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <cstddef>
+#include <cstdint>
 #include <arrayfire.h>
 #include "NN.h"
+#include "../counterRNG.h"
+#include "../definitions.h"
+#include "../mappedFile.h"
 #include "../threadPool.h"
+#include "../workerProcess.h"
 
 
 namespace AIExample {
@@ -27,6 +39,115 @@ namespace AIExample {
 	class miningAIGame;
 
 
+	/////////////////
+	//Enum classes.//
+	/////////////////
+
+	/**
+	* @brief The ways in which the fitness of the individuals can be evaluated.
+	* INDIVIDUAL: each individual plays its whole match on its own using the fitness function.
+	* LOCKSTEP: all individuals perform one action per step. The inference of the whole population is performed
+	* at once per step while the interaction with the world is parallelized across individuals.
+	* MULTIPROCESS: the individuals are split among worker processes that play their matches on a read-only image of the world.
+	*/
+	enum class evaluationMode { INDIVIDUAL, LOCKSTEP, MULTIPROCESS };
+
+	/**
+	* @brief Requests sent to the fitness worker processes when evaluationMode::MULTIPROCESS is used.
+	* WORLD: followed by the world's seed and the length and characters of the path of its image (std::uint32_t, std::uint32_t and chars).
+	* RESET: reset the agents' copies of the world and spawn the agents again.
+	* EVALUATE: followed by the number of individuals and, for each one of them, its ID and weights (std::uint32_t, std::uint32_t and floats).
+	* The worker answers with one 'fitnessWorkerResult' per individual in the same order.
+	*/
+	enum class fitnessWorkerRequest : std::uint32_t { WORLD, RESET, EVALUATE };
+
+	/**
+	* @brief Streams of the counter-based random generator used by the genetic operators,
+	* so that different operators never draw the same numbers.
+	*/
+	enum class randomStream : std::uint32_t { INITIALIZATION, SELECTION, MUTATION };
+
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief Header of the binary ".aidata" files.
+	* It is followed by 'nLayers' std::uint32_t with the number of neurons per layer and then by the weights
+	* of 'nIndividuals' individuals stored as raw little-endian floats, one individual after another and
+	* with the same layout used by GeneticNeuralNetwork.
+	*/
+	struct aidataHeader {
+
+		static constexpr std::uint32_t currentVersion = 1;
+
+		char magic[4]; // Always "VXAI".
+		std::uint32_t version,
+					  nLayers,
+					  nIndividuals;
+		std::uint64_t checksum; // VoxelEng::hashBytes() of everything that follows the header.
+
+	};
+
+	/**
+	* @brief Information gathered about the match played by an individual when its fitness was evaluated.
+	*/
+	struct episodeTelemetry {
+
+		unsigned int individualID,
+					 nActions; // Actions performed during the match, with or without cost.
+		float fitness,
+			  evaluationTime; // In milliseconds. Only measured when evaluationMode::INDIVIDUAL is used.
+		bool newborn,
+			 cached; // The match was not played again because the same genome was already evaluated in the same world.
+
+	};
+
+	/**
+	* @brief Wall-clock time spent in each phase of a training epoch, in milliseconds.
+	* 'worldTime' covers the generation of the world, the spawn of the agents and the observe/act steps of the matches.
+	* 'inferenceTime' is only measured when evaluationMode::LOCKSTEP is used. Otherwise, the inference performed
+	* during the matches is included in 'worldTime'.
+	* 'operatorsTime' covers the selection, crossover, mutation and replacement operators except for the evaluation of the newborn,
+	* whose time goes to the other two phases.
+	*/
+	struct epochTimings {
+
+		unsigned int epoch,
+					 nActions; // Actions performed during the epoch by both the population and the newborn.
+		float totalTime,
+			  worldTime,
+			  inferenceTime,
+			  operatorsTime;
+
+	};
+
+	/**
+	* @brief Result of a match stored in the fitness cache of the 'genetic' class.
+	*/
+	struct cachedFitness {
+
+		float fitness;
+		unsigned int nActions;
+
+	};
+
+	/**
+	* @brief Result of the match played by an individual in a fitness worker process.
+	*/
+	struct fitnessWorkerResult {
+
+		float fitness;
+		std::uint32_t nActions;
+		float evaluationTime; // In milliseconds.
+
+	};
+
+	static_assert(sizeof(aidataHeader) == 24, "The binary .aidata header must not have padding");
+	static_assert(std::endian::native == std::endian::little, "The binary .aidata format is read and written directly from memory and requires a little-endian host");
+
+
 	/**
 	* @brief Derives from 'job' class at threadPool.h. Used
 	* to represent jobs related to the heavy processing parts
@@ -40,37 +161,51 @@ namespace AIExample {
 
 		/**
 		* @brief Class constructor.
-		* @param The beginning of the range of individuals to process.
-		* @param The end of the range of individuals to process.
+		* Instead of processing a fixed range of individuals, the job keeps claiming batches of 'batchSize'
+		* individuals from the counter shared with the other jobs until all individuals have been claimed.
+		* This way, threads that get individuals with shorter matches process more of them.
+		* @param Counter shared by all the jobs with the position of the next individual to claim.
+		* @param The number of individuals to process between all the jobs.
+		* @param The number of individuals claimed at once.
 		* @param The start of the array that holds the fitness value of the individuals.
 		* @param The start of the array that holds the individuals indices for accessing their neural networks.
+		* @param The start of the array where the time in milliseconds spent evaluating each individual is stored (indexed like 'indices').
 		*/
-		geneticJob(std::size_t rangeStart, std::size_t rangeEnd, float* fitness, unsigned int* indices,
+		geneticJob(std::atomic<std::size_t>* nextIndividual, std::size_t nIndividuals, std::size_t batchSize,
+				   float* fitness, unsigned int* indices, float* evaluationTimes,
 				   float (*evaluationFunction)(unsigned int individualID));
 
 		/**
 		* @brief Instead of creating and deleting geneticJob objects, this method allows to reassing
 		* the object's attributes in order to reuse objects.
-		* @brief Class constructor.
-		* @param The beginning of the range of individuals to process.
-		* @param The end of the range of individuals to process.
-		* @param The start of the array that holds the fitness value of the individuals.
-		* @param The start of the array that holds the individuals indices for accessing their neural networks.
+		* The parameters are the same as in the class constructor.
 		*/
-		void setAttributes(std::size_t rangeStart, std::size_t rangeEnd, float* fitness, unsigned int* indices,
+		void setAttributes(std::atomic<std::size_t>* nextIndividual, std::size_t nIndividuals, std::size_t batchSize,
+						   float* fitness, unsigned int* indices, float* evaluationTimes,
 						   float (*evaluationFunction)(unsigned int individualID));
 
+
+		// Observers.
+
+		/**
+		* @brief Returns the time in milliseconds that the job spent evaluating individuals the last time it was processed.
+		*/
+		float busyTime() const;
+
 	private:
 
 		/*
 		Attributes.
 		*/
 
-		std::size_t rangeStart_,
-					rangeEnd_;
-		float* fitness_;
+		std::atomic<std::size_t>* nextIndividual_;
+		std::size_t nIndividuals_,
+					batchSize_;
+		float* fitness_,
+			 * evaluationTimes_;
 		unsigned int * indices_;
 		float (*evaluationFunction_)(unsigned int individualID);
+		float busyTime_;
 
 
 		/*
@@ -78,7 +213,7 @@ namespace AIExample {
 		*/
 
 		/*
-		Evaluate the fitness of the assigned individuals executing
+		Evaluate the fitness of the claimed individuals executing
 		the provided evaluation function and corresponding parameters.
 		*/
 		void process();
@@ -86,6 +221,80 @@ namespace AIExample {
 
 	};
 
+	inline float geneticJob::busyTime() const {
+
+		return busyTime_;
+
+	}
+
+
+	/**
+	* @brief Derives from 'job' class at threadPool.h. Used
+	* to represent jobs related to the heavy processing parts
+	* of the training process that will be completed
+	* by worker threads. In this particular case, this class is created
+	* for processing one step of the lockstep evaluation of the individuals.
+	* That is, performing the last action chosen for each of the assigned individuals
+	* and writing their next neural network input.
+	*/
+	class lockstepJob : public VoxelEng::job {
+
+	public:
+
+		/**
+		* @brief Class constructor.
+		* @param The beginning of the range of individuals to process.
+		* @param The end of the range of individuals to process.
+		* @param The start of the array that holds the individuals indices for accessing their neural networks.
+		* @param The start of the array that holds the last action chosen for each individual.
+		* @param The start of the array that holds whether each individual is still playing its match.
+		* @param The start of the matrix (one row per individual) where the neural network inputs are written.
+		* @param The number of neural network inputs per individual.
+		* @param True if this is the first step of the match.
+		*/
+		lockstepJob(std::size_t rangeStart, std::size_t rangeEnd, const unsigned int* indices, const unsigned int* actions,
+					unsigned char* active, int* inputs, unsigned int nInputs, bool firstStep,
+					void (*beginFunction)(unsigned int individualID),
+					bool (*observeFunction)(unsigned int individualID, int* input),
+					void (*actFunction)(unsigned int individualID, unsigned int action));
+
+		/**
+		* @brief Instead of creating and deleting lockstepJob objects, this method allows to reassing
+		* the object's attributes in order to reuse objects.
+		*/
+		void setAttributes(std::size_t rangeStart, std::size_t rangeEnd, const unsigned int* indices, const unsigned int* actions,
+						   unsigned char* active, int* inputs, unsigned int nInputs, bool firstStep,
+						   void (*beginFunction)(unsigned int individualID),
+						   bool (*observeFunction)(unsigned int individualID, int* input),
+						   void (*actFunction)(unsigned int individualID, unsigned int action));
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		std::size_t rangeStart_,
+					rangeEnd_;
+		const unsigned int* indices_,
+						  * actions_;
+		unsigned char* active_;
+		int* inputs_;
+		unsigned int nInputs_;
+		bool firstStep_;
+		void (*beginFunction_)(unsigned int individualID);
+		bool (*observeFunction_)(unsigned int individualID, int* input);
+		void (*actFunction_)(unsigned int individualID, unsigned int action);
+
+
+		/*
+		Methods.
+		*/
+
+		void process();
+
+	};
+
 
 	/**
 	* @brief Derives from 'job' class at threadPool.h. Used
@@ -141,6 +350,173 @@ namespace AIExample {
 	};
 
 
+	/**
+	* @brief Derives from 'job' class at threadPool.h. Used
+	* to represent jobs related to the heavy processing parts
+	* of the training process that will be completed
+	* by worker threads. In this particular case, this class is created
+	* for processing the mutation of the newborn.
+	* The random numbers are drawn from a counter-based generator using the generation, the position of the newborn
+	* and the gene as the counter, so the result does not depend on how the newborn are split among the jobs.
+	*/
+	class mutationJob : public VoxelEng::job {
+
+	public:
+
+		/**
+		* @brief Class constructor.
+		* @param The beginning of the range of newborn to process.
+		* @param The end of the range of newborn to process.
+		* @param The individuals whose weights are mutated.
+		* @param The start of the array that holds the newborn indices for accessing their neural networks.
+		* @param The random generator used to draw the mutations.
+		* @param The generation that the newborn belong to.
+		* @param The probability for a single gene (weight) to mutate.
+		* @param The minimum variation of a mutated gene.
+		* @param The maximum variation of a mutated gene.
+		*/
+		mutationJob(std::size_t rangeStart, std::size_t rangeEnd, std::vector<GeneticNeuralNetwork>* individuals, const unsigned int* newbornInds,
+					const VoxelEng::counterRNG* rng, unsigned int generation, float rate, float variationMin, float variationMax);
+
+		/**
+		* @brief Instead of creating and deleting mutationJob objects, this method allows to reassing
+		* the object's attributes in order to reuse objects.
+		*/
+		void setAttributes(std::size_t rangeStart, std::size_t rangeEnd, std::vector<GeneticNeuralNetwork>* individuals, const unsigned int* newbornInds,
+						   const VoxelEng::counterRNG* rng, unsigned int generation, float rate, float variationMin, float variationMax);
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		std::size_t rangeStart_,
+					rangeEnd_;
+		std::vector<GeneticNeuralNetwork>* individuals_;
+		const unsigned int* newbornInds_;
+		const VoxelEng::counterRNG* rng_;
+		unsigned int generation_;
+		float rate_,
+			  variationMin_,
+			  variationMax_;
+
+
+		/*
+		Methods.
+		*/
+
+		void process();
+
+	};
+
+
+	/**
+	* @brief Writes snapshots of the population's weights to disk in a background thread
+	* so that the training process does not have to stop while a checkpoint is being saved.
+	* Each checkpoint is first written to a temporary file that is then renamed to its final
+	* name, so an interrupted write never leaves a partially written ".aidata" file behind.
+	*/
+	class checkpointWriter {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		* @param Maximum number of checkpoints that can be waiting to be written or being written at the same time.
+		*/
+		checkpointWriter(unsigned int maxInFlight = 2);
+
+		checkpointWriter(const checkpointWriter&) = delete;
+
+		checkpointWriter& operator=(const checkpointWriter&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns the number of checkpoints that are waiting to be written or being written.
+		*/
+		unsigned int nInFlight();
+
+
+		// Modifiers.
+
+		/**
+		* @brief Returns an empty buffer to store a population snapshot in. Buffers of previously
+		* written checkpoints are reused to avoid allocating memory for each checkpoint.
+		*/
+		std::vector<float> stagingBuffer();
+
+		/**
+		* @brief Enqueue the snapshot of 'nIndividuals' individuals stored in 'weights' to be written in the binary
+		* ".aidata" format to 'path' (the file extension is not appended automatically).
+		* If the maximum number of in-flight checkpoints has been reached, the caller thread is blocked
+		* until one of them has been written.
+		*/
+		void submit(const std::string& path, const std::vector<unsigned int>& sizeLayer,
+					std::vector<float>&& weights, unsigned int nIndividuals);
+
+		/**
+		* @brief Locks the caller thread until all the submitted checkpoints have been written.
+		*/
+		void flush();
+
+		/**
+		* @brief Writes the binary ".aidata" file at 'path' with the 'nIndividuals' individuals whose weights
+		* are stored one after another in 'weights'. The data is first written to a temporary file
+		* that is then renamed to 'path'.
+		* Throws an std::runtime_error or an std::filesystem::filesystem_error if the file could not be written.
+		* It does not call VoxelEng::logger::errorLog() since it is also called from the writer thread.
+		*/
+		static void write(const std::string& path, const std::vector<unsigned int>& sizeLayer,
+						  const float* weights, unsigned int nIndividuals);
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor. Waits until all the submitted checkpoints have been written.
+		*/
+		~checkpointWriter();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		struct checkpoint {
+
+			std::string path;
+			std::vector<unsigned int> sizeLayer;
+			std::vector<float> weights;
+			unsigned int nIndividuals;
+
+		};
+
+		unsigned int maxInFlight_,
+					 nInFlight_;
+		bool stop_;
+		std::mutex mutex_;
+		std::condition_variable pendingCV_,
+								writtenCV_;
+		std::deque<checkpoint> pending_;
+		std::vector<std::vector<float>> freeBuffers_;
+		std::thread writerThread_;
+
+
+		/*
+		Methods.
+		*/
+
+		void writerLoop();
+
+	};
+
+
 	/**
 	* @brief Manages everything related to the genetic algorithms part of the
 	* example AI game, including the training, testing and record generation
@@ -174,6 +550,31 @@ namespace AIExample {
 		*/
 		unsigned int nIndividuals() const;
 
+		/**
+		* @brief Returns the way in which the fitness of the individuals is evaluated.
+		* WARNING. Not thread-safe.
+		*/
+		evaluationMode getEvaluationMode() const;
+
+		/**
+		* @brief Returns the telemetry of the matches played during the last generation, both the ones
+		* played by the population and the ones played by the newborn.
+		* WARNING. Not thread-safe.
+		*/
+		const std::vector<episodeTelemetry>& telemetry() const;
+
+		/**
+		* @brief Appends the telemetry of the last generation to the CSV file located at 'path', writing
+		* the column names first if the file does not exist.
+		*/
+		void dumpTelemetry(const std::string& path, unsigned int generation) const;
+
+		/**
+		* @brief Returns the time spent in each phase of the last training epoch.
+		* WARNING. Not thread-safe.
+		*/
+		const epochTimings& lastEpochTimings() const;
+
 
 		// Modifiers.
 
@@ -203,6 +604,75 @@ namespace AIExample {
 		*/
 		void setFitnessFunction(float (*fitnessFunction)(unsigned int individualID));
 
+		/**
+		* @brief Sets the functions used when evaluating the individuals in lockstep.
+		* 'beginFunction' prepares an individual to begin its match.
+		* 'observeFunction' writes the neural network input of an individual and returns false if its match has ended.
+		* 'actFunction' performs the action chosen by the neural network of an individual.
+		* 'scoreFunction' returns the fitness of an individual once its match has ended.
+		*/
+		void setLockstepFunctions(void (*beginFunction)(unsigned int individualID),
+								  bool (*observeFunction)(unsigned int individualID, int* input),
+								  void (*actFunction)(unsigned int individualID, unsigned int action),
+								  float (*scoreFunction)(unsigned int individualID));
+
+		/**
+		* @brief Sets the way in which the fitness of the individuals is evaluated.
+		* By default, evaluationMode::INDIVIDUAL is used.
+		* WARNING. Must be called before startSimulation().
+		*/
+		void setEvaluationMode(evaluationMode mode);
+
+		/**
+		* @brief Set the worker processes used when evaluationMode::MULTIPROCESS is used.
+		* 'nProcesses' processes of the executable located at 'executable' are started when the training begins.
+		* Said executable must call AIAPI::trainingGame::startFitnessWorker() when it receives the arguments
+		* "--fitness-worker", the AI game's name and the population size, followed by the channel handles (see workerProcess::start()).
+		* If a worker process crashes or does not send the results of its individuals within 'timeout' seconds,
+		* its individuals are evaluated in this process from then on. A 'timeout' of 0 means waiting forever.
+		* WARNING. Must be called before startSimulation().
+		*/
+		void setWorkerProcesses(unsigned int nProcesses, const std::string& executable, unsigned int timeout = 600);
+
+		/**
+		* @brief Evaluate the individuals requested through 'channel' by the training process until it closes the channel.
+		* The population has 'nIndividuals' individuals as in genetic::genInitPop().
+		* Used by the fitness worker processes. See evaluationMode::MULTIPROCESS.
+		*/
+		void serveFitnessRequests(unsigned int nIndividuals, VoxelEng::processChannel& channel);
+
+		/**
+		* @brief If 'path' is not empty, the telemetry of each generation will be appended to the CSV file
+		* located at 'path' during training. An empty 'path' disables it (default).
+		*/
+		void setTelemetryPath(const std::string& path);
+
+		/**
+		* @brief If 'report' is true, a line with the time spent in each phase of the epoch and the obtained throughput
+		* is printed to the standard output at the end of each training epoch, followed by a summary line once the training ends.
+		* The lines begin with "[TIMINGS]" and the values are written as space-separated 'key=value' pairs. Disabled by default.
+		*/
+		void setTimingsReport(bool report);
+
+		/**
+		* @brief If 'enabled' is true, the fitness of each genome evaluated during the training is remembered
+		* together with the seed of the world where it was evaluated, and individuals whose genome was already evaluated
+		* in the current world get said fitness instead of playing their match again.
+		* Must be disabled if the evaluation function is not deterministic. In each generation, one of the individuals
+		* found in the cache plays its match anyway and, if it gets a different fitness, the cache is disabled. Disabled by default.
+		*/
+		void setFitnessCache(bool enabled);
+
+		/**
+		* @brief Set how the worlds used during the training are generated in advance in the background.
+		* Up to 'nWorldsAhead' worlds using at most 'memoryCap' bytes are generated ahead by 'nThreads' threads.
+		* If 'nWorldsAhead' is 0, the worlds are generated when they are needed.
+		* By default, VoxelEng::DEF_N_PREGENERATED_WORLDS worlds are generated ahead by one thread using at most VoxelEng::DEF_PREGENERATED_WORLDS_MEMORY_CAP bytes.
+		* WARNING. Must be called before startSimulation().
+		*/
+		void setWorldPregeneration(unsigned int nWorldsAhead, std::size_t memoryCap = VoxelEng::DEF_PREGENERATED_WORLDS_MEMORY_CAP,
+								   unsigned int nThreads = 1);
+
 		/**
 		* @brief Set the crossover operator's split point.
 		* It is unused in implementation 1 of the crossover operator.
@@ -268,7 +738,8 @@ namespace AIExample {
 		void record(const std::string& recordName);
 
 		/**
-		* @brief Saves the current individuals stored in this 'genetic' object to disk in the specified directory.
+		* @brief Saves the current individuals stored in this 'genetic' object to disk in the specified directory
+		* using the binary format described in 'aidataHeader'.
 		* The file extension ".aidata" is automatically appended to 'path'.
 		*/
 		void saveIndividualsData(const std::string& path);
@@ -282,9 +753,25 @@ namespace AIExample {
 		* The file extension ".aidata" is automatically appended to 'path'.
 		* It will ask the user to specify a limit to the number of individuals to load from the file,
 		* if it is equal to 0 then all the individuals found in the file will be loaded.
+		* Both binary files and files with the old text format are supported. To convert a text file to
+		* the binary format, load it and save it again.
 		*/
 		int loadIndividualsData(const std::string& path);
 
+		/**
+		* @brief Same as genetic::loadIndividualsData(const std::string& path) but the maximum
+		* number of individuals to load is specified with 'nIndividualsToLoad' instead of asking the user.
+		*/
+		int loadIndividualsData(const std::string& path, unsigned int nIndividualsToLoad);
+
+		/**
+		* @brief Measures the time it takes to save and load the current individuals with both the binary
+		* and the old text ".aidata" formats 'nRepetitions' times and logs the results along with the size of
+		* the files and the precision lost by each format. The temporary files are created using 'path' as prefix.
+		* WARNING. Requires individuals to be loaded or generated first.
+		*/
+		void benchmarkIndividualsData(const std::string& path, unsigned int nRepetitions);
+
 		GeneticNeuralNetwork& individual(unsigned int individualID);
 
 
@@ -302,18 +789,29 @@ namespace AIExample {
 		*/
 
 		bool simInProgress_,
-		     saveIndsData_;
+			 training_, // Only true inside trainAgents(). The fitness cache is only used while training.
+		     saveIndsData_,
+			 reportTimings_,
+			 fitnessCacheEnabled_;
 		miningAIGame* aiGame_;
 		float (*evaluationFunction_)(unsigned int individualID);
+		evaluationMode evaluationMode_;
+		void (*lockstepBeginFunction_)(unsigned int individualID);
+		bool (*lockstepObserveFunction_)(unsigned int individualID, int* input);
+		void (*lockstepActFunction_)(unsigned int individualID, unsigned int action);
+		float (*lockstepScoreFunction_)(unsigned int individualID);
 		std::vector<unsigned int> sizeLayer_;
 		unsigned int nIndividuals_,
+					 generation_, // Used as part of the counter of the random numbers drawn by the genetic operators.
+					 nWeights_,
 					 crossoverSplitPoint_,
 					 nJobs_;
 		float mutationRate_, // Probability for a single gene (weight) to mutate.
 			  mutationVariationMin_,
 			  mutationVariationMax_;
 
-		std::vector<GeneticNeuralNetwork> individuals_;
+		std::vector<float> weightsArena_; // The weights of all individuals (population and newborn), one individual after another.
+		std::vector<GeneticNeuralNetwork> individuals_; // Views into 'weightsArena_'.
 		af::array fitness_,
 				  selected_,
 			     * popInds_,
@@ -324,8 +822,35 @@ namespace AIExample {
 					* hostNewbornInds_;
 
 		VoxelEng::threadPool* threadPool_;
+		VoxelEng::taskGroup jobsGroup_; // Used to wait only for the jobs submitted by this object.
 		std::vector<geneticJob> geneticJobs_;
+		std::atomic<std::size_t> nextIndividual_;
+		std::vector<float> evaluationTimes_;
+		std::vector<episodeTelemetry> telemetry_;
+		std::string telemetryPath_;
+		epochTimings epochTimings_;
+		unsigned int nPregeneratedWorlds_,
+					 nPregenerationThreads_;
+		std::size_t pregenerationMemoryCap_;
+		std::unordered_map<std::uint64_t, cachedFitness> fitnessCache_; // Only holds genomes evaluated in the world with seed 'fitnessCacheSeed_'.
+		unsigned int fitnessCacheSeed_;
+		std::vector<std::uint64_t> genomeKeys_;
+		std::vector<const cachedFitness*> fitnessCacheHits_;
+		std::vector<unsigned int> pendingIndices_;
+		unsigned int nWorkerProcesses_,
+					 workerTimeout_;
+		std::string workerExecutable_,
+					workerWorldPath_;
+		std::deque<VoxelEng::workerProcess> workers_;
+		std::vector<fitnessWorkerResult> workerResults_;
 		std::vector<copyJob> copyJobs_;
+		std::vector<mutationJob> mutationJobs_;
+		std::vector<lockstepJob> lockstepJobs_;
+		std::vector<af::array> stackedWeights_;
+		std::vector<int> lockstepInputs_;
+		std::vector<unsigned int> lockstepActions_;
+		std::vector<unsigned char> lockstepActive_;
+		checkpointWriter checkpointWriter_;
 
 
 		/*
@@ -340,9 +865,43 @@ namespace AIExample {
 		*/
 		void checkFlagsTrainOrTest();
 
+		/*
+		Prints the "[TIMINGS]" line of the last training epoch.
+		*/
+		void reportEpochTimings() const;
+
 
 		// Modifiers.
 
+		/*
+		Copies the current population to a staging buffer and lets 'checkpointWriter_'
+		save it to 'path' + ".aidata" in the background.
+		*/
+		void checkpointIndividualsData(const std::string& path);
+
+		/*
+		Saves the current individuals using the old text ".aidata" format.
+		Only used to compare it with the binary format.
+		*/
+		void saveIndividualsDataText(const std::string& path);
+
+		/*
+		Loads the individuals stored in a binary ".aidata" file that has been mapped into 'file'.
+		*/
+		void loadBinaryIndividualsData(const VoxelEng::mappedFile& file, const std::string& path, unsigned int nIndividualsToLoad);
+
+		/*
+		Loads the individuals stored in a ".aidata" file that uses the old text format.
+		*/
+		void importTextIndividualsData(const std::string& path, unsigned int nIndividualsToLoad);
+
+		/*
+		Allocate the weights arena for 'nIndividuals' individuals with the network layout
+		stored in sizeLayer_ and create the neural networks that refer to it.
+		The contents of the arena are left uninitialised.
+		*/
+		void allocateIndividuals(unsigned int nIndividuals);
+
 		/*
 		Calculate the fitness function assigned to this 'genetic' object
 		to all the individuals in the population and store the values.
@@ -357,6 +916,55 @@ namespace AIExample {
 		*/
 		void calculateFitness(bool useNewborn = false);
 
+		/*
+		Same as calculateFitness() but evaluating the individuals in lockstep.
+		'hostIndices' are the indices of the 'nIndices' individuals to evaluate and
+		the fitness values are stored in 'hostFitness_'.
+		*/
+		void calculateFitnessLockstep(const unsigned int* hostIndices, std::size_t nIndices);
+
+		/*
+		Make the fitness cache belong to the world that has just been generated, discarding the fitness
+		values obtained in the previous one. Must be called each time a new world is generated.
+		*/
+		void resetFitnessCache();
+
+		/*
+		Returns the key of the individual's genome in the fitness cache, which also depends on the seed of the current world.
+		*/
+		std::uint64_t genomeKey(unsigned int individualID) const;
+
+		/*
+		Same as calculateFitness() but splitting the individuals among the worker processes.
+		*/
+		void calculateFitnessWorkers(const unsigned int* hostIndices, std::size_t nIndices);
+
+		/*
+		Start the worker processes used by evaluationMode::MULTIPROCESS.
+		*/
+		void startWorkers();
+
+		/*
+		Export the current world and make the worker processes use it.
+		'seed' is the seed that was set in the world generator before generating the world.
+		*/
+		void sendWorldToWorkers(unsigned int seed);
+
+		/*
+		Make the worker processes reset their agents and their copies of the world.
+		*/
+		void resetWorkers();
+
+		/*
+		Stop the worker processes and delete the exported world.
+		*/
+		void stopWorkers();
+
+		/*
+		Stop the worker at position 'worker' in 'workers_' after it failed so that its work is done in this process.
+		*/
+		void dropWorker(std::size_t worker);
+
 		/*
 		0 = Roulette - wheel implementation. 
 		1 = Select the fittest in the population.
@@ -400,6 +1008,42 @@ namespace AIExample {
 	
 	}
 
+	inline evaluationMode genetic::getEvaluationMode() const {
+
+		return evaluationMode_;
+
+	}
+
+	inline const std::vector<episodeTelemetry>& genetic::telemetry() const {
+
+		return telemetry_;
+
+	}
+
+	inline void genetic::setTelemetryPath(const std::string& path) {
+
+		telemetryPath_ = path;
+
+	}
+
+	inline const epochTimings& genetic::lastEpochTimings() const {
+
+		return epochTimings_;
+
+	}
+
+	inline void genetic::setTimingsReport(bool report) {
+
+		reportTimings_ = report;
+
+	}
+
+	inline void genetic::setFitnessCache(bool enabled) {
+
+		fitnessCacheEnabled_ = enabled;
+
+	}
+
 }
 
 #endif
\ No newline at end of file
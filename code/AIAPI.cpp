@@ -1,6 +1,11 @@
 #include "AIAPI.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <ios>
+#include <iterator>
+#include <limits>
 #include "utilities.h"
 #include "gui.h"
 
@@ -62,9 +67,9 @@ namespace VoxelEng {
 		std::atomic<bool> aiGame::recording_ = false,
 						  aiGame::recordAgentModifiedBlocks_ = false,
 						  aiGame::gameInProgress_ = false;
-		std::ofstream aiGame::saveFile_;
-		std::string aiGame::saveDataBuffer_;
+		asyncFileWriter aiGame::saveFile_;
 		std::string aiGame::saveFileName_;
+		std::size_t aiGame::recordFrameSize_ = 0;
 		recordPlayMode aiGame::recordPlayMode_ = recordPlayMode::FORWARD;
 		std::vector<std::deque<block>> aiGame::agentModifiedBlocks_;
 		std::list<unsigned int> aiGame::entityIDcreationOrder_;
@@ -73,25 +78,42 @@ namespace VoxelEng {
 		// private
 		bool aiGame::initialised_ = false,
 			 aiGame::canForwardReplay_ = true,
-			 aiGame::canBackwardReplay_ = false,
-			 aiGame::backwardAIactionFound_ = true;
+			 aiGame::canBackwardReplay_ = false;
 		aiGame* aiGame::selectedGame_ = nullptr;
 		std::unordered_map<std::string, aiGame*> aiGame::aiGames_;
 		std::vector<aiGame*> aiGame::gamesRegisterOrder_;
 		std::vector<AIagentAction> aiGame::aiRecordActions_;
 		std::unordered_map<std::string, unsigned int> aiGame::AIactionsName_;
-		std::ifstream aiGame::loadedFile_;
-		std::string aiGame::readFileData_,
-					aiGame::readWord_;
-		char aiGame::readCharacter_;
-		unsigned int aiGame::readActionCode_ = 0,
-					 aiGame::readParamTypeInd_ = 0,
-					 aiGame::readState_ = 0,
-					 aiGame::lastParamInd_ = 0,
-			         aiGame::lastRawParamInd_ = 0;
+		worldProducer aiGame::worldProducer_;
+		unsigned int aiGame::setBlockCode_ = 0,
+					 aiGame::moveEntityCode_ = 0,
+					 aiGame::rotateAgentViewDirCode_ = 0,
+					 aiGame::rotateEntityCode_ = 0,
+					 aiGame::inverseRotateEntityCode_ = 0,
+					 aiGame::createEntityCode_ = 0,
+					 aiGame::createAgentCode_ = 0,
+					 aiGame::changeActiveStateCode_ = 0;
+		mappedFile aiGame::loadedFile_;
+		std::size_t aiGame::recordFramesOffset_ = 0,
+					aiGame::nRecordFrames_ = 0,
+					aiGame::nextRecordFrame_ = 0;
+		unsigned int aiGame::lastParamInd_ = 0;
 		double aiGame::oldActualTime_ = 0;
+		std::vector<std::uint64_t> aiGame::loadedKeyframes_;
+		unsigned int aiGame::loadedKeyframeInterval_ = 0;
+		std::atomic<std::size_t> aiGame::recordSeekTarget_ = std::numeric_limits<std::size_t>::max();
+		std::atomic<long long> aiGame::recordSeekOffset_ = 0;
+		std::unordered_map<vec3, block> aiGame::playbackOriginalBlocks_;
 		std::vector<agentActionArg> aiGame::params_;
-		std::deque<std::string> aiGame::rawParams_;
+		std::vector<std::uint32_t> aiGame::recordFrame_;
+		unsigned int aiGame::keyframeInterval_ = DEF_RECORD_KEYFRAME_INTERVAL;
+		std::size_t aiGame::nRecordedFrames_ = 0;
+		std::string aiGame::recordKeyframesBuffer_;
+		std::vector<std::uint64_t> aiGame::recordKeyframeOffsets_;
+		std::unordered_map<vec3, std::pair<block, block>> aiGame::recordModifiedBlocks_;
+		std::vector<std::vector<block>> aiGame::recordAgentReplacedBlocks_;
+		std::list<entityID> aiGame::recordEntityIDcreationOrder_;
+		std::list<agentID> aiGame::recordAgentIDcreationOrder_;
 
 
 		void aiGame::init() {
@@ -107,7 +129,7 @@ namespace VoxelEng {
 				recordAgentModifiedBlocks_ = false;
 				gameInProgress_ = false;
 
-				registerAction("setBlock", AIagentAction([]() {
+				setBlockCode_ = registerAction("setBlock", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					if (game->playingRecordForward()) {
@@ -129,7 +151,7 @@ namespace VoxelEng {
 
 				}, {agentActionArg::type::UINT, agentActionArg::type::INT, agentActionArg::type::INT, agentActionArg::type::INT, agentActionArg::type::BLOCK }));
 
-				registerAction("moveEntity", AIagentAction([]() {
+				moveEntityCode_ = registerAction("moveEntity", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					if (game->playingRecordForward()) {
@@ -147,7 +169,7 @@ namespace VoxelEng {
 
 				}, {agentActionArg::type::UINT, agentActionArg::type::INT, agentActionArg::type::INT, agentActionArg::type::INT }));
 
-				registerAction("rotateAgentViewDir", AIagentAction([]() {
+				rotateAgentViewDirCode_ = registerAction("rotateAgentViewDir", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					
@@ -166,7 +188,7 @@ namespace VoxelEng {
 
 				}, {agentActionArg::type::UINT, agentActionArg::type::BLOCKVIEWDIR }));
 
-				registerAction("rotateEntity", AIagentAction([]() {
+				rotateEntityCode_ = registerAction("rotateEntity", AIagentAction([]() {
 				
 					aiGame* game = aiGame::selectedGame();
 					
@@ -185,7 +207,7 @@ namespace VoxelEng {
 						
 				}, {agentActionArg::type::UINT, agentActionArg::type::FLOAT, agentActionArg::type::FLOAT, agentActionArg::type::FLOAT}));
 
-				registerAction("inverseRotateEntity", AIagentAction([]() {
+				inverseRotateEntityCode_ = registerAction("inverseRotateEntity", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					if (game->playingRecordForward()) {
@@ -203,7 +225,7 @@ namespace VoxelEng {
 
 				}, {agentActionArg::type::UINT, agentActionArg::type::FLOAT, agentActionArg::type::FLOAT, agentActionArg::type::FLOAT}));
 
-				registerAction("createEntity", AIagentAction([]() {
+				createEntityCode_ = registerAction("createEntity", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					
@@ -226,7 +248,7 @@ namespace VoxelEng {
 				}, {agentActionArg::type::UINT, agentActionArg::type::INT, agentActionArg::type::INT, agentActionArg::type::INT,
 					agentActionArg::type::FLOAT, agentActionArg::type::FLOAT, agentActionArg::type::FLOAT}));
 
-				registerAction("createAgent", AIagentAction([]() {
+				createAgentCode_ = registerAction("createAgent", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					if (game->playingRecordForward()) {
@@ -247,7 +269,7 @@ namespace VoxelEng {
 
 				}, {agentActionArg::type::UINT, agentActionArg::type::INT, agentActionArg::type::INT, agentActionArg::type::INT, agentActionArg::type::BLOCKVIEWDIR}));
 
-				registerAction("changeActiveState", AIagentAction([]() {
+				changeActiveStateCode_ = registerAction("changeActiveState", AIagentAction([]() {
 
 					aiGame* game = aiGame::selectedGame();
 					
@@ -501,6 +523,8 @@ namespace VoxelEng {
 			
 				selectedGame_->clearBlockModRecording();
 				loadedFile_.close();
+				loadedKeyframes_.clear();
+				playbackOriginalBlocks_.clear();
 
 				game::setLoopSelection(engineMode::EXITRECORD);
 				game::setLoopSelection(engineMode::AIMENULOOP);
@@ -575,17 +599,14 @@ namespace VoxelEng {
 									else
 										chunkManager::init(DEF_N_CHUNKS_TO_COMPUTE);
 
-									saveDataBuffer_ += selectedGame_->name_ + '|';
-									saveDataBuffer_ += "saves/recordingWorlds/" + selectedGame_->name_ + '/' + filename + '|';
-									saveDataBuffer_ += std::to_string(chunkManager::nChunksToCompute()) + "|@";
+									beginRecord_(selectedGame_->name_, "saves/recordingWorlds/" + selectedGame_->name_ + '/' + filename);
 
 									saveFileName_ = filename;
 
 									selectedGame_->setUpRecord_(1);
 									selectedGame_->record_();
 
-									saveFile_ << saveDataBuffer_;
-									saveDataBuffer_.clear();
+									finishRecord_();
 									saveFile_.close();
 									recording_ = false;
 
@@ -622,54 +643,42 @@ namespace VoxelEng {
 					game::setLoopSelection(engineMode::INITRECORD);
 					recordPlayMode_ = recordPlayMode::FORWARD;
 
-					loadedFile_.open(truePath);
-
-					bool readFirstLines = false;
-					while (!readFirstLines) {
-
-						if (loadedFile_.get(readCharacter_)) {
-
-							if (readCharacter_ == '|') { // End of action code/action parameter.
-
-								switch (readState_) {
-
-								case 0: // End of aiGame line.
-
-									if (readWord_ != selectedGame_->name_)
-										logger::errorLog("The loaded recording file belongs to the AI game " + readWord_ + 
-											". It does not belong to " + selectedGame_->name_);
-
-									readState_++;
-									break;
-
-								case 1: // End of terrain line.
-
-									chunkManager::openedTerrainFileName(readWord_);
+					if (convertTextRecord(path) == 0)
+						logger::debugLog("Converted text record " + truePath + " to the binary record format");
 
-									readState_++;
-									break;
-
-								case 2: // End of nChunksToCompute line.
-
-									chunkManager::setNChunksToCompute(sto<unsigned int>(readWord_));
-
-									readFirstLines = true;
-									break;
-
-								}
-
-								readWord_ = "";
-
-							}
-							else
-								readWord_ += readCharacter_;
-
-						}
-						else
-							logger::errorLog("Could not read first lines from record file " + truePath);
+					loadedFile_.open(truePath);
 
-					}
-					readState_ = 0;
+					recordHeader header;
+					if (loadedFile_.size() < sizeof(recordHeader))
+						logger::errorLog("Could not read the header of record file " + truePath);
+					std::memcpy(&header, loadedFile_.data(), sizeof(recordHeader));
+
+					if (header.version != recordHeader::currentVersion)
+						logger::errorLog("Record file " + truePath + " uses the unsupported version " + std::to_string(header.version));
+
+					recordFramesOffset_ = sizeof(recordHeader) + header.gameNameLength + header.terrainPathLength;
+					recordFrameSize_ = header.frameSize;
+					if (recordFrameSize_ < sizeof(std::uint32_t) || recordFrameSize_ % sizeof(std::uint32_t) || header.keyframesOffset < recordFramesOffset_ ||
+						header.keyframesOffset + header.nKeyframes * sizeof(std::uint64_t) > loadedFile_.size() ||
+						(header.keyframesOffset - recordFramesOffset_) % recordFrameSize_)
+						logger::errorLog("Record file " + truePath + " is corrupted");
+					nRecordFrames_ = (header.keyframesOffset - recordFramesOffset_) / recordFrameSize_;
+					nextRecordFrame_ = 0;
+					recordSeekTarget_ = std::numeric_limits<std::size_t>::max();
+					recordSeekOffset_ = 0;
+
+					loadedKeyframeInterval_ = header.keyframeInterval;
+					loadedKeyframes_.resize(header.nKeyframes);
+					std::memcpy(loadedKeyframes_.data(), loadedFile_.data() + header.keyframesOffset, header.nKeyframes * sizeof(std::uint64_t));
+
+					const char* headerStrings = reinterpret_cast<const char*>(loadedFile_.data() + sizeof(recordHeader));
+					std::string gameName(headerStrings, header.gameNameLength);
+					if (gameName != selectedGame_->name_)
+						logger::errorLog("The loaded recording file belongs to the AI game " + gameName +
+							". It does not belong to " + selectedGame_->name_);
+
+					chunkManager::openedTerrainFileName(std::string(headerStrings + header.gameNameLength, header.terrainPathLength));
+					chunkManager::setNChunksToCompute(header.nChunksToCompute);
 
 					selectedGame_->initBlockModRecording();
 
@@ -725,425 +734,741 @@ namespace VoxelEng {
 				if (oldActualTime_ == 0)
 					oldActualTime_ = time::actualTime<timeScale::s>();
 
+				std::size_t seekTarget = recordSeekTarget_.exchange(std::numeric_limits<std::size_t>::max());
+				long long seekOffset = recordSeekOffset_.exchange(0);
+				if (seekTarget != std::numeric_limits<std::size_t>::max())
+					seekRecord_(seekTarget);
+				if (seekOffset < 0)
+					seekRecord_(nextRecordFrame_ - std::min<std::size_t>(nextRecordFrame_, -seekOffset));
+				else if (seekOffset > 0)
+					seekRecord_(nextRecordFrame_ + seekOffset);
+
 				if (recordPlayMode_ != recordPlayMode::PAUSE && time::actualTime<timeScale::s>() - oldActualTime_ >= 0.5f) {
 
 					// Starting from the last played action (or the beginning of the record file)...
-					bool continuePlaying = true;
 					if (recordPlayMode_ == recordPlayMode::FORWARD) { // Play the next action forward.
 
-						if (canForwardReplay_) {
-						
-							bool readingActionCode = true;
-							do {
+						if (canForwardReplay_ && nextRecordFrame_ < nRecordFrames_) {
 
-								readCharacter_ = loadedFile_.peek();
+							playActionRecordForward_(readRecordFrame_(nextRecordFrame_++));
 
-								if (readCharacter_ == EOF) { // End of AI action lines reached. Do not advance and return.
+							canBackwardReplay_ = true; // Now the engine can play backwards at least one action.
 
-									changeRecordPlayMode(recordPlayMode::PAUSE);
-									canForwardReplay_ = false;
-									canBackwardReplay_ = true;
-									continuePlaying = false;
-									loadedFile_.seekg(-1, std::ios::cur);
-									backwardAIactionFound_ = true;
+						}
+						else
+							changeRecordPlayMode(recordPlayMode::PAUSE);
 
-								}
-								else {
+						if (nextRecordFrame_ == nRecordFrames_) { // End of the record reached.
 
-									if (readCharacter_ == '#') { // New action found.
+							changeRecordPlayMode(recordPlayMode::PAUSE);
+							canForwardReplay_ = false;
 
-										if (!readingActionCode) { // Finished reading the parameters of a previously found action. Execute said action and return. 
+						}
 
-											playActionRecordForward_(readActionCode_);
-											continuePlaying = false;
+					}
+					else {
 
-											canBackwardReplay_ = true; // Now the engine can play backwards at least one action.
-											backwardAIactionFound_ = false;
+						if (canBackwardReplay_ && nextRecordFrame_ > 0) { // Play the previous action backwards.
 
-										}
+							playActionRecordBackwards_(readRecordFrame_(--nextRecordFrame_));
 
-										readingActionCode = true;
-										readParamTypeInd_ = 0;
-										lastParamInd_ = 0;
+							canForwardReplay_ = true; // Now the engine can play at least one action in forward mode again.
 
-									}
-									else if (readCharacter_ == '|') { // End of action code/action parameter.
+						}
+						else
+							changeRecordPlayMode(recordPlayMode::PAUSE);
 
-										if (readingActionCode) { // End of action code.
+						if (nextRecordFrame_ == 0) { // Beginning of the record reached.
 
-											readActionCode_ = sto<unsigned int>(readWord_);
+							changeRecordPlayMode(recordPlayMode::PAUSE);
+							canBackwardReplay_ = false;
 
-											readingActionCode = false;
+						}
 
-										}
-										else // End of action parameter.
-											pushParam_(readWord_, readActionCode_, readParamTypeInd_++);
+					}
 
-										readWord_ = "";
+					oldActualTime_ = time::actualTime<timeScale::s>();
+				
+				}
 
-									}
-									else if (readCharacter_ != '@')
-										readWord_ += readCharacter_;
+				return;
 
-									if (continuePlaying)
-										loadedFile_.seekg(1, std::ios::cur);
+			}
+			else
+				logger::errorLog("Can only execute aiGame::playRecordTick() when playing a record");
 
-								}
+		}
 
-							} while (continuePlaying && game::threadsExecute[1]);
-						
-						}
-						else
-							changeRecordPlayMode(recordPlayMode::PAUSE);
+		unsigned int aiGame::convertTextRecord(const std::string& path) {
 
-						oldActualTime_ = time::actualTime<timeScale::s>();
+			std::string truePath = path + ".rec",
+						textData,
+						binaryData,
+						word;
+			std::vector<std::string> headerFields;
+			std::vector<std::uint32_t> frame;
+			std::ifstream textFile(truePath, std::ios::binary);
+			unsigned int actionCode = 0,
+						 nParams = 0;
+			std::size_t pos = 0,
+						actionEnd = 0;
+			char magic[4];
 
-						return;
 
-					}
-					else {
-					
-						if (canBackwardReplay_) { // Play the previous action backwards.
+			if (!textFile.is_open())
+				return 1;
 
-							bool readingAction = false;
-							do {
+			if (textFile.read(magic, sizeof(magic)) && std::memcmp(magic, "VXRC", sizeof(magic)) == 0)
+				return 2;
 
-								readCharacter_ = loadedFile_.peek();
+			textFile.clear();
+			textFile.seekg(0);
+			textData.assign(std::istreambuf_iterator<char>(textFile), std::istreambuf_iterator<char>());
+			textFile.close();
 
-								if (readCharacter_ == '#') { // New action found.
+			// Header lines: AI game name, terrain path and number of chunks to compute.
+			while (headerFields.size() < 3) {
 
-									if (backwardAIactionFound_) {
+				actionEnd = textData.find('|', pos);
+				if (actionEnd == std::string::npos)
+					logger::errorLog("Could not read first lines from record file " + truePath);
 
-										// "Clear" last parsed parameters. Reuse already allocated memory.
-										readParamTypeInd_ = 0;
-										lastParamInd_ = 0;
+				headerFields.push_back(textData.substr(pos, actionEnd - pos));
+				pos = actionEnd + 1;
 
-										readActionCode_ = sto<unsigned int>(readWord_);
-										pushParams_(readActionCode_);
-										playActionRecordBackwards_(readActionCode_);
-										continuePlaying = false;
-										readWord_ = "";
+			}
+			if (pos >= textData.size() || textData[pos] != '@')
+				logger::errorLog("Could not read first lines from record file " + truePath);
+			pos++;
 
-										rawParams_.clear(); // Clear last parsed parameters.
+			frame.resize(writeRecordHeader_(binaryData, headerFields[0], headerFields[1], sto<unsigned int>(headerFields[2])) / sizeof(std::uint32_t));
 
-										canForwardReplay_ = true; // Now the engine can play at least one action in forward mode again.
+			// Actions: "#actionCode|param1|param2|...|".
+			while (pos < textData.size()) {
 
-										backwardAIactionFound_ = false;
+				if (textData[pos] != '#')
+					logger::errorLog("Record file " + truePath + " is corrupted");
 
-									}
-									else
-										backwardAIactionFound_ = true;
+				actionEnd = textData.find('#', pos + 1);
+				if (actionEnd == std::string::npos)
+					actionEnd = textData.size();
 
-								}
-								else if (readCharacter_ == '|') { // End of action code/action parameter.
+				std::fill(frame.begin(), frame.end(), 0);
+				nParams = 0;
+				pos++;
+				while (pos < actionEnd) {
 
-									if (readingAction) {
+					std::size_t wordEnd = textData.find('|', pos);
+					if (wordEnd == std::string::npos || wordEnd > actionEnd)
+						logger::errorLog("Record file " + truePath + " is corrupted");
 
-										// We are reading the parameters in reverse order so we need to use push_front().
-										rawParams_.push_front(std::string(readWord_.rbegin(), readWord_.rend()));
-										readWord_ = "";
+					word = textData.substr(pos, wordEnd - pos);
+					if (nParams == 0) {
 
-									}
-									else
-										readingAction = true;
+						actionCode = sto<unsigned int>(word);
+						if (actionCode >= aiRecordActions_.size())
+							logger::errorLog("AI agent action with code " + std::to_string(actionCode) + " is not registered");
+						frame[0] = actionCode;
 
-								}
-								else if (readCharacter_ == '@') {
+					}
+					else if (nParams < frame.size())
+						frame[nParams] = encodeTextParam_(word, aiRecordActions_[actionCode].paramType(nParams - 1));
+					else
+						logger::errorLog("Record file " + truePath + " is corrupted");
 
-									changeRecordPlayMode(recordPlayMode::PAUSE);
-									canForwardReplay_ = true;
-									canBackwardReplay_ = false;
-									continuePlaying = false;
+					nParams++;
+					pos = wordEnd + 1;
 
-								}
-								else if (readCharacter_ != EOF)
-									readWord_ += readCharacter_;
+				}
 
-								if (continuePlaying) // As we need to continue playing, go back one position in the recording file.
-									loadedFile_.seekg(-1, std::ios::cur);
+				binaryData.append(reinterpret_cast<const char*>(frame.data()), frame.size() * sizeof(std::uint32_t));
 
-							} while (continuePlaying && game::threadsExecute[1]);
+			}
 
-						}
-						else
-							changeRecordPlayMode(recordPlayMode::PAUSE);
+			// Text records have no keyframes.
+			recordHeader header;
+			std::memcpy(&header, binaryData.data(), sizeof(recordHeader));
+			header.keyframesOffset = binaryData.size();
+			std::memcpy(binaryData.data(), &header, sizeof(recordHeader));
 
-						oldActualTime_ = time::actualTime<timeScale::s>();
+			{
 
-						return;
+				std::ofstream binaryFile(truePath + ".tmp", std::ios::binary | std::ios::trunc);
+				binaryFile.write(binaryData.data(), binaryData.size());
+				if (!binaryFile)
+					logger::errorLog("Could not write the converted record file " + truePath + ".tmp");
 
-					}
-				
-				}
+			}
 
-				return;
+			std::filesystem::rename(truePath + ".tmp", truePath);
 
-			}
-			else
-				logger::errorLog("Can only execute aiGame::playRecordTick() when playing a record");
+			return 0;
 
 		}
 
-		void aiGame::registerAction(const std::string& actionName, const AIagentAction& action) {
+		unsigned int aiGame::registerAction(const std::string& actionName, const AIagentAction& action) {
 		
 			if (AIactionsName_.find(actionName) == AIactionsName_.cend()) {
 
 				AIactionsName_[actionName] = aiRecordActions_.size();
 				aiRecordActions_.push_back(action);
 
+				return aiRecordActions_.size() - 1;
+
 			}
 			else
 				logger::errorLog("Action name is already registered");
 		
 		}
 
+		unsigned int aiGame::actionCode(const std::string& actionName) {
+
+			auto it = AIactionsName_.find(actionName);
+			if (it != AIactionsName_.cend())
+				return it->second;
+			else
+				logger::errorLog("No registered AI agent action named " + actionName + " was found");
+
+		}
+
 		void aiGame::recordAction(const std::string& actionName, std::initializer_list<agentActionArg> args) {
 
 			if (recording_) {
 
-				if (AIactionsName_.find(actionName) != AIactionsName_.cend()) {
+				auto action = AIactionsName_.find(actionName);
+				if (action != AIactionsName_.cend()) {
 
-					saveDataBuffer_ += "#" + std::to_string(AIactionsName_[actionName]) + "|";
+					if (args.size() >= recordFrame_.size())
+						logger::errorLog("AI agent action " + actionName + " has more parameters than the record's frames can hold");
 
-					for (auto it = args.begin(); it != args.end(); it++) {
-					
-						const agentActionArg& arg = *it;
 
-						switch (arg.tag) {
+					std::uint32_t* word = recordFrame_.data();
+					*word++ = action->second;
+					for (auto it = args.begin(); it != args.end(); it++)
+						*word++ = encodeParam_(*it);
 
-							case agentActionArg::type::INT:
+					writeRecordFrame_(args.size() + 1);
 
-								saveDataBuffer_ += std::to_string(arg.i) + "|";
+				}
+				else
+					logger::errorLog("No registered AI agent action named " + actionName + " was found");
 
-								break;
+			}
+			else
+				logger::errorLog("Recording mode is disabled so no AI agent action can be recorded");
+		}
 
-							case agentActionArg::type::UINT:
+		unsigned int aiGame::requiredFrameSize_() {
 
-								saveDataBuffer_ += std::to_string(arg.ui) + "|";
+			unsigned int maxParams = 0;
+			for (const AIagentAction& action : aiRecordActions_)
+				maxParams = std::max(maxParams, action.nParams());
 
-								break;
+			return (maxParams + 1) * sizeof(std::uint32_t);
 
-							case agentActionArg::type::FLOAT:
+		}
 
-								saveDataBuffer_ += std::to_string(arg.f) + "|";
+		unsigned int aiGame::writeRecordHeader_(std::string& buffer, const std::string& gameName, const std::string& terrainPath,
+												unsigned int nChunksToCompute) {
 
-								break;
+			recordHeader header;
 
-							case agentActionArg::type::CHAR:
 
-								saveDataBuffer_ += std::to_string(arg.c) + "|";
+			std::memcpy(header.magic, "VXRC", sizeof(header.magic));
+			header.version = recordHeader::currentVersion;
+			header.frameSize = requiredFrameSize_();
+			header.nChunksToCompute = nChunksToCompute;
+			header.gameNameLength = gameName.size();
+			header.terrainPathLength = terrainPath.size();
+			header.keyframeInterval = 0;
+			header.nKeyframes = 0;
+			header.keyframesOffset = 0;
 
-								break;
+			buffer.append(reinterpret_cast<const char*>(&header), sizeof(recordHeader));
+			buffer += gameName;
+			buffer += terrainPath;
 
-							case agentActionArg::type::BOOL:
+			return header.frameSize;
 
-								saveDataBuffer_ += std::to_string(arg.b) + "|";
+		}
 
-								break;
+		std::uint32_t aiGame::encodeParam_(const agentActionArg& arg) {
 
-							case agentActionArg::type::BLOCK:
+			std::uint32_t word = 0;
 
-								saveDataBuffer_ += std::to_string(arg.bl) + "|";
 
-								break;
+			switch (arg.tag) {
 
-							case agentActionArg::type::BLOCKVIEWDIR:
+				case agentActionArg::type::INT:
+					word = static_cast<std::uint32_t>(arg.i);
+					break;
 
-								saveDataBuffer_ += std::to_string(static_cast<unsigned int>(arg.bvd)) + "|";
+				case agentActionArg::type::UINT:
+					word = arg.ui;
+					break;
 
-								break;
+				case agentActionArg::type::FLOAT:
+					std::memcpy(&word, &arg.f, sizeof(float));
+					break;
 
-						}
-					
-					}
+				case agentActionArg::type::CHAR:
+					word = static_cast<unsigned char>(arg.c);
+					break;
 
-				}
-				else
-					logger::errorLog("No registered AI agent action named " + actionName + " was found");
+				case agentActionArg::type::BOOL:
+					word = arg.b;
+					break;
+
+				case agentActionArg::type::BLOCK:
+					word = arg.bl;
+					break;
+
+				case agentActionArg::type::BLOCKVIEWDIR:
+					word = static_cast<std::uint32_t>(arg.bvd);
+					break;
 
 			}
-			else
-				logger::errorLog("Recording mode is disabled so no AI agent action can be recorded");
+
+			return word;
+
 		}
 
-		void aiGame::pushParam_(const std::string& param, unsigned int actionCode, unsigned int paramTypeInd) {
+		std::uint32_t aiGame::encodeTextParam_(const std::string& param, agentActionArg::type type) {
 
-			if (actionRegistered_(actionCode)) {
+			switch (type) {
 
-				switch (aiRecordActions_[actionCode].paramType(paramTypeInd)) {
-					
-					// Parse parameter and push it into 'params_' to make it available for the corresponding
-					// action that is going to be executed.
-					case agentActionArg::type::INT:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].i = sto<int>(param);
-						else 
-							params_.emplace_back(sto<int>(param));
+				case agentActionArg::type::INT:
+					return encodeParam_(sto<int>(param));
 
-						lastParamInd_++;
+				case agentActionArg::type::UINT:
+					return encodeParam_(sto<unsigned int>(param));
 
-						break;
+				case agentActionArg::type::FLOAT:
+					return encodeParam_(sto<float>(param));
 
-					case agentActionArg::type::UINT:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].ui = sto<unsigned int>(param);
-						else
-							params_.emplace_back(sto<unsigned int>(param));
+				case agentActionArg::type::CHAR:
+					return encodeParam_(sto<char>(param));
 
-						lastParamInd_++;
+				case agentActionArg::type::BOOL:
+					return encodeParam_(sto<bool>(param));
 
-						break;
+				case agentActionArg::type::BLOCK:
+					return encodeParam_(sto<block>(param));
 
-					case agentActionArg::type::FLOAT:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].f = sto<float>(param);
-						else
-							params_.emplace_back(sto<float>(param));
+				default:
+					return encodeParam_(sto<blockViewDir>(param));
 
-						lastParamInd_++;
+			}
 
-						break;
+		}
 
-					case agentActionArg::type::CHAR:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].c = sto<char>(param);
-						else
-							params_.emplace_back(sto<char>(param));
+		void aiGame::setParam_(unsigned int index, std::uint32_t word, agentActionArg::type type) {
 
-						lastParamInd_++;
+			float f;
 
-						break;
 
-					case agentActionArg::type::BOOL:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].b = sto<bool>(param);
-						else
-							params_.emplace_back(sto<bool>(param));
+			if (index >= params_.size())
+				params_.emplace_back(0u);
 
-						lastParamInd_++;
+			agentActionArg& param = params_[index];
+			param.tag = type;
+			switch (type) {
 
-						break;
+				case agentActionArg::type::INT:
+					param.i = static_cast<int>(word);
+					break;
 
-					case agentActionArg::type::BLOCK:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].bl = sto<block>(param);
-						else
-							params_.emplace_back(sto<block>(param));
+				case agentActionArg::type::UINT:
+					param.ui = word;
+					break;
 
-						lastParamInd_++;
+				case agentActionArg::type::FLOAT:
+					std::memcpy(&f, &word, sizeof(float));
+					param.f = f;
+					break;
 
-						break;
+				case agentActionArg::type::CHAR:
+					param.c = static_cast<char>(word);
+					break;
 
-					case agentActionArg::type::BLOCKVIEWDIR:
-						if (lastParamInd_ < params_.size())
-							params_[lastParamInd_].bvd = sto<blockViewDir>(param);
-						else
-							params_.emplace_back(sto<blockViewDir>(param));
+				case agentActionArg::type::BOOL:
+					param.b = word != 0;
+					break;
 
-						lastParamInd_++;
+				case agentActionArg::type::BLOCK:
+					param.bl = static_cast<block>(word);
+					break;
 
-						break;
-					
-				}
+				case agentActionArg::type::BLOCKVIEWDIR:
+					param.bvd = static_cast<blockViewDir>(word);
+					break;
 
 			}
-			else
+
+		}
+
+		unsigned int aiGame::readRecordFrame_(std::size_t frame) {
+
+			const unsigned char* frameData = loadedFile_.data() + recordFramesOffset_ + frame * recordFrameSize_;
+			std::uint32_t word;
+			unsigned int actionCode,
+						 nParams;
+
+
+			std::memcpy(&actionCode, frameData, sizeof(std::uint32_t));
+			if (!actionRegistered_(actionCode))
 				logger::errorLog("AI agent action with code " + std::to_string(actionCode) + " is not registered");
 
+			const AIagentAction& action = aiRecordActions_[actionCode];
+			nParams = action.nParams();
+			if ((nParams + 1) * sizeof(std::uint32_t) > recordFrameSize_)
+				logger::errorLog("AI agent action with code " + std::to_string(actionCode) + " does not fit in the record's frames");
+
+			for (unsigned int i = 0; i < nParams; i++) {
+
+				std::memcpy(&word, frameData + (i + 1) * sizeof(std::uint32_t), sizeof(std::uint32_t));
+				setParam_(i, word, action.paramType(i));
+
+			}
+			lastParamInd_ = nParams;
+
+			return actionCode;
+
+		}
+
+		void aiGame::writeRecordFrame_(unsigned int nWords) {
+
+			if (keyframeInterval_ && nRecordedFrames_ && nRecordedFrames_ % keyframeInterval_ == 0)
+				takeRecordKeyframe_();
+
+			std::fill(recordFrame_.begin() + nWords, recordFrame_.end(), 0);
+			saveFile_.write(recordFrame_.data(), recordFrameSize_);
+			nRecordedFrames_++;
+
+		}
+
+		void aiGame::beginRecord_(const std::string& gameName, const std::string& terrainPath) {
+
+			std::string header;
+
+
+			recordFrameSize_ = writeRecordHeader_(header, gameName, terrainPath, chunkManager::nChunksToCompute());
+			saveFile_.write(header.data(), header.size());
+			recordFrame_.assign(recordFrameSize_ / sizeof(std::uint32_t), 0);
+
+			nRecordedFrames_ = 0;
+			recordKeyframesBuffer_.clear();
+			recordKeyframeOffsets_.clear();
+			recordModifiedBlocks_.clear();
+			recordAgentReplacedBlocks_.clear();
+			recordEntityIDcreationOrder_.clear();
+			recordAgentIDcreationOrder_.clear();
+
+		}
+
+		void aiGame::finishRecord_() {
+
+			std::uint32_t keyframeInterval = keyframeInterval_,
+						  nKeyframes = recordKeyframeOffsets_.size();
+			std::uint64_t keyframesOffset = saveFile_.bytesWritten(),
+						  keyframeOffset;
+
+
+			// Keyframe offsets table followed by the keyframes themselves.
+			for (std::size_t i = 0; i < recordKeyframeOffsets_.size(); i++) {
+
+				keyframeOffset = keyframesOffset + nKeyframes * sizeof(std::uint64_t) + recordKeyframeOffsets_[i];
+				saveFile_.write(&keyframeOffset, sizeof(std::uint64_t));
+
+			}
+			saveFile_.write(recordKeyframesBuffer_.data(), recordKeyframesBuffer_.size());
+
+			saveFile_.patch(offsetof(recordHeader, keyframeInterval), &keyframeInterval, sizeof(std::uint32_t));
+			saveFile_.patch(offsetof(recordHeader, nKeyframes), &nKeyframes, sizeof(std::uint32_t));
+			saveFile_.patch(offsetof(recordHeader, keyframesOffset), &keyframesOffset, sizeof(std::uint64_t));
+
+			recordKeyframesBuffer_.clear();
+			recordKeyframeOffsets_.clear();
+			recordModifiedBlocks_.clear();
+			recordAgentReplacedBlocks_.clear();
+			recordEntityIDcreationOrder_.clear();
+			recordAgentIDcreationOrder_.clear();
+
 		}
 
-		void aiGame::pushParams_(unsigned int actionCode) {
+		void aiGame::appendWord_(std::string& buffer, std::uint32_t word) {
+
+			buffer.append(reinterpret_cast<const char*>(&word), sizeof(std::uint32_t));
 
-			if (actionRegistered_(actionCode)) {
+		}
 
-				for (std::size_t i = 0; i < rawParams_.size(); i++) {
+		void aiGame::appendFloat_(std::string& buffer, float value) {
 
-					switch (aiRecordActions_[actionCode].paramType(i)) {
+			buffer.append(reinterpret_cast<const char*>(&value), sizeof(float));
 
-						// Parse parameter and push it into 'params_' to make it available for the corresponding
-						// action that is going to be executed.
-						case agentActionArg::type::INT:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].i = sto<int>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<int>(rawParams_[i]));
+		}
 
-							lastParamInd_++;
+		std::uint32_t aiGame::readWord_(const unsigned char*& cursor) {
 
-							break;
+			std::uint32_t word;
 
-						case agentActionArg::type::UINT:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].ui = sto<unsigned int>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<unsigned int>(rawParams_[i]));
 
-							lastParamInd_++;
+			std::memcpy(&word, cursor, sizeof(std::uint32_t));
+			cursor += sizeof(std::uint32_t);
 
-							break;
+			return word;
 
-						case agentActionArg::type::FLOAT:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].f = sto<float>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<float>(rawParams_[i]));
+		}
 
-							lastParamInd_++;
+		float aiGame::readFloat_(const unsigned char*& cursor) {
 
-							break;
+			float value;
 
-						case agentActionArg::type::CHAR:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].c = sto<char>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<char>(rawParams_[i]));
 
-							lastParamInd_++;
+			std::memcpy(&value, cursor, sizeof(float));
+			cursor += sizeof(float);
 
-							break;
+			return value;
+
+		}
 
-						case agentActionArg::type::BOOL:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].b = sto<bool>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<bool>(rawParams_[i]));
+		void aiGame::takeRecordKeyframe_() {
 
-							lastParamInd_++;
+			std::uint64_t frame = nRecordedFrames_;
+			std::uint32_t nAgents = 0;
+			std::size_t nAgentsPos = 0;
 
-							break;
 
-						case agentActionArg::type::BLOCK:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].bl = sto<block>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<block>(rawParams_[i]));
+			recordKeyframeOffsets_.push_back(recordKeyframesBuffer_.size());
+			recordKeyframesBuffer_.append(reinterpret_cast<const char*>(&frame), sizeof(std::uint64_t));
 
-							lastParamInd_++;
+			// AI agents. Only the blocks replaced by each agent since the last keyframe are stored.
+			nAgentsPos = recordKeyframesBuffer_.size();
+			appendWord_(recordKeyframesBuffer_, 0);
+			for (agentID agentID = 0; agentID < AIagentEntityID_.size(); agentID++)
+				if (freeAIagentID_.find(agentID) == freeAIagentID_.cend()) {
 
-							break;
+					entityID entityID = AIagentEntityID_[agentID];
+					entity agentEntity = entityManager::getEntity(entityID);
 
-						case agentActionArg::type::BLOCKVIEWDIR:
-							if (lastParamInd_ < params_.size())
-								params_[lastParamInd_].bvd = sto<blockViewDir>(rawParams_[i]);
-							else
-								params_.emplace_back(sto<blockViewDir>(rawParams_[i]));
+					appendWord_(recordKeyframesBuffer_, agentID);
+					appendWord_(recordKeyframesBuffer_, entityID);
+					appendWord_(recordKeyframesBuffer_, static_cast<std::uint32_t>(AIagentLookDirection_[agentID]));
+					appendWord_(recordKeyframesBuffer_, entityManager::isEntityActiveAt(entityID));
+					appendFloat_(recordKeyframesBuffer_, agentEntity.x());
+					appendFloat_(recordKeyframesBuffer_, agentEntity.y());
+					appendFloat_(recordKeyframesBuffer_, agentEntity.z());
+					appendFloat_(recordKeyframesBuffer_, agentEntity.rot().x);
+					appendFloat_(recordKeyframesBuffer_, agentEntity.rot().y);
+					appendFloat_(recordKeyframesBuffer_, agentEntity.rot().z);
 
-							lastParamInd_++;
+					if (agentID < recordAgentReplacedBlocks_.size()) {
 
-							break;
+						std::vector<block>& modifiedBlocks = recordAgentReplacedBlocks_[agentID];
+						appendWord_(recordKeyframesBuffer_, modifiedBlocks.size());
+						for (std::size_t i = 0; i < modifiedBlocks.size(); i++)
+							appendWord_(recordKeyframesBuffer_, modifiedBlocks[i]);
+						modifiedBlocks.clear();
 
 					}
+					else
+						appendWord_(recordKeyframesBuffer_, 0);
+
+					nAgents++;
 
 				}
+			std::memcpy(&recordKeyframesBuffer_[nAgentsPos], &nAgents, sizeof(std::uint32_t));
+
+			// Creation order of entities and AI agents.
+			appendWord_(recordKeyframesBuffer_, recordEntityIDcreationOrder_.size());
+			for (auto it = recordEntityIDcreationOrder_.cbegin(); it != recordEntityIDcreationOrder_.cend(); it++)
+				appendWord_(recordKeyframesBuffer_, *it);
+
+			appendWord_(recordKeyframesBuffer_, recordAgentIDcreationOrder_.size());
+			for (auto it = recordAgentIDcreationOrder_.cbegin(); it != recordAgentIDcreationOrder_.cend(); it++)
+				appendWord_(recordKeyframesBuffer_, *it);
+
+			// Modified terrain.
+			appendWord_(recordKeyframesBuffer_, recordModifiedBlocks_.size());
+			for (auto it = recordModifiedBlocks_.cbegin(); it != recordModifiedBlocks_.cend(); it++) {
+
+				appendWord_(recordKeyframesBuffer_, static_cast<int>(it->first.x));
+				appendWord_(recordKeyframesBuffer_, static_cast<int>(it->first.y));
+				appendWord_(recordKeyframesBuffer_, static_cast<int>(it->first.z));
+				appendWord_(recordKeyframesBuffer_, it->second.first);
+				appendWord_(recordKeyframesBuffer_, it->second.second);
 
 			}
-			else
-				logger::errorLog("AI agent action with code " + std::to_string(actionCode) + " is not registered");
+
+		}
+
+		bool aiGame::restoreRecordKeyframe_(std::size_t keyframe) {
+
+			const unsigned char* cursor = loadedFile_.data() + loadedKeyframes_[keyframe];
+			std::uint64_t frame;
+			unsigned int nAgents,
+						 nElements;
+			agentID agentID;
+			entityID entityID;
+
+
+			std::memcpy(&frame, cursor, sizeof(std::uint64_t));
+			cursor += sizeof(std::uint64_t);
+
+			// The keyframe can only be restored if the AI agents alive in it are the ones that are currently alive.
+			nAgents = readWord_(cursor);
+			if (nAgents != AIagentEntityID_.size() - freeAIagentID_.size())
+				return false;
+
+			const unsigned char* agentsBegin = cursor;
+			for (unsigned int i = 0; i < nAgents; i++) {
+
+				agentID = readWord_(cursor);
+				entityID = readWord_(cursor);
+				if (!isAgentRegistered(agentID) || AIagentEntityID_[agentID] != entityID)
+					return false;
+
+				cursor += 8 * sizeof(std::uint32_t);
+				cursor += readWord_(cursor) * sizeof(std::uint32_t);
+
+			}
+
+			// Terrain back to its original state.
+			for (auto it = playbackOriginalBlocks_.cbegin(); it != playbackOriginalBlocks_.cend(); it++)
+				chunkManager::setBlock(it->first, it->second);
+			playbackOriginalBlocks_.clear();
+
+			// AI agents.
+			cursor = agentsBegin;
+			for (unsigned int i = 0; i < nAgents; i++) {
+
+				agentID = readWord_(cursor);
+				entityID = readWord_(cursor);
+
+				entity agentEntity = entityManager::getEntity(entityID);
+				AIagentLookDirection_[agentID] = static_cast<blockViewDir>(readWord_(cursor));
+				entityManager::changeEntityActiveStateAt(entityID, readWord_(cursor));
+				vec3 position;
+				position.x = readFloat_(cursor);
+				position.y = readFloat_(cursor);
+				position.z = readFloat_(cursor);
+				entityManager::setEntityPos(entityID, position);
+				vec3 rotation;
+				rotation.x = readFloat_(cursor);
+				rotation.y = readFloat_(cursor);
+				rotation.z = readFloat_(cursor);
+				agentEntity.rotate(rotation - agentEntity.rot());
+
+				cursor += readWord_(cursor) * sizeof(std::uint32_t);
+
+				if (agentID >= agentModifiedBlocks_.size())
+					agentModifiedBlocks_.resize(agentID + 1);
+				agentModifiedBlocks_[agentID].clear();
+
+			}
+
+			// The blocks replaced by each AI agent are rebuilt from the ones stored in this and all the previous keyframes.
+			for (std::size_t i = 0; i <= keyframe; i++) {
+
+				const unsigned char* keyframeCursor = loadedFile_.data() + loadedKeyframes_[i] + sizeof(std::uint64_t);
+				unsigned int nKeyframeAgents = readWord_(keyframeCursor);
+				for (unsigned int j = 0; j < nKeyframeAgents; j++) {
+
+					agentID = readWord_(keyframeCursor);
+					keyframeCursor += 9 * sizeof(std::uint32_t);
+
+					nElements = readWord_(keyframeCursor);
+					for (unsigned int k = 0; k < nElements; k++) {
+
+						block modifiedBlock = readWord_(keyframeCursor);
+						if (isAgentRegistered(agentID))
+							agentModifiedBlocks_[agentID].push_back(modifiedBlock);
+
+					}
+
+				}
+
+			}
+
+			// Creation order of entities and AI agents.
+			entityIDcreationOrder_.clear();
+			nElements = readWord_(cursor);
+			for (unsigned int i = 0; i < nElements; i++)
+				entityIDcreationOrder_.push_back(readWord_(cursor));
+
+			agentIDcreationOrder_.clear();
+			nElements = readWord_(cursor);
+			for (unsigned int i = 0; i < nElements; i++)
+				agentIDcreationOrder_.push_back(readWord_(cursor));
+
+			// Modified terrain.
+			nElements = readWord_(cursor);
+			for (unsigned int i = 0; i < nElements; i++) {
+
+				int x = static_cast<int>(readWord_(cursor)),
+					y = static_cast<int>(readWord_(cursor)),
+					z = static_cast<int>(readWord_(cursor));
+				block original = readWord_(cursor),
+					  current = readWord_(cursor);
+
+				playbackOriginalBlocks_[vec3(x, y, z)] = original;
+				chunkManager::setBlock(x, y, z, current);
+
+			}
+
+			nextRecordFrame_ = frame;
+
+			return true;
+
+		}
+
+		void aiGame::seekRecord_(std::size_t tick) {
+
+			recordPlayMode mode = recordPlayMode_;
+			std::size_t nKeyframes = 0;
+
+
+			tick = std::min(tick, nRecordFrames_);
+
+			// Keyframe i was taken right before the AI action recorded at tick (i + 1) * interval.
+			// It is used when replaying from it is cheaper than stepping from the current tick.
+			if (loadedKeyframeInterval_)
+				nKeyframes = std::min<std::size_t>(tick / loadedKeyframeInterval_, loadedKeyframes_.size());
+
+			if (nKeyframes) {
+
+				std::size_t keyframeTick = nKeyframes * loadedKeyframeInterval_;
+				if ((tick >= nextRecordFrame_ ? keyframeTick > nextRecordFrame_ : tick - keyframeTick < nextRecordFrame_ - tick) &&
+					restoreRecordKeyframe_(nKeyframes - 1)) {
+
+					// Replaying from a keyframe that does not belong to its tick would silently desynchronise the playback.
+					if (nextRecordFrame_ != keyframeTick)
+						logger::errorLog("Keyframe " + std::to_string(nKeyframes - 1) + " of the record was expected at tick " +
+										 std::to_string(keyframeTick) + " but is at tick " + std::to_string(nextRecordFrame_));
+
+					logger::debugLog("Record playback restored from keyframe " + std::to_string(nKeyframes - 1) + " at tick " + std::to_string(keyframeTick));
+
+				}
+
+			}
+
+			recordPlayMode_ = recordPlayMode::BACKWARDS;
+			while (nextRecordFrame_ > tick)
+				playActionRecordBackwards_(readRecordFrame_(--nextRecordFrame_));
+
+			recordPlayMode_ = recordPlayMode::FORWARD;
+			while (nextRecordFrame_ < tick)
+				playActionRecordForward_(readRecordFrame_(nextRecordFrame_++));
+
+			recordPlayMode_ = mode;
+			canForwardReplay_ = nextRecordFrame_ < nRecordFrames_;
+			canBackwardReplay_ = nextRecordFrame_ > 0;
 
 		}
 
 		void aiGame::cleanUp() {
 		
+			worldProducer_.stop();
 			selectedGame_ = nullptr;
 
 			for (auto it = aiGames_.cbegin(); it != aiGames_.cend(); it++)
@@ -1274,8 +1599,22 @@ namespace VoxelEng {
 
 			if (isAgentRegistered(agentID)) {
 			
-				if (recording_)
-					recordAction("setBlock", {agentID, x, y, z, blockID});
+				if (recording_) {
+
+					recordAction(setBlockCode_, agentID, x, y, z, blockID);
+
+					// Keep track of the state needed by the record's keyframes.
+					block original = chunkManager::getBlock(x, y, z);
+					auto it = recordModifiedBlocks_.try_emplace(vec3(x, y, z), original, blockID).first;
+					it->second.second = blockID;
+
+					if (agentID >= recordAgentReplacedBlocks_.size())
+						recordAgentReplacedBlocks_.resize(agentID + 1);
+					recordAgentReplacedBlocks_[agentID].push_back(original);
+
+				}
+				else if (playingRecord())
+					playbackOriginalBlocks_.try_emplace(vec3(x, y, z), chunkManager::getBlock(x, y, z));
 
 
 				if (recordAgentModifiedBlocks_ && record)
@@ -1288,12 +1627,49 @@ namespace VoxelEng {
 				logger::errorLog("AI agent with ID " + std::to_string(agentID) + " was not found");
 		}
 
-		void aiGame::moveEntity(entityID entityID, int x, int y, int z) {
+		void aiGame::castRayFan(const vec3& origin, const vec3& direction, unsigned int nRaysX, unsigned int nRaysY,
+								float angleX, float angleY, float maxDistance, std::vector<raycastHit>& hits) {
 
-			entityManager::moveEntity(entityID, x, y, z);
+			float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z),
+				  yaw = 0.0f,
+				  pitch = 0.0f,
+				  rayYaw = 0.0f,
+				  rayPitch = 0.0f;
+			std::vector<vec3> origins(static_cast<std::size_t>(nRaysX) * nRaysY, origin),
+							  directions(origins.size());
+
+
+			if (length == 0.0f)
+				logger::errorLog("The direction of a fan of rays cannot be the null vector");
+
+			// Same angle convention as the camera's direction.
+			yaw = std::atan2(direction.z, direction.x);
+			pitch = std::asin(direction.y / length);
+
+			for (unsigned int j = 0; j < nRaysY; j++) {
+
+				rayPitch = pitch + glm::radians((nRaysY > 1) ? angleY * (static_cast<float>(j) / (nRaysY - 1) - 0.5f) : 0.0f);
+
+				for (unsigned int i = 0; i < nRaysX; i++) {
+
+					rayYaw = yaw + glm::radians((nRaysX > 1) ? angleX * (static_cast<float>(i) / (nRaysX - 1) - 0.5f) : 0.0f);
+					directions[j * nRaysX + i] = vec3(std::cos(rayYaw) * std::cos(rayPitch), std::sin(rayPitch), std::sin(rayYaw) * std::cos(rayPitch));
+
+				}
+
+			}
+
+			castRays(origins, directions, maxDistance, hits);
+
+		}
 
+		void aiGame::moveEntity(entityID entityID, int x, int y, int z) {
+
+			// The action is recorded before applying it so that the record's keyframes see the state prior to it.
 			if (recording_)
-				recordAction("moveEntity", { entityID, x, y, z });
+				recordAction(moveEntityCode_, entityID, x, y, z);
+
+			entityManager::moveEntity(entityID, x, y, z);
 
 		}
 
@@ -1305,10 +1681,7 @@ namespace VoxelEng {
 					recordAction("setEntityPos", { entityID, x, y, z });
 
 
-				vec3& pos = entityManager::getEntity(entityID).pos();
-				pos.x = x;
-				pos.y = y;
-				pos.z = z;
+				entityManager::setEntityPos(entityID, vec3(x, y, z));
 
 			}
 			else
@@ -1325,7 +1698,7 @@ namespace VoxelEng {
 				else {
 
 					if (recording_)
-						recordAction("rotateAgentViewDir", { agentID, direction });
+						recordAction(rotateAgentViewDirCode_, agentID, direction);
 
 					entityManager::getEntity(AIagentEntityID_[agentID]).rotateView(uDirectionToVec3(direction) * 90.0f);
 
@@ -1339,12 +1712,31 @@ namespace VoxelEng {
 
 		}
 
+		void aiGame::setAgentViewDir(agentID agentID, blockViewDir direction) {
+
+			if (!isAgentRegistered(agentID))
+				logger::errorLog("AI agent with ID " + std::to_string(agentID) + " was not found");
+
+			if (direction == blockViewDir::NONE)
+				logger::errorLog("View direction specified is not valid");
+
+			// Rotating around the X axis goes through all the horizontal directions (and away from the vertical ones),
+			// so any of them is reached after at most four rotations. The vertical directions are reached from PLUSX.
+			blockViewDir horizontalDirection = (direction == blockViewDir::PLUSY || direction == blockViewDir::NEGY) ? blockViewDir::PLUSX : direction;
+			for (unsigned int i = 0; i < 4 && AIagentLookDirection_[agentID] != horizontalDirection; i++)
+				rotateAgentViewDir(agentID, blockViewDir::PLUSX);
+
+			if (direction != horizontalDirection)
+				rotateAgentViewDir(agentID, direction);
+
+		}
+
 		void aiGame::rotateEntity(unsigned entityID, float rotX, float rotY, float rotZ) {
 		
 			if (entityManager::isEntityRegistered(entityID)) {
 
 				if (recording_)
-					recordAction("rotateEntity", {entityID, rotX, rotY, rotZ});
+					recordAction(rotateEntityCode_, entityID, rotX, rotY, rotZ);
 
 
 				entityManager::getEntity(entityID).rotate(rotX, rotY, rotZ);
@@ -1360,10 +1752,10 @@ namespace VoxelEng {
 			if (entityManager::isEntityRegistered(entityID)) {
 
 				if (recording_)
-					recordAction("inverseRotateEntity", { entityID, rotX, rotY, rotZ });
+					recordAction(inverseRotateEntityCode_, entityID, rotX, rotY, rotZ);
 
 
-				entity& entity = entityManager::getEntity(entityID);
+				entity entity = entityManager::getEntity(entityID);
 				entity.rotateZ(rotZ);
 				entity.rotateY(rotY);
 				entity.rotateX(rotX);
@@ -1377,9 +1769,14 @@ namespace VoxelEng {
 		unsigned int aiGame::createEntity(unsigned int entityTypeID, int posX, int posY, int posZ, float rotX, float rotY, float rotZ) {
 
 			if (recording_)
-				recordAction("createEntity", { entityTypeID, posX, posY, posZ, rotX, rotY, rotZ });
+				recordAction(createEntityCode_, entityTypeID, posX, posY, posZ, rotX, rotY, rotZ);
+
+			entityID ID = entityManager::registerEntity(entityTypeID, posX, posY, posZ, rotX, rotY, rotZ);
+
+			if (recording_)
+				recordEntityIDcreationOrder_.push_back(ID);
 
-			return entityManager::registerEntity(entityTypeID, posX, posY, posZ, rotX, rotY, rotZ);
+			return ID;
 
 		}
 
@@ -1388,7 +1785,7 @@ namespace VoxelEng {
 			unsigned int ID = entityManager::registerEntity(entityTypeID, x, y, z, uDirectionToVec3(direction));
 
 			if (recording_)
-				recordAction("createAgent", {entityTypeID, x, y, z, direction});
+				recordAction(createAgentCode_, entityTypeID, x, y, z, direction);
 
 			entityIDIsAgent.insert(ID);
 			if (freeAIagentID_.empty()) {
@@ -1399,6 +1796,9 @@ namespace VoxelEng {
 				if (game::selectedEngineMode() == engineMode::PLAYINGRECORD && ID >= agentModifiedBlocks_.size())
 					agentModifiedBlocks_.emplace_back();
 
+				if (recording_)
+					recordAgentIDcreationOrder_.push_back(AIagentEntityID_.size() - 1);
+
 				return AIagentEntityID_.size() - 1;
 
 			}
@@ -1410,6 +1810,9 @@ namespace VoxelEng {
 
 				freeAIagentID_.erase(agentID);
 
+				if (recording_)
+					recordAgentIDcreationOrder_.push_back(agentID);
+
 				return agentID;
 
 			}
@@ -1430,7 +1833,7 @@ namespace VoxelEng {
 			if (entityManager::isEntityRegistered(entityID)) {
 			
 				if (recording_)
-					recordAction("changeActiveState", {entityID, state});
+					recordAction(changeActiveStateCode_, entityID, state);
 
 				entityManager::changeEntityActiveStateAt(entityID, state);
 			
@@ -1515,13 +1918,91 @@ namespace VoxelEng {
 			if (!chunkManager::initialised())
 				logger::errorLog("Chunk management system is not initialised");
 
-			chunkManager::generateAIWorld(path);
+			producedWorld world;
+			if (path.empty() && worldProducer_.isRunning() && worldProducer_.takeWorld(world)) {
+
+				chunkManager::swapAIWorld(world.chunks);
+				worldProducer_.recycleChunks(world.chunks);
+
+				// Leave the selected world generator in the same state as if it had generated the world.
+				worldGen::setSeed(world.seed);
+				worldGen::prepareGen();
+
+			}
+			else
+				chunkManager::generateAIWorld(path);
+
+		}
+
+		void aiGame::startWorldPregeneration(const std::vector<unsigned int>& seeds, unsigned int nWorldsAhead,
+											 std::size_t memoryCap, unsigned int nThreads) {
+
+			if (!chunkManager::initialised())
+				logger::errorLog("Chunk management system is not initialised");
+
+			worldProducer_.start(seeds, chunkManager::nChunksToCompute(), nWorldsAhead, memoryCap, nThreads);
+
+		}
+
+		void aiGame::stopWorldPregeneration() {
+
+			worldProducer_.stop();
 
 		}
 
 
 		// 'trainingGame' class.
 
+		void trainingGame::startTraining(unsigned int nAgents, unsigned int nEpochs, unsigned int seed, unsigned int nThreads,
+										 unsigned int nProcesses, const std::string& executable) {
+
+			trainingGame* selected = dynamic_cast<trainingGame*>(selectedGame());
+
+
+			if (!selected)
+				logger::errorLog("The selected AI game does not support training");
+
+			if (gameInProgress_)
+				logger::errorLog("Cannot start a new AI game without finishing the one that is currently in progress");
+
+			gameInProgress_ = true;
+			game::setAImode(true);
+
+			selected->generalSetUp_();
+			selected->setUpHeadlessTraining_(seed, nThreads, nProcesses, executable);
+			selected->setUpTraining_(nAgents, nEpochs);
+			selected->train_();
+
+			game::setAImode(false);
+			selected->cleanUpGame_();
+			gameInProgress_ = false;
+
+		}
+
+		void trainingGame::startFitnessWorker(unsigned int nAgents, processChannel& channel) {
+
+			trainingGame* selected = dynamic_cast<trainingGame*>(selectedGame());
+
+
+			if (!selected)
+				logger::errorLog("The selected AI game does not support training");
+
+			if (gameInProgress_)
+				logger::errorLog("Cannot start a new AI game without finishing the one that is currently in progress");
+
+			gameInProgress_ = true;
+			game::setAImode(true);
+
+			selected->generalSetUp_();
+			selected->setUpTraining_(nAgents, 0);
+			selected->serveFitnessRequests_(channel);
+
+			game::setAImode(false);
+			selected->cleanUpGame_();
+			gameInProgress_ = false;
+
+		}
+
 		unsigned int trainingGame::generateRecordLoadedAgents_(const std::string& recordPath, const std::string& recordFilename,
 															   const std::string& agentsPath) {
 
@@ -1571,9 +2052,7 @@ namespace VoxelEng {
 
 									saveFile_.open(recordingPath);
 
-									saveDataBuffer_ += name_ + '|';
-									saveDataBuffer_ += "saves/recordingWorlds/" + name_ + '/' + recordFilename + '|';
-									saveDataBuffer_ += std::to_string(chunkManager::nChunksToCompute()) + "|@";
+									beginRecord_(name_, "saves/recordingWorlds/" + name_ + '/' + recordFilename);
 
 									saveFileName_ = recordFilename;
 
@@ -1582,7 +2061,6 @@ namespace VoxelEng {
 										logger::say("No file located at " + agentsPath);
 
 										saveFile_.close();
-										saveDataBuffer_.clear();
 										std::filesystem::remove(recordingPath);
 
 										recording_ = false;
@@ -1590,8 +2068,7 @@ namespace VoxelEng {
 									
 									}	
 
-									saveFile_ << saveDataBuffer_;
-									saveDataBuffer_.clear();
+									finishRecord_();
 									saveFile_.close();
 									recording_ = false;
 								
@@ -10,7 +10,9 @@
 #ifndef _VOXELENG_AIAPI_
 #define _VOXELENG_AIAPI_
 #include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <concepts>
 #include <deque>
 #include <initializer_list>
@@ -25,9 +27,14 @@
 #include "definitions.h"
 #include "entity.h"
 #include "game.h"
+#include "asyncFileWriter.h"
 #include "logger.h"
+#include "mappedFile.h"
+#include "raycast.h"
 #include "time.h"
 #include "worldGen.h"
+#include "worldProducer.h"
+#include "workerProcess.h"
 
 
 namespace VoxelEng {
@@ -51,6 +58,41 @@ namespace VoxelEng {
 		enum class recordPlayMode {FORWARD, PAUSE, BACKWARDS};
 
 
+		////////////
+		//Structs.//
+		////////////
+
+		/**
+		* @brief Header of the AI game match record files (".rec").
+		* It is followed by the name of the AI game ('gameNameLength' characters), the path of the
+		* record's terrain file ('terrainPathLength' characters) and the recorded AI actions.
+		* Each recorded AI action is stored in a frame of 'frameSize' bytes that holds the action's code
+		* followed by its parameters, all of them stored as 4 byte words. Since all frames have the same size,
+		* the N-th recorded action can be found without parsing the previous ones.
+		* The recorded AI actions end at 'keyframesOffset', where a table with the file offsets of the
+		* 'nKeyframes' keyframes begins. A keyframe is a snapshot of the AI agents and the modified terrain
+		* taken every 'keyframeInterval' recorded AI actions and it is used to seek any tick of the record quickly.
+		*/
+		struct recordHeader {
+
+			static constexpr std::uint32_t currentVersion = 2;
+
+			char magic[4]; // Always "VXRC".
+			std::uint32_t version,
+						  frameSize,
+						  nChunksToCompute,
+						  gameNameLength,
+						  terrainPathLength,
+						  keyframeInterval,
+						  nKeyframes;
+			std::uint64_t keyframesOffset;
+
+		};
+
+		static_assert(sizeof(recordHeader) == 40, "The record file header must not have padding");
+		static_assert(std::endian::native == std::endian::little, "Record files are read and written directly from memory and require a little-endian host");
+
+
 		////////////
 		//Classes.//
 		////////////
@@ -160,6 +202,11 @@ namespace VoxelEng {
 			*/
 			agentActionArg::type paramType(unsigned int index) const;
 
+			/**
+			* @brief Get the number of parameters of the AI action.
+			*/
+			unsigned int nParams() const;
+
 
 			// Misc.
 
@@ -177,6 +224,12 @@ namespace VoxelEng {
 
 		};
 
+		inline unsigned int AIagentAction::nParams() const {
+
+			return paramTypes_.size();
+
+		}
+
 		inline void AIagentAction::playRecordedAction() {
 
 			action_();
@@ -246,11 +299,26 @@ namespace VoxelEng {
 			*/
 			static bool recordPaused();
 
+			/**
+			* @brief Returns the number of ticks (recorded AI actions) of the record that is being played.
+			*/
+			static std::size_t nRecordTicks();
+
+			/**
+			* @brief Returns the tick of the record that is being played that would be played next in forward mode.
+			*/
+			static std::size_t recordTick();
+
 			/**
 			* @brief Name used to identify the AI game uniquely.
 			*/
 			const std::string& name() const;
 
+			/**
+			* @brief Returns the code of the registered AI action named 'actionName'.
+			*/
+			static unsigned int actionCode(const std::string& actionName);
+
 			/**
 			* @brief Returns true if the specified AI agent exists or false otherwise.
 			*/
@@ -397,12 +465,47 @@ namespace VoxelEng {
 			*/
 			static void stopPlayingRecord();
 
+			/**
+			* @brief Move the record playback to 'tick' so that the next AI action played in forward mode is the one recorded at said tick.
+			* The nearest keyframe of the record is loaded and the remaining AI actions up to 'tick' are replayed, unless it is cheaper
+			* to step from the current tick. The seek is performed by aiGame::playRecordTick() on its next call.
+			*/
+			static void seekRecord(std::size_t tick);
+
+			/**
+			* @brief Same as aiGame::seekRecord() but moving the record playback 'nTicks' ticks from the tick where it is
+			* when the seek is performed, backwards if 'nTicks' is negative. Successive calls before the seek accumulate.
+			*/
+			static void seekRecordBy(long long nTicks);
+
+			/**
+			* @brief Set the number of recorded AI actions between keyframes in the records generated from now on.
+			* A value of 0 disables the keyframes.
+			*/
+			static void setRecordKeyframeInterval(unsigned int interval);
+
 			/*
 			* @brief Generate the level to be used when using AI agents without
 			* the graphical part of the engine.
 			*/
 			void generateAIWorld(const std::string& path = "");
 
+			/**
+			* @brief Start generating in the background, with the selected world generator, one AI world for each seed in 'seeds'.
+			* While the world pregeneration is running, aiGame::generateAIWorld() with an empty 'path' swaps in the next
+			* pregenerated world instead of generating a new one, only waiting if said world is not ready yet.
+			* At most 'nWorldsAhead' worlds using up to 'memoryCap' bytes are kept generated in advance by 'nThreads' threads.
+			* Once all the pregenerated worlds are used, the worlds are generated as usual.
+			* WARNING. The chunk management system must be initialised.
+			*/
+			static void startWorldPregeneration(const std::vector<unsigned int>& seeds, unsigned int nWorldsAhead = DEF_N_PREGENERATED_WORLDS,
+												std::size_t memoryCap = DEF_PREGENERATED_WORLDS_MEMORY_CAP, unsigned int nThreads = 1);
+
+			/**
+			* @brief Stop the world pregeneration and free the worlds that were generated in advance but not used.
+			*/
+			static void stopWorldPregeneration();
+
 			/**
 			* @brief Get block and set block operations in the chunk manager system will now
 			* be performed on the AI world/level of AI agent with ID 'individualID'.
@@ -426,8 +529,10 @@ namespace VoxelEng {
 
 			/**
 			* @brief Register an AI action with its unique name to identify it.
+			* Returns the action's code, which can be used to record the action with
+			* aiGame::recordAction(unsigned int actionCode, Args... args).
 			*/
-			static void registerAction(const std::string& actionName, const AIagentAction& action);
+			static unsigned int registerAction(const std::string& actionName, const AIagentAction& action);
 
 			/**
 			* @brief Check if a block coordinate is withing the level's limits.
@@ -445,6 +550,15 @@ namespace VoxelEng {
 			*/
 			void recordAction(const std::string& actionName, std::initializer_list<agentActionArg> args);
 
+			/**
+			* @brief Record the AI action with code 'actionCode' (as returned by aiGame::registerAction()) performed by an AI agent.
+			* Each parameter is encoded directly from its type into the record's ring buffer, which is written
+			* into the record file by a background thread. No name lookups nor heap allocations are performed.
+			* WARNING. The recording flag must be set to true before recording an action. Not thread-safe.
+			*/
+			template <typename... Args>
+			void recordAction(unsigned int actionCode, Args... args);
+
 			/**
 			* @brief Get the last modified block ID by the specified AI agent. The caller may also
 			* optionally pop that ID out of the ordered list of the modified block IDs by said agent.
@@ -529,6 +643,25 @@ namespace VoxelEng {
 			*/
 			std::vector<block> getBlocksBox(int x1, int y1, int z1, int x2, int y2, int z2);
 
+			/**
+			* @brief Cast a ray for each pair of origins[i] and directions[i] and store in hits[i] the first non-null
+			* block found at a distance of 'maxDistance' or less, together with said distance and the face the ray hit.
+			* Only the blocks crossed by the rays are read, so it is a cheaper observation than a big box of blocks.
+			* WARNING. Select the proper level you want to access with "aiGame::selectAIWorld()" or "aiGame::selectOriginalWorld()"
+			* before calling this method.
+			*/
+			void castRays(const std::vector<vec3>& origins, const std::vector<vec3>& directions, float maxDistance, std::vector<raycastHit>& hits);
+
+			/**
+			* @brief Cast a fan of 'nRaysX' * 'nRaysY' rays from 'origin' centered on 'direction' that spans 'angleX' degrees
+			* horizontally and 'angleY' degrees vertically. The result of the ray in the column 'i' and row 'j' of the fan
+			* is stored in hits[j * nRaysX + i]. See aiGame::castRays().
+			* WARNING. Select the proper level you want to access with "aiGame::selectAIWorld()" or "aiGame::selectOriginalWorld()"
+			* before calling this method.
+			*/
+			void castRayFan(const vec3& origin, const vec3& direction, unsigned int nRaysX, unsigned int nRaysY,
+							float angleX, float angleY, float maxDistance, std::vector<raycastHit>& hits);
+
 			/**
 			* @brief Performs agent.pos() += movement;
 			*/
@@ -555,6 +688,12 @@ namespace VoxelEng {
 			*/
 			void rotateAgentViewDir(agentID agentID, blockViewDir direction);
 
+			/**
+			* @brief Make the AI agent look at 'direction' regardless of where it was looking at before.
+			* The agent is rotated with aiGame::rotateAgentViewDir(), so the rotations are recorded as usual.
+			*/
+			void setAgentViewDir(agentID agentID, blockViewDir direction);
+
 			/**
 			* @brief Rotates an entity.
 			* AI agents' view direction cannot be rotated with this method, use "aiGame::rotateAgentViewDir()" instead.
@@ -627,6 +766,14 @@ namespace VoxelEng {
 			*/
 			void playRecordTick();
 
+			/**
+			* @brief Convert the record located at 'path' + ".rec" that uses the old text format
+			* into the binary format described by 'recordHeader'. The file is replaced once the conversion is finished.
+			* All the AI actions used in the record must be registered.
+			* Returns 0 if the record was converted, 1 if the file was not found and 2 if it already uses the binary format.
+			*/
+			static unsigned int convertTextRecord(const std::string& path);
+
 
 			// Clean up.
 
@@ -646,9 +793,9 @@ namespace VoxelEng {
 			static std::atomic<bool> recording_,
 									 recordAgentModifiedBlocks_,
 								     gameInProgress_;
-			static std::ofstream saveFile_;
-			static std::string saveDataBuffer_, 
-							   saveFileName_;
+			static asyncFileWriter saveFile_;
+			static std::string saveFileName_;
+			static std::size_t recordFrameSize_; // Size in bytes of the frames of the record that is being generated or played.
 			static recordPlayMode recordPlayMode_;
 
 			// Stores a sequence of instantly followed block modifications done to each AI agent's level by the agent itself.
@@ -723,6 +870,22 @@ namespace VoxelEng {
 			*/
 			static unsigned int playRecord_(const std::string& path);
 
+			/*
+			Appends the header of a record file to 'buffer' and returns the size in bytes of the record's frames.
+			*/
+			static unsigned int writeRecordHeader_(std::string& buffer, const std::string& gameName, const std::string& terrainPath,
+												   unsigned int nChunksToCompute);
+
+			/*
+			Writes the header of the record into saveFile_ and prepares the keyframe state to record a new AI game match.
+			*/
+			static void beginRecord_(const std::string& gameName, const std::string& terrainPath);
+
+			/*
+			Writes the keyframes taken during the recording into saveFile_ and completes the record's header.
+			*/
+			static void finishRecord_();
+
 
 			// Clean up.
 
@@ -744,27 +907,36 @@ namespace VoxelEng {
 			
 			static bool initialised_,
 				        canForwardReplay_,
-				        canBackwardReplay_,
-						backwardAIactionFound_;
+				        canBackwardReplay_;
 			static aiGame* selectedGame_;
 			static std::unordered_map<std::string, aiGame*> aiGames_;
 			static std::vector<aiGame*> gamesRegisterOrder_;
 			static std::vector<AIagentAction> aiRecordActions_;
 			static std::unordered_map<std::string, unsigned int> AIactionsName_;
+			static worldProducer worldProducer_;
+			static unsigned int setBlockCode_,
+								moveEntityCode_,
+								rotateAgentViewDirCode_,
+								rotateEntityCode_,
+								inverseRotateEntityCode_,
+								createEntityCode_,
+								createAgentCode_,
+								changeActiveStateCode_;
 			
 			// Specific to recording file parsing.
-			static std::ifstream loadedFile_;
-			static std::string readFileData_,
-							   readWord_;
-			static char readCharacter_;
-			static unsigned int readActionCode_,
-							    readParamTypeInd_,
-							    readState_, // 0 = Reading aigame line.
-											// 1 = Reading level line.
-											// 2 = Reading actions.
-								lastParamInd_, // ID of the entity that has the tick function that executes a tick from the record playing process.
-								lastRawParamInd_;
+			static mappedFile loadedFile_;
+			static std::size_t recordFramesOffset_,
+							   nRecordFrames_,
+							   nextRecordFrame_; // Frame of the AI action that is played next in forward mode.
+			static unsigned int lastParamInd_; // Number of parameters available for the AI action that is being played.
 			static double oldActualTime_;
+			static std::vector<std::uint64_t> loadedKeyframes_; // File offsets of the loaded record's keyframes.
+			static unsigned int loadedKeyframeInterval_;
+			static std::atomic<std::size_t> recordSeekTarget_;
+			static std::atomic<long long> recordSeekOffset_;
+
+			// Blocks that the loaded record's AI actions have modified, with the block that was there before the first modification.
+			static std::unordered_map<vec3, block> playbackOriginalBlocks_;
 
 			// Here are allocated the parameters available for the agent actions that are going to be executed as part of a record of an AI game.
 			// The parameters are used the following way.
@@ -776,12 +948,22 @@ namespace VoxelEng {
 			// allocate said 2 float parameters in the first and second indices of the float input parameters vector, replacing any old values if they exist.
 			// The unsigned integer parameter will be allocated in the third index, overwriting any previous existing value.
 			// Third, only basic data types are supported (VoxelEng::block is a typedef of a basic data type).
-			// Last, only alphanumeric characters are allowed as char type parameteres.
 			static std::vector<agentActionArg> params_;
-			static std::deque<std::string> rawParams_;
 
 			// Specific to recording file parsing ends.
 
+			// Specific to keyframes taken while recording.
+			static std::vector<std::uint32_t> recordFrame_; // Frame of the AI action that is being recorded.
+			static unsigned int keyframeInterval_;
+			static std::size_t nRecordedFrames_;
+			static std::string recordKeyframesBuffer_;
+			static std::vector<std::uint64_t> recordKeyframeOffsets_;
+			static std::unordered_map<vec3, std::pair<block, block>> recordModifiedBlocks_; // Original and current block of each modified position.
+			static std::vector<std::vector<block>> recordAgentReplacedBlocks_; // Blocks replaced by each AI agent since the last keyframe.
+			static std::list<entityID> recordEntityIDcreationOrder_;
+			static std::list<agentID> recordAgentIDcreationOrder_;
+			// Specific to keyframes taken while recording ends.
+
 
 			/*
 			Methods.
@@ -795,18 +977,96 @@ namespace VoxelEng {
 			// Modifiers.
 
 			/*
-			Push the parameter in raw string form provided by 'param' and parses it to the corresponding type depending
-			on the 'actionCode' provided and the parameter type index related to said action code.
+			Returns the size in bytes of the frames needed to record any of the registered AI actions.
+			*/
+			static unsigned int requiredFrameSize_();
+
+			/*
+			Returns 'arg' encoded in a 4 byte word as it is stored in the record files.
+			*/
+			static std::uint32_t encodeParam_(const agentActionArg& arg);
+
+			static std::uint32_t encodeParam_(int value);
+
+			static std::uint32_t encodeParam_(unsigned int value);
+
+			static std::uint32_t encodeParam_(float value);
+
+			static std::uint32_t encodeParam_(char value);
+
+			static std::uint32_t encodeParam_(bool value);
+
+			static std::uint32_t encodeParam_(block value);
+
+			static std::uint32_t encodeParam_(blockViewDir value);
+
+			/*
+			Returns the type of AI action argument that 'value' is recorded as.
+			*/
+			static agentActionArg::type paramType_(int value);
+
+			static agentActionArg::type paramType_(unsigned int value);
+
+			static agentActionArg::type paramType_(float value);
+
+			static agentActionArg::type paramType_(char value);
+
+			static agentActionArg::type paramType_(bool value);
+
+			static agentActionArg::type paramType_(block value);
+
+			static agentActionArg::type paramType_(blockViewDir value);
+
+			/*
+			Writes into saveFile_ the AI action stored in the first 'nWords' words of recordFrame_,
+			padding the rest of the frame with zeros. Takes a keyframe before it if needed.
+			*/
+			void writeRecordFrame_(unsigned int nWords);
+
+			/*
+			Returns the parameter 'param' written in the old text record format parsed as a 4 byte word
+			of the record files. 'type' is the type of said parameter.
+			*/
+			static std::uint32_t encodeTextParam_(const std::string& param, agentActionArg::type type);
+
+			/*
+			Store in params_[index] the parameter of type 'type' encoded in 'word'.
+			*/
+			static void setParam_(unsigned int index, std::uint32_t word, agentActionArg::type type);
+
+			/*
+			Makes the parameters of the AI action recorded in the frame 'frame' of the loaded record
+			available through aiGame::getParam() and returns its action code.
+			*/
+			unsigned int readRecordFrame_(std::size_t frame);
+
+			static void appendWord_(std::string& buffer, std::uint32_t word);
+
+			static void appendFloat_(std::string& buffer, float value);
+
+			/*
+			Returns the 4 byte word located at 'cursor' and advances it to the next word.
 			*/
-			void pushParam_(const std::string& param, unsigned int actionCode, unsigned int paramTypeInd);
+			static std::uint32_t readWord_(const unsigned char*& cursor);
+
+			static float readFloat_(const unsigned char*& cursor);
+
+			/*
+			Appends to recordKeyframesBuffer_ a snapshot of the state of the match right before
+			the AI action that is about to be recorded.
+			*/
+			void takeRecordKeyframe_();
+
+			/*
+			Restores the state stored in the keyframe 'keyframe' of the loaded record and moves the playback to its tick.
+			Returns false without modifying anything if the AI agents in said keyframe do not match the current ones.
+			*/
+			bool restoreRecordKeyframe_(std::size_t keyframe);
 
 			/*
-			Same as pushParam_() but it is used to push and parse all the parameters related to the specified action
-			in 'actionCode'. The parameters (in std::string raw format as they are directly read from a recording file)
-			that are going to be pushed and parsed need to be stored in order (the first parameter in
-			the queue is the first one to be pushed and parsed) in the deque rawParams_.
+			Moves the playback of the loaded record to 'tick'.
 			*/
-			void pushParams_(unsigned int actionCode);
+			void seekRecord_(std::size_t tick);
 
 			void playActionRecordForward_(unsigned int actionCode);
 
@@ -841,6 +1101,148 @@ namespace VoxelEng {
 
 		}
 
+		template <typename... Args>
+		void aiGame::recordAction(unsigned int actionCode, Args... args) {
+
+			if (!recording_)
+				logger::errorLog("Recording mode is disabled so no AI agent action can be recorded");
+
+			if (actionCode >= aiRecordActions_.size() || aiRecordActions_[actionCode].nParams() != sizeof...(Args))
+				logger::errorLog("AI agent action with code " + std::to_string(actionCode) + " is not registered with " +
+								 std::to_string(sizeof...(Args)) + " parameters");
+
+			if (sizeof...(Args) >= recordFrame_.size())
+				logger::errorLog("AI agent action with code " + std::to_string(actionCode) + " has more parameters than the record's frames can hold");
+
+			// Otherwise the arguments would be decoded as another type when playing the record.
+			unsigned int paramIndex = 0;
+			if (!((aiRecordActions_[actionCode].paramType(paramIndex++) == paramType_(args)) && ...))
+				logger::errorLog("Argument " + std::to_string(paramIndex - 1) + " of AI agent action with code " + std::to_string(actionCode) +
+								 " does not have the type with which the action is registered");
+
+
+			std::uint32_t* word = recordFrame_.data();
+			*word++ = actionCode;
+			((*word++ = encodeParam_(args)), ...);
+
+			writeRecordFrame_(sizeof...(Args) + 1);
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(int value) {
+
+			return static_cast<std::uint32_t>(value);
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(unsigned int value) {
+
+			return value;
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(float value) {
+
+			return std::bit_cast<std::uint32_t>(value);
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(char value) {
+
+			return static_cast<unsigned char>(value);
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(bool value) {
+
+			return value;
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(block value) {
+
+			return value;
+
+		}
+
+		inline std::uint32_t aiGame::encodeParam_(blockViewDir value) {
+
+			return static_cast<std::uint32_t>(value);
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(int value) {
+
+			return agentActionArg::type::INT;
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(unsigned int value) {
+
+			return agentActionArg::type::UINT;
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(float value) {
+
+			return agentActionArg::type::FLOAT;
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(char value) {
+
+			return agentActionArg::type::CHAR;
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(bool value) {
+
+			return agentActionArg::type::BOOL;
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(block value) {
+
+			return agentActionArg::type::BLOCK;
+
+		}
+
+		inline agentActionArg::type aiGame::paramType_(blockViewDir value) {
+
+			return agentActionArg::type::BLOCKVIEWDIR;
+
+		}
+
+		inline std::size_t aiGame::nRecordTicks() {
+
+			return nRecordFrames_;
+
+		}
+
+		inline std::size_t aiGame::recordTick() {
+
+			return nextRecordFrame_;
+
+		}
+
+		inline void aiGame::seekRecord(std::size_t tick) {
+
+			recordSeekTarget_ = tick;
+
+		}
+
+		inline void aiGame::seekRecordBy(long long nTicks) {
+
+			recordSeekOffset_ += nTicks;
+
+		}
+
+		inline void aiGame::setRecordKeyframeInterval(unsigned int interval) {
+
+			keyframeInterval_ = interval;
+
+		}
+
 		inline bool aiGame::recordPaused() {
 		
 			return recordPlayMode_ == recordPlayMode::PAUSE;
@@ -948,6 +1350,12 @@ namespace VoxelEng {
 
 		}
 
+		inline void aiGame::castRays(const std::vector<vec3>& origins, const std::vector<vec3>& directions, float maxDistance, std::vector<raycastHit>& hits) {
+
+			raycast::cast(origins, directions, maxDistance, hits);
+
+		}
+
 		inline void aiGame::moveEntity(entityID entityID, const vec3& movement) {
 
 			moveEntity(entityID, movement.x, movement.y, movement.z);
@@ -998,12 +1406,45 @@ namespace VoxelEng {
 
 			// Modifiers.
 
+			/**
+			* @brief Train 'nAgents' agents of the currently selected AI game during 'nEpochs' epochs without any user interaction
+			* nor the engine's graphical mode. 'seed' is used to seed all the random number generators involved in the training
+			* and 'nThreads' is the number of threads used to evaluate the agents (0 means std::thread::hardware_concurrency()).
+			* If 'nProcesses' is not 0, the agents are evaluated instead in 'nProcesses' worker processes started from 'executable',
+			* which must call trainingGame::startFitnessWorker() when it receives the "--fitness-worker" argument.
+			* A machine-readable report with the time spent in each phase of every epoch is printed to the standard output.
+			* WARNING. The selected AI game must derive from 'trainingGame' and there cannot be another AI game in progress.
+			*/
+			static void startTraining(unsigned int nAgents, unsigned int nEpochs, unsigned int seed, unsigned int nThreads,
+									  unsigned int nProcesses = 0, const std::string& executable = "");
+
+			/**
+			* @brief Serve the fitness evaluation requests of a training session of 'nAgents' agents of the currently
+			* selected AI game that were sent through 'channel' until the training session closes it.
+			* WARNING. The selected AI game must derive from 'trainingGame' and there cannot be another AI game in progress.
+			*/
+			static void startFitnessWorker(unsigned int nAgents, processChannel& channel);
+
 		protected:
 
 			// Modifiers.
 
 			virtual void setUpTraining_(unsigned int nAgents, unsigned nEpochs) = 0;
 
+			/*
+			Called by trainingGame::startTraining() after the general set up of the AI game.
+			It must seed the AI game's random number generators with 'seed', use 'nThreads' threads for the training
+			and enable the report of the time spent in each phase of the training epochs.
+			If 'nProcesses' is not 0, the agents must be evaluated in that many worker processes started from 'executable'.
+			*/
+			virtual void setUpHeadlessTraining_(unsigned int seed, unsigned int nThreads, unsigned int nProcesses, const std::string& executable) = 0;
+
+			/*
+			Called by trainingGame::startFitnessWorker() after the set up of the training.
+			It must evaluate the agents requested through 'channel' until it is closed.
+			*/
+			virtual void serveFitnessRequests_(processChannel& channel) = 0;
+
 			virtual void train_() = 0;
 
 			virtual bool trainLoadedAgents_(const std::string& path) = 0;
@@ -1,13 +1,84 @@
 ﻿// Built-in includes.
+#include <cstring>
+#include <string>
 #include "game.h"
 #include "AIAPI.h"
 #include "logger.h"
+#include "spatialIndex.h"
 
 // Users' includes.
 #include "AI/AIGameEx1.h"
 
 
-int main() {
+/*
+Parses the arguments of a headless training session:
+--train [AI game name] [--population N] [--epochs N] [--seed N] [--threads N] [--processes N] [--fitness-cache] [--telemetry path]
+Returns false if they are not valid.
+*/
+bool parseTrainingArgs(int argc, char* argv[], std::string& gameName, unsigned int& nAgents,
+                       unsigned int& nEpochs, unsigned int& seed, unsigned int& nThreads, unsigned int& nProcesses, bool& fitnessCache,
+                       std::string& telemetryPath) {
+
+    int i = 2;
+    unsigned int* value = nullptr;
+
+
+    if (i < argc && argv[i][0] != '-')
+        gameName = argv[i++];
+
+    for (; i < argc; i++) {
+
+        if (!std::strcmp(argv[i], "--fitness-cache")) {
+
+            fitnessCache = true;
+            continue;
+
+        }
+
+        if (!std::strcmp(argv[i], "--telemetry")) {
+
+            if (++i == argc)
+                return false;
+
+            telemetryPath = argv[i];
+            continue;
+
+        }
+
+        if (!std::strcmp(argv[i], "--population"))
+            value = &nAgents;
+        else if (!std::strcmp(argv[i], "--epochs"))
+            value = &nEpochs;
+        else if (!std::strcmp(argv[i], "--seed"))
+            value = &seed;
+        else if (!std::strcmp(argv[i], "--threads"))
+            value = &nThreads;
+        else if (!std::strcmp(argv[i], "--processes"))
+            value = &nProcesses;
+        else
+            return false;
+
+        if (++i == argc)
+            return false;
+
+        try {
+
+            *value = std::stoul(argv[i]);
+
+        }
+        catch (...) {
+
+            return false;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+int main(int argc, char* argv[]) {
 
     try {
 
@@ -18,7 +89,119 @@ int main() {
         VoxelEng::AIAPI::aiGame::init();
         VoxelEng::AIAPI::aiGame::registerGame<AIExample::miningAIGame>("MiningAIGame");
 
-        VoxelEng::game::mainLoop();
+        if (argc > 1 && !std::strcmp(argv[1], "--train")) { // Headless training session.
+
+            std::string gameName = "MiningAIGame",
+                        telemetryPath;
+            unsigned int nAgents = 100,
+                         nEpochs = 10,
+                         seed = 0,
+                         nThreads = 0,
+                         nProcesses = 0;
+            bool fitnessCache = false;
+
+            if (!parseTrainingArgs(argc, argv, gameName, nAgents, nEpochs, seed, nThreads, nProcesses, fitnessCache, telemetryPath)) {
+
+                VoxelEng::logger::say("Usage: " + std::string(argv[0]) +
+                                      " --train [AI game name] [--population N] [--epochs N] [--seed N] [--threads N] [--processes N] [--fitness-cache] [--telemetry path]");
+                return 1;
+
+            }
+
+            VoxelEng::AIAPI::aiGame::selectGame(gameName);
+            if (AIExample::miningAIGame* game = dynamic_cast<AIExample::miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())) {
+
+                game->getGenetic().setFitnessCache(fitnessCache);
+                game->getGenetic().setTelemetryPath(telemetryPath);
+
+            }
+            VoxelEng::AIAPI::trainingGame::startTraining(nAgents, nEpochs, seed, nThreads, nProcesses, argv[0]);
+
+        }
+        else if (argc > 1 && !std::strcmp(argv[1], "--benchmark-inference")) { // Inference speed of the mining AI game's agents.
+
+            unsigned int nActions = 10000;
+
+            try {
+
+                if (argc > 2)
+                    nActions = std::stoul(argv[2]);
+
+            }
+            catch (...) {
+
+                VoxelEng::logger::say("Usage: " + std::string(argv[0]) + " --benchmark-inference [number of actions]");
+                return 1;
+
+            }
+
+            VoxelEng::AIAPI::aiGame::selectGame("MiningAIGame");
+            static_cast<AIExample::miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())->benchmarkInference(nActions);
+
+        }
+        else if (argc > 1 && !std::strcmp(argv[1], "--benchmark-aidata")) { // Save and load times of the mining AI game's agents.
+
+            unsigned int nAgents = 100,
+                         nRepetitions = 5;
+
+            try {
+
+                if (argc > 2)
+                    nAgents = std::stoul(argv[2]);
+                if (argc > 3)
+                    nRepetitions = std::stoul(argv[3]);
+
+            }
+            catch (...) {
+
+                VoxelEng::logger::say("Usage: " + std::string(argv[0]) + " --benchmark-aidata [number of agents] [number of repetitions]");
+                return 1;
+
+            }
+
+            VoxelEng::AIAPI::aiGame::selectGame("MiningAIGame");
+            static_cast<AIExample::miningAIGame*>(VoxelEng::AIAPI::aiGame::selectedGame())->benchmarkAgentsData(nAgents, nRepetitions);
+
+        }
+        else if (argc > 1 && !std::strcmp(argv[1], "--benchmark-spatial")) { // Entity spatial index against a brute-force scan.
+
+            unsigned int nEntities = 30000,
+                         nQueries = 2000;
+            float worldSize = 512.0f,
+                  radius = 16.0f;
+
+            try {
+
+                if (argc > 2)
+                    nEntities = std::stoul(argv[2]);
+                if (argc > 3)
+                    nQueries = std::stoul(argv[3]);
+                if (argc > 4)
+                    worldSize = std::stof(argv[4]);
+                if (argc > 5)
+                    radius = std::stof(argv[5]);
+
+            }
+            catch (...) {
+
+                VoxelEng::logger::say("Usage: " + std::string(argv[0]) + " --benchmark-spatial [number of entities] [number of queries] [world size] [radius]");
+                return 1;
+
+            }
+
+            VoxelEng::spatialIndex::benchmark(nEntities, nQueries, worldSize, radius);
+
+        }
+        else if (argc == 6 && !std::strcmp(argv[1], "--fitness-worker")) { // Started by a training session with --processes.
+
+            VoxelEng::processChannel channel(argv[4], argv[5]);
+
+            VoxelEng::AIAPI::aiGame::selectGame(argv[2]);
+            VoxelEng::AIAPI::trainingGame::startFitnessWorker(std::stoul(argv[3]), channel);
+
+        }
+        else
+            VoxelEng::game::mainLoop();
 
         // Exit game.
         VoxelEng::game::cleanUp();
@@ -0,0 +1,174 @@
+#include "asyncFileWriter.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "logger.h"
+
+
+namespace VoxelEng {
+
+	// 'asyncFileWriter' class.
+
+	asyncFileWriter::asyncFileWriter(std::size_t capacity)
+		: buffer_(std::bit_ceil(std::max<std::size_t>(capacity, 1))), mask_(buffer_.size() - 1), head_(0), tail_(0),
+		  dataSignal_(0), spaceSignal_(0), stop_(false), failed_(false)
+	{}
+
+	void asyncFileWriter::open(const std::string& path) {
+
+		if (isOpen())
+			logger::errorLog("File " + path_ + " is already opened for writing");
+
+		file_.open(path, std::ios::binary | std::ios::trunc);
+		if (!file_.is_open())
+			logger::errorLog("Could not open file " + path + " for writing");
+
+		path_ = path;
+		head_ = 0;
+		tail_ = 0;
+		stop_ = false;
+		failed_ = false;
+		writer_ = std::thread(&asyncFileWriter::writerLoop, this);
+
+	}
+
+	void asyncFileWriter::write(const void* data, std::size_t size) {
+
+		const char* source = static_cast<const char*>(data);
+		std::size_t head = head_.load(std::memory_order_relaxed),
+					freeSpace = 0,
+					chunkSize = 0;
+		std::uint64_t signal = 0;
+
+
+		while (size) {
+
+			signal = spaceSignal_.load(std::memory_order_acquire);
+			freeSpace = buffer_.size() - (head - tail_.load(std::memory_order_acquire));
+			if (freeSpace == 0) { // Ring buffer full. Wait for the writing thread.
+
+				spaceSignal_.wait(signal, std::memory_order_acquire);
+				continue;
+
+			}
+
+			// Copy up to the end of the ring buffer at most. The rest is copied in the next iteration.
+			chunkSize = std::min({size, freeSpace, buffer_.size() - (head & mask_)});
+			std::memcpy(buffer_.data() + (head & mask_), source, chunkSize);
+
+			head += chunkSize;
+			source += chunkSize;
+			size -= chunkSize;
+			head_.store(head, std::memory_order_release);
+
+		}
+
+		dataSignal_.fetch_add(1, std::memory_order_release);
+		dataSignal_.notify_one();
+
+	}
+
+	void asyncFileWriter::flush() {
+
+		std::uint64_t signal = 0;
+
+
+		while (true) {
+
+			signal = spaceSignal_.load(std::memory_order_acquire);
+			if (tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_relaxed))
+				break;
+
+			spaceSignal_.wait(signal, std::memory_order_acquire);
+
+		}
+
+	}
+
+	void asyncFileWriter::patch(std::size_t offset, const void* data, std::size_t size) {
+
+		if (offset + size > bytesWritten())
+			logger::errorLog("Cannot patch a region of file " + path_ + " that has not been written yet");
+
+		flush();
+
+		std::unique_lock<std::mutex> lock(fileMutex_);
+		file_.seekp(offset);
+		file_.write(static_cast<const char*>(data), size);
+		file_.seekp(0, std::ios::end);
+		if (!file_)
+			failed_ = true;
+
+	}
+
+	void asyncFileWriter::close() {
+
+		if (isOpen()) {
+
+			stop_ = true;
+			dataSignal_.fetch_add(1, std::memory_order_release);
+			dataSignal_.notify_one();
+			writer_.join();
+
+			file_.close();
+			if (failed_ || file_.fail())
+				logger::errorLog("Could not write file " + path_);
+
+		}
+
+	}
+
+	asyncFileWriter::~asyncFileWriter() {
+
+		try {
+
+			close();
+
+		}
+		catch (...) {}
+
+	}
+
+	void asyncFileWriter::writerLoop() {
+
+		std::size_t tail = tail_.load(std::memory_order_relaxed),
+					head = 0,
+					chunkSize = 0;
+		std::uint64_t signal = 0;
+
+
+		while (true) {
+
+			signal = dataSignal_.load(std::memory_order_acquire);
+			head = head_.load(std::memory_order_acquire);
+
+			if (head == tail) {
+
+				if (stop_)
+					break;
+
+				dataSignal_.wait(signal, std::memory_order_acquire);
+				continue;
+
+			}
+
+			// Write up to the end of the ring buffer at most. The rest is written in the next iteration.
+			chunkSize = std::min(head - tail, buffer_.size() - (tail & mask_));
+			{
+
+				std::unique_lock<std::mutex> lock(fileMutex_);
+				if (!file_.write(buffer_.data() + (tail & mask_), chunkSize))
+					failed_ = true;
+
+			}
+
+			tail += chunkSize;
+			tail_.store(tail, std::memory_order_release);
+			spaceSignal_.fetch_add(1, std::memory_order_release);
+			spaceSignal_.notify_all();
+
+		}
+
+	}
+
+}
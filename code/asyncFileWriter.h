@@ -0,0 +1,151 @@
+/**
+* @file asyncFileWriter.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Asynchronous file writer.
+* @brief Contains the declaration of the 'asyncFileWriter' class.
+*/
+#ifndef _VOXELENG_ASYNCFILEWRITER_
+#define _VOXELENG_ASYNCFILEWRITER_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace VoxelEng {
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Writes data into a binary file from a background thread.
+	* The data is copied into a preallocated ring buffer that a dedicated thread drains into the file,
+	* so writing it does not allocate heap memory nor wait for the disk unless the ring buffer is full.
+	* Only one thread may write data at a time.
+	*/
+	class asyncFileWriter {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Create a writer whose ring buffer can hold 'capacity' bytes.
+		* 'capacity' is rounded up to the next power of two.
+		*/
+		asyncFileWriter(std::size_t capacity = 1 << 20);
+
+		asyncFileWriter(const asyncFileWriter&) = delete;
+
+		asyncFileWriter& operator=(const asyncFileWriter&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns true if a file is currently opened or false otherwise.
+		*/
+		bool isOpen() const;
+
+		/**
+		* @brief Returns the number of bytes written since the file was opened,
+		* including the ones that are still waiting in the ring buffer.
+		*/
+		std::size_t bytesWritten() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Create (or truncate) the file located at 'path' and start the thread that writes into it.
+		* Throws an exception if the file could not be opened or if another file is already opened.
+		*/
+		void open(const std::string& path);
+
+		/**
+		* @brief Append 'size' bytes from 'data' to the file.
+		* Only waits if there is not enough free space in the ring buffer.
+		*/
+		void write(const void* data, std::size_t size);
+
+		/**
+		* @brief Wait until all the data written so far has been handed to the file.
+		*/
+		void flush();
+
+		/**
+		* @brief Overwrite 'size' bytes of the file starting at the position 'offset' with 'data'.
+		* All the data written so far is flushed first. The overwritten region must have already been written.
+		*/
+		void patch(std::size_t offset, const void* data, std::size_t size);
+
+		/**
+		* @brief Flush all the data written so far, stop the writing thread and close the file.
+		* Throws an exception if any write into the file failed.
+		*/
+		void close();
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		* Closes the file if it is opened ignoring any errors.
+		*/
+		~asyncFileWriter();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		std::vector<char> buffer_;
+		std::size_t mask_;
+		std::string path_;
+		std::ofstream file_;
+		std::mutex fileMutex_;
+		std::thread writer_;
+
+		// 'head_' is only advanced by asyncFileWriter::write() and 'tail_' by the background thread.
+		// Both only grow, so their difference is the number of bytes waiting in the ring buffer.
+		std::atomic<std::size_t> head_,
+								 tail_;
+
+		// Counters used to wait for new data ('dataSignal_') or free space ('spaceSignal_') without losing wake-ups.
+		std::atomic<std::uint64_t> dataSignal_,
+								   spaceSignal_;
+		std::atomic<bool> stop_,
+						  failed_;
+
+
+		/*
+		Methods.
+		*/
+
+		void writerLoop();
+
+	};
+
+	inline bool asyncFileWriter::isOpen() const {
+
+		return writer_.joinable();
+
+	}
+
+	inline std::size_t asyncFileWriter::bytesWritten() const {
+
+		return head_.load(std::memory_order_relaxed);
+
+	}
+
+}
+
+#endif
@@ -1,8 +1,16 @@
 #include "batch.h"
+#include <cstring>
 #include <string>
 #include <iterator>
 #include "definitions.h"
 #include "logger.h"
+#include "worldContext.h"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86_FP)
+
+#include <xmmintrin.h>
+
+#endif
 
 
 namespace VoxelEng {
@@ -11,10 +19,19 @@ namespace VoxelEng {
 	// 'batch' class.
 
 	batch::batch() 
-	: dirty_(false) {}
+	: dirty_(false), layoutDirty_(true) {
+	
+		model_.reserve(BATCH_MAX_VERTEX_COUNT);
+	
+	}
 
 	batch::batch(const batch& b) 
-	: dirty_(b.dirty_.load()), activeEntityID_(b.activeEntityID_), inactiveEntityID_(b.inactiveEntityID_), model_(b.model_) {}
+	: dirty_(b.dirty_.load()), activeEntityID_(b.activeEntityID_), inactiveEntityID_(b.inactiveEntityID_), model_(b.model_),
+	  slots_(b.slots_), layoutDirty_(b.layoutDirty_) {
+	
+		model_.reserve(BATCH_MAX_VERTEX_COUNT);
+	
+	}
 
 	const void* batch::data() {
 
@@ -45,8 +62,7 @@ namespace VoxelEng {
 		std::unique_lock<std::recursive_mutex> lock(mutex_);
 
 		if (entityManager::isEntityRegistered(entityID))
-			return activeEntityID_.find(entityID) != activeEntityID_.cend() ||
-				   inactiveEntityID_.find(entityID) != inactiveEntityID_.cend();
+			return contains_(activeEntityID_, entityID) || contains_(inactiveEntityID_, entityID);
 		else
 			logger::errorLog("No entity with ID " + std::to_string(entityID) + " is registered");
 	
@@ -56,8 +72,7 @@ namespace VoxelEng {
 
 		std::unique_lock<std::recursive_mutex> lock(mutex_);
 
-		return activeEntityID_.find(entityID) != activeEntityID_.cend() ||
-			   inactiveEntityID_.find(entityID) != inactiveEntityID_.cend();
+		return contains_(activeEntityID_, entityID) || contains_(inactiveEntityID_, entityID);
 
 	}
 
@@ -82,7 +97,8 @@ namespace VoxelEng {
 
 		if (model_.size() + entityManager::getEntity(entityID).entityModel().size() <= BATCH_MAX_VERTEX_COUNT) {
 
-			activeEntityID_.insert(entityID);
+			insert_(activeEntityID_, entityID);
+			layoutDirty_ = true;
 			dirty_ = true;
 
 			return true;
@@ -118,16 +134,21 @@ namespace VoxelEng {
 
 	bool batch::changeActiveState(entityID entityID, bool active) {
 
+		std::unique_lock<std::recursive_mutex> lock(mutex_);
+
+		layoutDirty_ = true;
+		dirty_ = true;
+
 		if (active) {
 
-			inactiveEntityID_.erase(entityID);
-			activeEntityID_.insert(entityID);
+			erase_(inactiveEntityID_, entityID);
+			insert_(activeEntityID_, entityID);
 
 		}
 		else {
 
-			inactiveEntityID_.insert(entityID);
-			activeEntityID_.erase(entityID);
+			erase_(activeEntityID_, entityID);
+			insert_(inactiveEntityID_, entityID);
 
 		}
 
@@ -154,10 +175,11 @@ namespace VoxelEng {
 		std::unique_lock<std::recursive_mutex> lock(mutex_);
 
 		if (entityManager::isEntityActive(entityID))
-			activeEntityID_.erase(entityID);
+			erase_(activeEntityID_, entityID);
 		else
-			inactiveEntityID_.erase(entityID);
+			erase_(inactiveEntityID_, entityID);
 
+		layoutDirty_ = true;
 		dirty_ = true;
 
 		return !(activeEntityID_.size() + inactiveEntityID_.size());
@@ -166,89 +188,30 @@ namespace VoxelEng {
 	
 	const model& batch::generateVertices() {
 
-		float sinAngleX,
-			  cosAngleX,
-			  sinAngleY,
-			  cosAngleY,
-			  sinAngleZ,
-			  cosAngleZ,
-			  oldFirstCoord,
-			  oldSecondCoord;
-		model entityModel;
-		bool updateXRot,
-			 updateYRot,
-			 updateZRot;
-
-
 		std::unique_lock<std::recursive_mutex> lock(mutex_);
 
-		model_.clear();
-		for (auto it = activeEntityID_.cbegin(); it != activeEntityID_.cend(); it++) {
-
-			entity& selectedEntity = entityManager::getEntity(*it);
-			entityModel = selectedEntity.entityModel();
-
-			if (entityModel.size()) {
-			
-				sinAngleX = selectedEntity.sinAngleX();
-				cosAngleX = selectedEntity.cosAngleX();
-				sinAngleY = selectedEntity.sinAngleY();
-				cosAngleY = selectedEntity.cosAngleY();
-				sinAngleZ = selectedEntity.sinAngleZ();
-				cosAngleZ = selectedEntity.cosAngleZ();
-				updateXRot = selectedEntity.updateXRotation();
-				updateYRot = selectedEntity.updateYRotation();
-				updateZRot = selectedEntity.updateZRotation();
-
-				// Translate the model's copy to the entity's position and apply rotations if necessary.
-				for (unsigned int j = 0; j < entityModel.size(); j++) {
-
-					// Rotate.
-					if (updateXRot) {
-
-						oldFirstCoord = entityModel[j].positions[1];
-						oldSecondCoord = entityModel[j].positions[2];
 
-						entityModel[j].positions[1] = oldFirstCoord * cosAngleX -
-							oldSecondCoord * sinAngleX;
-						entityModel[j].positions[2] = oldFirstCoord * sinAngleX +
-							oldSecondCoord * cosAngleX;
+		// A model with a different number of vertices does not fit in its entity's slot anymore.
+		for (std::size_t i = 0; !layoutDirty_ && i < slots_.size(); i++)
+			layoutDirty_ = entityManager::getEntity(slots_[i].ID).entityModel().size() != slots_[i].nVertices;
 
-					}
+		if (layoutDirty_)
+			layOutSlots_();
 
-					if (updateYRot) {
+		for (std::size_t i = 0; i < slots_.size(); i++) {
 
-						oldFirstCoord = entityModel[j].positions[0];
-						oldSecondCoord = entityModel[j].positions[2];
+			batchSlot& slot = slots_[i];
+			const entity selectedEntity = entityManager::getEntity(slot.ID);
 
-						entityModel[j].positions[0] = oldFirstCoord * cosAngleY +
-							oldSecondCoord * sinAngleY;
-						entityModel[j].positions[2] = oldSecondCoord * cosAngleY -
-							oldFirstCoord * sinAngleY;
+			if (!slot.written || slot.entityModel != &selectedEntity.entityModel() || slot.pos != selectedEntity.pos() || slot.rot != selectedEntity.rot()) {
 
-					}
+				writeEntityVertices_(selectedEntity, model_.data() + slot.offset);
 
-					if (updateZRot) {
+				slot.entityModel = &selectedEntity.entityModel();
+				slot.pos = selectedEntity.pos();
+				slot.rot = selectedEntity.rot();
+				slot.written = true;
 
-						oldFirstCoord = entityModel[j].positions[0];
-						oldSecondCoord = entityModel[j].positions[1];
-
-						entityModel[j].positions[0] = oldFirstCoord * cosAngleZ -
-							oldSecondCoord * sinAngleZ;
-						entityModel[j].positions[1] = oldFirstCoord * sinAngleZ +
-							oldSecondCoord * cosAngleZ;
-
-					}
-
-					// Translate.
-					entityModel[j].positions[0] += selectedEntity.x();
-					entityModel[j].positions[1] += selectedEntity.y();
-					entityModel[j].positions[2] += selectedEntity.z();
-
-					model_.push_back(entityModel[j]);
-
-				}
-			
 			}
 
 		}
@@ -274,7 +237,128 @@ namespace VoxelEng {
 		inactiveEntityID_.clear();
 
 		model_.clear();
+		slots_.clear();
+		layoutDirty_ = true;
 	
 	}
 
+	bool batch::contains_(const std::vector<entityID>& IDs, entityID entityID) {
+
+		const std::vector<unsigned int>& slot = worldContext::selected().entityBatchSlot_;
+
+
+		// The positions of entities that left the batch are not cleared, so the stored position is checked.
+		return entityID < slot.size() && slot[entityID] < IDs.size() && IDs[slot[entityID]] == entityID;
+
+	}
+
+	void batch::insert_(std::vector<entityID>& IDs, entityID entityID) {
+
+		std::vector<unsigned int>& slot = worldContext::selected().entityBatchSlot_;
+
+
+		if (!contains_(IDs, entityID)) {
+
+			if (entityID >= slot.size())
+				slot.resize(entityID + 1);
+
+			slot[entityID] = IDs.size();
+			IDs.push_back(entityID);
+
+		}
+
+	}
+
+	void batch::erase_(std::vector<entityID>& IDs, entityID entityID) {
+
+		std::vector<unsigned int>& slot = worldContext::selected().entityBatchSlot_;
+
+
+		if (contains_(IDs, entityID)) {
+
+			IDs[slot[entityID]] = IDs.back();
+			slot[IDs.back()] = slot[entityID];
+			IDs.pop_back();
+
+		}
+
+	}
+
+	void batch::layOutSlots_() {
+
+		std::size_t nVertices = 0;
+
+
+		slots_.clear();
+		for (std::size_t i = 0; i < activeEntityID_.size(); i++) {
+
+			std::size_t nModelVertices = entityManager::getEntity(activeEntityID_[i]).entityModel().size();
+
+			slots_.push_back({ activeEntityID_[i], nVertices, nModelVertices, nullptr, vec3Zero, vec3Zero, false });
+			nVertices += nModelVertices;
+
+		}
+
+		// Within the reserved capacity, so no reallocation takes place.
+		model_.resize(nVertices);
+		layoutDirty_ = false;
+
+	}
+
+	void batch::writeEntityVertices_(const entity& selectedEntity, vertex* destination) {
+
+		const model& entityModel = selectedEntity.entityModel();
+		const vec3& pos = selectedEntity.pos();
+		float sinX = selectedEntity.updateXRotation() ? selectedEntity.sinAngleX() : 0.0f,
+			  cosX = selectedEntity.updateXRotation() ? selectedEntity.cosAngleX() : 1.0f,
+			  sinY = selectedEntity.updateYRotation() ? selectedEntity.sinAngleY() : 0.0f,
+			  cosY = selectedEntity.updateYRotation() ? selectedEntity.cosAngleY() : 1.0f,
+			  sinZ = selectedEntity.updateZRotation() ? selectedEntity.sinAngleZ() : 0.0f,
+			  cosZ = selectedEntity.updateZRotation() ? selectedEntity.cosAngleZ() : 1.0f;
+
+		// Columns of the rotation around the X axis followed by the one around the Y axis and the one around the Z axis.
+		float column0[3] = { cosZ * cosY, sinZ * cosY, -sinY },
+			  column1[3] = { cosZ * sinY * sinX - sinZ * cosX, sinZ * sinY * sinX + cosZ * cosX, cosY * sinX },
+			  column2[3] = { cosZ * sinY * cosX + sinZ * sinX, sinZ * sinY * cosX - cosZ * sinX, cosY * cosX };
+
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86_FP)
+
+		__m128 c0 = _mm_setr_ps(column0[0], column0[1], column0[2], 0.0f),
+			   c1 = _mm_setr_ps(column1[0], column1[1], column1[2], 0.0f),
+			   c2 = _mm_setr_ps(column2[0], column2[1], column2[2], 0.0f),
+			   translation = _mm_setr_ps(pos.x, pos.y, pos.z, 0.0f),
+			   transformed;
+		alignas(16) float result[4];
+
+		for (std::size_t i = 0; i < entityModel.size(); i++) {
+
+			const vertex& source = entityModel[i];
+
+			transformed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(source.positions[0])), _mm_mul_ps(c1, _mm_set1_ps(source.positions[1]))),
+									 _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(source.positions[2])), translation));
+			_mm_store_ps(result, transformed);
+
+			destination[i] = source;
+			std::memcpy(destination[i].positions, result, sizeof(destination[i].positions));
+
+		}
+
+#else
+
+		for (std::size_t i = 0; i < entityModel.size(); i++) {
+
+			const vertex& source = entityModel[i];
+
+			destination[i] = source;
+			destination[i].positions[0] = column0[0] * source.positions[0] + column1[0] * source.positions[1] + column2[0] * source.positions[2] + pos.x;
+			destination[i].positions[1] = column0[1] * source.positions[0] + column1[1] * source.positions[1] + column2[1] * source.positions[2] + pos.y;
+			destination[i].positions[2] = column0[2] * source.positions[0] + column1[2] * source.positions[1] + column2[2] * source.positions[2] + pos.z;
+
+		}
+
+#endif
+
+	}
+
 }
\ No newline at end of file
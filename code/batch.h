@@ -10,9 +10,9 @@
 
 #ifndef _VOXELENG_BATCH_
 #define _VOXELENG_BATCH_
-#include <unordered_set>
 #include <atomic>
 #include <cstddef>
+#include <vector>
 #include "model.h"
 #include "entity.h"
 #include "gameWindow.h"
@@ -37,6 +37,27 @@ namespace VoxelEng {
 	class entity;
 
 
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief Location of an entity's vertices inside its batch's vertex data and the state of the entity
+	* when they were last written.
+	*/
+	struct batchSlot {
+
+		entityID ID;
+		std::size_t offset,
+					nVertices;
+		const model* entityModel;
+		vec3 pos,
+			 rot;
+		bool written;
+
+	};
+
+
 	////////////
 	//Classes.//
 	////////////
@@ -155,6 +176,8 @@ namespace VoxelEng {
 		/**
 		* @brief Generates new vertices based on the entities that are in the batch and
 		* their positions/rotations/states...
+		* Each active entity owns a slot of the batch's vertex data, so only the vertices of the entities
+		* that moved, rotated or changed their model since the last call are written again.
 		* Sets the batch as not dirty.
 		* WARNING. It overwrites any other vertex data stored inside the batch.
 		*/
@@ -170,12 +193,51 @@ namespace VoxelEng {
 		std::recursive_mutex mutex_; // FOR TESTING ONLY.
 	private:
 
+		/*
+		Attributes.
+		*/
+
 		std::atomic<bool> dirty_;
-		std::unordered_set<unsigned int> activeEntityID_,
-										 inactiveEntityID_;
-		model model_;
 
-		
+		// Only as large as the number of entities in the batch. The position of each entity inside
+		// the list it belongs to is stored in the level's 'entityBatchSlot_', shared by all its batches.
+		std::vector<entityID> activeEntityID_,
+							  inactiveEntityID_;
+		model model_; // Its capacity is reserved for BATCH_MAX_VERTEX_COUNT vertices on construction.
+		std::vector<batchSlot> slots_; // One slot per active entity, in the same order as their vertices.
+		bool layoutDirty_; // True if the slots must be assigned again because the active entities changed.
+
+
+		/*
+		Methods.
+		*/
+
+		/*
+		Returns true if the entity is in 'IDs', which must be 'activeEntityID_' or 'inactiveEntityID_'.
+		*/
+		static bool contains_(const std::vector<entityID>& IDs, entityID entityID);
+
+		/*
+		Add the entity to 'IDs', which must be 'activeEntityID_' or 'inactiveEntityID_'.
+		Does nothing if it is already in it.
+		*/
+		static void insert_(std::vector<entityID>& IDs, entityID entityID);
+
+		/*
+		Remove the entity from 'IDs', which must be 'activeEntityID_' or 'inactiveEntityID_',
+		moving the last entity of the list to its position. Does nothing if it is not in it.
+		*/
+		static void erase_(std::vector<entityID>& IDs, entityID entityID);
+
+		/*
+		Assign a slot in 'model_' to each active entity.
+		*/
+		void layOutSlots_();
+
+		/*
+		Write the vertices of 'selectedEntity's model rotated and translated to its position into 'destination'.
+		*/
+		static void writeEntityVertices_(const entity& selectedEntity, vertex* destination);
 
 	};
 
@@ -11,12 +11,13 @@ namespace VoxelEng {
 
     camera::camera(float FOV, float zNear, float zFar, window& window, bool isPlayerCamera,
         const vec3& position, const vec3& direction)
-        : window_(window), moveUp_(false), moveDown_(false), moveNorth_(false), moveSouth_(false), moveEast_(false), moveWest_(false),
+        : window_(window), moveUp_(false), moveDown_(false), moveNorth_(false), moveSouth_(false), moveEast_(false), moveWest_(false), collisions_(false),
         FOV_(FOV), zNear_(zNear), zFar_(zFar), angleX_(0), angleY_(0), mouseSensibility_(0.25f), movementSpeed_(5.0f),
         mouseX_(0), mouseY_(0), oldMouseX_(0), oldMouseY_(0),
         projectionMatrix_(glm::perspective(glm::radians(FOV_), static_cast<float>(window.width()) / window.height(), zNear_, zFar_)),
         viewMatrix_(glm::mat4(1.0f)), position_(position), direction_(direction),
-        modelMatrix_(glm::mat4(1.0f)), upAxis_(vec3(0.0f, 1.0f, 0.0f)) {
+        modelMatrix_(glm::mat4(1.0f)), upAxis_(vec3(0.0f, 1.0f, 0.0f)),
+        hitbox_(vec3(-0.3f, -1.5f, -0.3f), vec3(0.3f, 0.2f, 0.3f)) {
 
         chunkPosition_.x = trunc(position_.x / SCX);
         chunkPosition_.y = trunc(position_.y / SCY);
@@ -75,6 +76,9 @@ namespace VoxelEng {
 
     void camera::updatePos(float timeStep) {
 
+        vec3 oldPosition = position_;
+
+
         oldChunkPos_ = chunkPosition_;
 
         // Camera's movement.
@@ -120,6 +124,10 @@ namespace VoxelEng {
 
         }
 
+        // Redo the movement as a single sweep through the level so that the camera cannot go through blocks.
+        if (collisions_ && position_ != oldPosition)
+            position_ = oldPosition + hitbox_.translated(oldPosition).sweep(position_ - oldPosition).movement;
+
         // Update chunk-relative coordinates.
         chunkPosition_.x = trunc(position_.x / SCX);
         chunkPosition_.y = trunc(position_.y / SCY);
@@ -22,6 +22,7 @@
 #include "definitions.h"
 #include "chunk.h"
 #include "gameWindow.h"
+#include "hitbox.h"
 
 
 namespace VoxelEng {
@@ -118,6 +119,16 @@ namespace VoxelEng {
 		*/
 		const vec3& pos() const;
 
+		/**
+		* @brief Returns true if the camera's movement collides with the level's blocks or false otherwise.
+		*/
+		bool collisions() const;
+
+		/**
+		* @brief Get the camera's hitbox, relative to its position.
+		*/
+		const hitbox& collisionBox() const;
+
 
 		// Modifiers.
 
@@ -164,6 +175,17 @@ namespace VoxelEng {
 		*/
 		glm::mat4& modelMatrix();
 
+		/**
+		* @brief Enable or disable the collisions of the camera's movement with the level's blocks.
+		* They are disabled by default.
+		*/
+		bool& collisions();
+
+		/**
+		* @brief Provide access to the camera's hitbox, relative to its position.
+		*/
+		hitbox& collisionBox();
+
 		/**
 		* @brief Set the camera's position.
 		*/
@@ -263,7 +285,8 @@ namespace VoxelEng {
 			 moveNorth_,
 			 moveSouth_,
 			 moveEast_,
-			 moveWest_;
+			 moveWest_,
+			 collisions_;
 		float FOV_,
 			 zNear_,
 			 zFar_,
@@ -284,6 +307,7 @@ namespace VoxelEng {
 			 upAxis_,
 			 chunkPosition_,
 			 oldChunkPos_;
+		hitbox hitbox_;
 
 	};
 
@@ -353,6 +377,18 @@ namespace VoxelEng {
 
 	}
 
+	inline bool camera::collisions() const {
+
+		return collisions_;
+
+	}
+
+	inline const hitbox& camera::collisionBox() const {
+
+		return hitbox_;
+
+	}
+
 	inline camera* camera::playerCamera() {
 
 		return playerCamera_;
@@ -389,6 +425,18 @@ namespace VoxelEng {
 
 	}
 
+	inline bool& camera::collisions() {
+
+		return collisions_;
+
+	}
+
+	inline hitbox& camera::collisionBox() {
+
+		return hitbox_;
+
+	}
+
 	inline void camera::setPos(const vec3& newPos) {
 
 		setPos(newPos.x, newPos.y, newPos.z);
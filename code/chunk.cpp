@@ -8,6 +8,8 @@
 #include <cstdlib>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
+#include "commandBuffer.h"
 #include "input.h"
 #include "gui.h"
 #include "logger.h"
@@ -54,7 +56,7 @@ namespace VoxelEng {
     }
 
     chunk::chunk(bool empty, const vec3& chunkPos)
-    : nBlocks_(0) {
+    : nBlocks_(0), version_(0) {
 
         renderingData_.chunkPos = chunkPos;
 
@@ -74,7 +76,7 @@ namespace VoxelEng {
     }
 
     chunk::chunk(const chunk& chunk)
-    : nBlocks_(chunk.nBlocks_.load()) {
+    : nBlocks_(chunk.nBlocks_.load()), version_(0) {
 
         std::unique_lock<std::shared_mutex> lock(blocksMutex_);
 
@@ -112,6 +114,7 @@ namespace VoxelEng {
         std::unique_lock<std::shared_mutex> lock(blocksMutex_);
 
         changed_ = true;
+        version_++;
 
         if (blocks_[x][y][z] == 0 && blockID != 0)
             nBlocks_++;
@@ -130,6 +133,7 @@ namespace VoxelEng {
         std::unique_lock<std::shared_mutex> lock(blocksMutex_);
 
         changed_ = true;
+        version_++;
 
         if (blocks_[x][y][z] == 0 && blockID != 0)
             nBlocks_++;
@@ -152,6 +156,7 @@ namespace VoxelEng {
         std::unique_lock<std::shared_mutex> lock(blocksMutex_);
 
         changed_ = true;
+        version_++;
 
         if (blocks_[x][y][z] == 0 && blockID != 0)
             nBlocks_++;
@@ -403,6 +408,7 @@ namespace VoxelEng {
         std::unique_lock<std::shared_mutex> lock(blocksMutex_);
 
         changed_ = true;
+        version_++;
         nBlocks_ = 0;
 
         for (GLbyte x = 0; x < SCX; x++)
@@ -412,6 +418,33 @@ namespace VoxelEng {
 
     }
 
+    void chunk::copyBlocks(block* blocks) {
+
+        std::shared_lock<std::shared_mutex> lock(blocksMutex_);
+
+        std::memcpy(blocks, &blocks_[0][0][0], sizeof(blocks_));
+
+    }
+
+    void chunk::setBlocks(const block* blocks) {
+
+        unsigned int nBlocks = 0;
+
+
+        std::unique_lock<std::shared_mutex> lock(blocksMutex_);
+
+        changed_ = true;
+        version_++;
+
+        std::memcpy(&blocks_[0][0][0], blocks, sizeof(blocks_));
+
+        for (unsigned int i = 0; i < SCX * SCY * SCZ; i++)
+            if (blocks[i])
+                nBlocks++;
+        nBlocks_ = nBlocks;
+
+    }
+
     void chunk::regenChunk(bool empty, const vec3& chunkPos) {
     
         makeEmpty();
@@ -436,8 +469,6 @@ namespace VoxelEng {
 
     bool chunkManager::initialised_ = false,
          chunkManager::infiniteWorld_ = false;
-    int chunkManager::nChunksToCompute_ = 0;
-    std::unordered_map<vec3, chunk*> chunkManager::chunks_;
     std::unordered_map<vec3, std::vector<vertex>>* chunkManager::drawableChunksWrite_ = nullptr,
                                                  * chunkManager::drawableChunksRead_ = nullptr;
     std::deque<chunk*> chunkManager::freeChunks_;
@@ -451,7 +482,6 @@ namespace VoxelEng {
                chunkManager::loadingTerrainMutex_;
     std::shared_mutex chunkManager::highPriorityMutex_;
     std::recursive_mutex chunkManager::drawableChunksWriteMutex_,
-                         chunkManager::chunksMutex_,
                          chunkManager::freeChunksMutex_,
                          chunkManager::priorityMeshingListMutex_;
     std::condition_variable chunkManager::managerThreadCV_,
@@ -465,14 +495,11 @@ namespace VoxelEng {
     const unsigned int chunkManager::parseChunkPosStates_ = 2;
     std::string chunkManager::openedTerrainFileName_ = "";
 
-    std::unordered_map<unsigned int, std::unordered_map<vec3, bool>> chunkManager::AIChunkAvailable_;
-    std::unordered_map<unsigned int, std::unordered_map<vec3, chunk*>> chunkManager::AIagentChunks_;
-    unsigned int chunkManager::selectedAIWorld_ = 0;
 
-    bool chunkManager::originalWorldAccess_ = true;
+    void chunkManager::init(unsigned int nChunksToCompute) {
 
+        worldContext& context = worldContext::selected();
 
-    void chunkManager::init(unsigned int nChunksToCompute) {
 
         if (initialised_)
             logger::errorLog("Chunk management system was already initialised");
@@ -480,19 +507,19 @@ namespace VoxelEng {
 
             infiniteWorld_ = false;
 
-            nChunksToCompute_ = nChunksToCompute;
+            context.nChunksToCompute_ = nChunksToCompute;
 
             forceSyncFlag_ = false;
             waitTerrainLoaded_ = true;
 
             openedTerrainFileName_ = "";
 
-            originalWorldAccess_ = true;
+            context.originalWorldAccess_ = true;
 
             initialised_ = true;
 
             parseChunkPosState_ = 0;
-            selectedAIWorld_ = 0;
+            context.selectedAIWorld_ = 0;
 
             if (!game::AImodeON()) {
             
@@ -519,20 +546,21 @@ namespace VoxelEng {
 
     block chunkManager::getBlock(int posX, int posY, int posZ) {
 
+        worldContext& context = worldContext::selected();
         block selectedBlock = 0;
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
 
         if (game::AImodeON()) {
 
-            if (originalWorldAccess_ || AIagentChunks_.find(selectedAIWorld_) == AIagentChunks_.cend())
+            if (context.originalWorldAccess_ || context.AIagentChunks_.find(context.selectedAIWorld_) == context.AIagentChunks_.cend())
                 selectedBlock = getBlockOGWorld_(posX, posY, posZ);
             else {
 
-                std::unordered_map<vec3, chunk*>& AgentChunk = AIagentChunks_[selectedAIWorld_];
+                std::unordered_map<vec3, chunk*>& AgentChunk = context.AIagentChunks_[context.selectedAIWorld_];
                 vec3 chunkPos = getChunkCoords(posX, posY, posZ);
 
-                if (AgentChunk.find(chunkPos) == AgentChunk.cend() || !AIChunkAvailable_[selectedAIWorld_][chunkPos])
+                if (AgentChunk.find(chunkPos) == AgentChunk.cend() || !context.AIChunkAvailable_[context.selectedAIWorld_][chunkPos])
                     selectedBlock = getBlockOGWorld_(posX, posY, posZ);
                 else
                     selectedBlock = AgentChunk[chunkPos]->getBlock(floorMod(posX, SCX), floorMod(posY, SCY), floorMod(posZ, SCZ));
@@ -550,6 +578,7 @@ namespace VoxelEng {
 
     std::vector<block> chunkManager::getBlocksBox(int x1, int y1, int z1, int x2, int y2, int z2) {
 
+        worldContext& context = worldContext::selected();
         std::vector<block> blocks;
         int iInc = (x1 <= x2) ? 1 : -1,
             jInc = (y1 <= y2) ? 1 : -1,
@@ -559,7 +588,7 @@ namespace VoxelEng {
         z2 += kInc;
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
         for (int i = x1; i != x2; i += iInc) // No merece la pena hacer cach porque las posiciones de los bloques pueden estar puestas "a mala leche" y seguir dando un peor caso.
             for (int j = y1; j != y2; j += jInc)
                 for (int k = z1; k != z2; k += kInc)
@@ -571,9 +600,10 @@ namespace VoxelEng {
 
     chunkLoadLevel chunkManager::getChunkLoadLevel(const vec3& chunkPos) {
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        return (chunks_.find(chunkPos) != chunks_.cend() ? chunks_[chunkPos]->loadLevel() : chunkLoadLevel::NOTLOADED);
+        return (context.chunks_.find(chunkPos) != context.chunks_.cend() ? context.chunks_[chunkPos]->loadLevel() : chunkLoadLevel::NOTLOADED);
 
     }
 
@@ -610,11 +640,14 @@ namespace VoxelEng {
 
     void chunkManager::setNChunksToCompute(unsigned int nChunksToCompute) {
     
+        worldContext& context = worldContext::selected();
+
+
         // That is, if terrain has already been loaded, the number of chunks to compute
         // cannot be changed (for now).
 
         if (infiniteWorld_ || game::selectedEngineMode() != VoxelEng::engineMode::EDITLEVEL)
-            nChunksToCompute_ = nChunksToCompute;
+            context.nChunksToCompute_ = nChunksToCompute;
         else
             logger::errorLog("Cannot change number of chunks to compute in a finite world that has been loaded.");
     
@@ -622,30 +655,41 @@ namespace VoxelEng {
 
     block chunkManager::setBlock(int x, int y, int z, block blockID) {
     
+        worldContext& context = worldContext::selected();
         vec3 chunkPos = getChunkCoords(x, y, z);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        // Inside a parallel tick phase the change is applied later, when the command buffers are merged.
+        if (commandBuffer::recording()) {
+
+            commandBuffer::recording()->setBlock(x, y, z, blockID);
+
+            return getBlock(x, y, z);
+
+        }
+
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
         if (game::AImodeON()) {
         
-            if (AIagentChunks_.find(selectedAIWorld_) == AIagentChunks_.cend()) {
+            if (context.AIagentChunks_.find(context.selectedAIWorld_) == context.AIagentChunks_.cend()) {
             
-                AIagentChunks_[selectedAIWorld_] = std::unordered_map<vec3, chunk*>(); // Store here differences between the original level and the agent's copy.
-                AIChunkAvailable_[selectedAIWorld_] = std::unordered_map<vec3, bool>(); // Store if the agent's copy chunk can be accessed.
+                context.AIagentChunks_[context.selectedAIWorld_] = std::unordered_map<vec3, chunk*>(); // Store here differences between the original level and the agent's copy.
+                context.AIChunkAvailable_[context.selectedAIWorld_] = std::unordered_map<vec3, bool>(); // Store if the agent's copy chunk can be accessed.
             
             }
                
-            std::unordered_map<vec3, chunk*>& agentWorld = AIagentChunks_[selectedAIWorld_];
+            std::unordered_map<vec3, chunk*>& agentWorld = context.AIagentChunks_[context.selectedAIWorld_];
             if (agentWorld.find(chunkPos) == agentWorld.cend()) {
             
-                if (chunks_.find(chunkPos) == chunks_.cend())
+                chunk* copiedChunk = copyOGWorldChunk_(chunkPos);
+                if (!copiedChunk)
                     logger::errorLog("There is no chunk " + std::to_string(chunkPos.x) + '|' + std::to_string(chunkPos.y) + '|' + std::to_string(chunkPos.z) +
-                                     "for AI agent " + std::to_string(selectedAIWorld_));
+                                     "for AI agent " + std::to_string(context.selectedAIWorld_));
                 else {
                     
-                    agentWorld[chunkPos] = new chunk(*chunks_[chunkPos]);
-                    AIChunkAvailable_[selectedAIWorld_][chunkPos] = true;
+                    agentWorld[chunkPos] = copiedChunk;
+                    context.AIChunkAvailable_[context.selectedAIWorld_][chunkPos] = true;
                 
                 }
                 
@@ -656,11 +700,11 @@ namespace VoxelEng {
         }
         else {
         
-            if (chunks_.find(chunkPos) == chunks_.cend())
+            if (context.chunks_.find(chunkPos) == context.chunks_.cend())
                 logger::errorLog("Chunk " + std::to_string(chunkPos.x) + "|" + std::to_string(chunkPos.y) + "|" + std::to_string(chunkPos.z) + " does not exist");
             else {
             
-                block removedBlock = chunks_[chunkPos]->setBlock(getChunkRelCoords(x, y, z), blockID);
+                block removedBlock = context.chunks_[chunkPos]->setBlock(getChunkRelCoords(x, y, z), blockID);
 
                 chunkManager::highPriorityUpdate(chunkPos);
 
@@ -674,9 +718,10 @@ namespace VoxelEng {
 
     chunk* chunkManager::createChunkAt(bool empty, const vec3& chunkPos) {
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(chunkPos) == chunks_.end())
+        if (context.chunks_.find(chunkPos) == context.chunks_.end())
             return createChunk(empty, chunkPos);
         else
             logger::errorLog("Chunk at " + std::to_string(chunkPos.x) + '|' + std::to_string(chunkPos.y) + '|' + std::to_string(chunkPos.z) + " already exists");
@@ -685,18 +730,19 @@ namespace VoxelEng {
 
     chunk* chunkManager::createChunk(bool empty, const vec3& chunkPos) {
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
         chunk* selectedChunk = nullptr;
-        if (chunks_.find(chunkPos) == chunks_.cend()) {
+        if (context.chunks_.find(chunkPos) == context.chunks_.cend()) {
 
             selectedChunk = new chunk(empty, chunkPos);
-            chunks_.insert_or_assign(chunkPos, selectedChunk);
+            context.chunks_.insert_or_assign(chunkPos, selectedChunk);
 
         }
         else {
         
-            selectedChunk = chunks_[chunkPos];
+            selectedChunk = context.chunks_[chunkPos];
             selectedChunk->regenChunk(empty, chunkPos);
         
         }
@@ -707,11 +753,12 @@ namespace VoxelEng {
 
     chunk* chunkManager::selectChunk(int x, int y, int z) {
 
+        worldContext& context = worldContext::selected();
         vec3 chunkPos(x, y, z);
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
         
-        if (chunks_.find(chunkPos) != chunks_.end())
-            return chunks_.at(chunkPos);
+        if (context.chunks_.find(chunkPos) != context.chunks_.end())
+            return context.chunks_.at(chunkPos);
         else
             return nullptr;
         
@@ -719,10 +766,11 @@ namespace VoxelEng {
 
     chunk* chunkManager::selectChunkByChunkPos(const vec3& chunkPos) {
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(chunkPos) != chunks_.end())
-            return chunks_.at(chunkPos);
+        if (context.chunks_.find(chunkPos) != context.chunks_.end())
+            return context.chunks_.at(chunkPos);
         else
             return nullptr;
 
@@ -730,12 +778,13 @@ namespace VoxelEng {
 
     chunk* chunkManager::selectChunkByChunkPos(int x, int y, int z) {
 
+        worldContext& context = worldContext::selected();
         vec3 chunkPos = getChunkCoords(x, y, z);
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
 
-        if (chunks_.find(chunkPos) != chunks_.end())
-            return chunks_.at(chunkPos);
+        if (context.chunks_.find(chunkPos) != context.chunks_.end())
+            return context.chunks_.at(chunkPos);
         else
             return nullptr;
 
@@ -743,27 +792,66 @@ namespace VoxelEng {
 
     chunk* chunkManager::selectChunkByRealPos(const vec3& pos) {
 
+        worldContext& context = worldContext::selected();
         vec3 chunkPos = getChunkCoords(pos);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(chunkPos) != chunks_.end())
-            return chunks_.at(chunkPos);
+        if (context.chunks_.find(chunkPos) != context.chunks_.end())
+            return context.chunks_.at(chunkPos);
         else
             return nullptr;
 
     }
 
+    chunk* chunkManager::selectBlockSource(const vec3& chunkPos, const block*& imageBlocks) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
+
+
+        imageBlocks = nullptr;
+
+        // Same sources and priorities as chunkManager::getBlock().
+        if (game::AImodeON() && !context.originalWorldAccess_) {
+
+            auto itAgent = context.AIagentChunks_.find(context.selectedAIWorld_);
+            if (itAgent != context.AIagentChunks_.cend()) {
+
+                auto itChunk = itAgent->second.find(chunkPos);
+                if (itChunk != itAgent->second.cend() && context.AIChunkAvailable_[context.selectedAIWorld_][chunkPos])
+                    return itChunk->second;
+
+            }
+
+        }
+
+        if (context.AIWorldImage_.isOpen()) {
+
+            auto it = context.AIWorldImageChunks_.find(chunkPos);
+            if (it != context.AIWorldImageChunks_.cend())
+                imageBlocks = it->second;
+
+            return nullptr;
+
+        }
+
+        auto it = context.chunks_.find(chunkPos);
+        return (it == context.chunks_.cend()) ? nullptr : it->second;
+
+    }
+
     chunk* chunkManager::neighborMinusX(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         vec3 neighborChunkPos(chunkPos.x - 1, chunkPos.y, chunkPos.z);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(neighborChunkPos) != chunks_.end())
-            return chunks_.at(neighborChunkPos);
+        if (context.chunks_.find(neighborChunkPos) != context.chunks_.end())
+            return context.chunks_.at(neighborChunkPos);
         else
             return nullptr;
 
@@ -771,13 +859,14 @@ namespace VoxelEng {
 
     chunk* chunkManager::neighborPlusX(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         vec3 neighborChunkPos(chunkPos.x + 1, chunkPos.y, chunkPos.z);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(neighborChunkPos) != chunks_.end())
-            return chunks_.at(neighborChunkPos);
+        if (context.chunks_.find(neighborChunkPos) != context.chunks_.end())
+            return context.chunks_.at(neighborChunkPos);
         else
             return nullptr;
 
@@ -785,13 +874,14 @@ namespace VoxelEng {
 
     chunk* chunkManager::neighborMinusY(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         vec3 neighborChunkPos(chunkPos.x, chunkPos.y - 1, chunkPos.z);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(neighborChunkPos) != chunks_.end())
-            return chunks_.at(neighborChunkPos);
+        if (context.chunks_.find(neighborChunkPos) != context.chunks_.end())
+            return context.chunks_.at(neighborChunkPos);
         else
             return nullptr;
 
@@ -799,13 +889,14 @@ namespace VoxelEng {
 
     chunk* chunkManager::neighborPlusY(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         vec3 neighborChunkPos(chunkPos.x, chunkPos.y + 1, chunkPos.z);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(neighborChunkPos) != chunks_.end())
-            return chunks_.at(neighborChunkPos);
+        if (context.chunks_.find(neighborChunkPos) != context.chunks_.end())
+            return context.chunks_.at(neighborChunkPos);
         else
             return nullptr;
 
@@ -813,13 +904,14 @@ namespace VoxelEng {
 
     chunk* chunkManager::neighborMinusZ(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         vec3 neighborChunkPos(chunkPos.x, chunkPos.y, chunkPos.z - 1);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(neighborChunkPos) != chunks_.end())
-            return chunks_.at(neighborChunkPos);
+        if (context.chunks_.find(neighborChunkPos) != context.chunks_.end())
+            return context.chunks_.at(neighborChunkPos);
         else
             return nullptr;
 
@@ -827,13 +919,14 @@ namespace VoxelEng {
 
     chunk* chunkManager::neighborPlusZ(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         vec3 neighborChunkPos(chunkPos.x, chunkPos.y, chunkPos.z + 1);
 
 
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-        if (chunks_.find(neighborChunkPos) != chunks_.end())
-            return chunks_.at(neighborChunkPos);
+        if (context.chunks_.find(neighborChunkPos) != context.chunks_.end())
+            return context.chunks_.at(neighborChunkPos);
         else
             return nullptr;
 
@@ -886,14 +979,15 @@ namespace VoxelEng {
 
     void chunkManager::loadChunk(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         bool chunkNotLoaded;
 
 
         {
 
-            std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+            std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-            chunkNotLoaded = chunks_.find(chunkPos) == chunks_.end();
+            chunkNotLoaded = context.chunks_.find(chunkPos) == context.chunks_.end();
 
         }
 
@@ -922,9 +1016,9 @@ namespace VoxelEng {
 
             {
 
-                std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+                std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
-                chunks_.insert_or_assign(chunkPos, chunkPtr);
+                context.chunks_.insert_or_assign(chunkPos, chunkPtr);
 
             }
 
@@ -934,14 +1028,15 @@ namespace VoxelEng {
 
     void chunkManager::unloadChunk(const vec3& chunkPos) {
 
+        worldContext& context = worldContext::selected();
         std::unordered_map<vec3, chunk*>::iterator it;
-        std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
         std::unique_lock<std::recursive_mutex> lockFree(freeChunksMutex_);
 
-        if ((it = chunks_.find(chunkPos)) != chunks_.end()) {
+        if ((it = context.chunks_.find(chunkPos)) != context.chunks_.end()) {
 
             chunk* unloadedChunk = it->second;
-            chunks_.erase(chunkPos);
+            context.chunks_.erase(chunkPos);
             freeChunks_.push_back(unloadedChunk);
 
         }
@@ -1049,6 +1144,7 @@ namespace VoxelEng {
 
     void chunkManager::manageChunks(unsigned int nMeshingThreads) {
 
+        worldContext& context = worldContext::selected();
         std::vector<std::thread> meshingThreads;
 
 
@@ -1119,15 +1215,15 @@ namespace VoxelEng {
                     // All remaining chunks marked as freeable are freed.
                     // No thread can access the chunks dictionary  
                     // at the same time this is being executed.
-                    chunksMutex_.lock();
+                    context.chunksMutex_.lock();
                     for (std::unordered_set<vec3>::iterator it = freeableChunks_.begin(); it != freeableChunks_.end(); it++)
                         unloadChunk(*it);
-                    chunksMutex_.unlock();
+                    context.chunksMutex_.unlock();
 
                     // Increase chunk viewing range for the next
                     // iteration until we reach the limit established
                     // by the player's configuration.
-                    if (chunkRange <= nChunksToCompute_)
+                    if (chunkRange <= context.nChunksToCompute_)
                         chunkRange++;
 
                     // Sync with the rendering thread.
@@ -1212,6 +1308,9 @@ namespace VoxelEng {
 
     void chunkManager::finiteWorldLoading(const std::string& terrainFile) {
 
+        worldContext& context = worldContext::selected();
+
+
         try {
         
             chunk* selectedChunk = nullptr;
@@ -1226,7 +1325,7 @@ namespace VoxelEng {
                 */
                 if (terrainFile.empty()) {
 
-                    std::unique_lock<std::recursive_mutex> lock(chunksMutex_);
+                    std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
 
 
                     if (unsigned int slot = game::selectedSaveSlot())
@@ -1239,11 +1338,11 @@ namespace VoxelEng {
                         worldGen::prepareGen();
 
                         for (chunkPos.y = -yChunksRange; chunkPos.y < yChunksRange; chunkPos.y++)
-                            for (chunkPos.x = -nChunksToCompute_; chunkPos.x < nChunksToCompute_; chunkPos.x++)
-                                for (chunkPos.z = -nChunksToCompute_; chunkPos.z < nChunksToCompute_; chunkPos.z++) {
+                            for (chunkPos.x = -context.nChunksToCompute_; chunkPos.x < context.nChunksToCompute_; chunkPos.x++)
+                                for (chunkPos.z = -context.nChunksToCompute_; chunkPos.z < context.nChunksToCompute_; chunkPos.z++) {
 
                                     selectedChunk = chunkManager::createChunk(false, chunkPos);
-                                    chunks_.insert_or_assign(chunkPos, selectedChunk);
+                                    context.chunks_.insert_or_assign(chunkPos, selectedChunk);
 
                                 }
 
@@ -1264,8 +1363,8 @@ namespace VoxelEng {
                 // Once chunk data has been loaded, generate the meshes. All chunk data must be loaded first before generating any mesh to
                 // compute block face culling optimizations.
                 for (chunkPos.y = -yChunksRange; chunkPos.y < yChunksRange; chunkPos.y++)
-                    for (chunkPos.x = -nChunksToCompute_; chunkPos.x < nChunksToCompute_; chunkPos.x++)
-                        for (chunkPos.z = -nChunksToCompute_; chunkPos.z < nChunksToCompute_; chunkPos.z++) {
+                    for (chunkPos.x = -context.nChunksToCompute_; chunkPos.x < context.nChunksToCompute_; chunkPos.x++)
+                        for (chunkPos.z = -context.nChunksToCompute_; chunkPos.z < context.nChunksToCompute_; chunkPos.z++) {
 
                             selectedChunk = selectChunkByChunkPos(chunkPos);
 
@@ -1354,6 +1453,9 @@ namespace VoxelEng {
 
     void chunkManager::generateAIWorld(const std::string& path) {
 
+        worldContext& context = worldContext::selected();
+
+
         if (game::AImodeON()) {
 
             chunk* selectedChunk = nullptr;
@@ -1366,12 +1468,12 @@ namespace VoxelEng {
                 worldGen::prepareGen();
 
                 for (chunkPos.y = -yChunksRange; chunkPos.y < yChunksRange; chunkPos.y++)
-                    for (chunkPos.x = -nChunksToCompute_; chunkPos.x < nChunksToCompute_; chunkPos.x++)
-                        for (chunkPos.z = -nChunksToCompute_; chunkPos.z < nChunksToCompute_; chunkPos.z++) {
+                    for (chunkPos.x = -context.nChunksToCompute_; chunkPos.x < context.nChunksToCompute_; chunkPos.x++)
+                        for (chunkPos.z = -context.nChunksToCompute_; chunkPos.z < context.nChunksToCompute_; chunkPos.z++) {
 
 
                             selectedChunk = chunkManager::createChunk(false, chunkPos);
-                            chunks_.insert_or_assign(chunkPos, selectedChunk);
+                            context.chunks_.insert_or_assign(chunkPos, selectedChunk);
 
                         }
 
@@ -1388,8 +1490,107 @@ namespace VoxelEng {
 
     }
 
+    void chunkManager::swapAIWorld(std::unordered_map<vec3, chunk*>& chunks) {
+
+        worldContext& context = worldContext::selected();
+
+
+        if (game::AImodeON()) {
+
+            std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
+
+            context.chunks_.swap(chunks);
+
+        }
+        else
+            logger::errorLog("Chunk manager's AI mode must be turned on when generating a world for AI testing/training.");
+
+    }
+
+    void chunkManager::exportAIWorld(const std::string& path) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
+        std::string temporaryPath = path + ".tmp";
+        std::ofstream imageFile(temporaryPath, std::ios::binary | std::ios::trunc);
+        AIWorldImageHeader header{ { 'V', 'X', 'W', 'I' }, 1, context.nChunksToCompute_, static_cast<std::uint32_t>(context.chunks_.size()) };
+        std::vector<block> blocks(SCX * SCY * SCZ);
+        std::int32_t chunkPos[3];
+
+
+        if (!imageFile.is_open())
+            logger::errorLog("Could not open file " + temporaryPath + " for writing");
+
+        imageFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (auto it = context.chunks_.begin(); it != context.chunks_.end(); it++) {
+
+            chunkPos[0] = it->first.x;
+            chunkPos[1] = it->first.y;
+            chunkPos[2] = it->first.z;
+            it->second->copyBlocks(blocks.data());
+
+            imageFile.write(reinterpret_cast<const char*>(chunkPos), sizeof(chunkPos));
+            imageFile.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(block));
+
+        }
+
+        imageFile.close();
+        if (imageFile.fail())
+            logger::errorLog("Could not write file " + temporaryPath);
+
+        // Readers never see a partially written image.
+        std::filesystem::rename(temporaryPath, path);
+
+    }
+
+    void chunkManager::attachAIWorld(const std::string& path) {
+
+        worldContext& context = worldContext::selected();
+
+
+        if (!game::AImodeON())
+            logger::errorLog("Chunk manager's AI mode must be turned on when attaching to an AI world image");
+
+        std::unique_lock<std::recursive_mutex> lock(context.chunksMutex_);
+        const AIWorldImageHeader* header = nullptr;
+        const unsigned char* record = nullptr;
+        std::size_t recordSize = 3 * sizeof(std::int32_t) + SCX * SCY * SCZ * sizeof(block);
+        std::int32_t chunkPos[3];
+
+
+        context.AIWorldImageChunks_.clear();
+        context.AIWorldImage_.open(path);
+
+        header = reinterpret_cast<const AIWorldImageHeader*>(context.AIWorldImage_.data());
+        if (context.AIWorldImage_.size() < sizeof(AIWorldImageHeader) || std::memcmp(header->magic, "VXWI", 4) != 0 || header->version != 1 ||
+            context.AIWorldImage_.size() != sizeof(AIWorldImageHeader) + header->nChunks * recordSize) {
+
+            context.AIWorldImage_.close();
+            logger::errorLog("File " + path + " is not a valid AI world image");
+
+        }
+
+        record = context.AIWorldImage_.data() + sizeof(AIWorldImageHeader);
+        for (std::uint32_t i = 0; i < header->nChunks; i++, record += recordSize) {
+
+            std::memcpy(chunkPos, record, sizeof(chunkPos));
+            context.AIWorldImageChunks_[vec3(chunkPos[0], chunkPos[1], chunkPos[2])] = reinterpret_cast<const block*>(record + sizeof(chunkPos));
+
+        }
+        context.nChunksToCompute_ = header->nChunksToCompute;
+
+        // The agents' copies belong to the previous world.
+        for (auto it = context.AIagentChunks_.cbegin(); it != context.AIagentChunks_.cend(); it++)
+            for (auto itChunks = it->second.cbegin(); itChunks != it->second.cend(); itChunks++)
+                delete itChunks->second;
+        context.AIagentChunks_.clear();
+        context.AIChunkAvailable_.clear();
+
+    }
+
     void chunkManager::saveAllChunks(const std::string& path) {
 
+        worldContext& context = worldContext::selected();
         std::unique_lock<std::recursive_mutex> lock(input::inputMutex());
         input::shouldProcessInputs(false);
 
@@ -1407,12 +1608,12 @@ namespace VoxelEng {
         timer t;
         t.start();
 
-        saveData += std::to_string(nChunksToCompute_) + '|';
+        saveData += std::to_string(context.nChunksToCompute_) + '|';
 
         const vec3& playerPos = (game::AImodeON()) ? worldGen::playerSpawnPos() : game::playerCamera().pos();
         saveData += std::to_string((int)playerPos.x) + '|' + std::to_string((int)playerPos.y) + '|' + std::to_string((int)playerPos.z) + "|";
 
-        for (auto it = chunks_.begin(); it != chunks_.end(); it++) {
+        for (auto it = context.chunks_.begin(); it != context.chunks_.end(); it++) {
 
             if (it->second->getNBlocks()) {
             
@@ -1469,6 +1670,7 @@ namespace VoxelEng {
 
     void chunkManager::loadAllChunks(const std::string& path) {
 
+        worldContext& context = worldContext::selected();
         std::string truePath = path + ".terrain";
         std::ifstream saveFile(truePath);
        
@@ -1512,14 +1714,14 @@ namespace VoxelEng {
                     
                         case 0: // Set number of chunks to compute and load chunk data structures.
 
-                            nChunksToCompute_ = number;
+                            context.nChunksToCompute_ = number;
 
                             for (pos.y = -yChunksRange; pos.y < yChunksRange; pos.y++)
-                                for (pos.x = -nChunksToCompute_; pos.x < nChunksToCompute_; pos.x++)
-                                    for (pos.z = -nChunksToCompute_; pos.z < nChunksToCompute_; pos.z++) {
+                                for (pos.x = -context.nChunksToCompute_; pos.x < context.nChunksToCompute_; pos.x++)
+                                    for (pos.z = -context.nChunksToCompute_; pos.z < context.nChunksToCompute_; pos.z++) {
 
                                         selectedChunk = chunkManager::createChunk(true, pos);
-                                        chunks_.insert_or_assign(pos, selectedChunk);
+                                        context.chunks_.insert_or_assign(pos, selectedChunk);
 
                                     }
 
@@ -1625,8 +1827,8 @@ namespace VoxelEng {
 
             // Lastly, mark all chunks as decorated as the entire level has been properly loaded.
             for (pos.y = -yChunksRange; pos.y < yChunksRange; pos.y++)
-                for (pos.x = -nChunksToCompute_; pos.x < nChunksToCompute_; pos.x++)
-                    for (pos.z = -nChunksToCompute_; pos.z < nChunksToCompute_; pos.z++)
+                for (pos.x = -context.nChunksToCompute_; pos.x < context.nChunksToCompute_; pos.x++)
+                    for (pos.z = -context.nChunksToCompute_; pos.z < context.nChunksToCompute_; pos.z++)
                         selectChunkByChunkPos(pos)->setLoadLevel(VoxelEng::chunkLoadLevel::DECORATED);
 
             t.finish();
@@ -1653,10 +1855,13 @@ namespace VoxelEng {
 
     void chunkManager::selectAIworld(unsigned int individualID) {
 
+        worldContext& context = worldContext::selected();
+
+
         if (game::AImodeON()) {
 
-            originalWorldAccess_ = false;
-            selectedAIWorld_ = individualID;
+            context.originalWorldAccess_ = false;
+            context.selectedAIWorld_ = individualID;
 
         }
         else
@@ -1666,8 +1871,11 @@ namespace VoxelEng {
 
     void chunkManager::selectOriginalWorld() {
 
+        worldContext& context = worldContext::selected();
+
+
         if (game::AImodeON())
-            originalWorldAccess_ = true;
+            context.originalWorldAccess_ = true;
         else
             logger::errorLog("AI mode needs to be enabled to select an AI agent world");
 
@@ -1675,10 +1883,13 @@ namespace VoxelEng {
 
     void chunkManager::resetAIChunks() {
     
+        worldContext& context = worldContext::selected();
+
+
         timer t;
 
         t.start();
-        for (auto it = AIChunkAvailable_.begin(); it != AIChunkAvailable_.end(); it++)
+        for (auto it = context.AIChunkAvailable_.begin(); it != context.AIChunkAvailable_.end(); it++)
             for (auto it2 = it->second.begin(); it2 != it->second.end(); it2++)
                 it2->second = false;
         t.finish();
@@ -1698,10 +1909,13 @@ namespace VoxelEng {
 
     void chunkManager::clean() {
 
-        for (auto it = chunks_.begin(); it != chunks_.end(); it++)
+        worldContext& context = worldContext::selected();
+
+
+        for (auto it = context.chunks_.begin(); it != context.chunks_.end(); it++)
             if (it->second)
                 delete it->second;
-        chunks_.clear();
+        context.chunks_.clear();
 
         if (drawableChunksRead_)
             drawableChunksRead_->clear();
@@ -1719,19 +1933,22 @@ namespace VoxelEng {
         priorityMeshingList_.clear();
         priorityUpdateList_.clear();
 
-        for (auto it = AIagentChunks_.cbegin(); it != AIagentChunks_.cend(); it++)
+        for (auto it = context.AIagentChunks_.cbegin(); it != context.AIagentChunks_.cend(); it++)
             for (auto itChunks = it->second.cbegin(); itChunks != it->second.cend(); itChunks++)
                 delete itChunks->second;
-        AIagentChunks_.clear();
+        context.AIagentChunks_.clear();
 
     }
 
     void chunkManager::cleanUp() {
 
-        for (auto it = chunks_.begin(); it != chunks_.end(); it++)
+        worldContext& context = worldContext::selected();
+
+
+        for (auto it = context.chunks_.begin(); it != context.chunks_.end(); it++)
             if (it->second)
                 delete it->second;
-        chunks_.clear();
+        context.chunks_.clear();
 
         if (drawableChunksRead_) {
         
@@ -1757,10 +1974,13 @@ namespace VoxelEng {
         priorityMeshingList_.clear();
         priorityUpdateList_.clear();
 
-        for (auto it = AIagentChunks_.cbegin(); it != AIagentChunks_.cend(); it++)
+        for (auto it = context.AIagentChunks_.cbegin(); it != context.AIagentChunks_.cend(); it++)
             for (auto itChunks = it->second.cbegin(); itChunks != it->second.cend(); itChunks++)
                 delete itChunks->second;
-        AIagentChunks_.clear();
+        context.AIagentChunks_.clear();
+
+        context.AIWorldImageChunks_.clear();
+        context.AIWorldImage_.close();
 
         initialised_ = false;
 
@@ -1768,13 +1988,51 @@ namespace VoxelEng {
 
     block chunkManager::getBlockOGWorld_(int posX, int posY, int posZ) {
     
+        worldContext& context = worldContext::selected();
         vec3 chunkPos = getChunkCoords(posX, posY, posZ);
 
-        if (chunks_.find(chunkPos) == chunks_.end())
+        if (context.AIWorldImage_.isOpen()) {
+
+            auto it = context.AIWorldImageChunks_.find(chunkPos);
+            if (it == context.AIWorldImageChunks_.cend())
+                logger::errorLog("Chunk " + std::to_string(chunkPos.x) + "|" + std::to_string(chunkPos.y) + "|" + std::to_string(chunkPos.z) + " does not exist in the AI world image");
+            else
+                return it->second[(floorMod(posX, SCX) * SCY + floorMod(posY, SCY)) * SCZ + floorMod(posZ, SCZ)];
+
+        }
+
+        if (context.chunks_.find(chunkPos) == context.chunks_.end())
             logger::errorLog("Chunk " + std::to_string(chunkPos.x) + "|" + std::to_string(chunkPos.y) + "|" + std::to_string(chunkPos.z) + " does not exist");
         else
-            return chunks_[chunkPos]->getBlock(floorMod(posX, SCX), floorMod(posY, SCY), floorMod(posZ, SCZ));
+            return context.chunks_[chunkPos]->getBlock(floorMod(posX, SCX), floorMod(posY, SCY), floorMod(posZ, SCZ));
     
     }
 
+    chunk* chunkManager::copyOGWorldChunk_(const vec3& chunkPos) {
+
+        worldContext& context = worldContext::selected();
+
+
+        if (context.AIWorldImage_.isOpen()) {
+
+            auto it = context.AIWorldImageChunks_.find(chunkPos);
+            if (it == context.AIWorldImageChunks_.cend())
+                return nullptr;
+
+            chunk* copiedChunk = new chunk(true, chunkPos);
+            copiedChunk->setBlocks(it->second);
+
+            return copiedChunk;
+
+        }
+        else {
+
+            auto it = context.chunks_.find(chunkPos);
+
+            return (it == context.chunks_.cend()) ? nullptr : new chunk(*it->second);
+
+        }
+
+    }
+
 }
@@ -12,6 +12,7 @@
 #include <atomic>
 #include <barrier>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <vector>
 #include <unordered_map>
@@ -36,8 +37,10 @@
 #include "camera.h"
 #include "texture.h"
 #include "model.h"
+#include "worldContext.h"
 #include "worldGen.h"
 #include "definitions.h"
+#include "mappedFile.h"
 #include "utilities.h"
 
 
@@ -77,6 +80,21 @@ namespace VoxelEng {
 	};
 
 
+	/**
+	* @brief Header of the binary AI world images written by chunkManager::exportAIWorld().
+	* It is followed by 'nChunks' records, each one made of the chunk's position as three std::int32_t
+	* and its SCX * SCY * SCZ blocks in the same order as chunk::copyBlocks() writes them.
+	*/
+	struct AIWorldImageHeader {
+
+		char magic[4]; // "VXWI".
+		std::uint32_t version;
+		std::int32_t nChunksToCompute;
+		std::uint32_t nChunks;
+
+	};
+
+
 	/**
 	* @brief Represents a section of the voxel world, with its blocks, mesh, position and other infomation.
 	* Chunks that are marked as 'dirty' or 'changed' will have their mesh regenerated.
@@ -178,6 +196,18 @@ namespace VoxelEng {
 		*/
 		chunkLoadLevel loadLevel() const;
 
+		/**
+		* @brief Returns a counter that is increased each time the chunk's blocks or load level are modified.
+		* Used to know whether information computed from the chunk is still valid.
+		*/
+		unsigned int version() const;
+
+		/**
+		* @brief Copy the chunk's SCX * SCY * SCZ blocks into 'blocks', ordered by their linear index
+		* (the one used by chunk::setBlock(unsigned int linearIndex, block blockID)).
+		*/
+		void copyBlocks(block* blocks);
+
 
 		// Modifiers.
 
@@ -238,6 +268,12 @@ namespace VoxelEng {
 		*/
 		void makeEmpty();
 
+		/**
+		* @brief Replace the chunk's block data with the SCX * SCY * SCZ blocks in 'blocks', ordered by their linear index.
+		* The chunk is marked as dirty.
+		*/
+		void setBlocks(const block* blocks);
+
 		/**
 		* @brief Set the chunk's load level.
 		*/
@@ -269,6 +305,7 @@ namespace VoxelEng {
 		std::atomic<bool> changed_;
 		std::atomic<unsigned int> nBlocks_;
 		std::atomic<chunkLoadLevel> loadLevel_;
+		std::atomic<unsigned int> version_;
 		chunkRenderingData renderingData_;
 
 		/*
@@ -353,6 +390,12 @@ namespace VoxelEng {
 
 	}
 
+	inline unsigned int chunk::version() const {
+
+		return version_;
+
+	}
+
 	inline chunkRenderingData& chunk::renderingData() {
 
 		return renderingData_;
@@ -380,6 +423,7 @@ namespace VoxelEng {
 	inline void chunk::setLoadLevel(chunkLoadLevel level) {
 
 		loadLevel_ = level;
+		version_++;
 
 	}
 
@@ -387,6 +431,7 @@ namespace VoxelEng {
 
 	/**
 	* @brief Used for managing the chunks' life cycle, level loading...
+	* The chunks of the level belong to the 'worldContext' selected in the calling thread.
 	*/
 	class chunkManager {
 
@@ -615,6 +660,14 @@ namespace VoxelEng {
 		*/
 		static chunk* selectChunkByRealPos(const vec3& pos);
 
+		/**
+		* @brief Select the chunk whose blocks are seen by chunkManager::getBlock() at the specified chunk position,
+		* which in AI mode can be the selected AI agent's copy of said chunk.
+		* If the blocks are read from the AI world image instead, nullptr is returned and 'imageBlocks' points to them.
+		* If there is no such chunk, nullptr is returned and 'imageBlocks' is set to nullptr.
+		*/
+		static chunk* selectBlockSource(const vec3& chunkPos, const block*& imageBlocks);
+
 		/**
 		* @brief Select the neighbor -X chunk for the chunk with the specified chunk position
 		* WARNING. Not meant for use in AI mode.
@@ -789,6 +842,27 @@ namespace VoxelEng {
 		*/
 		static void generateAIWorld(const std::string& path = "");
 
+		/**
+		* @brief Replaces the chunks of the original copy of the AI world with the ones in 'chunks'.
+		* After the call, 'chunks' holds the chunks that were replaced.
+		* Intended to be used with worlds generated in advance by a 'worldProducer' object.
+		*/
+		static void swapAIWorld(std::unordered_map<vec3, chunk*>& chunks);
+
+		/**
+		* @brief Writes the original copy of the AI world into a binary image located at 'path'
+		* so that other processes can use it with chunkManager::attachAIWorld().
+		*/
+		static void exportAIWorld(const std::string& path);
+
+		/**
+		* @brief Maps the AI world image located at 'path' in read-only mode and uses it as the original copy of the AI world.
+		* The image's chunks are read directly from the mapping. Only the chunks that the AI agents modify are copied into their worlds.
+		* The AI agents' copies of the previous world are discarded.
+		* AI mode must be turned on in the chunk manager system.
+		*/
+		static void attachAIWorld(const std::string& path);
+
 		/**
 		* @brief Saves all loaded chunks.
 		* This is intended to be used along with finite world loading.
@@ -864,8 +938,6 @@ namespace VoxelEng {
 
 		static bool initialised_,
 					infiniteWorld_;
-		static int nChunksToCompute_;
-		static std::unordered_map<vec3, chunk*> chunks_;
 		static std::unordered_map<vec3, model>* drawableChunksWrite_,
 															* drawableChunksRead_;
 		static std::deque<chunk*> freeChunks_;
@@ -886,7 +958,6 @@ namespace VoxelEng {
 		static std::shared_mutex highPriorityMutex_;
 
 		static std::recursive_mutex drawableChunksWriteMutex_,
-						            chunksMutex_,
 						            freeChunksMutex_,
 						            priorityMeshingListMutex_;
 		static std::condition_variable managerThreadCV_,
@@ -906,11 +977,7 @@ namespace VoxelEng {
 		static const unsigned int parseChunkPosStates_;
 		static std::string openedTerrainFileName_;
 
-		static std::unordered_map<unsigned int, std::unordered_map<vec3, bool>> AIChunkAvailable_;
-		static std::unordered_map<unsigned int, std::unordered_map<vec3, chunk*>> AIagentChunks_;
-		static unsigned int selectedAIWorld_;
-
-		static bool originalWorldAccess_;
+		// The chunks, the AI agents' copies of them and the AI world image are kept in the selected 'worldContext'.
 
 
 		/*
@@ -918,6 +985,11 @@ namespace VoxelEng {
 		*/
 		static block getBlockOGWorld_(int posX, int posY, int posZ);
 
+		/*
+		Returns a new chunk with the same blocks as the one located at 'chunkPos' in the original copy of the AI world.
+		*/
+		static chunk* copyOGWorldChunk_(const vec3& chunkPos);
+
 	};
 
 	inline bool chunkManager::initialised() {
@@ -982,7 +1054,7 @@ namespace VoxelEng {
 
 	inline const std::unordered_map<vec3, chunk*>& chunkManager::chunks() {
 
-		return chunks_;
+		return worldContext::selected().chunks_;
 
 	}
 
@@ -1000,7 +1072,7 @@ namespace VoxelEng {
 
 	inline unsigned int chunkManager::nChunksToCompute() {
 
-		return nChunksToCompute_;
+		return worldContext::selected().nChunksToCompute_;
 
 	}
 
@@ -1037,9 +1109,11 @@ namespace VoxelEng {
 
 	inline bool chunkManager::isInWorld(int x, int y, int z) {
 
-		return x >= -nChunksToCompute_ * VoxelEng::SCX && x < (nChunksToCompute_ - 1) * VoxelEng::SCX &&
+		int nChunksToCompute = worldContext::selected().nChunksToCompute_;
+
+		return x >= -nChunksToCompute * VoxelEng::SCX && x < (nChunksToCompute - 1) * VoxelEng::SCX &&
 			   y >= -yChunksRange * VoxelEng::SCY && y < (yChunksRange - 1) * VoxelEng::SCY &&
-			   z >= -nChunksToCompute_ * VoxelEng::SCZ && z < (nChunksToCompute_ - 1) * VoxelEng::SCZ;
+			   z >= -nChunksToCompute * VoxelEng::SCZ && z < (nChunksToCompute - 1) * VoxelEng::SCZ;
 	
 	}
 
@@ -1051,9 +1125,11 @@ namespace VoxelEng {
 
 	inline bool chunkManager::isChunkInWorld(int chunkX, int chunkY, int chunkZ) {
 
-		return  chunkX >= -nChunksToCompute_ && chunkX < nChunksToCompute_&&
+		int nChunksToCompute = worldContext::selected().nChunksToCompute_;
+
+		return  chunkX >= -nChunksToCompute && chunkX < nChunksToCompute &&
 				chunkY >= -yChunksRange && chunkY < yChunksRange &&
-				chunkZ >= -nChunksToCompute_ && chunkZ < nChunksToCompute_;
+				chunkZ >= -nChunksToCompute && chunkZ < nChunksToCompute;
 
 	}
 
@@ -1095,7 +1171,7 @@ namespace VoxelEng {
 
 	inline std::recursive_mutex& chunkManager::chunksMutex() {
 
-		return chunksMutex_;
+		return worldContext::selected().chunksMutex_;
 
 	}
 
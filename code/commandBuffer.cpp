@@ -0,0 +1,105 @@
+#include "commandBuffer.h"
+#include "chunk.h"
+#include "entity.h"
+#include "logger.h"
+
+
+namespace VoxelEng {
+
+	// 'commandBuffer' class.
+
+	thread_local commandBuffer* commandBuffer::recording_ = nullptr;
+
+
+	commandBuffer::commandBuffer() {}
+
+	void commandBuffer::setBlock(int x, int y, int z, block blockID) {
+
+		commands_.push_back({ tickCommandType::SET_BLOCK, 0, x, y, z, vec3Zero, blockID, false });
+
+	}
+
+	void commandBuffer::moveEntity(entityID ID, int x, int y, int z) {
+
+		commands_.push_back({ tickCommandType::MOVE_ENTITY, ID, x, y, z, vec3Zero, 0, false });
+
+	}
+
+	void commandBuffer::setEntityPos(entityID ID, const vec3& pos) {
+
+		commands_.push_back({ tickCommandType::SET_ENTITY_POS, ID, 0, 0, 0, pos, 0, false });
+
+	}
+
+	void commandBuffer::rotateEntity(entityID ID, float x, float y, float z) {
+
+		commands_.push_back({ tickCommandType::ROTATE_ENTITY, ID, 0, 0, 0, vec3(x, y, z), 0, false });
+
+	}
+
+	void commandBuffer::changeEntityActiveState(entityID ID, bool active) {
+
+		commands_.push_back({ tickCommandType::CHANGE_ENTITY_ACTIVE_STATE, ID, 0, 0, 0, vec3Zero, 0, active });
+
+	}
+
+	void commandBuffer::deleteEntity(entityID ID) {
+
+		commands_.push_back({ tickCommandType::DELETE_ENTITY, ID, 0, 0, 0, vec3Zero, 0, false });
+
+	}
+
+	void commandBuffer::apply() {
+
+		if (recording_)
+			logger::errorLog("Cannot apply a command buffer from a thread that is recording one");
+
+		for (std::size_t i = 0; i < commands_.size(); i++) {
+
+			const tickCommand& command = commands_[i];
+
+			// An entity may have been deleted by a command applied earlier.
+			if (command.type != tickCommandType::SET_BLOCK && !entityManager::isEntityRegistered(command.ID))
+				continue;
+
+			switch (command.type) {
+
+				case tickCommandType::SET_BLOCK:
+
+					chunkManager::setBlock(command.x, command.y, command.z, command.blockID);
+					break;
+
+				case tickCommandType::MOVE_ENTITY:
+
+					entityManager::moveEntity(command.ID, command.x, command.y, command.z);
+					break;
+
+				case tickCommandType::SET_ENTITY_POS:
+
+					entityManager::setEntityPos(command.ID, command.values);
+					break;
+
+				case tickCommandType::ROTATE_ENTITY:
+
+					entityManager::rotateEntity(command.ID, command.values.x, command.values.y, command.values.z);
+					break;
+
+				case tickCommandType::CHANGE_ENTITY_ACTIVE_STATE:
+
+					entityManager::changeEntityActiveStateAt(command.ID, command.active);
+					break;
+
+				case tickCommandType::DELETE_ENTITY:
+
+					entityManager::deleteEntity(command.ID);
+					break;
+
+			}
+
+		}
+
+		commands_.clear();
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+/**
+* @file commandBuffer.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Command buffer.
+* @brief Contains the declaration of the 'commandBuffer' class, used to defer the changes
+* made to a level by entity tick functions executed in parallel.
+*/
+#ifndef _VOXELENG_COMMANDBUFFER_
+#define _VOXELENG_COMMANDBUFFER_
+#include <cstddef>
+#include <vector>
+#include "definitions.h"
+
+
+namespace VoxelEng {
+
+	/////////////////
+	//Enum classes.//
+	/////////////////
+
+	/**
+	* @brief The changes to a level that can be deferred with a 'commandBuffer'.
+	*/
+	enum class tickCommandType { SET_BLOCK, MOVE_ENTITY, SET_ENTITY_POS, ROTATE_ENTITY, CHANGE_ENTITY_ACTIVE_STATE, DELETE_ENTITY };
+
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief A deferred change to a level.
+	* SET_BLOCK uses 'x', 'y', 'z' as the block's position and 'blockID'.
+	* MOVE_ENTITY uses 'ID' and 'x', 'y', 'z' as the displacement.
+	* SET_ENTITY_POS uses 'ID' and 'values' as the new position.
+	* ROTATE_ENTITY uses 'ID' and 'values' as the rotation angles.
+	* CHANGE_ENTITY_ACTIVE_STATE uses 'ID' and 'active'.
+	* DELETE_ENTITY uses 'ID'.
+	*/
+	struct tickCommand {
+
+		tickCommandType type;
+		entityID ID;
+		int x,
+			y,
+			z;
+		vec3 values;
+		block blockID;
+		bool active;
+
+	};
+
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Records changes to a level to apply them later, in the same order they were recorded.
+	* While a command buffer is recording in a thread, the methods chunkManager::setBlock(), entityManager::moveEntity(),
+	* entityManager::setEntityPos(), entityManager::rotateEntity(), entityManager::changeEntityActiveStateAt() and entityManager::deleteEntity()
+	* called from said thread record the change in the buffer instead of applying it.
+	* This allows entity tick functions to run in parallel, each thread recording into its own buffer, and to apply
+	* the buffers afterwards in a fixed order so that the result does not depend on the thread scheduling.
+	*/
+	class commandBuffer {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		commandBuffer();
+
+
+		// Observers.
+
+		/**
+		* @brief Returns the command buffer that is recording in the calling thread or nullptr if there is none.
+		*/
+		static commandBuffer* recording();
+
+		/**
+		* @brief Returns the number of recorded commands.
+		*/
+		std::size_t size() const;
+
+		/**
+		* @brief Returns true if no commands are recorded or false otherwise.
+		*/
+		bool empty() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Make the calling thread record its changes to the level into this buffer.
+		*/
+		void startRecording();
+
+		/**
+		* @brief Make the calling thread apply its changes to the level again.
+		*/
+		static void stopRecording();
+
+		void setBlock(int x, int y, int z, block blockID);
+
+		void moveEntity(entityID ID, int x, int y, int z);
+
+		void setEntityPos(entityID ID, const vec3& pos);
+
+		void rotateEntity(entityID ID, float x, float y, float z);
+
+		void changeEntityActiveState(entityID ID, bool active);
+
+		void deleteEntity(entityID ID);
+
+		/**
+		* @brief Apply the recorded commands to the level selected in the calling thread in the order
+		* they were recorded and clear the buffer.
+		* WARNING. It must not be called from a thread that is recording.
+		*/
+		void apply();
+
+		/**
+		* @brief Discard the recorded commands.
+		*/
+		void clear();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		static thread_local commandBuffer* recording_;
+
+		std::vector<tickCommand> commands_;
+
+	};
+
+	inline commandBuffer* commandBuffer::recording() {
+
+		return recording_;
+
+	}
+
+	inline std::size_t commandBuffer::size() const {
+
+		return commands_.size();
+
+	}
+
+	inline bool commandBuffer::empty() const {
+
+		return commands_.empty();
+
+	}
+
+	inline void commandBuffer::startRecording() {
+
+		recording_ = this;
+
+	}
+
+	inline void commandBuffer::stopRecording() {
+
+		recording_ = nullptr;
+
+	}
+
+	inline void commandBuffer::clear() {
+
+		commands_.clear();
+
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+/**
+* @file counterRNG.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Counter-based random number generator.
+* @brief Contains the declaration of the 'counterRNG' class.
+*/
+#ifndef _VOXELENG_COUNTERRNG_
+#define _VOXELENG_COUNTERRNG_
+#include <array>
+#include <cstdint>
+
+
+namespace VoxelEng {
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Counter-based random number generator (Philox4x32-10).
+	* Instead of advancing an internal state, each random number is obtained by encrypting a counter made of
+	* (generation, individual, step, stream) with the seed as the key. The same counter always yields the same numbers,
+	* so any number of threads can draw numbers at the same time and the results do not depend on the order in which they do it.
+	* 'stream' is used to separate the numbers drawn for different purposes that share the rest of the counter.
+	*/
+	class counterRNG {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		counterRNG(std::uint64_t seed = 0);
+
+
+		// Observers.
+
+		/**
+		* @brief Returns the seed used as the key of the generator.
+		*/
+		std::uint64_t seed() const;
+
+		/**
+		* @brief Returns the four 32-bit random numbers associated with the specified counter.
+		*/
+		std::array<std::uint32_t, 4> generate(std::uint32_t generation, std::uint32_t individual, std::uint32_t step, std::uint32_t stream = 0) const;
+
+		/**
+		* @brief Returns a random float in [0, 1) associated with the specified counter.
+		*/
+		float uniform(std::uint32_t generation, std::uint32_t individual, std::uint32_t step, std::uint32_t stream = 0) const;
+
+		/**
+		* @brief Returns a random unsigned integer in ['min', 'max'] associated with the specified counter.
+		*/
+		unsigned int uniformInt(unsigned int min, unsigned int max, std::uint32_t generation, std::uint32_t individual,
+								std::uint32_t step, std::uint32_t stream = 0) const;
+
+		/**
+		* @brief Converts one of the numbers returned by counterRNG::generate() into a float in [0, 1).
+		*/
+		static float toFloat(std::uint32_t bits);
+
+
+		// Modifiers.
+
+		/**
+		* @brief Set the seed used as the key of the generator.
+		*/
+		void setSeed(std::uint64_t seed);
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		std::uint64_t seed_;
+		std::uint32_t key_[2];
+
+	};
+
+	inline counterRNG::counterRNG(std::uint64_t seed) {
+
+		setSeed(seed);
+
+	}
+
+	inline std::uint64_t counterRNG::seed() const {
+
+		return seed_;
+
+	}
+
+	inline std::array<std::uint32_t, 4> counterRNG::generate(std::uint32_t generation, std::uint32_t individual, std::uint32_t step, std::uint32_t stream) const {
+
+		std::uint32_t counter[4] = { generation, individual, step, stream },
+					  key0 = key_[0],
+					  key1 = key_[1];
+		std::uint64_t product0 = 0,
+					  product1 = 0;
+
+
+		for (unsigned int round = 0; round < 10; round++) {
+
+			if (round) {
+
+				key0 += 0x9E3779B9u;
+				key1 += 0xBB67AE85u;
+
+			}
+
+			product0 = std::uint64_t(0xD2511F53u) * counter[0];
+			product1 = std::uint64_t(0xCD9E8D57u) * counter[2];
+
+			counter[0] = std::uint32_t(product1 >> 32) ^ counter[1] ^ key0;
+			counter[1] = std::uint32_t(product1);
+			counter[2] = std::uint32_t(product0 >> 32) ^ counter[3] ^ key1;
+			counter[3] = std::uint32_t(product0);
+
+		}
+
+		return { counter[0], counter[1], counter[2], counter[3] };
+
+	}
+
+	inline float counterRNG::uniform(std::uint32_t generation, std::uint32_t individual, std::uint32_t step, std::uint32_t stream) const {
+
+		return toFloat(generate(generation, individual, step, stream)[0]);
+
+	}
+
+	inline unsigned int counterRNG::uniformInt(unsigned int min, unsigned int max, std::uint32_t generation, std::uint32_t individual,
+											   std::uint32_t step, std::uint32_t stream) const {
+
+		// Scale instead of using the modulo. The bias is negligible for the ranges used here.
+		return min + static_cast<unsigned int>((std::uint64_t(generate(generation, individual, step, stream)[0]) * (std::uint64_t(max) - min + 1)) >> 32);
+
+	}
+
+	inline float counterRNG::toFloat(std::uint32_t bits) {
+
+		return (bits >> 8) * (1.0f / 16777216.0f);
+
+	}
+
+	inline void counterRNG::setSeed(std::uint64_t seed) {
+
+		seed_ = seed;
+		key_[0] = std::uint32_t(seed);
+		key_[1] = std::uint32_t(seed >> 32);
+
+	}
+
+}
+
+#endif
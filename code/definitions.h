@@ -10,6 +10,7 @@
 #ifndef _VOXELENG_DEFINITIONS_
 #define _VOXELENG_DEFINITIONS_
 #include <chrono>
+#include <cstddef>
 
 #if GRAPHICS_API == OPENGL
 
@@ -82,6 +83,21 @@ namespace VoxelEng {
 	*/
 	const unsigned int DEF_N_CHUNKS_TO_COMPUTE = 10;
 
+	/**
+	* @brief Default number of recorded AI actions between the keyframes of an AI game match record.
+	*/
+	const unsigned int DEF_RECORD_KEYFRAME_INTERVAL = 1000;
+
+	/**
+	* @brief Default maximum number of AI training worlds generated in advance in the background.
+	*/
+	const unsigned int DEF_N_PREGENERATED_WORLDS = 2;
+
+	/**
+	* @brief Default maximum amount of memory in bytes used by the AI training worlds generated in advance in the background.
+	*/
+	const std::size_t DEF_PREGENERATED_WORLDS_MEMORY_CAP = std::size_t(512) << 20;
+
 	/**
 	* @brief Number of GUIelement layers in which to organize the graphical user interface.
 	*/
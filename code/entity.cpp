@@ -1,7 +1,10 @@
 #include "entity.h"
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <future>
 #include <string>
+#include <utility>
 #include "game.h"
 #include "graphics.h"
 #include "gui.h"
@@ -16,12 +19,15 @@ namespace VoxelEng {
     bool player::initialised_ = false;
     GLFWwindow* player::window_ = nullptr;
     camera* player::camera_ = nullptr;
-    float player::blockReachRange_ = 0.0f,
-          player::blockSearchIncrement_ = 0.0f;
+    float player::blockReachRange_ = 0.0f;
     block player::selectedBlock_ = 0;
     std::atomic<block> player::blockToPlace_ = 1;
     vec3 player::selectedBlockPos_ = vec3Zero,
-         player::oldSelectedBlockPos_ = vec3Zero;
+         player::selectedBlockNormal_ = vec3Zero,
+         player::rayOrigin_ = vec3Zero,
+         player::rayDirection_ = vec3Zero;
+    bool player::selectionComputed_ = false;
+    std::vector<raycastChunk> player::rayChunks_;
     std::atomic<bool> player::destroyBlock_ = false,
                       player::placeBlock_ = false;
 
@@ -38,7 +44,7 @@ namespace VoxelEng {
                 window_ = window.windowAPIpointer();
                 camera_ = new camera(FOV, zNear, zFar, window, true);
                 blockReachRange_ = blockReachRange;
-                blockSearchIncrement_ = 0.01f;
+                selectionComputed_ = false;
 
             }  
             else 
@@ -50,29 +56,21 @@ namespace VoxelEng {
 
     void player::selectBlock() {
 
-        float step = blockSearchIncrement_;
-        const vec3& dir = camera_->direction(),
-                    pos = camera_->pos();
-        vec3 blockPos;
-        selectedBlock_ = 0;
+        vec3 pos = camera_->pos(),
+             dir = camera_->direction();
 
-        while (step < blockReachRange_ && !selectedBlock_) {
 
-            selectedBlockPos_ = pos + (dir * step);
+        if (!selectionComputed_ || pos != rayOrigin_ || dir != rayDirection_ || !raycast::unchanged(rayChunks_)) {
 
-            blockPos.x = floor(selectedBlockPos_.x);
-            blockPos.y = floor(selectedBlockPos_.y);
-            blockPos.z = floor(selectedBlockPos_.z);
+            raycastHit hit = raycast::cast(pos, dir, blockReachRange_, true, &rayChunks_);
 
-            selectedBlock_ = (chunkManager::getChunkLoadLevel(chunkManager::getChunkCoords(blockPos)) == VoxelEng::chunkLoadLevel::DECORATED) ? chunkManager::getBlock(blockPos) : 0;
+            selectedBlock_ = hit.hit ? hit.blockID : 0;
+            selectedBlockPos_ = hit.blockPos;
+            selectedBlockNormal_ = hit.normal;
 
-            if (!selectedBlock_) { // No non-null block found. Continue searching.
-
-                oldSelectedBlockPos_ = selectedBlockPos_;
-
-                step += blockSearchIncrement_;
-
-            }
+            rayOrigin_ = pos;
+            rayDirection_ = dir;
+            selectionComputed_ = true;
 
         }
 
@@ -131,42 +129,19 @@ namespace VoxelEng {
 
     void player::placeSelectedBlock() {
 
-        if (!GUImanager::levelGUIOpened()) {
+        // The block is placed next to the face of the selected block that the user is looking at.
+        if (!GUImanager::levelGUIOpened() && selectedBlockNormal_ != vec3Zero) {
 
-            float xOld = std::floor(oldSelectedBlockPos_.x),
-                  yOld = std::floor(oldSelectedBlockPos_.y),
-                  zOld = std::floor(oldSelectedBlockPos_.z),
-                  x = std::floor(selectedBlockPos_.x),
-                  y = std::floor(selectedBlockPos_.y),
-                  z = std::floor(selectedBlockPos_.z);
+            vec3 placePos = selectedBlockPos_ + selectedBlockNormal_;
 
-            // Only one coordinate may differ between the two positions.
-            if (xOld != x) {
-            
-                if (yOld != y)
-                    yOld = y;
-
-                if (zOld != z)
-                    zOld = z;
-            
-            }
-            else if (yOld != y) { // xOld == x
+            if (chunkManager::isInWorld(placePos) && !chunkManager::getBlock(placePos)) {
             
-                if (zOld != z)
-                    zOld = z;
-            
-            } // else xOld == x && yOld == y
-
-            if (chunkManager::isInWorld(xOld, yOld, zOld) && !chunkManager::getBlock(xOld, yOld, zOld)) {
-            
-                chunk* selectedChunk = chunkManager::selectChunkByChunkPos(xOld, yOld, zOld),
+                chunk* selectedChunk = chunkManager::selectChunkByRealPos(placePos),
                      * neighbor = nullptr;
 
                 if (selectedChunk && selectedBlock_) {
 
-                    vec3 chunkRelPos(floorMod(xOld, SCX),
-                                     floorMod(yOld, SCY),
-                                     floorMod(zOld, SCZ));
+                    vec3 chunkRelPos = chunkManager::getChunkRelCoords(placePos);
 
                     selectedChunk->setBlock(chunkRelPos, blockToPlace_);
 
@@ -308,36 +283,26 @@ namespace VoxelEng {
     const float entity::piDiv = 3.1415926f / 180.0f;
 
 
-    entity::entity(unsigned int modelID, const vec3& pos, const vec3& rot, tickFunc func)
-        : model_(&models::getModelAt(modelID)), pos_(pos), rot_(rot),
-        updateXRotation_(false), updateYRotation_(false), updateZRotation_(false),
-        tickFunc_(func) {
-    
-        if (rot != vec3Zero)
-            rotate(rot);
-    
-    }
-
     void entity::rotate(float x, float y, float z) {
     
         if (x != 0) {
         
-            rot_.x += x;
-            updateXRotation_ = true;
+            context_->entityRot_[ID_].x += x;
+            context_->entityRotationFlags_[ID_] |= 1;
         
         }
 
         if (y != 0) {
 
-            rot_.y += y;
-            updateYRotation_ = true;
+            context_->entityRot_[ID_].y += y;
+            context_->entityRotationFlags_[ID_] |= 2;
 
         }
 
         if (z != 0) {
 
-            rot_.z += z;
-            updateZRotation_ = true;
+            context_->entityRot_[ID_].z += z;
+            context_->entityRotationFlags_[ID_] |= 4;
 
         }
 
@@ -347,8 +312,8 @@ namespace VoxelEng {
 
         if (angle) {
 
-            rot_.x += angle;
-            updateXRotation_ = true;
+            context_->entityRot_[ID_].x += angle;
+            context_->entityRotationFlags_[ID_] |= 1;
 
         }
 
@@ -358,8 +323,8 @@ namespace VoxelEng {
 
         if (angle) {
 
-            rot_.y += angle;
-            updateYRotation_ = true;
+            context_->entityRot_[ID_].y += angle;
+            context_->entityRotationFlags_[ID_] |= 2;
 
         }
 
@@ -369,8 +334,8 @@ namespace VoxelEng {
 
         if (angle) {
 
-            rot_.z += angle;
-            updateZRotation_ = true;
+            context_->entityRot_[ID_].z += angle;
+            context_->entityRotationFlags_[ID_] |= 4;
 
         }
 
@@ -380,22 +345,22 @@ namespace VoxelEng {
 
         if (roll != 0) {
 
-            rot_.z += roll;
-            updateZRotation_ = true;
+            context_->entityRot_[ID_].z += roll;
+            context_->entityRotationFlags_[ID_] |= 4;
 
         }
 
         if (pitch != 0) {
 
-            rot_.x += pitch;
-            updateXRotation_ = true;
+            context_->entityRot_[ID_].x += pitch;
+            context_->entityRotationFlags_[ID_] |= 1;
 
         }
 
         if (yaw != 0) {
 
-            rot_.y += yaw;
-            updateYRotation_ = true;
+            context_->entityRot_[ID_].y += yaw;
+            context_->entityRotationFlags_[ID_] |= 2;
 
         }
 
@@ -405,8 +370,8 @@ namespace VoxelEng {
     
         if (angle != 0) {
 
-            rot_.z += angle;
-            updateZRotation_ = true;
+            context_->entityRot_[ID_].z += angle;
+            context_->entityRotationFlags_[ID_] |= 4;
 
         }
     
@@ -416,8 +381,8 @@ namespace VoxelEng {
     
         if (angle != 0) {
 
-            rot_.x += angle;
-            updateXRotation_ = true;
+            context_->entityRot_[ID_].x += angle;
+            context_->entityRotationFlags_[ID_] |= 1;
 
         }
     
@@ -427,8 +392,8 @@ namespace VoxelEng {
     
         if (angle != 0) {
 
-            rot_.y += angle;
-            updateYRotation_ = true;
+            context_->entityRot_[ID_].y += angle;
+            context_->entityRotationFlags_[ID_] |= 2;
 
         }
     
@@ -439,21 +404,11 @@ namespace VoxelEng {
 
     bool entityManager::initialised_ = false,
          entityManager::firstManagementIteration_ = true;
-    std::vector<entity> entityManager::entities_;
-    std::vector<batch> entityManager::batches_;
     std::vector<model>* entityManager::renderingDataWrite_ = nullptr,
                       * entityManager::renderingDataRead_ = nullptr;
-    std::unordered_set<unsigned int> entityManager::activeEntityID_,
-                                     entityManager::activeBatchID_,
-                                     entityManager::freeEntityID_,
-                                     entityManager::freeBatchID_,
-                                     entityManager::inactiveEntityID_,
-                                     entityManager::inactiveBatchID_,
-                                     entityManager::deleteableEntityID_;
-    std::list<unsigned int> entityManager::tickingEntityID_;
-    std::unordered_map<unsigned int, unsigned int> entityManager::entityBatch_;
-    std::recursive_mutex entityManager::entitiesMutex_,
-                         entityManager::batchesMutex_;
+    std::atomic<bool> entityManager::instancedRendering_ = false;
+    instanceRenderingData* entityManager::instancesWrite_ = nullptr,
+                         * entityManager::instancesRead_ = nullptr;
     std::condition_variable entityManager::entityManagerCV_;
     std::atomic<bool> entityManager::entityMngCVContinue_ = false;
     std::mutex entityManager::syncMutex_;
@@ -475,6 +430,10 @@ namespace VoxelEng {
                     renderingDataWrite_ = new std::vector<model>();
                 if (!renderingDataRead_)
                     renderingDataRead_ = new std::vector<model>();
+                if (!instancesWrite_)
+                    instancesWrite_ = new instanceRenderingData();
+                if (!instancesRead_)
+                    instancesRead_ = new instanceRenderingData();
             
             }
             
@@ -488,9 +447,10 @@ namespace VoxelEng {
 
     bool entityManager::isEntityRegistered(entityID entityID) {
 
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
 
-        return entityID < entities_.size() && freeEntityID_.find(entityID) == freeEntityID_.cend();
+        return entityID < context.entityPos_.size() && !context.freeEntityID_.contains(entityID);
 
     }
 
@@ -505,19 +465,48 @@ namespace VoxelEng {
 
     bool entityManager::isEntityActive(entityID entityID) {
 
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
 
-        return inactiveEntityID_.find(entityID) == inactiveEntityID_.cend();
+        return !context.inactiveEntityID_.contains(entityID);
+
+    }
+
+    void entityManager::entitiesInAABB(const vec3& min, const vec3& max, std::vector<entityID>& result) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+
+        context.entityIndex_.queryAABB(min, max, result);
+
+    }
+
+    void entityManager::entitiesInRadius(const vec3& center, float radius, std::vector<entityID>& result) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+
+        context.entityIndex_.queryRadius(center, radius, result);
+
+    }
+
+    entityID entityManager::nearestEntity(const vec3& pos, float maxDistance, entityID ignoredID) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+
+        return context.entityIndex_.nearest(pos, maxDistance, ignoredID);
 
     }
 
     unsigned int entityManager::registerBatch_() {
 
-        std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-        batches_.emplace_back();
+        context.batches_.emplace_back();
 
-        return batches_.size() - 1;
+        return context.batches_.size() - 1;
 
     }
 
@@ -538,6 +527,20 @@ namespace VoxelEng {
                 renderingDataRead_ = nullptr;
 
             }
+
+            if (instancesWrite_) {
+
+                delete instancesWrite_;
+                instancesWrite_ = nullptr;
+
+            }
+
+            if (instancesRead_) {
+
+                delete instancesRead_;
+                instancesRead_ = nullptr;
+
+            }
         
         }
         else {
@@ -547,54 +550,106 @@ namespace VoxelEng {
 
             if (!renderingDataRead_)
                 renderingDataRead_ = new std::vector<model>();
+
+            if (!instancesWrite_)
+                instancesWrite_ = new instanceRenderingData();
+
+            if (!instancesRead_)
+                instancesRead_ = new instanceRenderingData();
         
         }
     
     }
 
+    void entityManager::setInstancedRendering(bool on) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
+
+
+        instancedRendering_ = on;
+
+        // Make the rendering data of the selected path be generated in the next management iteration.
+        for (std::size_t i = 0; i < context.batches_.size(); i++)
+            context.batches_[i].isDirty() = true;
+
+    }
+
+    void entityManager::setTickThreads(unsigned int nThreads) {
+
+        if (!nThreads)
+            logger::errorLog("At least one thread is needed to execute the entities' tick functions");
+        else {
+
+            worldContext& context = worldContext::selected();
+
+
+            stopTickThreads_(context);
+
+            context.nTickThreads_ = nThreads;
+            context.tickCommandBuffers_.resize(context.nTickThreads_);
+            if (context.nTickThreads_ > 1)
+                context.tickThreadPool_ = new threadPool(context.nTickThreads_);
+
+        }
+
+    }
+
     void entityManager::manageEntities() {
 
+        worldContext& context = worldContext::selected();
+
+
         // If the generated level is new use the spawn position
         // provided by the selected world generator as the player's.
         if (firstManagementIteration_ && chunkManager::openedTerrainFileName() == "")
             player::changePosition(worldGen::playerSpawnPos());
         firstManagementIteration_ = false;
 
-        // Process active entities that have a corresponding tick function ...
-        entitiesMutex_.lock();
-        unsigned int ID;
-        for (unsigned int i = 0; i < ticksPerFrame_ && i < tickingEntityID_.size(); i++) { // It processes min(ticksPerFrame_, tickingEntityID_.size()) ticks.
+        // Process active entities that have a corresponding tick function in turns...
+        context.entitiesMutex_.lock();
+        unsigned int nTicks = std::min<std::size_t>(ticksPerFrame_, context.tickingEntityID_.size());
+        if (context.tickThreadPool_ && nTicks > 1)
+            tickInParallel_(context, nTicks);
+        else
+            for (unsigned int i = 0; i < ticksPerFrame_ && i < context.tickingEntityID_.size(); i++) { // It processes min(ticksPerFrame_, tickingEntityID_.size()) ticks.
+
+                if (context.nextTickingEntity_ >= context.tickingEntityID_.size())
+                    context.nextTickingEntity_ = 0;
 
-            ID = tickingEntityID_.front();
-            entities_[ID].tickFunc_();
-            tickingEntityID_.push_back(ID);
-            tickingEntityID_.pop_front();
+                context.entityTickFunc_[context.tickingEntityID_[context.nextTickingEntity_++]]();
 
-        }
+            }
 
         // ... and delete all unused entities.
-        for (auto it = deleteableEntityID_.cbegin(); it != deleteableEntityID_.cend(); it++)
-            deleteEntity(*it);
-        deleteableEntityID_.clear();
+        for (std::size_t i = 0; i < context.deleteableEntityID_.size(); i++)
+            deleteEntity(context.deleteableEntityID_[i]);
+        context.deleteableEntityID_.clear();
 
-        entitiesMutex_.unlock();
+        context.entitiesMutex_.unlock();
 
 
         // Regenerate all batches that need to be.
-        batchesMutex_.lock();
+        // With instanced rendering, the instance records of all entities are regenerated instead if any batch changed.
+        context.batchesMutex_.lock();
         bool synchronise = false;
-        for (unsigned int i = 0; i < batches_.size(); i++)
-            if (batches_[i].isDirty()) {
+        for (unsigned int i = 0; i < context.batches_.size(); i++)
+            if (context.batches_[i].isDirty()) {
                     
-                if (renderingDataWrite_->size() <= i)
-                    renderingDataWrite_->push_back(batches_[i].generateVertices());
+                if (instancedRendering_)
+                    context.batches_[i].isDirty() = false;
+                else if (renderingDataWrite_->size() <= i)
+                    renderingDataWrite_->push_back(context.batches_[i].generateVertices());
                 else
-                    renderingDataWrite_->operator[](i) = batches_[i].generateVertices();
+                    renderingDataWrite_->operator[](i) = context.batches_[i].generateVertices();
                 synchronise = true;
                     
             }  
 
-        batchesMutex_.unlock();
+        context.batchesMutex_.unlock();
+
+        if (synchronise && instancedRendering_)
+            generateInstances(*instancesWrite_);
 
         // Sync with rendering thread if necessary to update the models being drawn.
         if (synchronise)
@@ -604,92 +659,104 @@ namespace VoxelEng {
 
     unsigned int entityManager::nEntities() {
 
-        std::unique_lock<std::recursive_mutex> lock(entitiesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lock(context.entitiesMutex_);
 
-        return entities_.size();
+        return context.entityPos_.size();
 
     }
 
     entityID entityManager::registerEntity(unsigned int modelID, int posX, int posY, int posZ, float rotX, float rotY, float rotZ, tickFunc func) {
 
+        worldContext& context = worldContext::selected();
         entityID entityID = 0,
                  batchID = 0;
 
 
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
 
-        // Get entity's ID and register it inside the 'entities_' structure.
-        if (freeEntityID_.empty()) {
+        // Get entity's ID and store its components in the context's component arrays.
+        if (context.freeEntityID_.empty()) {
 
-            entityID = entities_.size();
-            entities_.emplace_back(modelID, vec3(posX, posY, posZ), vec3(rotX, rotY, rotZ), func);
+            entityID = context.entityPos_.size();
+            context.entityPos_.emplace_back(posX, posY, posZ);
+            context.entityRot_.push_back(vec3Zero);
+            context.entityModel_.push_back(&models::getModelAt(modelID));
+            context.entityModelID_.push_back(modelID);
+            context.entityTickFunc_.push_back(func);
+            context.entityHitbox_.emplace_back();
+            context.entityRotationFlags_.push_back(0);
+            context.entityBatch_.push_back(0);
 
         }
         else {
 
-            entityID = *freeEntityID_.begin();
-            freeEntityID_.erase(entityID);
+            entityID = context.freeEntityID_[0];
+            context.freeEntityID_.erase(entityID);
             
-            entities_[entityID].setModelID(modelID);
-            entities_[entityID].pos_ = vec3(posX, posY, posZ);
-            entities_[entityID].rotate(rotX, rotY, rotZ);
-            entities_[entityID].tickFunc_ = func;
+            context.entityPos_[entityID] = vec3(posX, posY, posZ);
+            context.entityModel_[entityID] = &models::getModelAt(modelID);
+            context.entityModelID_[entityID] = modelID;
+            context.entityTickFunc_[entityID] = func;
+            context.entityHitbox_[entityID] = hitbox();
 
         }
-        activeEntityID_.insert(entityID);
+        entity(context, entityID).rotate(rotX, rotY, rotZ);
+        context.activeEntityID_.insert(entityID);
+        context.entityIndex_.insert(entityID, context.entityPos_[entityID]);
 
         if (func)
-            tickingEntityID_.push_back(entityID);
+            context.tickingEntityID_.insert(entityID);
 
         if (!game::AImodeON()) { // Register the new entity inside a batch only if AI mode is disabled.
             
-            std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+            std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-            if (batches_.empty()) { // If no batch is registered.
+            if (context.batches_.empty()) { // If no batch is registered.
 
                 batchID = registerBatch_();
 
-                if (!batches_[batches_.size() - 1].addEntity(entityID))
+                if (!context.batches_[context.batches_.size() - 1].addEntity(entityID))
                     logger::errorLog("Entity with ID: " + std::to_string(entityID) + " has a model too big for a batch!");
 
             }
             else {
 
-                if (freeBatchID_.empty()) {
+                if (context.freeBatchID_.empty()) {
 
-                    if (!batches_[batches_.size() - 1].addEntity(entityID)) { // If last created batch cannot store the entity's model, then create another batch.
+                    if (!context.batches_[context.batches_.size() - 1].addEntity(entityID)) { // If last created batch cannot store the entity's model, then create another batch.
 
                         batchID = registerBatch_();
 
-                        if (!batches_[batches_.size() - 1].addEntity(entityID))
+                        if (!context.batches_[context.batches_.size() - 1].addEntity(entityID))
                             logger::errorLog("Entity with ID " + std::to_string(entityID) + " has a model with too many vertices for a batch.");
 
                     }
                     else
-                        batchID = batches_.size() - 1;
+                        batchID = context.batches_.size() - 1;
 
                 }
                 else {
 
                     bool found = false;
-                    auto it = freeBatchID_.cbegin();
-                    for (it; it != freeBatchID_.cend() && !found;) // Check if new entity's model fits into one of the already created batches.
-                        if (!(found = batches_[*it].addEntity(entityID)))
-                            it++;
+                    std::size_t i = 0;
+                    for (i; i < context.freeBatchID_.size() && !found;) // Check if new entity's model fits into one of the already created batches.
+                        if (!(found = context.batches_[context.freeBatchID_[i]].addEntity(entityID)))
+                            i++;
 
                     if (found) {
 
-                        if (batches_[*it].size() == BATCH_MAX_VERTEX_COUNT)
-                            freeBatchID_.erase(*it);
+                        batchID = context.freeBatchID_[i];
 
-                        batchID = *it;
+                        if (context.batches_[batchID].size() == BATCH_MAX_VERTEX_COUNT)
+                            context.freeBatchID_.erase(batchID);
 
                     }
                     else {
 
                         batchID = registerBatch_();
 
-                        if (!batches_[batches_.size() - 1].addEntity(entityID))
+                        if (!context.batches_[context.batches_.size() - 1].addEntity(entityID))
                             logger::errorLog("Entity with ID: " + std::to_string(entityID) + " has a model too big for a batch!");
 
                     }
@@ -699,7 +766,7 @@ namespace VoxelEng {
             }
 
             // Associate entity and corresponding batch.
-            entityBatch_[entityID] = batchID;
+            context.entityBatch_[entityID] = batchID;
 
         }
 
@@ -707,7 +774,7 @@ namespace VoxelEng {
 
     }
 
-    entity& entityManager::getEntityAt(entityID entityID) {
+    entity entityManager::getEntityAt(entityID entityID) {
 
         if (isEntityRegistered(entityID))
             return getEntity(entityID);
@@ -716,43 +783,49 @@ namespace VoxelEng {
     
     }
 
-    entity& entityManager::getEntity(entityID entityID) {
+    entity entityManager::getEntity(entityID entityID) {
 
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
-        return entities_[entityID];
+        return entity(worldContext::selected(), entityID);
 
     }
 
     void entityManager::changeEntityActiveStateAt(entityID entityID, bool active) {
 
-        if (isEntityRegistered(entityID)) {
+        worldContext& context = worldContext::selected();
+
+
+        if (commandBuffer::recording())
+            commandBuffer::recording()->changeEntityActiveState(entityID, active);
+        else if (isEntityRegistered(entityID)) {
 
-            if (active && inactiveEntityID_.find(entityID) != inactiveEntityID_.cend()) {
+            if (active && context.inactiveEntityID_.contains(entityID)) {
 
-                std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+                std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
 
-                inactiveEntityID_.erase(entityID);
-                activeEntityID_.insert(entityID);
+                context.inactiveEntityID_.erase(entityID);
+                context.activeEntityID_.insert(entityID);
+                context.entityIndex_.insert(entityID, context.entityPos_[entityID]);
 
-                if (entities_[entityID].tickFunc_)
-                    tickingEntityID_.push_back(entityID);
+                if (context.entityTickFunc_[entityID])
+                    context.tickingEntityID_.insert(entityID);
                 
 
             }
-            else if(!active && activeEntityID_.find(entityID) != activeEntityID_.cend()) {
+            else if(!active && context.activeEntityID_.contains(entityID)) {
 
-                std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+                std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
 
-                inactiveEntityID_.insert(entityID);
-                activeEntityID_.erase(entityID);
-                tickingEntityID_.remove(entityID);
+                context.inactiveEntityID_.insert(entityID);
+                context.activeEntityID_.erase(entityID);
+                eraseTickingEntity_(context, entityID);
+                context.entityIndex_.erase(entityID);
 
             }
 
             // Reflect changes on respective batch.
-            std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+            std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-            batches_[entityBatch_[entityID]].changeActiveState(entityID, active);
+            context.batches_[context.entityBatch_[entityID]].changeActiveState(entityID, active);
         
         }
         else
@@ -771,35 +844,45 @@ namespace VoxelEng {
 
     void entityManager::deleteEntity(entityID entityID) {
 
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+        worldContext& context = worldContext::selected();
+
+
+        if (commandBuffer::recording()) {
+
+            commandBuffer::recording()->deleteEntity(entityID);
+            return;
+
+        }
+
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
 
-        freeEntityID_.insert(entityID);
+        context.freeEntityID_.insert(entityID);
 
         if (isEntityActive(entityID)) {
         
-            activeEntityID_.erase(entityID);
-            tickingEntityID_.remove(entityID);
+            context.activeEntityID_.erase(entityID);
+            eraseTickingEntity_(context, entityID);
+            context.entityIndex_.erase(entityID);
         
         } 
         else
-            inactiveEntityID_.erase(entityID);
+            context.inactiveEntityID_.erase(entityID);
 
         // Remove entity from its corresponding batch and
         // mark batch as free if no more entities are related to it.
         // Also reflect changes in said batch.
         if (!game::AImodeON()) {
         
-            std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
-            unsigned int batchID = entityBatch_[entityID];
-            if (batches_[batchID].deleteEntity(entityID))
+            std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
+            unsigned int batchID = context.entityBatch_[entityID];
+            if (context.batches_[batchID].deleteEntity(entityID))
                 deleteBatch_(batchID);
-
-            entityBatch_.erase(entityID);
         
         }
 
         // Reset entity's attributes here.
-        entities_[entityID].rot_ = vec3Zero;
+        context.entityRot_[entityID] = vec3Zero;
+        context.entityRotationFlags_[entityID] = 0;
         
     }
 
@@ -810,12 +893,116 @@ namespace VoxelEng {
         renderingDataRead_ = renderingDataWrite_;
         renderingDataWrite_ = aux;
 
+        std::swap(instancesRead_, instancesWrite_);
+
+    }
+
+    std::size_t entityManager::generateInstances(instanceRenderingData& data) {
+
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+        std::unordered_map<unsigned int, std::size_t> groupIndex;
+        entityID entityID = 0;
+        unsigned int modelID = 0,
+                     first = 0;
+
+
+        data.instances.resize(context.activeEntityID_.size());
+        data.groups.clear();
+
+        // Count the instances of each model...
+        for (std::size_t i = 0; i < context.activeEntityID_.size(); i++) {
+
+            modelID = context.entityModelID_[context.activeEntityID_[i]];
+
+            auto it = groupIndex.find(modelID);
+            if (it == groupIndex.cend()) {
+
+                groupIndex[modelID] = data.groups.size();
+                data.groups.push_back({ modelID, 0, 1 });
+
+            }
+            else
+                data.groups[it->second].count++;
+
+        }
+
+        // ... give each model its range of instances, in increasing model ID order so that the draw order is stable...
+        std::sort(data.groups.begin(), data.groups.end(), [](const instanceGroup& a, const instanceGroup& b) {
+
+            return a.modelID < b.modelID;
+
+        });
+        for (std::size_t i = 0; i < data.groups.size(); i++) {
+
+            groupIndex[data.groups[i].modelID] = i;
+            data.groups[i].first = first;
+            first += data.groups[i].count;
+            data.groups[i].count = 0;
+
+        }
+
+        // ... and write each entity's record in the next free position of its model's range.
+        for (std::size_t i = 0; i < context.activeEntityID_.size(); i++) {
+
+            entityID = context.activeEntityID_[i];
+            instanceGroup& group = data.groups[groupIndex[context.entityModelID_[entityID]]];
+            entityInstance& instance = data.instances[group.first + group.count++];
+            const vec3& pos = context.entityPos_[entityID],
+                      & rot = context.entityRot_[entityID];
+            unsigned char rotationFlags = context.entityRotationFlags_[entityID];
+
+            instance.pos[0] = pos.x;
+            instance.pos[1] = pos.y;
+            instance.pos[2] = pos.z;
+            instance.rot[0] = (rotationFlags & 1) ? rot.x * entity::piDiv : 0.0f;
+            instance.rot[1] = (rotationFlags & 2) ? rot.y * entity::piDiv : 0.0f;
+            instance.rot[2] = (rotationFlags & 4) ? rot.z * entity::piDiv : 0.0f;
+            instance.modelID = context.entityModelID_[entityID];
+
+        }
+
+        return data.instances.size() * sizeof(entityInstance);
+
+    }
+
+    void entityManager::reportRenderingDataSize() {
+
+        worldContext& context = worldContext::selected();
+        instanceRenderingData data;
+        std::size_t instanceBytes = generateInstances(data),
+                    batchedBytes = 0,
+                    modelBytes = 0;
+
+
+        {
+
+            std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+            for (std::size_t i = 0; i < context.activeEntityID_.size(); i++)
+                batchedBytes += context.entityModel_[context.activeEntityID_[i]]->size() * sizeof(vertex);
+
+        }
+
+        for (std::size_t i = 0; i < data.groups.size(); i++)
+            modelBytes += models::getModelAt(data.groups[i].modelID).size() * sizeof(vertex);
+
+        logger::say("Rendering data of " + std::to_string(data.instances.size()) + " active entities using " + std::to_string(data.groups.size()) + " models");
+        logger::say("Batched rendering: " + std::to_string(batchedBytes) + " bytes of vertices sent each time the entities change");
+        logger::say("Instanced rendering: " + std::to_string(instanceBytes) + " bytes of instance records sent each time the entities change and " +
+                    std::to_string(modelBytes) + " bytes of model vertices sent once");
+
     }
 
     void entityManager::moveEntity(entityID entityID, int x, int y, int z) {
     
-        if (entityManager::isEntityRegistered(entityID)) {
+        worldContext& context = worldContext::selected();
+
 
+        if (commandBuffer::recording())
+            commandBuffer::recording()->moveEntity(entityID, x, y, z);
+        else if (entityManager::isEntityRegistered(entityID)) {
+
+            std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
             vec3& pos = entityManager::getEntity(entityID).pos();
             pos.x += x;
             pos.y += y;
@@ -824,8 +1011,11 @@ namespace VoxelEng {
             if (y != 0)
                 y = y - 1 + 1;
 
+            if (context.entityIndex_.contains(entityID))
+                context.entityIndex_.update(entityID, pos);
+
             if (!game::AImodeON())
-                batches_[entityBatch_[entityID]].isDirty() = true;
+                context.batches_[context.entityBatch_[entityID]].isDirty() = true;
 
         }
         else
@@ -833,27 +1023,166 @@ namespace VoxelEng {
     
     }
 
+    void entityManager::setEntityPos(entityID entityID, const vec3& pos) {
+
+        worldContext& context = worldContext::selected();
+
+
+        if (commandBuffer::recording())
+            commandBuffer::recording()->setEntityPos(entityID, pos);
+        else if (isEntityRegistered(entityID)) {
+
+            std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+
+            context.entityPos_[entityID] = pos;
+
+            if (context.entityIndex_.contains(entityID))
+                context.entityIndex_.update(entityID, pos);
+
+            if (!game::AImodeON())
+                context.batches_[context.entityBatch_[entityID]].isDirty() = true;
+
+        }
+        else
+            logger::errorLog("Entity with ID " + std::to_string(entityID) + " was not found");
+
+    }
+
+    void entityManager::setEntityHitbox(entityID entityID, const hitbox& box) {
+
+        worldContext& context = worldContext::selected();
+
+
+        if (isEntityRegistered(entityID)) {
+
+            std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+
+            context.entityHitbox_[entityID] = box;
+
+        }
+        else
+            logger::errorLog("Entity with ID " + std::to_string(entityID) + " was not found");
+
+    }
+
+    sweepResult entityManager::moveEntityColliding(entityID entityID, const vec3& movement) {
+
+        worldContext& context = worldContext::selected();
+        vec3 pos;
+        hitbox box;
+        sweepResult result;
+
+
+        if (!isEntityRegistered(entityID))
+            logger::errorLog("Entity with ID " + std::to_string(entityID) + " was not found");
+
+        {
+
+            std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+            pos = context.entityPos_[entityID];
+            box = context.entityHitbox_[entityID].translated(pos);
+
+        }
+
+        // The entities' mutex is not held while reading the terrain so that it is never locked before the chunks' mutex.
+        result = box.sweep(movement);
+        setEntityPos(entityID, pos + result.movement);
+
+        return result;
+
+    }
+
+    void entityManager::moveEntitiesColliding(const std::vector<entityID>& entityIDs, const std::vector<vec3>& movements) {
+
+        worldContext& context = worldContext::selected();
+        std::vector<vec3> positions(entityIDs.size());
+        std::vector<hitbox> boxes(entityIDs.size());
+        std::vector<sweepResult> results;
+
+
+        if (entityIDs.size() != movements.size())
+            logger::errorLog("The number of entities and movements to resolve must be the same");
+
+        {
+
+            std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
+            for (std::size_t i = 0; i < entityIDs.size(); i++) {
+
+                if (!isEntityRegistered(entityIDs[i]))
+                    logger::errorLog("Entity with ID " + std::to_string(entityIDs[i]) + " was not found");
+
+                positions[i] = context.entityPos_[entityIDs[i]];
+                boxes[i] = context.entityHitbox_[entityIDs[i]].translated(positions[i]);
+
+            }
+
+        }
+
+        hitbox::sweep(boxes, movements, results);
+
+        for (std::size_t i = 0; i < entityIDs.size(); i++)
+            setEntityPos(entityIDs[i], positions[i] + results[i].movement);
+
+    }
+
+    void entityManager::rotateEntity(entityID entityID, float x, float y, float z) {
+
+        worldContext& context = worldContext::selected();
+
+
+        if (commandBuffer::recording())
+            commandBuffer::recording()->rotateEntity(entityID, x, y, z);
+        else if (isEntityRegistered(entityID)) {
+
+            getEntity(entityID).rotate(x, y, z);
+
+            if (!game::AImodeON())
+                context.batches_[context.entityBatch_[entityID]].isDirty() = true;
+
+        }
+        else
+            logger::errorLog("Entity with ID " + std::to_string(entityID) + " was not found");
+
+    }
+
     void entityManager::clean() {
 
-        std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
         std::unique_lock<std::mutex> syncLock(syncMutex_);
 
-        entities_.clear();
+        context.entityPos_.clear();
+        context.entityRot_.clear();
+        context.entityModel_.clear();
+        context.entityModelID_.clear();
+        context.entityTickFunc_.clear();
+        context.entityHitbox_.clear();
+        context.entityRotationFlags_.clear();
+
+        context.batches_.clear();
+
+        context.entityBatch_.clear();
+        context.entityBatchSlot_.clear();
 
-        batches_.clear();
+        context.activeEntityID_.clear();
 
-        entityBatch_.clear();
+        context.activeBatchID_.clear();
 
-        activeEntityID_.clear();
+        context.freeEntityID_.clear();
 
-        activeBatchID_.clear();
+        context.freeBatchID_.clear();
 
-        freeEntityID_.clear();
+        context.inactiveEntityID_.clear();
 
-        freeBatchID_.clear();
+        context.inactiveBatchID_.clear();
 
-        tickingEntityID_.clear();
+        context.deleteableEntityID_.clear();
+
+        context.tickingEntityID_.clear();
+        context.nextTickingEntity_ = 0;
+
+        context.entityIndex_.clear();
 
         if (renderingDataWrite_)
             renderingDataWrite_->clear();
@@ -861,29 +1190,52 @@ namespace VoxelEng {
         if (renderingDataRead_)
             renderingDataRead_->clear();
 
+        if (instancesWrite_)
+            *instancesWrite_ = instanceRenderingData();
+
+        if (instancesRead_)
+            *instancesRead_ = instanceRenderingData();
+
     }
 
     void entityManager::cleanUp() {
 
-        std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
-        std::unique_lock<std::recursive_mutex> lockEntities(entitiesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
+        std::unique_lock<std::recursive_mutex> lockEntities(context.entitiesMutex_);
         std::unique_lock<std::mutex> syncLock(syncMutex_);
 
-        entities_.clear();
+        context.entityPos_.clear();
+        context.entityRot_.clear();
+        context.entityModel_.clear();
+        context.entityModelID_.clear();
+        context.entityTickFunc_.clear();
+        context.entityHitbox_.clear();
+        context.entityRotationFlags_.clear();
+
+        context.batches_.clear();
+
+        context.entityBatch_.clear();
+        context.entityBatchSlot_.clear();
+
+        context.activeEntityID_.clear();
+
+        context.activeBatchID_.clear();
 
-        batches_.clear();
+        context.freeEntityID_.clear();
 
-        entityBatch_.clear();
+        context.freeBatchID_.clear();
 
-        activeEntityID_.clear();
+        context.inactiveEntityID_.clear();
 
-        activeBatchID_.clear();
+        context.inactiveBatchID_.clear();
 
-        freeEntityID_.clear();
+        context.deleteableEntityID_.clear();
 
-        freeBatchID_.clear();
+        context.tickingEntityID_.clear();
+        context.nextTickingEntity_ = 0;
 
-        tickingEntityID_.clear();
+        context.entityIndex_.clear();
 
         if (renderingDataWrite_) {
         
@@ -899,15 +1251,36 @@ namespace VoxelEng {
 
         }
 
+        if (instancesWrite_) {
+
+            delete instancesWrite_;
+            instancesWrite_ = nullptr;
+
+        }
+
+        if (instancesRead_) {
+
+            delete instancesRead_;
+            instancesRead_ = nullptr;
+
+        }
+        instancedRendering_ = false;
+
+        stopTickThreads_(context);
+        context.nTickThreads_ = 1;
+        context.tickCommandBuffers_.clear();
+        context.tickedEntityID_.clear();
+
         initialised_ = false;
 
     }
 
     bool entityManager::isBatchRegistered_(unsigned int batchID) {
 
-        std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-        return batchID < batches_.size() && freeBatchID_.find(batchID) == freeBatchID_.cend();
+        return batchID < context.batches_.size() && !context.freeBatchID_.contains(batchID);
 
     }
 
@@ -922,8 +1295,9 @@ namespace VoxelEng {
 
     bool entityManager::isBatchActive_(unsigned int batchID) {
 
-        std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
-        return inactiveBatchID_.find(batchID) == inactiveBatchID_.cend();
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
+        return !context.inactiveBatchID_.contains(batchID);
 
     }
 
@@ -941,20 +1315,23 @@ namespace VoxelEng {
 
     void entityManager::changeBatchActiveState_(unsigned int batchID, bool active) {
 
+        worldContext& context = worldContext::selected();
+
+
         if (active) {
 
-            std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+            std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-            inactiveBatchID_.erase(batchID);
-            activeBatchID_.insert(batchID);
+            context.inactiveBatchID_.erase(batchID);
+            context.activeBatchID_.insert(batchID);
 
         }
         else {
 
-            std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+            std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-            inactiveBatchID_.insert(batchID);
-            activeBatchID_.erase(batchID);
+            context.inactiveBatchID_.insert(batchID);
+            context.activeBatchID_.erase(batchID);
 
         }
 
@@ -971,14 +1348,134 @@ namespace VoxelEng {
 
     void entityManager::deleteBatch_(unsigned int batchID) {
 
-        std::unique_lock<std::recursive_mutex> lockBatches(batchesMutex_);
+        worldContext& context = worldContext::selected();
+        std::unique_lock<std::recursive_mutex> lockBatches(context.batchesMutex_);
 
-        freeBatchID_.insert(batchID);
-        batches_[batchID].clear();
+        context.freeBatchID_.insert(batchID);
+        context.batches_[batchID].clear();
         if (isBatchActive_(batchID))
-            activeBatchID_.erase(batchID);
+            context.activeBatchID_.erase(batchID);
         else
-            inactiveBatchID_.erase(batchID);
+            context.inactiveBatchID_.erase(batchID);
+
+    }
+
+    void entityManager::eraseTickingEntity_(worldContext& context, entityID entityID) {
+
+        if (context.tickingEntityID_.contains(entityID)) {
+
+            // Erasing moves the last entity of the ring to the erased one's position. If that position
+            // has already been ticked in this turn, the erased entity is first swapped with the last ticked
+            // one so that the moved entity ends at the cursor's position and does not miss its tick.
+            if (context.tickingEntityID_.indexOf(entityID) < context.nextTickingEntity_) {
+
+                context.tickingEntityID_.swap(entityID, context.tickingEntityID_[--context.nextTickingEntity_]);
+                context.tickingEntityID_.erase(entityID);
+
+            }
+            else
+                context.tickingEntityID_.erase(entityID);
+
+        }
+
+    }
+
+    void entityManager::restoreTickState_(worldContext& context, commandBuffer* buffer) {
+
+        worldContext::select(&context);
+        if (buffer)
+            buffer->startRecording();
+        else
+            commandBuffer::stopRecording();
+
+    }
+
+    void entityManager::tickInParallel_(worldContext& context, unsigned int nTicks) {
+
+        // threadPool::wait() does not return until the last task of the group has stopped using it,
+        // so the group can live in the stack.
+        taskGroup group;
+        std::vector<std::future<void>> partitions;
+        std::size_t nPartitions = std::min<std::size_t>(context.nTickThreads_, nTicks),
+                    partitionSize = (nTicks + nPartitions - 1) / nPartitions;
+
+
+        // Take the entities to tick this frame from the ring, in order.
+        context.tickedEntityID_.clear();
+        for (unsigned int i = 0; i < nTicks; i++) {
+
+            if (context.nextTickingEntity_ >= context.tickingEntityID_.size())
+                context.nextTickingEntity_ = 0;
+
+            context.tickedEntityID_.push_back(context.tickingEntityID_[context.nextTickingEntity_++]);
+
+        }
+
+        // The tick functions read the level through the static API, which locks the entities' mutex,
+        // so it is released while the partitions are processed. Their changes are deferred anyway.
+        context.entitiesMutex_.unlock();
+
+        for (std::size_t i = 0; i < nPartitions; i++) {
+
+            std::size_t begin = i * partitionSize,
+                        end = std::min<std::size_t>(begin + partitionSize, nTicks);
+            commandBuffer& buffer = context.tickCommandBuffers_[i];
+
+            partitions.push_back(context.tickThreadPool_->submit(group, [&context, &buffer, begin, end]() {
+
+                // The partition can be processed by the thread waiting for the group, which may have selected
+                // another context or be recording into another buffer, so both are restored afterwards.
+                worldContext& previousContext = worldContext::selected();
+                commandBuffer* previousBuffer = commandBuffer::recording();
+
+
+                worldContext::select(&context);
+                buffer.clear();
+                buffer.startRecording();
+
+                try {
+
+                    for (std::size_t j = begin; j < end; j++)
+                        context.entityTickFunc_[context.tickedEntityID_[j]]();
+
+                }
+                catch (...) {
+
+                    restoreTickState_(previousContext, previousBuffer);
+                    throw;
+
+                }
+
+                restoreTickState_(previousContext, previousBuffer);
+
+            }));
+
+        }
+        context.tickThreadPool_->wait(group);
+
+        context.entitiesMutex_.lock();
+
+        // Rethrow any error raised by a tick function before changing anything.
+        for (std::size_t i = 0; i < partitions.size(); i++)
+            partitions[i].get();
+
+        // Merge the changes in the order of the ticking queue so that the result
+        // does not depend on how the partitions were scheduled.
+        for (std::size_t i = 0; i < nPartitions; i++)
+            context.tickCommandBuffers_[i].apply();
+
+    }
+
+    void entityManager::stopTickThreads_(worldContext& context) {
+
+        if (context.tickThreadPool_) {
+
+            context.tickThreadPool_->shutdown();
+            context.tickThreadPool_->awaitTermination();
+            delete context.tickThreadPool_;
+            context.tickThreadPool_ = nullptr;
+
+        }
 
     }
 
@@ -11,7 +11,7 @@
 #define _VOXENG_ENTITY_
 #include <atomic>
 #include <condition_variable>
-#include <list>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -28,9 +28,15 @@
 #include "batch.h"
 #include "camera.h"
 #include "chunk.h"
+#include "commandBuffer.h"
 #include "definitions.h"
+#include "entityInstance.h"
 #include "gameWindow.h"
+#include "hitbox.h"
 #include "model.h"
+#include "raycast.h"
+#include "spatialIndex.h"
+#include "threadPool.h"
 
 
 namespace VoxelEng {
@@ -71,8 +77,10 @@ namespace VoxelEng {
 		static camera& getCamera();
 
 		/**
-		* @brief Computes a basic raycast to select a block in the world that is
+		* @brief Computes a raycast to select a block in the world that is
 		* reachable from where the user stands.
+		* The raycast is only recomputed if the camera has moved or rotated or if any of
+		* the chunks that the previous one went through has changed.
 		*/
 		static void selectBlock();
 
@@ -126,12 +134,15 @@ namespace VoxelEng {
 		static bool initialised_;
 		static GLFWwindow* window_;
 		static camera* camera_;
-		static float blockReachRange_,
-			         blockSearchIncrement_;
+		static float blockReachRange_;
 		static block selectedBlock_;
 		static std::atomic<block> blockToPlace_;
 		static vec3 selectedBlockPos_,
-			        oldSelectedBlockPos_;
+			        selectedBlockNormal_, // Normal of the selected block's face that the user is looking at.
+			        rayOrigin_,
+			        rayDirection_;
+		static bool selectionComputed_;
+		static std::vector<raycastChunk> rayChunks_;
 		
 
 		/*
@@ -169,14 +180,20 @@ namespace VoxelEng {
 
 		/**
 		* @brief Class constructor.
-		* WARNING. To create an entity use entityManager::registerEntity(). Otherwise the
-		* created entity will not be registered in the entity management system.
+		* WARNING. To create an entity use entityManager::registerEntity() and to access it
+		* use entityManager::getEntity(). Otherwise the object will not refer to an entity
+		* registered in the entity management system.
 		*/
-		entity(unsigned int modelID, const vec3& pos, const vec3& rot, tickFunc func = nullptr);
+		entity(worldContext& context, entityID ID);
 
 
 		// Observers.
 
+		/**
+		* @brief Get the entity's ID.
+		*/
+		entityID ID() const;
+
 		/**
 		* @brief Get the entity's position.
 		*/
@@ -207,6 +224,11 @@ namespace VoxelEng {
 		*/
 		const model& entityModel() const;
 
+		/**
+		* @brief Get the entity's hitbox relative to its position.
+		*/
+		const hitbox& entityHitbox() const;
+
 		/**
 		* @brief Flag to check if model X rotation needs to be updated in the model's vertices.
 		*/
@@ -357,127 +379,139 @@ namespace VoxelEng {
 
 		static const float piDiv;
 
-		bool updateXRotation_,
-			 updateYRotation_,
-			 updateZRotation_;
-		vec3 pos_,
-			 rot_;
-		const model* model_;
-		tickFunc tickFunc_;
+		// The entity's components are stored in the context where it is registered.
+		worldContext* context_;
+		entityID ID_;
 
 	};
 
+	inline entity::entity(worldContext& context, entityID ID)
+		: context_(&context), ID_(ID)
+	{}
+
+	inline entityID entity::ID() const {
+
+		return ID_;
+
+	}
+
 	inline const vec3& entity::pos() const {
 	
-		return pos_;
+		return context_->entityPos_[ID_];
 	
 	}
 
 	inline const vec3& entity::rot() const {
 	
-		return rot_;
+		return context_->entityRot_[ID_];
 	
 	}
 
 	inline float entity::x() const {
 	
-		return pos_.x;
+		return context_->entityPos_[ID_].x;
 	
 	}
 
 	inline float entity::y() const {
 
-		return pos_.y;
+		return context_->entityPos_[ID_].y;
 
 	}
 
 	inline float entity::z() const {
 
-		return pos_.z;
+		return context_->entityPos_[ID_].z;
 
 	}
 
 	inline const model& entity::entityModel() const {
 
-		return *model_;
+		return *context_->entityModel_[ID_];
+
+	}
+
+	inline const hitbox& entity::entityHitbox() const {
+
+		return context_->entityHitbox_[ID_];
 
 	}
 
 	inline bool entity::updateXRotation() const {
 	
-		return updateXRotation_;
+		return context_->entityRotationFlags_[ID_] & 1;
 	
 	}
 
 	inline bool entity::updateYRotation() const {
 
-		return updateYRotation_;
+		return context_->entityRotationFlags_[ID_] & 2;
 
 	}
 
 	inline bool entity::updateZRotation() const {
 
-		return updateZRotation_;
+		return context_->entityRotationFlags_[ID_] & 4;
 
 	}
 
 	inline float entity::sinAngleX() const {
 
-		return std::sin(rot_.x * piDiv);
+		return std::sin(context_->entityRot_[ID_].x * piDiv);
 	
 	}
 
 	inline float entity::cosAngleX() const {
 
-		return std::cos(rot_.x * piDiv);
+		return std::cos(context_->entityRot_[ID_].x * piDiv);
 
 	}
 
 	inline float entity::sinAngleY() const {
 
-		return std::sin(rot_.y * piDiv);
+		return std::sin(context_->entityRot_[ID_].y * piDiv);
 
 	}
 
 	inline float entity::cosAngleY() const {
 
-		return std::cos(rot_.y * piDiv);
+		return std::cos(context_->entityRot_[ID_].y * piDiv);
 
 	}
 
 	inline float entity::sinAngleZ() const {
 
-		return std::sin(rot_.z * piDiv);
+		return std::sin(context_->entityRot_[ID_].z * piDiv);
 
 	}
 
 	inline float entity::cosAngleZ() const {
 
-		return std::cos(rot_.z * piDiv);
+		return std::cos(context_->entityRot_[ID_].z * piDiv);
 
 	}
 
 	inline vec3& entity::pos() {
 
-		return pos_;
+		return context_->entityPos_[ID_];
 
 	}
 
 	inline float& entity::x() {
 
-		return pos_.x;
+		return context_->entityPos_[ID_].x;
 
 	}
 
 	inline float& entity::y() {
 
-		return pos_.y;
+		return context_->entityPos_[ID_].y;
 
 	}
 
 	inline float& entity::z() {
 
-		return pos_.z;
+		return context_->entityPos_[ID_].z;
 
 	}
 
@@ -495,7 +529,7 @@ namespace VoxelEng {
 
 	inline void entity::setModelID(unsigned int modelID) {
 	
-		model_ = &models::getModelAt(modelID);
+		context_->entityModel_[ID_] = &models::getModelAt(modelID);
 	
 	}
 
@@ -543,6 +577,23 @@ namespace VoxelEng {
 		*/
 		static bool isEntityActive(entityID entityID);
 
+		/**
+		* @brief Appends to 'result' the active entities whose position is inside the axis-aligned box
+		* between 'min' and 'max' (both included).
+		*/
+		static void entitiesInAABB(const vec3& min, const vec3& max, std::vector<entityID>& result);
+
+		/**
+		* @brief Appends to 'result' the active entities whose position is at a distance of 'radius' or less from 'center'.
+		*/
+		static void entitiesInRadius(const vec3& center, float radius, std::vector<entityID>& result);
+
+		/**
+		* @brief Returns the active entity nearest to 'pos' at a distance of 'maxDistance' or less, ignoring 'ignoredID',
+		* or spatialIndex::noEntity if there is none.
+		*/
+		static entityID nearestEntity(const vec3& pos, float maxDistance = std::numeric_limits<float>::infinity(), entityID ignoredID = spatialIndex::noEntity);
+
 
 		// Modifiers: general.
 
@@ -552,6 +603,25 @@ namespace VoxelEng {
 		*/
 		static void setAImode(bool on);
 
+		/**
+		* @brief Draw the entities with instanced rendering, uploading each model's vertices only once and
+		* a compact record per entity each time they change, or with their batches' vertices, which are transformed
+		* in the CPU. The batched rendering is used by default.
+		*/
+		static void setInstancedRendering(bool on);
+
+		/**
+		* @brief Set the number of threads used to execute the entities' tick functions of the selected level.
+		* Each level has its own threads and command buffers, so several levels can be managed at the same time.
+		* With more than one thread, the tick functions of each frame are split into as many contiguous
+		* partitions of the ticking queue and executed in parallel. The changes they make through
+		* chunkManager::setBlock(), entityManager::moveEntity(), entityManager::setEntityPos(), entityManager::rotateEntity(),
+		* entityManager::changeEntityActiveStateAt() and entityManager::deleteEntity() are recorded in a command buffer
+		* per partition and applied once all partitions are finished, in the order of the ticking queue.
+		* WARNING. With more than one thread, tick functions must not modify the level through any other means.
+		*/
+		static void setTickThreads(unsigned int nThreads);
+
 		/**
 		* @brief Function used by a worker thread to manage entities in a world/level.
 		* Management includes creating, updating and removing entities from the world.
@@ -584,12 +654,12 @@ namespace VoxelEng {
 		/**
 		* @brief Returns the entity with the specified entity ID (with bounds checking).
 		*/
-		static entity& getEntityAt(entityID ID);
+		static entity getEntityAt(entityID ID);
 
 		/**
 		* @brief Returns the entity with the specified entity ID (without bounds checking).
 		*/
-		static entity& getEntity(entityID ID);
+		static entity getEntity(entityID ID);
 
 		/**
 		* @brief Changes the entity's active state (without bounds checking).
@@ -634,11 +704,58 @@ namespace VoxelEng {
 		*/
 		static const std::vector<model>* renderingData();
 
+		/**
+		* @brief Returns true if the entities are drawn with instanced rendering or false if
+		* they are drawn with their batches' vertices.
+		*/
+		static bool instancedRendering();
+
+		/**
+		* @brief Get the readable instance records necessary for the rendering thread to draw the entities
+		* with instanced rendering.
+		*/
+		static const instanceRenderingData* instanceData();
+
+		/**
+		* @brief Fill 'data' with the instance records of the active entities of the level selected in the calling thread,
+		* grouped by model ID in increasing order, and return the number of bytes of instance records produced.
+		* It does not need a graphics API context.
+		*/
+		static std::size_t generateInstances(instanceRenderingData& data);
+
+		/**
+		* @brief Report the number of bytes that the active entities of the level selected in the calling thread
+		* need to send to the GPU with batched rendering and with instanced rendering.
+		* It does not need a graphics API context.
+		*/
+		static void reportRenderingDataSize();
+
 
 		// Modifiers: actions on entities.
 
 		static void moveEntity(entityID entityID, int x, int y, int z);
 
+		static void setEntityPos(entityID entityID, const vec3& pos);
+
+		/**
+		* @brief Set the entity's hitbox, given relative to its position. Entities are created with an empty one.
+		*/
+		static void setEntityHitbox(entityID entityID, const hitbox& box);
+
+		/**
+		* @brief Move the entity by 'movement' colliding its hitbox against the level's blocks.
+		* See hitbox::sweep().
+		*/
+		static sweepResult moveEntityColliding(entityID entityID, const vec3& movement);
+
+		/**
+		* @brief Move each entity in 'entityIDs' by the movement with the same index colliding their hitboxes against
+		* the level's blocks, resolving all of them at once. See hitbox::sweep().
+		*/
+		static void moveEntitiesColliding(const std::vector<entityID>& entityIDs, const std::vector<vec3>& movements);
+
+		static void rotateEntity(entityID entityID, float x, float y, float z);
+
 		
 		// Clean up.
 
@@ -660,28 +777,16 @@ namespace VoxelEng {
 
 		static bool initialised_,
 					firstManagementIteration_;
-		static std::vector<entity> entities_;
-		static std::vector<batch> batches_;
-
-		static std::unordered_map<unsigned int, unsigned int> entityBatch_; // Relates entity's ID with the batch it belongs to.
-		static std::unordered_set<unsigned int> activeEntityID_,
-												activeBatchID_,
-											    freeEntityID_,
-												freeBatchID_,
-												inactiveEntityID_,
-												inactiveBatchID_,
-												deleteableEntityID_;
-
-		// Queue of entities' ID that belong to entities that are
-		// waiting for their tick method (with its respective pointer different from nullptr)
-		// to execute.
-		static std::list<unsigned int> tickingEntityID_; 	
+
+		// The entities' components, their batches and the ring of entities' ID whose tick method
+		// is executed in turns are kept in the selected 'worldContext'.
 
 		static std::vector <model>* renderingDataWrite_,
 						          * renderingDataRead_;
-		
-		static std::recursive_mutex entitiesMutex_,
-									batchesMutex_;
+		static std::atomic<bool> instancedRendering_;
+		static instanceRenderingData* instancesWrite_,
+									* instancesRead_;
+
 		static std::condition_variable entityManagerCV_;
 		static std::atomic<bool> entityMngCVContinue_;
 		static std::mutex syncMutex_;
@@ -733,6 +838,28 @@ namespace VoxelEng {
 		*/
 		static void deleteBatch_(unsigned int batchID);
 
+		/*
+		Removes an entity from the ticking ring without making any other entity miss its turn.
+		*/
+		static void eraseTickingEntity_(worldContext& context, entityID entityID);
+
+		/*
+		Execute the tick functions of the next 'nTicks' entities of the ticking queue in parallel
+		and apply the changes they made once all of them are finished.
+		*/
+		static void tickInParallel_(worldContext& context, unsigned int nTicks);
+
+		/*
+		Stop the threads used to execute the tick functions of the level 'context' in parallel.
+		*/
+		static void stopTickThreads_(worldContext& context);
+
+		/*
+		Select 'context' in the calling thread and make it record into 'buffer',
+		or apply its changes directly if 'buffer' is nullptr.
+		*/
+		static void restoreTickState_(worldContext& context, commandBuffer* buffer);
+
 
 	};
 
@@ -778,6 +905,18 @@ namespace VoxelEng {
 	
 	}
 
+	inline bool entityManager::instancedRendering() {
+
+		return instancedRendering_;
+
+	}
+
+	inline const instanceRenderingData* entityManager::instanceData() {
+
+		return instancesRead_;
+
+	}
+
 }
 
 #endif
\ No newline at end of file
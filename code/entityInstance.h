@@ -0,0 +1,59 @@
+/**
+* @file entityInstance.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Entity instance.
+* @brief Contains the declaration of the per entity records used to draw the entities
+* with instanced rendering instead of with their batches' vertices.
+*/
+#ifndef _VOXELENG_ENTITYINSTANCE_
+#define _VOXELENG_ENTITYINSTANCE_
+#include <vector>
+
+
+namespace VoxelEng {
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief What needs to be sent to the GPU each time an entity changes in order to draw it
+	* with its model's vertices, which are sent only once.
+	* 'rot' contains the entity's rotation angles in radians around the X, Y and Z axes, which are
+	* applied in that order. Its layout must match the one of the instance attributes in the vertex shader.
+	*/
+	struct entityInstance {
+
+		float pos[3],
+			  rot[3];
+		unsigned int modelID;
+
+	};
+
+	/**
+	* @brief The instances from 'first' to 'first' + 'count' - 1 use the model 'modelID'
+	* and are drawn with a single instanced draw call.
+	*/
+	struct instanceGroup {
+
+		unsigned int modelID,
+					 first,
+					 count;
+
+	};
+
+	/**
+	* @brief Instance records of all the entities to draw, stored contiguously by model.
+	*/
+	struct instanceRenderingData {
+
+		std::vector<entityInstance> instances;
+		std::vector<instanceGroup> groups;
+
+	};
+
+}
+
+#endif
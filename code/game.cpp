@@ -77,12 +77,18 @@ namespace VoxelEng {
 
     std::unordered_map<vec3, std::vector<vertex>> const* game::chunksToDraw_ = nullptr;
     const std::vector<model>* game::batchesToDraw_ = nullptr;
+    const instanceRenderingData* game::instancesToDraw_ = nullptr;
+    bool game::instancesChanged_ = false;
 
     shader* game::defaultShader_ = nullptr;
     vertexBuffer* game::vbo_ = nullptr;
     vertexArray* game::va_ = nullptr;
     vertexBufferLayout* game::layout_ = nullptr;
     renderer* game::renderer_ = nullptr;
+    vertexArray* game::instanceVa_ = nullptr;
+    vertexBuffer* game::instanceVbo_ = nullptr;
+    vertexBufferLayout* game::instanceLayout_ = nullptr;
+    std::unordered_map<unsigned int, vertexBuffer*> game::modelVbos_;
 
     #if GRAPHICS_API == OPENGL
 
@@ -206,6 +212,9 @@ namespace VoxelEng {
             va_ = new vertexArray();
             layout_ = new vertexBufferLayout();
             renderer_ = new renderer();
+            instanceVa_ = new vertexArray();
+            instanceVbo_ = new vertexBuffer();
+            instanceLayout_ = new vertexBufferLayout();
 
 
             /*
@@ -275,6 +284,11 @@ namespace VoxelEng {
             layout_->push<GLfloat>(2);
             layout_->push<normalVec>(1);
 
+            // Configure the instance layout for instanced entity rendering. It must match 'entityInstance'.
+            instanceLayout_->push<GLfloat>(3);
+            instanceLayout_->push<GLfloat>(3);
+            instanceLayout_->push<unsigned int>(1);
+
 
             // Bind the currently used VAO, shaders and atlases for 3D rendering.
             va_->bind();
@@ -440,6 +454,8 @@ namespace VoxelEng {
                     input::setControlAction(controlCode::rightArrow, inputFunctions::recordForward, false);
                     input::setControlAction(controlCode::downArrow, inputFunctions::recordPause, false);
                     input::setControlAction(controlCode::leftArrow, inputFunctions::recordBackwards, false);
+                    input::setControlAction(controlCode::period, inputFunctions::recordSeekForward, false);
+                    input::setControlAction(controlCode::comma, inputFunctions::recordSeekBackwards, false);
                     input::setControlAction(controlCode::x, inputFunctions::exitRecord, false);
 
                     world::addGlobalTickFunction("playRecordTick", TickFunctions::playRecordTick);
@@ -561,6 +577,8 @@ namespace VoxelEng {
 
                     entityManager::swapReadWrite();
                     batchesToDraw_ = entityManager::renderingData();
+                    instancesToDraw_ = entityManager::instanceData();
+                    instancesChanged_ = true;
 
                     entityManager::syncMutex().unlock();
                     entityManager::entityManagerCV().notify_one();
@@ -590,8 +608,56 @@ namespace VoxelEng {
 
                 }
 
-                // Render batches.
-                if (batchesToDraw_) {
+                // Render entities, either with one instanced draw call per model...
+                if (entityManager::instancedRendering()) {
+
+                    if (instancesToDraw_ && !instancesToDraw_->instances.empty()) {
+
+                        defaultShader_->setUniform1i("u_instanced", 1);
+                        instanceVa_->bind();
+
+                        if (instancesChanged_) {
+
+                            instanceVbo_->bind();
+                            instanceVbo_->prepareStatic(instancesToDraw_->instances.data(), sizeof(entityInstance) * instancesToDraw_->instances.size());
+                            instancesChanged_ = false;
+
+                        }
+
+                        for (auto const& group : instancesToDraw_->groups) {
+
+                            const model& groupModel = models::getModelAt(group.modelID);
+
+                            if (nVertices = groupModel.size()) {
+
+                                auto it = modelVbos_.find(group.modelID);
+                                if (it == modelVbos_.end()) {
+
+                                    it = modelVbos_.emplace(group.modelID, new vertexBuffer()).first;
+                                    it->second->bind();
+                                    it->second->prepareStatic(groupModel.data(), sizeof(vertex) * nVertices);
+
+                                }
+
+                                it->second->bind();
+                                instanceVa_->addLayout(*layout_);
+                                instanceVbo_->bind();
+                                instanceVa_->addInstanceLayout(*instanceLayout_, layout_->elements().size(), sizeof(entityInstance) * group.first);
+
+                                renderer_->draw3DInstanced(0, nVertices, group.count);
+
+                            }
+
+                        }
+
+                        defaultShader_->setUniform1i("u_instanced", 0);
+                        va_->bind();
+                        vbo_->bind();
+
+                    }
+
+                }
+                else if (batchesToDraw_) { // ... or with the vertices of each batch.
 
                     for (auto const& batch : *batchesToDraw_) {
 
@@ -1084,12 +1150,26 @@ namespace VoxelEng {
         if (renderer_)
             delete renderer_;
 
+        if (instanceVa_)
+            delete instanceVa_;
+
+        if (instanceVbo_)
+            delete instanceVbo_;
+
+        if (instanceLayout_)
+            delete instanceLayout_;
+
+        for (auto it = modelVbos_.begin(); it != modelVbos_.end(); it++)
+            delete it->second;
+        modelVbos_.clear();
+
         mainWindow_ = nullptr;
 
         playerCamera_ = nullptr;
 
         chunksToDraw_ = nullptr;
         batchesToDraw_ = nullptr;
+        instancesToDraw_ = nullptr;
 
         graphicalModeInitialised_ = false;
 
@@ -13,8 +13,10 @@
 #include <condition_variable>
 #include <thread>
 #include <mutex>
+#include <unordered_map>
 #include "chunk.h"
 #include "definitions.h"
+#include "entityInstance.h"
 #include "gameWindow.h"
 #include "indexBuffer.h"
 #include "vertexBuffer.h"
@@ -246,12 +248,20 @@ namespace VoxelEng {
         static texture* blockTextureAtlas_;
         static std::unordered_map<vec3, std::vector<vertex>> const* chunksToDraw_;
         static const std::vector<model>* batchesToDraw_;
+        static const instanceRenderingData* instancesToDraw_;
+        static bool instancesChanged_; // True if 'instancesToDraw_' has not been sent to the GPU yet.
         static shader* defaultShader_;
         static vertexBuffer* vbo_;
         static vertexArray* va_;
         static vertexBufferLayout* layout_;
         static renderer* renderer_;
 
+        // Instanced entity rendering.
+        static vertexArray* instanceVa_;
+        static vertexBuffer* instanceVbo_;
+        static vertexBufferLayout* instanceLayout_;
+        static std::unordered_map<unsigned int, vertexBuffer*> modelVbos_; // The vertices of each model are sent only once.
+
         #if GRAPHICS_API == OPENGL
 
             static glm::mat4 MVPmatrix_;
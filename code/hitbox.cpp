@@ -0,0 +1,208 @@
+#include "hitbox.h"
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+#include "chunk.h"
+#include "logger.h"
+#include "utilities.h"
+
+
+namespace VoxelEng {
+
+	// 'terrainReader' class.
+
+	terrainReader::terrainReader()
+		: cached_(false), chunkPos_(vec3Zero), chunk_(nullptr), imageBlocks_(nullptr)
+	{}
+
+	block terrainReader::getBlock(int x, int y, int z) {
+
+		int localX = floorMod(x, SCX),
+			localY = floorMod(y, SCY),
+			localZ = floorMod(z, SCZ);
+
+
+		selectChunk_(chunkManager::getChunkCoords(x, y, z));
+
+		if (chunk_)
+			return chunk_->getBlock(localX, localY, localZ);
+		else if (imageBlocks_)
+			return imageBlocks_[(localX * SCY + localY) * SCZ + localZ];
+		else
+			return 0;
+
+	}
+
+	bool terrainReader::isDecorated(int x, int y, int z) {
+
+		selectChunk_(chunkManager::getChunkCoords(x, y, z));
+
+		return chunk_ ? chunk_->loadLevel() == chunkLoadLevel::DECORATED : imageBlocks_ != nullptr;
+
+	}
+
+	void terrainReader::selectChunk_(const vec3& chunkPos) {
+
+		if (!cached_ || chunkPos != chunkPos_) {
+
+			chunk_ = chunkManager::selectBlockSource(chunkPos, imageBlocks_);
+			chunkPos_ = chunkPos;
+			cached_ = true;
+
+		}
+
+	}
+
+
+	// 'hitbox' class.
+
+	const float hitbox::skinWidth_ = 0.001f;
+
+
+	hitbox::hitbox()
+		: min_(vec3Zero), max_(vec3Zero)
+	{}
+
+	hitbox::hitbox(const vec3& min, const vec3& max)
+		: min_(min), max_(max) {
+
+		if (min.x > max.x || min.y > max.y || min.z > max.z)
+			logger::errorLog("The minimum corner of a hitbox cannot be greater than its maximum corner");
+
+	}
+
+	bool hitbox::intersectsTerrain() const {
+
+		std::unique_lock<std::recursive_mutex> lock(chunkManager::chunksMutex());
+		terrainReader terrain;
+		int minX = std::floor(min_.x),
+			minY = std::floor(min_.y),
+			minZ = std::floor(min_.z),
+			maxX = std::ceil(max_.x) - 1,
+			maxY = std::ceil(max_.y) - 1,
+			maxZ = std::ceil(max_.z) - 1;
+
+
+		for (int x = minX; x <= maxX; x++)
+			for (int y = minY; y <= maxY; y++)
+				for (int z = minZ; z <= maxZ; z++)
+					if (terrain.isSolid(x, y, z))
+						return true;
+
+		return false;
+
+	}
+
+	sweepResult hitbox::sweep(const vec3& movement) const {
+
+		std::unique_lock<std::recursive_mutex> lock(chunkManager::chunksMutex());
+		terrainReader terrain;
+
+
+		return sweep(movement, terrain);
+
+	}
+
+	sweepResult hitbox::sweep(const vec3& movement, terrainReader& terrain) const {
+
+		hitbox box(*this);
+		sweepResult result;
+
+
+		result.movement.y = box.sweepAxis_(1, movement.y, terrain, result.collisionY);
+		result.movement.x = box.sweepAxis_(0, movement.x, terrain, result.collisionX);
+		result.movement.z = box.sweepAxis_(2, movement.z, terrain, result.collisionZ);
+
+		return result;
+
+	}
+
+	void hitbox::sweep(const std::vector<hitbox>& boxes, const std::vector<vec3>& movements, std::vector<sweepResult>& results) {
+
+		if (boxes.size() != movements.size())
+			logger::errorLog("The number of hitboxes and movements to resolve must be the same");
+
+		std::vector<std::size_t> order(boxes.size());
+		std::vector<vec3> chunkPos(boxes.size());
+
+
+		// Resolve the boxes grouped by the chunk where they start so that the terrain reader's cache is reused.
+		std::iota(order.begin(), order.end(), 0);
+		for (std::size_t i = 0; i < boxes.size(); i++)
+			chunkPos[i] = chunkManager::getChunkCoords(boxes[i].min_);
+		std::sort(order.begin(), order.end(), [&chunkPos](std::size_t a, std::size_t b) {
+
+			return std::tie(chunkPos[a].x, chunkPos[a].y, chunkPos[a].z) < std::tie(chunkPos[b].x, chunkPos[b].y, chunkPos[b].z);
+
+		});
+
+		results.resize(boxes.size());
+
+		std::unique_lock<std::recursive_mutex> lock(chunkManager::chunksMutex());
+		terrainReader terrain;
+		for (std::size_t i = 0; i < order.size(); i++)
+			results[order[i]] = boxes[order[i]].sweep(movements[order[i]], terrain);
+
+	}
+
+	float hitbox::sweepAxis_(int axis, float distance, terrainReader& terrain, bool& collision) {
+
+		int a = axis,
+			b = (axis + 1) % 3,
+			c = (axis + 2) % 3,
+			minB = std::floor(min_[b]),
+			maxB = std::max<int>(std::ceil(max_[b]) - 1, minB),
+			minC = std::floor(min_[c]),
+			maxC = std::max<int>(std::ceil(max_[c]) - 1, minC),
+			layer = 0,
+			step = 0,
+			lastLayer = 0,
+			blockPos[3];
+		float travelled = distance;
+
+
+		collision = false;
+
+		if (distance == 0.0f)
+			return 0.0f;
+
+		// Go through the layers of blocks perpendicular to 'axis' that the box's front face enters,
+		// from the nearest one to the farthest one, checking only the blocks under the box's cross section.
+		if (distance > 0.0f) {
+
+			layer = std::ceil(max_[a]);
+			lastLayer = std::ceil(max_[a] + distance) - 1;
+			step = 1;
+
+		}
+		else {
+
+			layer = std::floor(min_[a]) - 1;
+			lastLayer = std::floor(min_[a] + distance);
+			step = -1;
+
+		}
+
+		for (; !collision && (layer - lastLayer) * step <= 0; layer += step) {
+
+			blockPos[a] = layer;
+			for (blockPos[b] = minB; !collision && blockPos[b] <= maxB; blockPos[b]++)
+				for (blockPos[c] = minC; !collision && blockPos[c] <= maxC; blockPos[c]++)
+					collision = terrain.isSolid(blockPos[0], blockPos[1], blockPos[2]);
+
+			// Stop right before the blocking layer. A box that already penetrates it slightly is not pushed back.
+			if (collision)
+				travelled = (step > 0) ? std::max(0.0f, layer - max_[a] - skinWidth_) : std::min(0.0f, layer + 1 - min_[a] + skinWidth_);
+
+		}
+
+		min_[a] += travelled;
+		max_[a] += travelled;
+
+		return travelled;
+
+	}
+
+}
\ No newline at end of file
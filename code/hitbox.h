@@ -1,9 +1,251 @@
+/**
+* @file hitbox.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Hitbox.
+* @brief Contains the declaration of the 'hitbox' class, an axis-aligned bounding box that can be
+* moved through the level colliding against its blocks, and of the auxiliary 'terrainReader' class.
+*/
 #ifndef _VOXELENG_HITBOX_
 #define _VOXELENG_HITBOX_
 #include <cmath>
+#include <vector>
+#include "definitions.h"
+
 
 namespace VoxelEng {
 
+	//////////////////////////////
+	//Forward class declaration.//
+	//////////////////////////////
+
+	class chunk;
+
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief Result of moving a hitbox through the level.
+	* 'movement' is the part of the requested movement that could be performed and
+	* the collision flags tell in which axes the movement was stopped by a block.
+	*/
+	struct sweepResult {
+
+		vec3 movement;
+		bool collisionX,
+			 collisionY,
+			 collisionZ;
+
+	};
+
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Reads the blocks of the level selected in the calling thread, keeping a pointer to
+	* the last chunk read so that consecutive reads in the same chunk need no chunk lookup.
+	* In AI mode it sees the same blocks as chunkManager::getBlock().
+	* WARNING. The chunks' mutex (chunkManager::chunksMutex()) must be locked during the whole
+	* lifetime of the object so that the cached chunk cannot be freed.
+	*/
+	class terrainReader {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		terrainReader();
+
+
+		// Observers.
+
+		/**
+		* @brief Get the block at the specified global position.
+		* Positions inside chunks that do not exist are considered to be empty (block 0).
+		*/
+		block getBlock(int x, int y, int z);
+
+		/**
+		* @brief Returns true if the block at the specified global position blocks the movement of hitboxes.
+		*/
+		bool isSolid(int x, int y, int z);
+
+		/**
+		* @brief Returns true if the block at the specified global position belongs to a chunk whose
+		* generation is finished or that is read from the AI world image, or false otherwise.
+		*/
+		bool isDecorated(int x, int y, int z);
+
+		/**
+		* @brief Returns the chunk read by the last call to any of the methods that take a position or nullptr
+		* if said position was not inside a stored chunk.
+		*/
+		const chunk* cachedChunk() const;
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		bool cached_;
+		vec3 chunkPos_;
+		chunk* chunk_;
+		const block* imageBlocks_; // Used instead of 'chunk_' when the blocks are read from the AI world image.
+
+
+		/*
+		Methods.
+		*/
+
+		/*
+		Make the chunk at 'chunkPos' the cached one unless it already is.
+		*/
+		void selectChunk_(const vec3& chunkPos);
+
+	};
+
+	/**
+	* @brief Axis-aligned box given by its minimum and maximum corners. A block at the integer position
+	* (x, y, z) occupies the box between (x, y, z) and (x + 1, y + 1, z + 1), and a hitbox collides
+	* with it only if they overlap, so touching a block's face is allowed.
+	*/
+	class hitbox {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Create an empty box at the origin.
+		*/
+		hitbox();
+
+		/**
+		* @brief Create the box between 'min' and 'max'.
+		*/
+		hitbox(const vec3& min, const vec3& max);
+
+
+		// Observers.
+
+		const vec3& min() const;
+
+		const vec3& max() const;
+
+		vec3 size() const;
+
+		/**
+		* @brief Returns true if both boxes overlap or false otherwise.
+		*/
+		bool intersects(const hitbox& box) const;
+
+		/**
+		* @brief Returns the box moved by 'offset'.
+		*/
+		hitbox translated(const vec3& offset) const;
+
+		/**
+		* @brief Returns true if the box overlaps any solid block of the level selected in the calling thread.
+		*/
+		bool intersectsTerrain() const;
+
+		/**
+		* @brief Move the box by 'movement' through the level selected in the calling thread, stopping
+		* each axis' movement at the first solid block found. The Y axis is resolved first, then the X axis
+		* and finally the Z axis, and only the blocks that the box sweeps in each of them are read.
+		*/
+		sweepResult sweep(const vec3& movement) const;
+
+		/**
+		* @brief Same as hitbox::sweep() but using a 'terrainReader' owned by the caller.
+		* WARNING. See the 'terrainReader' class.
+		*/
+		sweepResult sweep(const vec3& movement, terrainReader& terrain) const;
+
+		/**
+		* @brief Resolve the movement of many boxes at once, with boxes[i] being moved by movements[i].
+		* The boxes are processed grouped by chunk with a single chunk lock and 'terrainReader',
+		* so that boxes that are close to each other reuse the cached chunks.
+		* The boxes do not collide with each other.
+		*/
+		static void sweep(const std::vector<hitbox>& boxes, const std::vector<vec3>& movements, std::vector<sweepResult>& results);
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		static const float skinWidth_; // Distance left between a box and the block that stopped it.
+
+		vec3 min_,
+			 max_;
+
+
+		/*
+		Methods.
+		*/
+
+		/*
+		Move the box along 'axis' by 'distance' and return the distance that could be travelled.
+		'collision' is set to true if a block stopped the movement.
+		*/
+		float sweepAxis_(int axis, float distance, terrainReader& terrain, bool& collision);
+
+	};
+
+	inline const vec3& hitbox::min() const {
+
+		return min_;
+
+	}
+
+	inline const vec3& hitbox::max() const {
+
+		return max_;
+
+	}
+
+	inline vec3 hitbox::size() const {
+
+		return max_ - min_;
+
+	}
+
+	inline bool hitbox::intersects(const hitbox& box) const {
+
+		return min_.x < box.max_.x && max_.x > box.min_.x &&
+			   min_.y < box.max_.y && max_.y > box.min_.y &&
+			   min_.z < box.max_.z && max_.z > box.min_.z;
+
+	}
+
+	inline hitbox hitbox::translated(const vec3& offset) const {
+
+		return hitbox(min_ + offset, max_ + offset);
+
+	}
+
+	inline bool terrainReader::isSolid(int x, int y, int z) {
+
+		return getBlock(x, y, z) != 0;
+
+	}
+
+	inline const chunk* terrainReader::cachedChunk() const {
+
+		return chunk_;
+
+	}
 
 }
 
@@ -17,6 +17,16 @@
 
 namespace VoxelEng {
 
+	//////////////
+	//Constants.//
+	//////////////
+
+	/**
+	* @brief Number of ticks that the record playback is moved each time it is seeked with the keyboard.
+	*/
+	const long long RECORD_SEEK_STEP = 100;
+
+
 	class inputFunctions {
 
 	public:
@@ -89,6 +99,16 @@ namespace VoxelEng {
 		*/
 		static void recordBackwards();
 
+		/**
+		* @brief Move the recording's playback RECORD_SEEK_STEP ticks forward.
+		*/
+		static void recordSeekForward();
+
+		/**
+		* @brief Move the recording's playback RECORD_SEEK_STEP ticks backwards.
+		*/
+		static void recordSeekBackwards();
+
 		/**
 		* @brief Exit the current record being played.
 		*/
@@ -219,6 +239,18 @@ namespace VoxelEng {
 
 	}
 
+	inline void inputFunctions::recordSeekForward() {
+
+		AIAPI::aiGame::seekRecordBy(RECORD_SEEK_STEP);
+
+	}
+
+	inline void inputFunctions::recordSeekBackwards() {
+
+		AIAPI::aiGame::seekRecordBy(-RECORD_SEEK_STEP);
+
+	}
+
 	inline void inputFunctions::exitRecord() {
 	
 		AIAPI::aiGame::stopPlayingRecord();
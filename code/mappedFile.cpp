@@ -0,0 +1,175 @@
+#include "mappedFile.h"
+#include "logger.h"
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+
+namespace VoxelEng {
+
+	// 'mappedFile' class.
+
+#ifdef _WIN32
+
+	mappedFile::mappedFile()
+		: data_(nullptr), size_(0), fileHandle_(INVALID_HANDLE_VALUE), mappingHandle_(nullptr)
+	{}
+
+#else
+
+	mappedFile::mappedFile()
+		: data_(nullptr), size_(0), fileDescriptor_(-1)
+	{}
+
+#endif
+
+	mappedFile::mappedFile(const std::string& path)
+		: mappedFile() {
+
+		open(path);
+
+	}
+
+#ifdef _WIN32
+
+	void mappedFile::open(const std::string& path) {
+
+		LARGE_INTEGER fileSize;
+
+
+		close();
+
+		fileHandle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle_ == INVALID_HANDLE_VALUE)
+			logger::errorLog("Could not open file " + path + " for mapping");
+
+		if (!GetFileSizeEx(fileHandle_, &fileSize)) {
+
+			close();
+			logger::errorLog("Could not get the size of file " + path);
+
+		}
+		size_ = static_cast<std::size_t>(fileSize.QuadPart);
+
+		if (size_) { // Empty files cannot be mapped.
+
+			mappingHandle_ = CreateFileMappingA(fileHandle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mappingHandle_) {
+
+				close();
+				logger::errorLog("Could not map file " + path);
+
+			}
+
+			data_ = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+			if (!data_) {
+
+				close();
+				logger::errorLog("Could not map file " + path);
+
+			}
+
+		}
+
+	}
+
+	void mappedFile::close() {
+
+		if (data_) {
+
+			UnmapViewOfFile(data_);
+			data_ = nullptr;
+
+		}
+
+		if (mappingHandle_) {
+
+			CloseHandle(mappingHandle_);
+			mappingHandle_ = nullptr;
+
+		}
+
+		if (fileHandle_ != INVALID_HANDLE_VALUE) {
+
+			CloseHandle(fileHandle_);
+			fileHandle_ = INVALID_HANDLE_VALUE;
+
+		}
+
+		size_ = 0;
+
+	}
+
+#else
+
+	void mappedFile::open(const std::string& path) {
+
+		struct stat fileStats;
+		void* mapping = nullptr;
+
+
+		close();
+
+		fileDescriptor_ = ::open(path.c_str(), O_RDONLY);
+		if (fileDescriptor_ == -1)
+			logger::errorLog("Could not open file " + path + " for mapping");
+
+		if (fstat(fileDescriptor_, &fileStats) == -1) {
+
+			close();
+			logger::errorLog("Could not get the size of file " + path);
+
+		}
+		size_ = static_cast<std::size_t>(fileStats.st_size);
+
+		if (size_) { // Empty files cannot be mapped.
+
+			mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileDescriptor_, 0);
+			if (mapping == MAP_FAILED) {
+
+				close();
+				logger::errorLog("Could not map file " + path);
+
+			}
+
+			data_ = static_cast<const unsigned char*>(mapping);
+
+		}
+
+	}
+
+	void mappedFile::close() {
+
+		if (data_) {
+
+			munmap(const_cast<unsigned char*>(data_), size_);
+			data_ = nullptr;
+
+		}
+
+		if (fileDescriptor_ != -1) {
+
+			::close(fileDescriptor_);
+			fileDescriptor_ = -1;
+
+		}
+
+		size_ = 0;
+
+	}
+
+#endif
+
+}
@@ -0,0 +1,135 @@
+/**
+* @file mappedFile.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Mapped file.
+* @brief Contains the declaration of the 'mappedFile' class.
+*/
+#ifndef _VOXELENG_MAPPEDFILE_
+#define _VOXELENG_MAPPEDFILE_
+#include <cstddef>
+#include <string>
+
+
+namespace VoxelEng {
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Read-only view of the contents of a file mapped into the process' memory.
+	* The operating system loads the pages of the file on demand, so no copies or parsing
+	* are needed to access its contents.
+	*/
+	class mappedFile {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Create an object that does not map any file.
+		*/
+		mappedFile();
+
+		/**
+		* @brief Map the file located at 'path'.
+		* Throws an exception if the file could not be mapped.
+		*/
+		mappedFile(const std::string& path);
+
+		mappedFile(const mappedFile&) = delete;
+
+		mappedFile& operator=(const mappedFile&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns true if a file is currently mapped or false otherwise.
+		*/
+		bool isOpen() const;
+
+		/**
+		* @brief Returns the start of the mapped file's contents or nullptr if no file is mapped.
+		*/
+		const unsigned char* data() const;
+
+		/**
+		* @brief Returns the size in bytes of the mapped file.
+		*/
+		std::size_t size() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Map the file located at 'path'. Any previously mapped file is unmapped first.
+		* Throws an exception if the file could not be mapped.
+		*/
+		void open(const std::string& path);
+
+		/**
+		* @brief Unmap the currently mapped file if any.
+		*/
+		void close();
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		*/
+		~mappedFile();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		const unsigned char* data_;
+		std::size_t size_;
+
+#ifdef _WIN32
+
+		void* fileHandle_,
+			* mappingHandle_;
+
+#else
+
+		int fileDescriptor_;
+
+#endif
+
+	};
+
+	inline bool mappedFile::isOpen() const {
+
+		return data_ != nullptr;
+
+	}
+
+	inline const unsigned char* mappedFile::data() const {
+
+		return data_;
+
+	}
+
+	inline std::size_t mappedFile::size() const {
+
+		return size_;
+
+	}
+
+	inline mappedFile::~mappedFile() {
+
+		close();
+
+	}
+
+}
+
+#endif
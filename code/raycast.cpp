@@ -0,0 +1,158 @@
+#include "raycast.h"
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include "chunk.h"
+#include "logger.h"
+
+
+namespace VoxelEng {
+
+	// 'raycast' class.
+
+	raycastHit raycast::cast(const vec3& origin, const vec3& direction, float maxDistance, bool onlyDecorated,
+							 std::vector<raycastChunk>* visitedChunks) {
+
+		std::unique_lock<std::recursive_mutex> lock(chunkManager::chunksMutex());
+		terrainReader terrain;
+
+
+		return cast(origin, direction, maxDistance, terrain, onlyDecorated, visitedChunks);
+
+	}
+
+	raycastHit raycast::cast(const vec3& origin, const vec3& direction, float maxDistance, terrainReader& terrain,
+							 bool onlyDecorated, std::vector<raycastChunk>* visitedChunks) {
+
+		raycastHit result = { false, 0, vec3Zero, vec3Zero, 0.0f };
+		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z),
+			  t = 0.0f,
+			  tMax[3],
+			  tDelta[3];
+		int pos[3],
+			step[3],
+			axis = 0;
+		bool decorated = false;
+		block blockID = 0;
+		vec3 chunkPos,
+			 normal = vec3Zero;
+
+
+		if (visitedChunks)
+			visitedChunks->clear();
+
+		if (length == 0.0f)
+			return result;
+
+		// 'tMax' is the distance along the ray at which the next block boundary of each axis is crossed
+		// and 'tDelta' the distance between two consecutive boundaries of said axis.
+		for (int i = 0; i < 3; i++) {
+
+			float dir = direction[i] / length;
+
+			pos[i] = std::floor(origin[i]);
+			if (dir > 0.0f) {
+
+				step[i] = 1;
+				tDelta[i] = 1.0f / dir;
+				tMax[i] = (pos[i] + 1 - origin[i]) * tDelta[i];
+
+			}
+			else if (dir < 0.0f) {
+
+				step[i] = -1;
+				tDelta[i] = -1.0f / dir;
+				tMax[i] = (origin[i] - pos[i]) * tDelta[i];
+
+			}
+			else {
+
+				step[i] = 0;
+				tDelta[i] = std::numeric_limits<float>::infinity();
+				tMax[i] = std::numeric_limits<float>::infinity();
+
+			}
+
+		}
+
+		while (t <= maxDistance) {
+
+			// Also makes the block's chunk the one cached by the reader.
+			decorated = terrain.isDecorated(pos[0], pos[1], pos[2]);
+
+			// The chunk's version is taken before reading the block so that any later modification invalidates the result.
+			if (visitedChunks) {
+
+				chunkPos = chunkManager::getChunkCoords(pos[0], pos[1], pos[2]);
+				if (visitedChunks->empty() || visitedChunks->back().chunkPos != chunkPos) {
+
+					const chunk* chunkPtr = terrain.cachedChunk();
+					visitedChunks->push_back({ chunkPos, chunkPtr, chunkPtr ? chunkPtr->version() : 0 });
+
+				}
+
+			}
+
+			blockID = (decorated || !onlyDecorated) ? terrain.getBlock(pos[0], pos[1], pos[2]) : 0;
+			if (blockID) {
+
+				result.hit = true;
+				result.blockID = blockID;
+				result.blockPos = vec3(pos[0], pos[1], pos[2]);
+				result.normal = normal;
+				result.distance = t;
+
+				return result;
+
+			}
+
+			// Step into the next block through the nearest boundary.
+			axis = (tMax[0] < tMax[1]) ? ((tMax[0] < tMax[2]) ? 0 : 2) : ((tMax[1] < tMax[2]) ? 1 : 2);
+			t = tMax[axis];
+			pos[axis] += step[axis];
+			tMax[axis] += tDelta[axis];
+
+			normal = vec3Zero;
+			normal[axis] = -step[axis];
+
+		}
+
+		return result;
+
+	}
+
+	void raycast::cast(const std::vector<vec3>& origins, const std::vector<vec3>& directions, float maxDistance,
+					   std::vector<raycastHit>& hits, bool onlyDecorated) {
+
+		if (origins.size() != directions.size())
+			logger::errorLog("The number of ray origins and directions must be the same");
+
+		hits.resize(origins.size());
+
+		std::unique_lock<std::recursive_mutex> lock(chunkManager::chunksMutex());
+		terrainReader terrain;
+		for (std::size_t i = 0; i < origins.size(); i++)
+			hits[i] = cast(origins[i], directions[i], maxDistance, terrain, onlyDecorated);
+
+	}
+
+	bool raycast::unchanged(const std::vector<raycastChunk>& visitedChunks) {
+
+		std::unique_lock<std::recursive_mutex> lock(chunkManager::chunksMutex());
+		const block* imageBlocks = nullptr;
+		const chunk* current = nullptr;
+
+
+		for (std::size_t i = 0; i < visitedChunks.size(); i++) {
+
+			current = chunkManager::selectBlockSource(visitedChunks[i].chunkPos, imageBlocks);
+			if (current != visitedChunks[i].chunkPtr || (current && current->version() != visitedChunks[i].version))
+				return false;
+
+		}
+
+		return true;
+
+	}
+
+}
@@ -0,0 +1,109 @@
+/**
+* @file raycast.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Raycast.
+* @brief Contains the declaration of the 'raycast' class, used to find the first block
+* hit by a ray going through the level.
+*/
+#ifndef _VOXELENG_RAYCAST_
+#define _VOXELENG_RAYCAST_
+#include <vector>
+#include "definitions.h"
+#include "hitbox.h"
+
+
+namespace VoxelEng {
+
+	//////////////////////////////
+	//Forward class declaration.//
+	//////////////////////////////
+
+	class chunk;
+
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief Result of casting a ray through the level.
+	* If 'hit' is true, 'blockID' and 'blockPos' are the block hit by the ray, 'normal' is the normal
+	* of the block's face through which the ray entered it (zero if the ray started inside the block) and
+	* 'distance' is the distance travelled by the ray until said face.
+	*/
+	struct raycastHit {
+
+		bool hit;
+		block blockID;
+		vec3 blockPos,
+			 normal;
+		float distance;
+
+	};
+
+	/**
+	* @brief A chunk gone through by a ray together with its version at that moment,
+	* used to know if the ray's result is still valid.
+	*/
+	struct raycastChunk {
+
+		vec3 chunkPos;
+		const chunk* chunkPtr;
+		unsigned int version;
+
+	};
+
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Voxel raycasting through the level selected in the calling thread.
+	* The blocks are traversed with the Amanatides-Woo algorithm, which visits each block that the ray
+	* goes through exactly once and in order, so no block is skipped and no block is read twice.
+	*/
+	class raycast {
+
+	public:
+
+		// Observers.
+
+		/**
+		* @brief Cast a ray from 'origin' in 'direction' (which does not need to be normalised) and return the
+		* first non-null block found at a distance of 'maxDistance' or less.
+		* If 'onlyDecorated' is true, blocks in chunks whose generation is not finished are ignored.
+		* If 'visitedChunks' is not nullptr, it is filled with the chunks that the ray went through so that
+		* raycast::unchanged() can tell later if the result is still valid.
+		*/
+		static raycastHit cast(const vec3& origin, const vec3& direction, float maxDistance, bool onlyDecorated = false,
+							   std::vector<raycastChunk>* visitedChunks = nullptr);
+
+		/**
+		* @brief Same as raycast::cast() but using a 'terrainReader' owned by the caller.
+		* WARNING. See the 'terrainReader' class.
+		*/
+		static raycastHit cast(const vec3& origin, const vec3& direction, float maxDistance, terrainReader& terrain,
+							   bool onlyDecorated = false, std::vector<raycastChunk>* visitedChunks = nullptr);
+
+		/**
+		* @brief Cast many rays at once, with hits[i] being the result of the ray that starts at origins[i]
+		* and goes in directions[i]. All of them share a single chunk lock and 'terrainReader', so rays that
+		* are close to each other (such as a fan of rays cast by an agent) reuse the cached chunks.
+		*/
+		static void cast(const std::vector<vec3>& origins, const std::vector<vec3>& directions, float maxDistance,
+						 std::vector<raycastHit>& hits, bool onlyDecorated = false);
+
+		/**
+		* @brief Returns true if none of the chunks visited by a ray have been modified, loaded or unloaded since
+		* the ray was cast, that is, if casting the same ray again would give the same result.
+		*/
+		static bool unchanged(const std::vector<raycastChunk>& visitedChunks);
+
+	};
+
+}
+
+#endif
@@ -43,6 +43,13 @@ namespace VoxelEng {
 		*/
 		void draw3D(int count) const;
 
+		/**
+		* @brief Draws 'nInstances' times the 'count' model triangles that start at the vertex 'first'
+		* into a 3D space, with the currently bound instance attributes advancing once per instance.
+		* WARNING. Must be called in a thread with valid graphics API context.
+		*/
+		void draw3DInstanced(int first, int count, int nInstances) const;
+
 		/**
 		* @brief Draws 'count' model triangles into a 2D space.
 		* WARNING. Must be called in a thread with valid graphics API context.
@@ -74,6 +81,12 @@ namespace VoxelEng {
 
 	}
 
+	inline void renderer::draw3DInstanced(int first, int count, int nInstances) const {
+
+		glDrawArraysInstanced(GL_TRIANGLES, first, count, nInstances);
+
+	}
+
 	inline void renderer::draw2D(int count) const {
 		
 		// For now it is equal to the draw3D(int count) method
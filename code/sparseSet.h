@@ -0,0 +1,215 @@
+/**
+* @file sparseSet.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Sparse set.
+* @brief Contains the definition of the 'sparseSet' class, a set of unsigned integers
+* intended for storing IDs.
+*/
+#ifndef _VOXELENG_SPARSESET_
+#define _VOXELENG_SPARSESET_
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+
+namespace VoxelEng {
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Set of unsigned integers with constant time insertion, deletion and lookup that
+	* stores its elements contiguously, so they can be iterated linearly without any hashing.
+	* Erasing an element moves the last stored element to its position, so the order of the
+	* elements is not preserved.
+	* Memory usage is proportional to the largest element ever inserted, which makes it suitable
+	* for IDs that are reused after being freed.
+	*/
+	class sparseSet {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		sparseSet() = default;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns true if 'value' is in the set or false otherwise.
+		*/
+		bool contains(unsigned int value) const;
+
+		/**
+		* @brief Returns the number of elements in the set.
+		*/
+		std::size_t size() const;
+
+		/**
+		* @brief Returns true if the set has no elements or false otherwise.
+		*/
+		bool empty() const;
+
+		/**
+		* @brief Returns the element stored at position 'index' (without bounds checking).
+		*/
+		unsigned int operator[](std::size_t index) const;
+
+		/**
+		* @brief Returns the position at which 'value' is stored (without checking that it is in the set).
+		*/
+		std::size_t indexOf(unsigned int value) const;
+
+		std::vector<unsigned int>::const_iterator cbegin() const;
+
+		std::vector<unsigned int>::const_iterator cend() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Adds 'value' to the set. Returns true if it was not already in it or false otherwise.
+		*/
+		bool insert(unsigned int value);
+
+		/**
+		* @brief Removes 'value' from the set. Returns true if it was in it or false otherwise.
+		*/
+		bool erase(unsigned int value);
+
+		/**
+		* @brief Exchanges the positions at which 'value1' and 'value2' are stored.
+		* Both must be in the set.
+		*/
+		void swap(unsigned int value1, unsigned int value2);
+
+		/**
+		* @brief Removes all elements from the set.
+		*/
+		void clear();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		static constexpr unsigned int none_ = std::numeric_limits<unsigned int>::max();
+
+		std::vector<unsigned int> dense_, // The elements of the set.
+								  sparse_; // Position of each value inside 'dense_' or 'none_' if it is not in the set.
+
+	};
+
+	inline bool sparseSet::contains(unsigned int value) const {
+
+		return value < sparse_.size() && sparse_[value] != none_;
+
+	}
+
+	inline std::size_t sparseSet::size() const {
+
+		return dense_.size();
+
+	}
+
+	inline bool sparseSet::empty() const {
+
+		return dense_.empty();
+
+	}
+
+	inline unsigned int sparseSet::operator[](std::size_t index) const {
+
+		return dense_[index];
+
+	}
+
+	inline std::size_t sparseSet::indexOf(unsigned int value) const {
+
+		return sparse_[value];
+
+	}
+
+	inline std::vector<unsigned int>::const_iterator sparseSet::cbegin() const {
+
+		return dense_.cbegin();
+
+	}
+
+	inline std::vector<unsigned int>::const_iterator sparseSet::cend() const {
+
+		return dense_.cend();
+
+	}
+
+	inline bool sparseSet::insert(unsigned int value) {
+
+		if (contains(value))
+			return false;
+		else {
+
+			if (value >= sparse_.size())
+				sparse_.resize(value + 1, none_);
+
+			sparse_[value] = dense_.size();
+			dense_.push_back(value);
+
+			return true;
+
+		}
+
+	}
+
+	inline bool sparseSet::erase(unsigned int value) {
+
+		if (contains(value)) {
+
+			unsigned int last = dense_.back(),
+						 index = sparse_[value];
+
+
+			dense_[index] = last;
+			sparse_[last] = index;
+			dense_.pop_back();
+			sparse_[value] = none_;
+
+			return true;
+
+		}
+		else
+			return false;
+
+	}
+
+	inline void sparseSet::swap(unsigned int value1, unsigned int value2) {
+
+		unsigned int index1 = sparse_[value1],
+					 index2 = sparse_[value2];
+
+
+		dense_[index1] = value2;
+		dense_[index2] = value1;
+		sparse_[value1] = index2;
+		sparse_[value2] = index1;
+
+	}
+
+	inline void sparseSet::clear() {
+
+		for (std::size_t i = 0; i < dense_.size(); i++)
+			sparse_[dense_[i]] = none_;
+		dense_.clear();
+
+	}
+
+}
+
+#endif
\ No newline at end of file
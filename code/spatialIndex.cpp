@@ -0,0 +1,321 @@
+#include "spatialIndex.h"
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "logger.h"
+#include "timer.h"
+
+
+namespace VoxelEng {
+
+	// 'spatialIndex' class.
+
+	void spatialIndex::queryAABB(const vec3& min, const vec3& max, std::vector<entityID>& result) const {
+
+		forEachCell_(cellOf_(min), cellOf_(max), [&min, &max, &result](const std::vector<spatialIndexEntry>& bucket) {
+
+			for (std::size_t i = 0; i < bucket.size(); i++)
+				if (bucket[i].pos.x >= min.x && bucket[i].pos.x <= max.x &&
+					bucket[i].pos.y >= min.y && bucket[i].pos.y <= max.y &&
+					bucket[i].pos.z >= min.z && bucket[i].pos.z <= max.z)
+					result.push_back(bucket[i].ID);
+
+		});
+
+	}
+
+	void spatialIndex::queryRadius(const vec3& center, float radius, std::vector<entityID>& result) const {
+
+		float radius2 = radius * radius;
+		vec3 extent(radius, radius, radius);
+
+
+		forEachCell_(cellOf_(center - extent), cellOf_(center + extent), [&center, radius2, &result](const std::vector<spatialIndexEntry>& bucket) {
+
+			vec3 offset;
+			for (std::size_t i = 0; i < bucket.size(); i++) {
+
+				offset = bucket[i].pos - center;
+				if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radius2)
+					result.push_back(bucket[i].ID);
+
+			}
+
+		});
+
+	}
+
+	entityID spatialIndex::nearest(const vec3& pos, float maxDistance, entityID ignoredID) const {
+
+		entityID nearestID = noEntity;
+		float nearestDistance2 = maxDistance * maxDistance,
+			  cellSize = std::min(std::min(SCX, SCY), SCZ);
+		vec3 centerCell = cellOf_(pos),
+			 offset;
+		std::size_t nVisitedCells = 0;
+		auto visit = [&pos, ignoredID, &nearestID, &nearestDistance2, &offset](const std::vector<spatialIndexEntry>& bucket) {
+
+			float distance2;
+			for (std::size_t i = 0; i < bucket.size(); i++)
+				if (bucket[i].ID != ignoredID) {
+
+					offset = bucket[i].pos - pos;
+					distance2 = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+
+					// Ties are broken by entity ID so that the result does not depend on the buckets' order.
+					if (distance2 < nearestDistance2 || (distance2 == nearestDistance2 && bucket[i].ID < nearestID)) {
+
+						nearestID = bucket[i].ID;
+						nearestDistance2 = distance2;
+
+					}
+
+				}
+
+		};
+
+
+		// Visit the chunks in shells of increasing Chebyshev distance around the chunk that contains 'pos'.
+		// An entity in shell 'r' is at least (r - 1) * cellSize blocks away, so the search stops when that
+		// bound exceeds the distance to the nearest entity found so far.
+		for (int r = 0; r == 0 || (r - 1) * cellSize * (r - 1) * cellSize <= nearestDistance2; r++) {
+
+			double nShellCells = r ? std::pow(2.0 * r + 1, 3) - std::pow(2.0 * r - 1, 3) : 1;
+
+			// When the shells get bigger than the index itself, finish by going through all the occupied chunks.
+			if (nShellCells > cells_.size() - std::min(nVisitedCells, cells_.size())) {
+
+				for (auto it = cells_.cbegin(); it != cells_.cend(); it++)
+					if (std::max(std::max(std::abs(it->first.x - centerCell.x), std::abs(it->first.y - centerCell.y)), std::abs(it->first.z - centerCell.z)) >= r)
+						visit(it->second);
+
+				break;
+
+			}
+
+			vec3 cell;
+			for (int dx = -r; dx <= r; dx++)
+				for (int dy = -r; dy <= r; dy++)
+					for (int dz = -r; dz <= r; dz += (std::abs(dx) == r || std::abs(dy) == r || !r) ? 1 : 2 * r) {
+
+						cell = centerCell + vec3(dx, dy, dz);
+
+						auto it = cells_.find(cell);
+						if (it != cells_.cend()) {
+
+							visit(it->second);
+							nVisitedCells++;
+
+						}
+
+					}
+
+		}
+
+		return nearestID;
+
+	}
+
+	void spatialIndex::benchmark(unsigned int nEntities, unsigned int nQueries, float worldSize, float radius) {
+
+		std::mt19937 generator(0);
+		std::uniform_real_distribution<float> coordDist(0.0f, worldSize),
+											  stepDist(-1.0f, 1.0f);
+		std::vector<vec3> positions(nEntities),
+						  queries(nQueries);
+		std::vector<std::vector<entityID>> indexResults(nQueries),
+										   bruteResults(nQueries);
+		std::vector<entityID> nearestIndex(nQueries),
+							  nearestBrute(nQueries);
+		spatialIndex index;
+		unsigned int nMismatches = 0;
+		std::size_t nFound = 0;
+		float radius2 = radius * radius;
+		VoxelEng::timer t;
+		VoxelEng::duration durationInsert,
+						   durationUpdate,
+						   durationRadiusIndex,
+						   durationRadiusBrute,
+						   durationNearestIndex,
+						   durationNearestBrute;
+
+
+		if (!nEntities || !nQueries)
+			logger::errorLog("Cannot benchmark the spatial index without entities or queries");
+
+		for (unsigned int i = 0; i < nEntities; i++)
+			positions[i] = vec3(coordDist(generator), coordDist(generator), coordDist(generator));
+		for (unsigned int i = 0; i < nQueries; i++)
+			queries[i] = vec3(coordDist(generator), coordDist(generator), coordDist(generator));
+
+		t.start();
+		for (unsigned int i = 0; i < nEntities; i++)
+			index.insert(i, positions[i]);
+		t.finish();
+		durationInsert = t.getDurationMs();
+
+		// Small displacements, as the ones performed each tick.
+		for (unsigned int i = 0; i < nEntities; i++)
+			positions[i] += vec3(stepDist(generator), stepDist(generator), stepDist(generator));
+		t.start();
+		for (unsigned int i = 0; i < nEntities; i++)
+			index.update(i, positions[i]);
+		t.finish();
+		durationUpdate = t.getDurationMs();
+
+		// Radius queries.
+		t.start();
+		for (unsigned int i = 0; i < nQueries; i++)
+			index.queryRadius(queries[i], radius, indexResults[i]);
+		t.finish();
+		durationRadiusIndex = t.getDurationMs();
+
+		t.start();
+		for (unsigned int i = 0; i < nQueries; i++) {
+
+			vec3 offset;
+			for (unsigned int j = 0; j < nEntities; j++) {
+
+				offset = positions[j] - queries[i];
+				if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radius2)
+					bruteResults[i].push_back(j);
+
+			}
+
+		}
+		t.finish();
+		durationRadiusBrute = t.getDurationMs();
+
+		for (unsigned int i = 0; i < nQueries; i++) {
+
+			std::sort(indexResults[i].begin(), indexResults[i].end());
+			if (indexResults[i] != bruteResults[i])
+				nMismatches++;
+			nFound += bruteResults[i].size();
+
+		}
+
+		// Nearest neighbour queries.
+		t.start();
+		for (unsigned int i = 0; i < nQueries; i++)
+			nearestIndex[i] = index.nearest(queries[i]);
+		t.finish();
+		durationNearestIndex = t.getDurationMs();
+
+		t.start();
+		for (unsigned int i = 0; i < nQueries; i++) {
+
+			float nearestDistance2 = std::numeric_limits<float>::infinity(),
+				  distance2;
+			vec3 offset;
+			nearestBrute[i] = noEntity;
+			for (unsigned int j = 0; j < nEntities; j++) {
+
+				offset = positions[j] - queries[i];
+				distance2 = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z;
+				if (distance2 < nearestDistance2) {
+
+					nearestBrute[i] = j;
+					nearestDistance2 = distance2;
+
+				}
+
+			}
+
+		}
+		t.finish();
+		durationNearestBrute = t.getDurationMs();
+
+		for (unsigned int i = 0; i < nQueries; i++)
+			if (nearestIndex[i] != nearestBrute[i])
+				nMismatches++;
+
+		logger::say("Spatial index with " + std::to_string(nEntities) + " entities in " + std::to_string(index.nCells()) + " chunks");
+		logger::say("Insertions: " + std::to_string(nEntities * 1000.0 / std::max<VoxelEng::duration>(durationInsert, 1)) + " entities/s");
+		logger::say("Updates: " + std::to_string(nEntities * 1000.0 / std::max<VoxelEng::duration>(durationUpdate, 1)) + " entities/s");
+		logger::say("Radius queries (average of " + std::to_string(static_cast<double>(nFound) / nQueries) + " results): " +
+					std::to_string(nQueries * 1000.0 / std::max<VoxelEng::duration>(durationRadiusIndex, 1)) + " queries/s indexed, " +
+					std::to_string(nQueries * 1000.0 / std::max<VoxelEng::duration>(durationRadiusBrute, 1)) + " queries/s brute force");
+		logger::say("Nearest neighbour queries: " +
+					std::to_string(nQueries * 1000.0 / std::max<VoxelEng::duration>(durationNearestIndex, 1)) + " queries/s indexed, " +
+					std::to_string(nQueries * 1000.0 / std::max<VoxelEng::duration>(durationNearestBrute, 1)) + " queries/s brute force");
+		logger::say("Queries that differ between both approaches: " + std::to_string(nMismatches) + "/" + std::to_string(2 * nQueries));
+
+	}
+
+	void spatialIndex::insert(entityID ID, const vec3& pos) {
+
+		if (contains(ID))
+			logger::errorLog("Entity with ID " + std::to_string(ID) + " is already stored in the spatial index");
+
+		vec3 cell = cellOf_(pos);
+		std::vector<spatialIndexEntry>& bucket = cells_[cell];
+
+
+		if (ID >= entityIndex_.size()) {
+
+			entityIndex_.resize(ID + 1, notStored_);
+			entityCell_.resize(ID + 1);
+
+		}
+
+		entityCell_[ID] = cell;
+		entityIndex_[ID] = bucket.size();
+		bucket.push_back({ ID, pos });
+		nEntities_++;
+
+	}
+
+	void spatialIndex::update(entityID ID, const vec3& pos) {
+
+		if (!contains(ID))
+			logger::errorLog("Entity with ID " + std::to_string(ID) + " is not stored in the spatial index");
+
+		vec3 cell = cellOf_(pos);
+
+
+		if (cell == entityCell_[ID])
+			cells_.find(cell)->second[entityIndex_[ID]].pos = pos;
+		else {
+
+			erase(ID);
+			insert(ID, pos);
+
+		}
+
+	}
+
+	void spatialIndex::erase(entityID ID) {
+
+		if (contains(ID)) {
+
+			auto it = cells_.find(entityCell_[ID]);
+			std::vector<spatialIndexEntry>& bucket = it->second;
+			unsigned int index = entityIndex_[ID];
+
+
+			// Move the bucket's last entity to the freed position.
+			bucket[index] = bucket.back();
+			entityIndex_[bucket[index].ID] = index;
+			bucket.pop_back();
+			if (bucket.empty())
+				cells_.erase(it);
+
+			entityIndex_[ID] = notStored_;
+			nEntities_--;
+
+		}
+
+	}
+
+	void spatialIndex::clear() {
+
+		cells_.clear();
+		entityCell_.clear();
+		entityIndex_.clear();
+		nEntities_ = 0;
+
+	}
+
+}
\ No newline at end of file
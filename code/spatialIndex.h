@@ -0,0 +1,221 @@
+/**
+* @file spatialIndex.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Spatial index.
+* @brief Contains the declaration of the 'spatialIndex' class, used to find the entities
+* that are near a position without going through all of them.
+*/
+#ifndef _VOXELENG_SPATIALINDEX_
+#define _VOXELENG_SPATIALINDEX_
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include <hash.hpp>
+#include "definitions.h"
+
+
+namespace VoxelEng {
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief An entity stored in a cell of a 'spatialIndex' together with its position,
+	* so that queries do not need to look up the entity.
+	*/
+	struct spatialIndexEntry {
+
+		entityID ID;
+		vec3 pos;
+
+	};
+
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Spatial hash of entity positions whose cells are the level's chunks, that is, an entity
+	* is stored in the bucket of the chunk that contains its position.
+	* Insertions, deletions and position updates take constant time and range and nearest neighbour
+	* queries only visit the chunks that can contain a result.
+	* It is not thread safe.
+	*/
+	class spatialIndex {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		spatialIndex() = default;
+
+
+		// Observers.
+
+		/**
+		* @brief Value used to represent the absence of an entity.
+		*/
+		static constexpr entityID noEntity = std::numeric_limits<entityID>::max();
+
+		/**
+		* @brief Returns true if the entity is stored in the index or false otherwise.
+		*/
+		bool contains(entityID ID) const;
+
+		/**
+		* @brief Returns the number of stored entities.
+		*/
+		std::size_t size() const;
+
+		/**
+		* @brief Returns the number of chunks that contain at least one stored entity.
+		*/
+		std::size_t nCells() const;
+
+		/**
+		* @brief Appends to 'result' the stored entities whose position is inside the axis-aligned box
+		* between 'min' and 'max' (both included).
+		*/
+		void queryAABB(const vec3& min, const vec3& max, std::vector<entityID>& result) const;
+
+		/**
+		* @brief Appends to 'result' the stored entities whose position is at a distance
+		* of 'radius' or less from 'center'.
+		*/
+		void queryRadius(const vec3& center, float radius, std::vector<entityID>& result) const;
+
+		/**
+		* @brief Returns the stored entity whose position is the nearest to 'pos' at a distance of
+		* 'maxDistance' or less, ignoring 'ignoredID', or spatialIndex::noEntity if there is none.
+		*/
+		entityID nearest(const vec3& pos, float maxDistance = std::numeric_limits<float>::infinity(), entityID ignoredID = noEntity) const;
+
+		/**
+		* @brief Measure the number of radius and nearest neighbour queries per second that can be answered with
+		* 'nEntities' entities randomly placed in a cube of 'worldSize' blocks per side, comparing them with
+		* going through all the entities. The number of queries where both approaches do not agree is also reported.
+		*/
+		static void benchmark(unsigned int nEntities, unsigned int nQueries, float worldSize, float radius);
+
+
+		// Modifiers.
+
+		/**
+		* @brief Store an entity with the given position.
+		*/
+		void insert(entityID ID, const vec3& pos);
+
+		/**
+		* @brief Update the position of a stored entity.
+		* It only moves the entity to another bucket if it has changed chunk.
+		*/
+		void update(entityID ID, const vec3& pos);
+
+		/**
+		* @brief Remove an entity from the index. Does nothing if it is not stored.
+		*/
+		void erase(entityID ID);
+
+		/**
+		* @brief Remove all entities from the index.
+		*/
+		void clear();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		static constexpr unsigned int notStored_ = std::numeric_limits<unsigned int>::max();
+
+		std::unordered_map<vec3, std::vector<spatialIndexEntry>> cells_;
+		std::vector<vec3> entityCell_; // Chunk of each stored entity, indexed by entity ID.
+		std::vector<unsigned int> entityIndex_; // Position of each entity inside its chunk's bucket or 'notStored_'.
+		std::size_t nEntities_ = 0;
+
+
+		/*
+		Methods.
+		*/
+
+		static vec3 cellOf_(const vec3& pos);
+
+		/*
+		Call f(bucket) for each non-empty bucket of the chunks between 'minCell' and 'maxCell' (both included).
+		*/
+		template <typename F>
+		void forEachCell_(const vec3& minCell, const vec3& maxCell, F&& f) const;
+
+	};
+
+	inline bool spatialIndex::contains(entityID ID) const {
+
+		return ID < entityIndex_.size() && entityIndex_[ID] != notStored_;
+
+	}
+
+	inline std::size_t spatialIndex::size() const {
+
+		return nEntities_;
+
+	}
+
+	inline std::size_t spatialIndex::nCells() const {
+
+		return cells_.size();
+
+	}
+
+	inline vec3 spatialIndex::cellOf_(const vec3& pos) {
+
+		return vec3(std::floor(pos.x / SCX), std::floor(pos.y / SCY), std::floor(pos.z / SCZ));
+
+	}
+
+	template <typename F>
+	void spatialIndex::forEachCell_(const vec3& minCell, const vec3& maxCell, F&& f) const {
+
+		double nRangeCells = (static_cast<double>(maxCell.x) - minCell.x + 1) * (static_cast<double>(maxCell.y) - minCell.y + 1) *
+							 (static_cast<double>(maxCell.z) - minCell.z + 1);
+
+
+		// Large ranges in a sparse index are cheaper to answer by going through the occupied chunks.
+		if (nRangeCells > cells_.size()) {
+
+			for (auto it = cells_.cbegin(); it != cells_.cend(); it++)
+				if (it->first.x >= minCell.x && it->first.x <= maxCell.x &&
+					it->first.y >= minCell.y && it->first.y <= maxCell.y &&
+					it->first.z >= minCell.z && it->first.z <= maxCell.z)
+					f(it->second);
+
+		}
+		else {
+
+			vec3 cell;
+			for (cell.x = minCell.x; cell.x <= maxCell.x; cell.x++)
+				for (cell.y = minCell.y; cell.y <= maxCell.y; cell.y++)
+					for (cell.z = minCell.z; cell.z <= maxCell.z; cell.z++) {
+
+						auto it = cells_.find(cell);
+						if (it != cells_.cend())
+							f(it->second);
+
+					}
+
+		}
+
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -4,95 +4,150 @@
 
 namespace VoxelEng {
 
+	// Pool that owns the calling thread (if any) and the index of said thread inside it.
+	thread_local const threadPool* workerPool = nullptr;
+	thread_local unsigned int workerIndex = 0;
+
+
+	// 'taskGroup' class.
+
+	taskGroup::taskGroup()
+		: nPendingTasks_(0)
+	{}
+
+	void taskGroup::taskFinished() {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		if (--nPendingTasks_ == 0)
+			finishedCV_.notify_all();
+
+	}
+
+
+	// 'threadPool' class.
+
 	threadPool::threadPool(unsigned int nThreads)
-	: nThreads_(nThreads), shutdown_(false), terminated_(false), nWorkingThreads_(0) {
+	: nThreads_(nThreads ? nThreads : 1), shutdown_(false), terminated_(false), nQueuedTasks_(0), nUnfinishedTasks_(0), nextQueue_(0) {
+
+		for (unsigned int i = 0; i < nThreads_; i++)
+			queues_.push_back(std::make_unique<workerQueue>());
 
-		for (unsigned int i = 0; i < nThreads; i++)
-			pool_.push_back(std::thread([this]() {this->waitForTask(); }));
+		for (unsigned int i = 0; i < nThreads_; i++)
+			pool_.push_back(std::thread([this, i]() {this->waitForTask(i); }));
 
 	}
 
-	void threadPool::waitForTask() {
+	void threadPool::waitForTask(unsigned int index) {
 
-		job* job;
-		while (true) {
+		std::function<void()> task;
 
-			{
 
-				std::unique_lock<std::mutex> lock(jobsMutex_);
-				// If there are no more jobs, notify callers that are waiting on the awaitNoJobs() method.
-				{
+		workerPool = this;
+		workerIndex = index;
 
-					std::unique_lock<std::mutex> lock(callerMutex_);
+		while (true) {
 
-					if (jobs_.empty() && !nWorkingThreads_)
-						callerCV_.notify_all();
+			if (takeTask(index, task)) {
 
-				}
+				runTask(task);
+				continue;
 
-				while (jobs_.empty() && !shutdown_) // Wait until there is a job to do (if we should wait for one).
-					jobsAvailable_.wait(lock); 
+			}
 
+			{
+
+				std::unique_lock<std::mutex> lock(sleepMutex_);
 
-				// If new jobs are not going to we added to the queue (that is, shutdown() was called), 
+				// Wait until there is a job to do (if we should wait for one).
+				tasksAvailable_.wait(lock, [this]() { return nQueuedTasks_ > 0 || shutdown_; });
+
+				// If new jobs are not going to we added to the queues (that is, shutdown() was called), 
 				// then finish this thread's execution
-				if (shutdown_ && jobs_.empty())
+				if (shutdown_ && nQueuedTasks_ == 0)
 					return;
 
-				job = jobs_.front();
-				jobs_.pop_front();
-
 			}
 
-			nWorkingThreads_++;
-			job->process();
-			nWorkingThreads_--;
-
 		}
 
 	}
 
 	void threadPool::submitJob(job* job) {
 
-		if (shutdown_)
-			VoxelEng::logger::errorLog("Cannot submit new jobs to a thread pool if shutdown() was called previously for that pool");
+		enqueue([job]() { job->process(); });
 
-		{
+	}
 
-			std::unique_lock<std::mutex> lock(jobsMutex_);
-			jobs_.push_back(job);
+	void threadPool::submitJob(job* job, taskGroup& group) {
 
-		}
+		group.nPendingTasks_++;
+		enqueue([job, &group]() {
 
-		jobsAvailable_.notify_one();
+			job->process();
+			group.taskFinished();
+
+		});
+
+	}
+
+	void threadPool::wait(taskGroup& group) {
+
+		std::function<void()> task;
+		unsigned int index = callerWorkerIndex();
+
+
+		while (true) {
+
+			{
+
+				// The counter is checked while holding the group's mutex, which the thread that finishes the
+				// group's last task keeps until it stops using the group, so the group can be destroyed once this returns.
+				std::unique_lock<std::mutex> lock(group.mutex_);
+				if (group.nPendingTasks_ == 0)
+					return;
+
+			}
+
+			// Help with the pool's work instead of just blocking the caller thread.
+			if (takeTask(index, task))
+				runTask(task);
+			else {
+
+				// The remaining tasks of the group are being processed by other threads.
+				std::unique_lock<std::mutex> lock(group.mutex_);
+				group.finishedCV_.wait(lock, [&group]() { return group.nPendingTasks_ == 0; });
+
+			}
+
+		}
 
 	}
 
 	/*
 	Orders the thread pool to not to accept any new jobs submitted.
-	The rest of the jobs that remain unfinished in the jobs queue will
+	The rest of the jobs that remain unfinished in the jobs queues will
 	continue to get processed.
 	*/
 	void threadPool::shutdown() {
 
-		shutdown_ = true;
-		jobsAvailable_.notify_all();
+		{
 
-	}
+			std::unique_lock<std::mutex> lock(sleepMutex_);
+			shutdown_ = true;
 
-	void threadPool::awaitNoJobs() {
+		}
 
-		{
+		tasksAvailable_.notify_all();
 
-			std::unique_lock<std::mutex> lock(callerMutex_);
-			
-			do {
+	}
+
+	void threadPool::awaitNoJobs() {
 
-				callerCV_.wait(lock);
+		std::unique_lock<std::mutex> lock(callerMutex_);
 
-			} while (!jobs_.empty() && nWorkingThreads_); // If 'jobs_' is already empty and there are no jobs currently being done, unblock.
-				
-		}
+		// The counter is decremented while holding 'callerMutex_', so the notification cannot be missed.
+		callerCV_.wait(lock, [this]() { return nUnfinishedTasks_ == 0; });
 
 	}
 
@@ -100,14 +155,6 @@ namespace VoxelEng {
 
 		if (shutdown_) {
 
-			{
-
-				std::unique_lock<std::mutex> lock(jobsMutex_);
-				while (!jobs_.empty() && nWorkingThreads_)
-					jobsAvailable_.wait(lock);
-
-			}
-
 			for (std::thread& t : pool_)
 				t.join();
 
@@ -120,6 +167,102 @@ namespace VoxelEng {
 
 	}
 
+	void threadPool::enqueue(std::function<void()>&& task) {
+
+		if (shutdown_)
+			VoxelEng::logger::errorLog("Cannot submit new jobs to a thread pool if shutdown() was called previously for that pool");
+
+		unsigned int index = callerWorkerIndex();
+
+
+		if (index == nThreads_)
+			index = nextQueue_++ % nThreads_;
+
+		nUnfinishedTasks_++;
+
+		{
+
+			// Count the task before it is visible in the queue so that the counter never goes below zero.
+			// Incremented under 'sleepMutex_' so that a thread that is about to sleep sees the new task.
+			std::unique_lock<std::mutex> lock(sleepMutex_);
+			nQueuedTasks_++;
+
+		}
+
+		{
+
+			std::unique_lock<std::mutex> lock(queues_[index]->mutex);
+			queues_[index]->tasks.push_back(std::move(task));
+
+		}
+
+		tasksAvailable_.notify_one();
+
+	}
+
+	bool threadPool::takeTask(unsigned int index, std::function<void()>& task) {
+
+		// Own queue first, newest task first (it is more likely to have its data in cache).
+		if (index < nThreads_) {
+
+			std::unique_lock<std::mutex> lock(queues_[index]->mutex);
+
+			if (!queues_[index]->tasks.empty()) {
+
+				task = std::move(queues_[index]->tasks.back());
+				queues_[index]->tasks.pop_back();
+				nQueuedTasks_--;
+
+				return true;
+
+			}
+
+		}
+
+		// Steal the oldest task from the other queues.
+		for (unsigned int i = 1; i <= nThreads_; i++) {
+
+			workerQueue& victim = *queues_[(index + i) % nThreads_];
+			std::unique_lock<std::mutex> lock(victim.mutex);
+
+			if (!victim.tasks.empty()) {
+
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				nQueuedTasks_--;
+
+				return true;
+
+			}
+
+		}
+
+		return false;
+
+	}
+
+	void threadPool::runTask(std::function<void()>& task) {
+
+		task();
+		task = nullptr;
+
+		{
+
+			std::unique_lock<std::mutex> lock(callerMutex_);
+
+			if (--nUnfinishedTasks_ == 0)
+				callerCV_.notify_all();
+
+		}
+
+	}
+
+	unsigned int threadPool::callerWorkerIndex() const {
+
+		return (workerPool == this) ? workerIndex : nThreads_;
+
+	}
+
 	/*
 	If method terminated() returns false, that is, if shutdown() was not called or all the threads have not finished running, the destructor will call
 	the methods shutdown() first and awaitTermination() last to ensure that all submitted tasks are finished and that all threads stop their execution
@@ -136,4 +279,4 @@ namespace VoxelEng {
 
 	}
 
-}
\ No newline at end of file
+}
@@ -8,10 +8,16 @@
 */
 #ifndef _THREADPOOL_
 #define _THREADPOOL_
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
+#include <future>
+#include <memory>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <functional>
 #include <mutex>
@@ -44,10 +50,61 @@ namespace VoxelEng {
 
 	};
 
+	/**
+	* @brief Counts the tasks submitted to a thread pool that belong to it so that
+	* it is possible to wait for them without waiting for all the pool's tasks.
+	* A 'taskGroup' object can be reused once all its tasks are finished.
+	*/
+	class taskGroup {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		taskGroup();
+
+		taskGroup(const taskGroup&) = delete;
+
+		taskGroup& operator=(const taskGroup&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns the number of tasks of the group that are yet to be finished.
+		*/
+		unsigned int nPendingTasks() const;
+
+	private:
+
+		friend class threadPool;
+
+		/*
+		Attributes.
+		*/
+
+		std::atomic<unsigned int> nPendingTasks_;
+		std::mutex mutex_;
+		std::condition_variable finishedCV_;
+
+
+		/*
+		Methods.
+		*/
+
+		void taskFinished();
+
+	};
+
 	/**
 	* @brief A collection of threads that are commonly used to divide the workload
 	* of one heavy task in terms of computational power into several smaller tasks that
 	* can be completed in parallel by those threads.
+	* Each thread has its own queue of tasks. A thread that runs out of tasks steals
+	* tasks from the other threads' queues before going to sleep.
 	*/
 	class threadPool {
 
@@ -61,15 +118,20 @@ namespace VoxelEng {
 		threadPool(unsigned int nThreads);
 
 
-		// Modifiers.
+		// Observers.
 
 		/**
-		* @brief The caller thread will be blocked until a task to complete 
-		* can be assigned to it. Then that thread will process said task and, if
-		* there are no other tasks to do, wait until a new task is given or the corresponding threadPool
-		* object is shutdown or terminated.
+		* Returns true if the thread pool is terminated or false otherwise.
 		*/
-		void waitForTask();
+		bool terminated() const;
+
+		/**
+		* @brief Returns the number of threads of the pool.
+		*/
+		unsigned int nThreads() const;
+
+
+		// Modifiers.
 
 		/**
 		* @brief Submit a job to complete to the thread pool.
@@ -77,6 +139,39 @@ namespace VoxelEng {
 		*/
 		void submitJob(job* job);
 
+		/**
+		* @brief Same as threadPool::submitJob(job* job) but the job is counted as one of the tasks of 'group'.
+		*/
+		void submitJob(job* job, taskGroup& group);
+
+		/**
+		* @brief Submit a callable object to be executed by the thread pool.
+		* Returns a std::future that holds the value returned by 'task' (or the exception that it threw).
+		*/
+		template <typename F>
+		auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+		/**
+		* @brief Same as threadPool::submit(F&& task) but the task is counted as one of the tasks of 'group'.
+		*/
+		template <typename F>
+		auto submit(taskGroup& group, F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>;
+
+		/**
+		* @brief Calls body(i) for each i in [begin, end) using the thread pool, dividing the range
+		* into chunks of at most 'grainSize' indices. The caller thread helps processing the chunks
+		* and it is blocked until all of them are finished.
+		*/
+		template <typename F>
+		void parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, F&& body);
+
+		/**
+		* @brief Locks the caller thread until all the tasks of 'group' are finished.
+		* While waiting, the caller thread processes queued tasks of the pool, so it is safe to call this
+		* method from inside a task of the same pool.
+		*/
+		void wait(taskGroup& group);
+
 		/**
 		* @brief The thread pool will no longer accept submitted jobs.
 		*/
@@ -84,6 +179,7 @@ namespace VoxelEng {
 
 		/**
 		* @brief Locks the caller thread until this 'threadpool' object has no jobs left to process.
+		* That is, until all the submitted tasks are finished, including the ones submitted while waiting.
 		*/
 		void awaitNoJobs();
 
@@ -95,11 +191,6 @@ namespace VoxelEng {
 		*/
 		void awaitTermination();
 
-		/**
-		* Returns true if the thread pool is terminated or false otherwise.
-		*/
-		bool terminated() const;
-
 
 		// Destructors.
 
@@ -110,25 +201,149 @@ namespace VoxelEng {
 
 	private:
 
+		/*
+		Attributes.
+		*/
+
+		struct workerQueue {
+
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+
+		};
+
 		unsigned int nThreads_;
-		std::mutex jobsMutex_,
+		std::vector<std::unique_ptr<workerQueue>> queues_;
+		std::mutex sleepMutex_,
 				   callerMutex_;
-		std::condition_variable jobsAvailable_,
+		std::condition_variable tasksAvailable_,
 								callerCV_;
 		std::atomic<bool> shutdown_,
 					      terminated_;
-		std::atomic<unsigned int> nWorkingThreads_;
+		std::atomic<unsigned int> nQueuedTasks_, // Submitted tasks that have not started yet.
+								  nUnfinishedTasks_, // Submitted tasks that have not finished yet.
+								  nextQueue_;
 		std::vector<std::thread> pool_;
-		std::deque<job*> jobs_;
-	
+
+
+		/*
+		Methods.
+		*/
+
+		/*
+		Main loop of the pool's thread 'workerIndex'. It processes tasks
+		until the pool is shutdown and there are no tasks left.
+		*/
+		void waitForTask(unsigned int workerIndex);
+
+		/*
+		Enqueue 'task'. If the caller thread is one of the pool's threads, the task is added to its own
+		queue. Otherwise, the queues are chosen in a round-robin fashion.
+		*/
+		void enqueue(std::function<void()>&& task);
+
+		/*
+		Try to take a task from the queue of the worker 'workerIndex' (newest first) or, if it is empty,
+		from the other queues (oldest first). Returns false if no task was found.
+		*/
+		bool takeTask(unsigned int workerIndex, std::function<void()>& task);
+
+		/*
+		Run 'task' and update the pool's counters.
+		*/
+		void runTask(std::function<void()>& task);
+
+		/*
+		Returns the index of the pool's thread that is calling this method or nThreads_ if the
+		caller does not belong to this pool.
+		*/
+		unsigned int callerWorkerIndex() const;
+
 	};
 
+	inline unsigned int taskGroup::nPendingTasks() const {
+
+		return nPendingTasks_;
+
+	}
+
 	inline bool threadPool::terminated() const {
 
 		return terminated_;
 
 	}
 
+	inline unsigned int threadPool::nThreads() const {
+
+		return nThreads_;
+
+	}
+
+	template <typename F>
+	auto threadPool::submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+
+		using result = std::invoke_result_t<std::decay_t<F>>;
+
+		std::shared_ptr<std::packaged_task<result()>> packagedTask = std::make_shared<std::packaged_task<result()>>(std::forward<F>(task));
+		std::future<result> future = packagedTask->get_future();
+
+
+		enqueue([packagedTask]() { (*packagedTask)(); });
+
+		return future;
+
+	}
+
+	template <typename F>
+	auto threadPool::submit(taskGroup& group, F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+
+		using result = std::invoke_result_t<std::decay_t<F>>;
+
+		std::shared_ptr<std::packaged_task<result()>> packagedTask = std::make_shared<std::packaged_task<result()>>(std::forward<F>(task));
+		std::future<result> future = packagedTask->get_future();
+
+
+		group.nPendingTasks_++;
+		enqueue([packagedTask, &group]() {
+
+			(*packagedTask)();
+			group.taskFinished();
+
+		});
+
+		return future;
+
+	}
+
+	template <typename F>
+	void threadPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, F&& body) {
+
+		taskGroup group;
+		std::vector<std::future<void>> chunks;
+		grainSize = std::max<std::size_t>(grainSize, 1);
+
+
+		for (std::size_t chunkStart = begin; chunkStart < end; chunkStart += grainSize) {
+
+			std::size_t chunkEnd = std::min(chunkStart + grainSize, end);
+
+			chunks.push_back(submit(group, [&body, chunkStart, chunkEnd]() {
+
+				for (std::size_t i = chunkStart; i < chunkEnd; i++)
+					body(i);
+
+			}));
+
+		}
+
+		wait(group);
+
+		// Rethrow the first exception thrown by any of the chunks (if any).
+		for (std::future<void>& chunk : chunks)
+			chunk.get();
+
+	}
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -11,6 +11,7 @@
 #ifndef _VOXENG_UTILITIES_
 #define _VOXENG_UTILITIES_
 #include <cstddef>
+#include <cstdint>
 #include <concepts>
 #include <cmath>
 #include <string>
@@ -61,6 +62,26 @@ namespace VoxelEng {
 	};
 
 
+	/**
+	* @brief Returns the 64-bit FNV-1a hash of the 'size' bytes that start at 'data'.
+	* The result of a previous call can be passed as 'hash' to hash non-contiguous data.
+	*/
+	inline std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ull) {
+
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+		for (std::size_t i = 0; i < size; i++) {
+
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+
+		}
+
+		return hash;
+
+	}
+
+
 	// vec3 utility functions.
 
 	/**
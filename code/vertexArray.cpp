@@ -52,6 +52,23 @@ namespace VoxelEng {
 
     }
 
+    void vertexArray::addInstanceLayout(const vertexBufferLayout& layout, unsigned int firstIndex, std::size_t offset) {
+
+        const std::vector<vertexBufferElement>& elements = layout.elements();
+
+        for (unsigned int i = 0; i < elements.size(); i++) {
+
+            vertexBufferElement element = elements[i];
+
+            glEnableVertexAttribArray(firstIndex + i);
+            glVertexAttribPointer(firstIndex + i, element.count, element.type, element.is_normalized ? GL_TRUE : GL_FALSE, layout.stride(), (const void*) offset);
+            glVertexAttribDivisor(firstIndex + i, 1);
+            offset += element.count * graphicsAPISizeOf(element.type);
+
+        }
+
+    }
+
     void vertexArray::addDynamicBuffer(const vertexBuffer& vb, const vertexBufferLayout& layout, size_t size, const void* data) {
 
         bind();
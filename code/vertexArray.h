@@ -8,6 +8,7 @@
 */
 #ifndef _VOXELENG_VERTEXARRAY_
 #define _VOXELENG_VERTEXARRAY_
+#include <cstddef>
 #include "vertexBuffer.h"
 #include "vertexBufferLayout.h"
 
@@ -56,6 +57,14 @@ namespace VoxelEng {
 		*/
 		void addLayout(const vertexBufferLayout& layout);
 
+		/**
+		* @brief Add a vertex buffer layout whose attributes advance once per instance instead of once per vertex.
+		* Its attributes are given the indices from 'firstIndex' onwards and are read from the currently bound vertex buffer
+		* starting at the byte 'offset', which allows to draw a range of the instances stored in said buffer.
+		* WARNING. Must be called in a thread with valid graphics API context.
+		*/
+		void addInstanceLayout(const vertexBufferLayout& layout, unsigned int firstIndex, std::size_t offset);
+
 		/**
 		* @brief Submit vertex data from a vertex buffer object to an VAO which has been prepared for dynamic
 		* geometry with a call to vertexBuffer::prepareDynamic(...) done before this one.
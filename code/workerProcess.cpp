@@ -0,0 +1,440 @@
+#include "workerProcess.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include "logger.h"
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#else
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#endif
+
+
+namespace VoxelEng {
+
+	// 'processChannel' class.
+
+#ifdef _WIN32
+
+	processChannel::processChannel()
+		: readTimeout_(0), readHandle_(nullptr), writeHandle_(nullptr)
+	{}
+
+	processChannel::processChannel(const std::string& readHandle, const std::string& writeHandle)
+		: processChannel() {
+
+		try {
+
+			readHandle_ = reinterpret_cast<HANDLE>(static_cast<std::uintptr_t>(std::stoull(readHandle)));
+			writeHandle_ = reinterpret_cast<HANDLE>(static_cast<std::uintptr_t>(std::stoull(writeHandle)));
+
+		}
+		catch (...) {
+
+			logger::errorLog("Invalid process channel handles " + readHandle + ' ' + writeHandle);
+
+		}
+
+	}
+
+	bool processChannel::isOpen() const {
+
+		return readHandle_ != nullptr;
+
+	}
+
+	bool processChannel::read(void* data, std::size_t size) {
+
+		char* destination = static_cast<char*>(data);
+		DWORD nRead = 0,
+			  nAvailable = 0;
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(readTimeout_);
+
+
+		while (size) {
+
+			// Anonymous pipes do not support overlapped reads, so the timeout is implemented by peeking the pipe.
+			// If the pipe is broken, PeekNamedPipe() fails and so does the following ReadFile().
+			if (readTimeout_)
+				while (PeekNamedPipe(readHandle_, nullptr, 0, nullptr, &nAvailable, nullptr) && !nAvailable) {
+
+					if (std::chrono::steady_clock::now() >= deadline)
+						return false;
+
+					Sleep(1);
+
+				}
+
+			if (!ReadFile(readHandle_, destination, static_cast<DWORD>(std::min<std::size_t>(size, 1 << 30)), &nRead, nullptr) || !nRead)
+				return false;
+
+			destination += nRead;
+			size -= nRead;
+
+		}
+
+		return true;
+
+	}
+
+	bool processChannel::write(const void* data, std::size_t size) {
+
+		const char* source = static_cast<const char*>(data);
+		DWORD nWritten = 0;
+
+
+		while (size) {
+
+			if (!WriteFile(writeHandle_, source, static_cast<DWORD>(std::min<std::size_t>(size, 1 << 30)), &nWritten, nullptr))
+				return false;
+
+			source += nWritten;
+			size -= nWritten;
+
+		}
+
+		return true;
+
+	}
+
+	void processChannel::close() {
+
+		if (readHandle_) {
+
+			CloseHandle(readHandle_);
+			readHandle_ = nullptr;
+
+		}
+
+		if (writeHandle_) {
+
+			CloseHandle(writeHandle_);
+			writeHandle_ = nullptr;
+
+		}
+
+	}
+
+#else
+
+	processChannel::processChannel()
+		: readTimeout_(0), readDescriptor_(-1), writeDescriptor_(-1)
+	{}
+
+	processChannel::processChannel(const std::string& readHandle, const std::string& writeHandle)
+		: processChannel() {
+
+		try {
+
+			readDescriptor_ = std::stoi(readHandle);
+			writeDescriptor_ = std::stoi(writeHandle);
+
+		}
+		catch (...) {
+
+			logger::errorLog("Invalid process channel handles " + readHandle + ' ' + writeHandle);
+
+		}
+
+		// Writing into a closed pipe must fail instead of terminating the process.
+		std::signal(SIGPIPE, SIG_IGN);
+
+	}
+
+	bool processChannel::isOpen() const {
+
+		return readDescriptor_ != -1;
+
+	}
+
+	bool processChannel::read(void* data, std::size_t size) {
+
+		char* destination = static_cast<char*>(data);
+		ssize_t nRead = 0;
+		pollfd descriptor{ readDescriptor_, POLLIN, 0 };
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(readTimeout_);
+		int remaining = 0,
+			nReady = 0;
+
+
+		while (size) {
+
+			if (readTimeout_) {
+
+				remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+				nReady = poll(&descriptor, 1, std::max(remaining, 0));
+				if (nReady == -1 && errno == EINTR)
+					continue;
+				if (nReady <= 0)
+					return false;
+
+			}
+
+			nRead = ::read(readDescriptor_, destination, size);
+			if (nRead == -1 && errno == EINTR)
+				continue;
+			if (nRead <= 0)
+				return false;
+
+			destination += nRead;
+			size -= nRead;
+
+		}
+
+		return true;
+
+	}
+
+	bool processChannel::write(const void* data, std::size_t size) {
+
+		const char* source = static_cast<const char*>(data);
+		ssize_t nWritten = 0;
+
+
+		while (size) {
+
+			nWritten = ::write(writeDescriptor_, source, size);
+			if (nWritten == -1 && errno == EINTR)
+				continue;
+			if (nWritten <= 0)
+				return false;
+
+			source += nWritten;
+			size -= nWritten;
+
+		}
+
+		return true;
+
+	}
+
+	void processChannel::close() {
+
+		if (readDescriptor_ != -1) {
+
+			::close(readDescriptor_);
+			readDescriptor_ = -1;
+
+		}
+
+		if (writeDescriptor_ != -1) {
+
+			::close(writeDescriptor_);
+			writeDescriptor_ = -1;
+
+		}
+
+	}
+
+#endif
+
+	void processChannel::setReadTimeout(unsigned int milliseconds) {
+
+		readTimeout_ = milliseconds;
+
+	}
+
+	processChannel::~processChannel() {
+
+		close();
+
+	}
+
+
+	// 'workerProcess' class.
+
+#ifdef _WIN32
+
+	workerProcess::workerProcess()
+		: processHandle_(nullptr)
+	{}
+
+	void workerProcess::start(const std::string& executable, const std::vector<std::string>& args) {
+
+		SECURITY_ATTRIBUTES inheritable{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+		HANDLE toWorkerRead = nullptr,
+			   toWorkerWrite = nullptr,
+			   fromWorkerRead = nullptr,
+			   fromWorkerWrite = nullptr;
+		STARTUPINFOA startupInfo{ sizeof(STARTUPINFOA) };
+		PROCESS_INFORMATION processInfo{};
+		std::string commandLine = '"' + executable + '"';
+
+
+		if (isRunning())
+			logger::errorLog("The worker process is already running");
+
+		if (!CreatePipe(&toWorkerRead, &toWorkerWrite, &inheritable, 0))
+			logger::errorLog("Could not create the pipes for worker process " + executable);
+
+		if (!CreatePipe(&fromWorkerRead, &fromWorkerWrite, &inheritable, 0)) {
+
+			CloseHandle(toWorkerRead);
+			CloseHandle(toWorkerWrite);
+			logger::errorLog("Could not create the pipes for worker process " + executable);
+
+		}
+
+		// Only the worker's ends are inherited.
+		SetHandleInformation(toWorkerWrite, HANDLE_FLAG_INHERIT, 0);
+		SetHandleInformation(fromWorkerRead, HANDLE_FLAG_INHERIT, 0);
+
+		for (std::size_t i = 0; i < args.size(); i++)
+			commandLine += " \"" + args[i] + '"';
+		commandLine += ' ' + std::to_string(reinterpret_cast<std::uintptr_t>(toWorkerRead)) +
+					   ' ' + std::to_string(reinterpret_cast<std::uintptr_t>(fromWorkerWrite));
+
+		bool started = CreateProcessA(executable.c_str(), commandLine.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startupInfo, &processInfo);
+
+		CloseHandle(toWorkerRead);
+		CloseHandle(fromWorkerWrite);
+
+		if (!started) {
+
+			CloseHandle(toWorkerWrite);
+			CloseHandle(fromWorkerRead);
+			logger::errorLog("Could not start worker process " + executable);
+
+		}
+
+		CloseHandle(processInfo.hThread);
+		processHandle_ = processInfo.hProcess;
+		channel_.readHandle_ = fromWorkerRead;
+		channel_.writeHandle_ = toWorkerWrite;
+
+	}
+
+	void workerProcess::stop() {
+
+		channel_.close();
+
+		if (processHandle_) {
+
+			// The worker exits once it reads the end of the channel.
+			if (WaitForSingleObject(processHandle_, 10000) != WAIT_OBJECT_0)
+				TerminateProcess(processHandle_, 1);
+
+			CloseHandle(processHandle_);
+			processHandle_ = nullptr;
+
+		}
+
+	}
+
+#else
+
+	workerProcess::workerProcess()
+		: processID_(-1)
+	{}
+
+	void workerProcess::start(const std::string& executable, const std::vector<std::string>& args) {
+
+		int toWorker[2],
+			fromWorker[2];
+		std::vector<std::string> arguments;
+		std::vector<char*> argv;
+
+
+		if (isRunning())
+			logger::errorLog("The worker process is already running");
+
+		// Close-on-exec so that other workers do not inherit this worker's pipes.
+		// Otherwise, they would keep them open after this worker exits.
+		if (pipe2(toWorker, O_CLOEXEC) == -1)
+			logger::errorLog("Could not create the pipes for worker process " + executable);
+
+		if (pipe2(fromWorker, O_CLOEXEC) == -1) {
+
+			::close(toWorker[0]);
+			::close(toWorker[1]);
+			logger::errorLog("Could not create the pipes for worker process " + executable);
+
+		}
+
+		// Build the arguments before forking since the child may only call async-signal-safe functions.
+		arguments.push_back(executable);
+		arguments.insert(arguments.end(), args.cbegin(), args.cend());
+		arguments.push_back(std::to_string(toWorker[0]));
+		arguments.push_back(std::to_string(fromWorker[1]));
+		for (std::size_t i = 0; i < arguments.size(); i++)
+			argv.push_back(arguments[i].data());
+		argv.push_back(nullptr);
+
+		std::signal(SIGPIPE, SIG_IGN);
+
+		processID_ = fork();
+		if (processID_ == 0) {
+
+			fcntl(toWorker[0], F_SETFD, 0);
+			fcntl(fromWorker[1], F_SETFD, 0);
+			execv(executable.c_str(), argv.data());
+			_exit(127);
+
+		}
+
+		::close(toWorker[0]);
+		::close(fromWorker[1]);
+
+		if (processID_ == -1) {
+
+			::close(toWorker[1]);
+			::close(fromWorker[0]);
+			logger::errorLog("Could not start worker process " + executable);
+
+		}
+
+		channel_.readDescriptor_ = fromWorker[0];
+		channel_.writeDescriptor_ = toWorker[1];
+
+	}
+
+	void workerProcess::stop() {
+
+		int status = 0;
+		pid_t result = 0;
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+
+		channel_.close();
+
+		if (processID_ != -1) {
+
+			// The worker exits once it reads the end of the channel. As on Windows, it is killed if it does not within 10 seconds.
+			while ((result = waitpid(processID_, &status, WNOHANG)) == 0 && std::chrono::steady_clock::now() < deadline)
+				usleep(10000);
+
+			if (result == 0) {
+
+				kill(processID_, SIGKILL);
+				while (waitpid(processID_, &status, 0) == -1 && errno == EINTR);
+
+			}
+
+			processID_ = -1;
+
+		}
+
+	}
+
+#endif
+
+	workerProcess::~workerProcess() {
+
+		stop();
+
+	}
+
+}
@@ -0,0 +1,207 @@
+/**
+* @file workerProcess.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title Worker process.
+* @brief Contains the declaration of the 'processChannel' and 'workerProcess' classes.
+*/
+#ifndef _VOXELENG_WORKERPROCESS_
+#define _VOXELENG_WORKERPROCESS_
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace VoxelEng {
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Two-way binary channel between a process and one of its worker processes made of two anonymous pipes.
+	*/
+	class processChannel {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor. The channel is not opened.
+		*/
+		processChannel();
+
+		/**
+		* @brief Open the worker's end of a channel using the handles that the worker received in its command line arguments.
+		* Throws an exception if the handles are not valid numbers.
+		*/
+		processChannel(const std::string& readHandle, const std::string& writeHandle);
+
+		processChannel(const processChannel&) = delete;
+
+		processChannel& operator=(const processChannel&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns true if the channel is opened or false otherwise.
+		*/
+		bool isOpen() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Wait until 'size' bytes are received and store them in 'data'.
+		* Returns false if the other process closed its end of the channel or exited before sending them,
+		* or if they were not received within the channel's read timeout.
+		*/
+		bool read(void* data, std::size_t size);
+
+		/**
+		* @brief Send 'size' bytes from 'data'.
+		* Returns false if the other process closed its end of the channel or exited.
+		*/
+		bool write(const void* data, std::size_t size);
+
+		/**
+		* @brief Make processChannel::read() fail if the requested bytes are not received within 'milliseconds'.
+		* 0 means waiting forever (default).
+		*/
+		void setReadTimeout(unsigned int milliseconds);
+
+		/**
+		* @brief Close both pipes. The other process reads the end of the channel after this.
+		*/
+		void close();
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		*/
+		~processChannel();
+
+	private:
+
+		friend class workerProcess;
+
+
+		/*
+		Attributes.
+		*/
+
+		unsigned int readTimeout_;
+
+#ifdef _WIN32
+
+		void* readHandle_,
+			* writeHandle_;
+
+#else
+
+		int readDescriptor_,
+			writeDescriptor_;
+
+#endif
+
+	};
+
+
+	/**
+	* @brief A child process of the engine's executable that receives work through a 'processChannel'.
+	* A crash in the worker only closes its channel, so the process that started it can detect it and keep running.
+	*/
+	class workerProcess {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		workerProcess();
+
+		workerProcess(const workerProcess&) = delete;
+
+		workerProcess& operator=(const workerProcess&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns true if the worker has been started and not stopped yet or false otherwise.
+		* The worker may have exited on its own even if this returns true.
+		*/
+		bool isRunning() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Returns the channel used to communicate with the worker.
+		*/
+		processChannel& channel();
+
+		/**
+		* @brief Start the executable located at 'executable' with the arguments 'args' followed by the two handles
+		* that the worker must pass to processChannel::processChannel(const std::string&, const std::string&) to open its end of the channel.
+		* Throws an exception if the worker is already running or if it could not be started.
+		*/
+		void start(const std::string& executable, const std::vector<std::string>& args);
+
+		/**
+		* @brief Close the channel and wait for the worker to exit.
+		* The worker is killed if it does not exit within 10 seconds.
+		*/
+		void stop();
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		* Stops the worker if it is running.
+		*/
+		~workerProcess();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		processChannel channel_;
+
+#ifdef _WIN32
+
+		void* processHandle_;
+
+#else
+
+		int processID_;
+
+#endif
+
+	};
+
+	inline bool workerProcess::isRunning() const {
+
+		return channel_.isOpen();
+
+	}
+
+	inline processChannel& workerProcess::channel() {
+
+		return channel_;
+
+	}
+
+}
+
+#endif
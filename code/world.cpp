@@ -2,6 +2,7 @@
 #include "entity.h"
 #include "game.h"
 #include "logger.h"
+#include "worldContext.h"
 
 
 namespace VoxelEng {
@@ -9,14 +10,12 @@ namespace VoxelEng {
 	// 'world' class.
 
 	bool world::initialised_ = false;
-	std::unordered_map<std::string, tickFunc> world::globalTickFunctions_;
-	std::unordered_set<std::string> world::activeTickFunctions_;
-	std::mutex world::tickFunctionsMutex_;
 
 
 	void world::init() {
 	
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
 		if (initialised_)
 			logger::errorLog("The world class is already initialised");
@@ -27,14 +26,15 @@ namespace VoxelEng {
 
 	void world::addGlobalTickFunction(const std::string& name, tickFunc func, bool active) {
 	
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
-		if (globalTickFunctions_.find(name) == globalTickFunctions_.cend()) {
+		if (context.globalTickFunctions_.find(name) == context.globalTickFunctions_.cend()) {
 		
-			globalTickFunctions_[name] = func;
+			context.globalTickFunctions_[name] = func;
 
 			if (active)
-				activeTickFunctions_.insert(name);
+				context.activeTickFunctions_.insert(name);
 		
 		}
 		else
@@ -44,16 +44,17 @@ namespace VoxelEng {
 
 	void world::changeStateGlobalTickFunction(const std::string& name) {
 
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
-		if (globalTickFunctions_.find(name) == globalTickFunctions_.cend())
+		if (context.globalTickFunctions_.find(name) == context.globalTickFunctions_.cend())
 			logger::errorLog("A global tick function with the name " + name + " is not registered.");
 		else {
 		
-			if (activeTickFunctions_.find(name) != activeTickFunctions_.cend())
-				activeTickFunctions_.erase(name);
+			if (context.activeTickFunctions_.find(name) != context.activeTickFunctions_.cend())
+				context.activeTickFunctions_.erase(name);
 			else
-				activeTickFunctions_.insert(name);
+				context.activeTickFunctions_.insert(name);
 		
 		}
 
@@ -61,16 +62,17 @@ namespace VoxelEng {
 
 	void world::changeStateGlobalTickFunction(const std::string& name, bool active) {
 
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
-		if (globalTickFunctions_.find(name) == globalTickFunctions_.cend())
+		if (context.globalTickFunctions_.find(name) == context.globalTickFunctions_.cend())
 			logger::errorLog("A global tick function with the name " + name + " is not registered.");
 		else {
 
 			if (active)
-				activeTickFunctions_.insert(name);
+				context.activeTickFunctions_.insert(name);
 			else
-				activeTickFunctions_.erase(name);
+				context.activeTickFunctions_.erase(name);
 
 		}
 
@@ -78,14 +80,15 @@ namespace VoxelEng {
 
 	void world::deleteGlobalTickFunction(const std::string& name) {
 
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
-		if (globalTickFunctions_.find(name) == globalTickFunctions_.cend())
+		if (context.globalTickFunctions_.find(name) == context.globalTickFunctions_.cend())
 			logger::errorLog("A global tick function with the name " + name + " is not registered.");
 		else {
 
-			globalTickFunctions_.erase(name);
-			activeTickFunctions_.erase(name);
+			context.globalTickFunctions_.erase(name);
+			context.activeTickFunctions_.erase(name);
 
 		}
 
@@ -121,21 +124,23 @@ namespace VoxelEng {
 
 	void world::processGlobalTickFunctions() {
 	
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
-		for (auto it = activeTickFunctions_.cbegin(); it != activeTickFunctions_.cend(); it++)
-			globalTickFunctions_[*it]();
+		for (auto it = context.activeTickFunctions_.cbegin(); it != context.activeTickFunctions_.cend(); it++)
+			context.globalTickFunctions_[*it]();
 	
 	}
 
 	void world::cleanUp() {
 	
-		std::unique_lock<std::mutex> lock(tickFunctionsMutex_);
+		worldContext& context = worldContext::selected();
+		std::unique_lock<std::mutex> lock(context.tickFunctionsMutex_);
 
 		if (initialised_) {
 
-			globalTickFunctions_.clear();
-			activeTickFunctions_.clear();
+			context.globalTickFunctions_.clear();
+			context.activeTickFunctions_.clear();
 
 			initialised_ = false;
 
@@ -109,10 +109,7 @@ namespace VoxelEng {
 
 	private:
 
-		static bool initialised_;
-		static std::unordered_map<std::string, tickFunc> globalTickFunctions_;
-		static std::unordered_set<std::string> activeTickFunctions_;
-		static std::mutex tickFunctionsMutex_;
+		static bool initialised_; // The global tick functions are kept in the selected 'worldContext'.
 	
 	};
 
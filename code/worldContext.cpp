@@ -0,0 +1,53 @@
+#include "worldContext.h"
+#include "chunk.h"
+#include "entity.h"
+#include "threadPool.h"
+#include "worldGen.h"
+
+
+namespace VoxelEng {
+
+	// 'worldContext' class.
+
+	worldContext worldContext::defaultContext_;
+	thread_local worldContext* worldContext::selectedContext_ = nullptr;
+
+
+	worldContext::worldContext(unsigned int nChunksToCompute)
+		: nChunksToCompute_(nChunksToCompute), selectedAIWorld_(0), originalWorldAccess_(true),
+		  nextTickingEntity_(0), nTickThreads_(1), tickThreadPool_(nullptr), generator_(worldGen::createSelectedGenInstance())
+	{}
+
+	worldContext::worldContext()
+		: nChunksToCompute_(0), selectedAIWorld_(0), originalWorldAccess_(true), nextTickingEntity_(0), nTickThreads_(1),
+		  tickThreadPool_(nullptr), generator_(nullptr)
+	{}
+
+	worldContext::~worldContext() {
+
+		if (selectedContext_ == this)
+			selectedContext_ = nullptr;
+
+		if (tickThreadPool_) {
+
+			tickThreadPool_->shutdown();
+			tickThreadPool_->awaitTermination();
+			delete tickThreadPool_;
+
+		}
+
+		for (auto it = chunks_.begin(); it != chunks_.end(); it++)
+			delete it->second;
+		chunks_.clear();
+
+		for (auto it = AIagentChunks_.cbegin(); it != AIagentChunks_.cend(); it++)
+			for (auto itChunks = it->second.cbegin(); itChunks != it->second.cend(); itChunks++)
+				delete itChunks->second;
+		AIagentChunks_.clear();
+
+		if (generator_)
+			delete generator_;
+
+	}
+
+}
@@ -0,0 +1,208 @@
+/**
+* @file worldContext.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title World context.
+* @brief Contains the declaration of the 'worldContext' class.
+*/
+#ifndef _VOXELENG_WORLDCONTEXT_
+#define _VOXELENG_WORLDCONTEXT_
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <hash.hpp>
+#include "commandBuffer.h"
+#include "definitions.h"
+#include "hitbox.h"
+#include "mappedFile.h"
+#include "model.h"
+#include "sparseSet.h"
+#include "spatialIndex.h"
+
+
+namespace VoxelEng {
+
+	//////////////////////////////
+	//Forward class declaration.//
+	//////////////////////////////
+
+	class batch;
+	class chunk;
+	class chunkManager;
+	class entity;
+	class entityManager;
+	class threadPool;
+	class world;
+	class worldGen;
+
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief The state of one simulated level: its chunks, the copies of them used by AI agents, its entities,
+	* its global tick functions and the world generator used to generate it.
+	* The static API of 'chunkManager', 'entityManager', 'world' and 'worldGen' operates on the context selected
+	* in the calling thread, which is the default context unless another one is selected with worldContext::select().
+	* Since every thread can select its own context, several independent levels can be simulated at the same time
+	* in the same process, for example one AI population per thread.
+	* Rendering, level loading and the chunk/entity management threads only work with the default context.
+	*/
+	class worldContext {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Create a new empty context whose levels span 'nChunksToCompute' chunks in each direction of the XZ plane
+		* and that uses its own object of the selected world generator's class.
+		* The engine's systems must be initialised beforehand.
+		*/
+		worldContext(unsigned int nChunksToCompute);
+
+		worldContext(const worldContext&) = delete;
+
+		worldContext& operator=(const worldContext&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns the context selected in the calling thread.
+		*/
+		static worldContext& selected();
+
+		/**
+		* @brief Returns the context used by the threads that have not selected any other.
+		*/
+		static worldContext& defaultContext();
+
+
+		// Modifiers.
+
+		/**
+		* @brief Select 'context' as the context used by the static API in the calling thread.
+		* If 'context' is nullptr, the default context is selected.
+		* WARNING. The context must outlive its selection.
+		*/
+		static void select(worldContext* context);
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		* Frees the chunks, entities and world generator owned by the context.
+		*/
+		~worldContext();
+
+	private:
+
+		friend batch;
+		friend chunk;
+		friend chunkManager;
+		friend entity;
+		friend entityManager;
+		friend world;
+		friend worldGen;
+
+
+		/*
+		Attributes.
+		*/
+
+		static worldContext defaultContext_;
+		static thread_local worldContext* selectedContext_;
+
+		// Chunk management.
+		int nChunksToCompute_;
+		std::unordered_map<vec3, chunk*> chunks_;
+		std::recursive_mutex chunksMutex_;
+		std::unordered_map<unsigned int, std::unordered_map<vec3, bool>> AIChunkAvailable_;
+		std::unordered_map<unsigned int, std::unordered_map<vec3, chunk*>> AIagentChunks_;
+		unsigned int selectedAIWorld_;
+		bool originalWorldAccess_;
+		mappedFile AIWorldImage_;
+		std::unordered_map<vec3, const block*> AIWorldImageChunks_; // Block data of each chunk inside 'AIWorldImage_'.
+
+		// Entity management.
+		// The components of the entities are stored in parallel arrays indexed by entity ID.
+		std::vector<vec3> entityPos_,
+						  entityRot_;
+		std::vector<const model*> entityModel_;
+		std::vector<unsigned int> entityModelID_;
+		std::vector<tickFunc> entityTickFunc_;
+		std::vector<hitbox> entityHitbox_; // Relative to the entity's position.
+		std::vector<unsigned char> entityRotationFlags_; // Bits 0, 1 and 2 are set if the X, Y or Z rotation must be applied to the model.
+		std::vector<batch> batches_;
+		std::vector<unsigned int> entityBatch_, // Relates entity's ID with the batch it belongs to.
+								  entityBatchSlot_; // Position of each entity inside its batch's active or inactive entity list.
+		sparseSet activeEntityID_,
+				  activeBatchID_,
+				  freeEntityID_,
+				  freeBatchID_,
+				  inactiveEntityID_,
+				  inactiveBatchID_,
+				  deleteableEntityID_,
+				  tickingEntityID_; // Ring of the entities whose tick function is executed in turns.
+		std::size_t nextTickingEntity_; // Position inside 'tickingEntityID_' of the next entity to tick.
+		spatialIndex entityIndex_; // Positions of the active entities bucketed by chunk.
+		std::recursive_mutex entitiesMutex_,
+							 batchesMutex_;
+
+		// Parallel tick phase. See entityManager::setTickThreads().
+		unsigned int nTickThreads_;
+		threadPool* tickThreadPool_;
+		std::vector<commandBuffer> tickCommandBuffers_; // One per partition of the ticked entities.
+		std::vector<entityID> tickedEntityID_; // Entities to tick in the current frame.
+
+		// Global tick functions.
+		std::unordered_map<std::string, tickFunc> globalTickFunctions_;
+		std::unordered_set<std::string> activeTickFunctions_;
+		std::mutex tickFunctionsMutex_;
+
+		// World generation. nullptr means the selected world generator.
+		worldGen* generator_;
+
+
+		/*
+		Methods.
+		*/
+
+		// Constructors.
+
+		/*
+		Constructor of the default context, which uses the selected world generator
+		and gets its number of chunks to compute from chunkManager::init().
+		*/
+		worldContext();
+
+	};
+
+	inline worldContext& worldContext::selected() {
+
+		return selectedContext_ ? *selectedContext_ : defaultContext_;
+
+	}
+
+	inline worldContext& worldContext::defaultContext() {
+
+		return defaultContext_;
+
+	}
+
+	inline void worldContext::select(worldContext* context) {
+
+		selectedContext_ = context;
+
+	}
+
+}
+
+#endif
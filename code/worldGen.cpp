@@ -7,19 +7,22 @@ namespace VoxelEng {
 
 	// 'worldGen' class.
 
-	vec3 worldGen::playerSpawnPos_ = vec3Zero;
-	unsigned int worldGen::seed_ = 0;
 	std::random_device worldGen::RD_;
-	std::mt19937 worldGen::generator_(worldGen::RD_());
-	std::uniform_int_distribution<unsigned int> worldGen::uDistribution_(0, std::numeric_limits<unsigned int>::max());
 	std::uniform_int_distribution<unsigned int>::param_type worldGen::flatWorldBlockDistribution_(1, 3);
 	std::atomic<bool> worldGen::isCreatingAllowed_ = false; // To restrict constructor's use.
 	bool worldGen::initialised_ = false;
 	std::unordered_map<std::string, worldGen*> worldGen::generators_;
+	std::unordered_map<std::string, worldGen* (*)()> worldGen::factories_;
 	worldGen* worldGen::defaultGen_ = nullptr;
 	worldGen* worldGen::selectedGen_ = nullptr;
+	worldGen* (*worldGen::selectedFactory_)() = nullptr;
+
+
+	worldGen::worldGen()
+		: playerSpawnPos_(vec3Zero), seed_(0), generator_(RD_()),
+		  uDistribution_(0, std::numeric_limits<unsigned int>::max()), levelChunks_(nullptr)
+	{}
 
-	
 
 	void worldGen::init() {
 	
@@ -33,12 +36,16 @@ namespace VoxelEng {
 
 				{"default", new defaultWorldGen()}
 
+			};
+			factories_ = {
+
+				{"default", []() -> worldGen* { return new defaultWorldGen(); }}
+
 			};
 
 			defaultGen_ = generators_["default"];
 			selectedGen_ = defaultGen_;
-
-			playerSpawnPos_ = vec3Zero;
+			selectedFactory_ = factories_["default"];
 
 			initialised_ = true;
 
@@ -55,19 +62,21 @@ namespace VoxelEng {
 
 	}
 
+	worldGen* worldGen::createSelectedGenInstance() {
+
+		return selectedFactory_();
+
+	}
+
 	void worldGen::setSeed() {
 	
-		seed_ = uDistribution_(generator_);
-		generator_.seed(seed_);
-			
-		logger::debugLog("World generator seed: " + std::to_string(seed_));
+		selectedGen().newSeed_();
 
 	}
 
 	void worldGen::setSeed(unsigned int seed) {
 	
-		seed_ = seed;
-		generator_.seed(seed_);
+		selectedGen().useSeed_(seed);
 			
 	}
 
@@ -83,11 +92,16 @@ namespace VoxelEng {
 
 				worldGen* genToDelete = generators_[genName];
 
-				if (genToDelete == selectedGen_)
+				if (genToDelete == selectedGen_) {
+
 					selectedGen_ = defaultGen_;
+					selectedFactory_ = factories_["default"];
+
+				}
 
 				delete genToDelete;
 				generators_.erase(genName);
+				factories_.erase(genName);
 
 			}
 		
@@ -100,15 +114,62 @@ namespace VoxelEng {
 		for (auto it = generators_.begin(); it != generators_.cend(); it++)
 			delete it->second;
 		generators_.clear();
+		factories_.clear();
 
 		defaultGen_ = nullptr;
 		selectedGen_ = nullptr;
+		selectedFactory_ = nullptr;
 
 		initialised_ = false;
 	
 	}
 
 
+	void worldGen::newSeed_() {
+
+		seed_ = uDistribution_(generator_);
+		generator_.seed(seed_);
+
+		logger::debugLog("World generator seed: " + std::to_string(seed_));
+
+	}
+
+	void worldGen::useSeed_(unsigned int seed) {
+
+		seed_ = seed;
+		generator_.seed(seed_);
+
+	}
+
+	chunk* worldGen::levelChunk_(const vec3& chunkPos) {
+
+		if (!levelChunks_) {
+
+			if (chunkManager::getChunkLoadLevel(chunkPos) == chunkLoadLevel::NOTLOADED)
+				return chunkManager::createChunk(true, chunkPos);
+			else
+				return chunkManager::selectChunkByChunkPos(chunkPos);
+
+		}
+		else {
+
+			auto it = levelChunks_->find(chunkPos);
+			if (it == levelChunks_->cend())
+				return levelChunks_->insert({ chunkPos, new chunk(true, chunkPos) }).first->second;
+			else {
+
+				if (it->second->loadLevel() == chunkLoadLevel::NOTLOADED)
+					it->second->regenChunk(true, chunkPos);
+
+				return it->second;
+
+			}
+
+		}
+
+	}
+
+
 	// 'defaultWorldGen' class.
 
 	void defaultWorldGen::prepareGen_() {
@@ -117,7 +178,7 @@ namespace VoxelEng {
 		playerSpawnPos_.y = 150;
 		playerSpawnPos_.z = 0;
 
-		setSeed();
+		newSeed_();
 
 	}
 
@@ -18,6 +18,7 @@
 #include "chunk.h"
 #include "logger.h"
 #include "definitions.h"
+#include "worldContext.h"
 
 
 namespace VoxelEng {
@@ -28,6 +29,7 @@ namespace VoxelEng {
 
 	class chunk;
 	class chunkManager;
+	class worldProducer;
 
 
 	/**
@@ -62,11 +64,12 @@ namespace VoxelEng {
 		* to the subclass that is being used in the loaded AI game.
 		* By default the returned pointer points to an existing built-in 'worldGen' object
 		* so no need to check if it is returning null.
+		* If the 'worldContext' selected in the calling thread has its own world generator, that one is returned instead.
 		*/
 		static const worldGen& cSelectedGen();
 
 		/**
-		* @brief Returns the current user spawn position into the world.
+		* @brief Returns the current user spawn position into the world of the selected world generator.
 		*/
 		static const vec3& playerSpawnPos();
 
@@ -77,11 +80,19 @@ namespace VoxelEng {
 		static bool isGenRegistered(const std::string& name);
 
 		/**
-		* @brief Returns the current level's seed. Used for adding a controlled randomness
+		* @brief Returns the current level's seed of the selected world generator. Used for adding a controlled randomness
 		* factor to world generation.
 		*/
 		static unsigned int getSeed();
 
+		/**
+		* @brief Returns a new object of the same class as the selected world generator that is neither registered nor selected.
+		* Since each world generator object has its own seed and random number generator, the returned object can
+		* generate levels in another thread without interfering with the selected world generator.
+		* WARNING. The caller takes ownership of the returned object.
+		*/
+		static worldGen* createSelectedGenInstance();
+
 
 		// Modifiers.
 
@@ -112,7 +123,8 @@ namespace VoxelEng {
 		static void selectGen(const std::string& genName);
 
 		/**
-		* @brief Sets the specified world generator as current loaded and selected world generator.
+		* @brief Returns the currently loaded and selected world generator.
+		* If the 'worldContext' selected in the calling thread has its own world generator, that one is returned instead.
 		*/
 		static worldGen& selectedGen();
 
@@ -154,18 +166,39 @@ namespace VoxelEng {
 		*/
 		static void cleanUp();
 
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		*/
+		virtual ~worldGen() = default;
+
 	protected:
 
+		// Constructors.
+
+		worldGen();
+
+
 		/*
 		Attributes.
 		*/
-		static vec3 playerSpawnPos_;
-		static unsigned int seed_;
+
 		static std::random_device RD_;
-		static std::mt19937 generator_;
-		static std::uniform_int_distribution<unsigned int> uDistribution_;
 		static std::uniform_int_distribution<unsigned int>::param_type flatWorldBlockDistribution_;
 
+		vec3 playerSpawnPos_;
+		unsigned int seed_;
+		std::mt19937 generator_;
+
+		// Per instance since the world producer threads generate with their own generator instances concurrently.
+		std::uniform_int_distribution<unsigned int> uDistribution_;
+
+		// Chunks of the level that is being generated by this object when it is not the selected world generator.
+		// If nullptr, the level is the one managed by the chunk management system.
+		std::unordered_map<vec3, chunk*>* levelChunks_;
+
 
 		/*
 		Methods.
@@ -183,25 +216,46 @@ namespace VoxelEng {
 		*/
 		virtual void generate_(chunk& chunk) = 0;
 
+		/*
+		Sets a random seed for this world generator object.
+		*/
+		void newSeed_();
+
+		/*
+		Sets the specified seed for this world generator object.
+		*/
+		void useSeed_(unsigned int seed);
+
+		/*
+		Returns the chunk located at 'chunkPos' in the level that is being generated,
+		creating an empty one if said chunk has not been generated yet.
+		Used by world generators that place blocks outside of the chunk they are generating.
+		*/
+		chunk* levelChunk_(const vec3& chunkPos);
+
 	private:
 
+		friend worldProducer;
+
 		static std::atomic<bool> isCreatingAllowed_; // To restrict constructor's use.
 		static bool initialised_;
 		static std::unordered_map<std::string, worldGen*> generators_;
+		static std::unordered_map<std::string, worldGen* (*)()> factories_;
 		static worldGen* selectedGen_,
 					   * defaultGen_;
+		static worldGen* (*selectedFactory_)();
 		
 	};
 
 	inline const worldGen& worldGen::cSelectedGen() {
 
-		return *selectedGen_;
+		return selectedGen();
 	
 	}
 
 	inline const vec3& worldGen::playerSpawnPos() {
 	
-		return playerSpawnPos_;
+		return selectedGen().playerSpawnPos_;
 	
 	}
 
@@ -213,13 +267,16 @@ namespace VoxelEng {
 
 	inline unsigned int worldGen::getSeed() {
 	
-		return seed_;
+		return selectedGen().seed_;
 	
 	}
 
 	inline worldGen& worldGen::selectedGen() {
 
-		return *selectedGen_;
+		worldGen* contextGen = worldContext::selected().generator_;
+
+
+		return contextGen ? *contextGen : *selectedGen_;
 
 	}
 
@@ -239,24 +296,26 @@ namespace VoxelEng {
 	inline void worldGen::registerGen(const std::string& genName) {
 
 		generators_.insert({ genName, new T() });
+		factories_.insert({ genName, []() -> worldGen* { return new T(); } });
 
 	}
 
 	inline void worldGen::selectGen(const std::string& genName) {
 
 		selectedGen_ = generators_[genName];
+		selectedFactory_ = factories_[genName];
 
 	}
 
 	inline void worldGen::prepareGen() {
 	
-		selectedGen_->prepareGen_();
+		selectedGen().prepareGen_();
 	
 	}
 
 	inline void worldGen::generate(chunk& chunk) {
 
-		selectedGen_->generate_(chunk);
+		selectedGen().generate_(chunk);
 	
 	}
 
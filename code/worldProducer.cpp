@@ -0,0 +1,253 @@
+#include "worldProducer.h"
+#include <algorithm>
+#include "worldGen.h"
+#include "logger.h"
+
+
+namespace VoxelEng {
+
+	// 'worldProducer' class.
+
+	worldProducer::worldProducer()
+		: nChunksToCompute_(0), maxQueuedWorlds_(0), nClaimedWorlds_(0), nTakenWorlds_(0), stop_(false)
+	{}
+
+	void worldProducer::start(const std::vector<unsigned int>& seeds, int nChunksToCompute, std::size_t maxQueuedWorlds,
+							  std::size_t memoryCap, unsigned int nThreads) {
+
+		if (isRunning())
+			logger::errorLog("The world producer is already running");
+
+		std::size_t nChunks = std::size_t(2 * yChunksRange) * (2 * nChunksToCompute) * (2 * nChunksToCompute),
+					worldSize = nChunks * (sizeof(chunk) + sizeof(std::pair<const vec3, chunk*>));
+
+
+		seeds_ = seeds;
+		nChunksToCompute_ = nChunksToCompute;
+		maxQueuedWorlds_ = std::max<std::size_t>(1, std::min(maxQueuedWorlds, memoryCap / worldSize));
+		nClaimedWorlds_ = 0;
+		nTakenWorlds_ = 0;
+		stop_ = false;
+		error_ = nullptr;
+
+		logger::debugLog("Generating up to " + std::to_string(maxQueuedWorlds_) + " worlds in advance (" +
+						 std::to_string(worldSize >> 20) + " MB per world)");
+
+		for (unsigned int i = 0; i < std::max(1u, nThreads); i++) {
+
+			generators_.push_back(worldGen::createSelectedGenInstance());
+			threads_.emplace_back(&worldProducer::producerLoop, this, generators_.back());
+
+		}
+
+	}
+
+	bool worldProducer::takeWorld(producedWorld& world) {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+
+		if (nTakenWorlds_ == seeds_.size())
+			return false;
+
+		readyCV_.wait(lock, [this]() { return error_ || readyWorlds_.find(nTakenWorlds_) != readyWorlds_.cend(); });
+
+		if (error_)
+			std::rethrow_exception(error_);
+
+		auto it = readyWorlds_.find(nTakenWorlds_);
+		world.seed = it->second.seed;
+		world.chunks.swap(it->second.chunks);
+		readyWorlds_.erase(it);
+		nTakenWorlds_++;
+
+		lock.unlock();
+		spaceCV_.notify_all();
+
+		return true;
+
+	}
+
+	void worldProducer::recycleChunks(std::unordered_map<vec3, chunk*>& chunks) {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+
+		for (auto it = chunks.begin(); it != chunks.end(); it++)
+			freeChunks_.push_back(it->second);
+		chunks.clear();
+
+	}
+
+	void worldProducer::stop() {
+
+		{
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			stop_ = true;
+
+		}
+		spaceCV_.notify_all();
+
+		for (std::size_t i = 0; i < threads_.size(); i++)
+			threads_[i].join();
+		threads_.clear();
+
+		for (std::size_t i = 0; i < generators_.size(); i++)
+			delete generators_[i];
+		generators_.clear();
+
+		for (auto it = readyWorlds_.begin(); it != readyWorlds_.end(); it++)
+			deleteChunks(it->second.chunks);
+		readyWorlds_.clear();
+
+		for (std::size_t i = 0; i < freeChunks_.size(); i++)
+			delete freeChunks_[i];
+		freeChunks_.clear();
+
+		seeds_.clear();
+
+	}
+
+	worldProducer::~worldProducer() {
+
+		stop();
+
+	}
+
+	void worldProducer::producerLoop(worldGen* generator) {
+
+		std::size_t nChunks = std::size_t(2 * yChunksRange) * (2 * nChunksToCompute_) * (2 * nChunksToCompute_),
+					worldIndex = 0;
+		std::vector<chunk*> chunks;
+		producedWorld world;
+		bool generated = false;
+
+
+		try {
+
+			while (true) {
+
+				{
+
+					std::unique_lock<std::mutex> lock(mutex_);
+					spaceCV_.wait(lock, [this]() { return stop_ || nClaimedWorlds_ == seeds_.size() ||
+														  nClaimedWorlds_ < nTakenWorlds_ + maxQueuedWorlds_; });
+
+					if (stop_ || nClaimedWorlds_ == seeds_.size())
+						break;
+
+					worldIndex = nClaimedWorlds_++;
+
+					// Reuse the chunks of the levels that are no longer used.
+					std::size_t nReused = std::min(nChunks, freeChunks_.size());
+					chunks.assign(freeChunks_.end() - nReused, freeChunks_.end());
+					freeChunks_.resize(freeChunks_.size() - nReused);
+
+				}
+
+				generated = generateWorld(generator, seeds_[worldIndex], chunks, world);
+
+				std::unique_lock<std::mutex> lock(mutex_);
+				if (!generated) {
+
+					deleteChunks(world.chunks);
+					break;
+
+				}
+
+				readyWorlds_[worldIndex] = std::move(world);
+				world.chunks.clear();
+
+				lock.unlock();
+				readyCV_.notify_all();
+
+			}
+
+		}
+		catch (...) {
+
+			deleteChunks(world.chunks);
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			error_ = std::current_exception();
+
+			lock.unlock();
+			readyCV_.notify_all();
+
+		}
+
+	}
+
+	bool worldProducer::generateWorld(worldGen* generator, unsigned int seed, std::vector<chunk*>& chunks, producedWorld& world) {
+
+		vec3 chunkPos;
+		chunk* selectedChunk = nullptr;
+		std::size_t nextChunk = 0;
+
+
+		world.seed = seed;
+		world.chunks.clear();
+
+		// Reused chunks are treated as if they were not generated yet
+		// in case the world generator needs to place blocks in them beforehand.
+		for (chunkPos.y = -yChunksRange; chunkPos.y < yChunksRange; chunkPos.y++)
+			for (chunkPos.x = -nChunksToCompute_; chunkPos.x < nChunksToCompute_; chunkPos.x++)
+				for (chunkPos.z = -nChunksToCompute_; chunkPos.z < nChunksToCompute_ && nextChunk < chunks.size(); chunkPos.z++) {
+
+					selectedChunk = chunks[nextChunk++];
+					selectedChunk->regenChunk(true, chunkPos);
+					selectedChunk->setLoadLevel(chunkLoadLevel::NOTLOADED);
+					world.chunks.insert({ chunkPos, selectedChunk });
+
+				}
+		chunks.clear();
+
+		// Same steps as in chunkManager::generateAIWorld() but on 'world.chunks' instead of the chunks managed by the chunk management system.
+		generator->levelChunks_ = &world.chunks;
+		generator->useSeed_(seed);
+		generator->prepareGen_();
+
+		for (chunkPos.y = -yChunksRange; chunkPos.y < yChunksRange; chunkPos.y++) {
+
+			if (stop_) {
+
+				generator->levelChunks_ = nullptr;
+				return false;
+
+			}
+
+			for (chunkPos.x = -nChunksToCompute_; chunkPos.x < nChunksToCompute_; chunkPos.x++)
+				for (chunkPos.z = -nChunksToCompute_; chunkPos.z < nChunksToCompute_; chunkPos.z++) {
+
+					auto it = world.chunks.find(chunkPos);
+					if (it == world.chunks.cend())
+						selectedChunk = world.chunks.insert({ chunkPos, new chunk(true, chunkPos) }).first->second;
+					else {
+
+						selectedChunk = it->second;
+						selectedChunk->regenChunk(true, chunkPos);
+
+					}
+
+					generator->generate_(*selectedChunk);
+
+				}
+
+		}
+
+		generator->levelChunks_ = nullptr;
+
+		return true;
+
+	}
+
+	void worldProducer::deleteChunks(std::unordered_map<vec3, chunk*>& chunks) {
+
+		for (auto it = chunks.begin(); it != chunks.end(); it++)
+			delete it->second;
+		chunks.clear();
+
+	}
+
+}
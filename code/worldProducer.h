@@ -0,0 +1,178 @@
+/**
+* @file worldProducer.h
+* @version 1.0
+* @date 20/04/2023
+* @author Abdon Crespo Alvarez
+* @title World producer.
+* @brief Contains the declaration of the 'worldProducer' class.
+*/
+#ifndef _VOXELENG_WORLDPRODUCER_
+#define _VOXELENG_WORLDPRODUCER_
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "chunk.h"
+
+
+namespace VoxelEng {
+
+	//////////////////////////////
+	//Forward class declaration.//
+	//////////////////////////////
+
+	class worldGen;
+
+
+	////////////
+	//Structs.//
+	////////////
+
+	/**
+	* @brief A level generated in advance by a 'worldProducer' object.
+	*/
+	struct producedWorld {
+
+		unsigned int seed;
+		std::unordered_map<vec3, chunk*> chunks;
+
+	};
+
+
+	////////////
+	//Classes.//
+	////////////
+
+	/**
+	* @brief Generates levels in background threads so that they are ready by the time they are needed.
+	* The seed of each level is fixed in advance, so the generated levels do not depend on when or in which thread they are generated.
+	* Each thread uses its own object of the selected world generator's class. The levels are taken in the same order as their seeds were given.
+	*/
+	class worldProducer {
+
+	public:
+
+		// Constructors.
+
+		/**
+		* @brief Class constructor.
+		*/
+		worldProducer();
+
+		worldProducer(const worldProducer&) = delete;
+
+		worldProducer& operator=(const worldProducer&) = delete;
+
+
+		// Observers.
+
+		/**
+		* @brief Returns true if the producer has been started and not stopped yet or false otherwise.
+		*/
+		bool isRunning() const;
+
+		/**
+		* @brief Returns the maximum number of levels that can be generated ahead of the last one taken.
+		*/
+		std::size_t maxQueuedWorlds() const;
+
+
+		// Modifiers.
+
+		/**
+		* @brief Start generating in the background one level per seed in 'seeds' with the selected world generator.
+		* Each level spans the same chunks as the ones generated by chunkManager::generateAIWorld() when 'nChunksToCompute'
+		* chunks are computed.
+		* At most 'maxQueuedWorlds' levels are generated ahead of the last one taken, and less if they would need more than
+		* 'memoryCap' bytes. One level is always allowed regardless of 'memoryCap'.
+		* 'nThreads' levels are generated at the same time at most.
+		* Throws an exception if the producer is already running.
+		*/
+		void start(const std::vector<unsigned int>& seeds, int nChunksToCompute, std::size_t maxQueuedWorlds,
+				   std::size_t memoryCap, unsigned int nThreads = 1);
+
+		/**
+		* @brief Wait until the next level is generated and move it into 'world'. 'world.chunks' must be empty.
+		* Returns false if all the levels have already been taken.
+		* Throws an exception if the generation of the level failed.
+		*/
+		bool takeWorld(producedWorld& world);
+
+		/**
+		* @brief Give back the chunks of a level that is no longer used so that they are reused in the next levels.
+		* 'chunks' is left empty.
+		*/
+		void recycleChunks(std::unordered_map<vec3, chunk*>& chunks);
+
+		/**
+		* @brief Stop the generation threads and free the levels that were not taken.
+		*/
+		void stop();
+
+
+		// Destructors.
+
+		/**
+		* @brief Class destructor.
+		* Stops the producer if it is running.
+		*/
+		~worldProducer();
+
+	private:
+
+		/*
+		Attributes.
+		*/
+
+		std::vector<unsigned int> seeds_;
+		int nChunksToCompute_;
+		std::size_t maxQueuedWorlds_,
+					nClaimedWorlds_,
+					nTakenWorlds_;
+		std::map<std::size_t, producedWorld> readyWorlds_; // Sorted by the position of their seed in 'seeds_'.
+		std::vector<chunk*> freeChunks_;
+		std::vector<worldGen*> generators_;
+		std::vector<std::thread> threads_;
+		std::mutex mutex_;
+		std::condition_variable readyCV_,
+								spaceCV_;
+		std::atomic<bool> stop_;
+		std::exception_ptr error_;
+
+
+		/*
+		Methods.
+		*/
+
+		void producerLoop(worldGen* generator);
+
+		/*
+		Generates the level with the specified seed into 'world' using 'generator'.
+		'chunks' are reused for the level's chunks. Returns false if the producer was stopped meanwhile.
+		*/
+		bool generateWorld(worldGen* generator, unsigned int seed, std::vector<chunk*>& chunks, producedWorld& world);
+
+		static void deleteChunks(std::unordered_map<vec3, chunk*>& chunks);
+
+	};
+
+	inline bool worldProducer::isRunning() const {
+
+		return !threads_.empty();
+
+	}
+
+	inline std::size_t worldProducer::maxQueuedWorlds() const {
+
+		return maxQueuedWorlds_;
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,24 @@
+#include "/root/repo/code/threadPool.h"
+#include <cstdio>
+#include <atomic>
+using namespace VoxelEng;
+struct J : job { std::atomic<int>* c; void process() override { (*c)++; } };
+int main(){
+  for (int rep=0; rep<200; rep++){
+    threadPool p(4);
+    std::atomic<int> c{0};
+    std::vector<J> js(64); for(auto&j:js) j.c=&c;
+    taskGroup g;
+    for (int it=0; it<20; it++){ for(auto&j:js) p.submitJob(&j,g); p.wait(g);}    
+    if (c!=64*20) printf("bad %d\n", (int)c.load());
+    std::atomic<long> s{0};
+    p.parallelFor(0,10000,7,[&](size_t i){ s+=i; });
+    if (s!=49995000) printf("bad pf\n");
+    // nested
+    taskGroup g2; std::atomic<int> n{0};
+    for(int i=0;i<8;i++) p.submit(g2,[&]{ taskGroup inner; for(int k=0;k<8;k++) p.submit(inner,[&]{n++;}); p.wait(inner); });
+    p.wait(g2); if(n!=64) printf("bad nested\n");
+    for(auto&j:js) p.submitJob(&j); p.awaitNoJobs();
+  }
+  puts("ok");
+}